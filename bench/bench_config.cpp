@@ -0,0 +1,48 @@
+/**
+ * @file bench_config.cpp
+ * @brief Бенчмарки разрешения ссылок ${variable} в конфигурации
+ *
+ * @date 2025
+ */
+
+#include "src/config.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <unordered_map>
+
+namespace {
+
+/**
+ * @brief Строит конфигурацию, где каждое значение ссылается на предыдущее
+ *
+ * @param size Количество параметров
+ * @return std::unordered_map<std::string, std::string> Параметры конфигурации
+ */
+std::unordered_map<std::string, std::string> MakeChainedConfig(int size) {
+    std::unordered_map<std::string, std::string> config;
+    config["VAR_0"] = "localhost";
+    for (int i = 1; i < size; ++i) {
+        config["VAR_" + std::to_string(i)] = "${VAR_" + std::to_string(i - 1) + "}:" +
+                                             std::to_string(i);
+    }
+    return config;
+}
+
+}  // namespace
+
+/**
+ * @brief Разрешение цепочки ссылок
+ *
+ * @param state.range(0) Количество параметров
+ */
+static void BmResolveNested(benchmark::State& state) {
+    const auto file = MakeChainedConfig(static_cast<int>(state.range(0)));
+    const std::unordered_map<std::string, std::string> env = {
+        {"HOME", "/root"}, {"PATH", "/usr/bin:/bin"}};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ConfigManager::ResolveNested(env, file));
+    }
+}
+BENCHMARK(BmResolveNested)->Arg(8)->Arg(32)->Arg(128);
@@ -0,0 +1,92 @@
+/**
+ * @file bench_connection_pool.cpp
+ * @brief Бенчмарки получения и возврата соединений пула под конкуренцией
+ *
+ * Пул параметризуется фиктивным соединением, поэтому измеряются только
+ * накладные расходы синхронизации пула, без сетевых обращений к PostgreSQL.
+ *
+ * @date 2025
+ */
+
+#include "src/connection_pool.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+namespace {
+
+/**
+ * @brief Соединение-заглушка без сетевого взаимодействия
+ */
+struct FakeConnection {
+    uint64_t queries = 0;  ///< Количество "выполненных" запросов
+};
+
+/// Пул, общий для всех потоков одного запуска бенчмарка
+std::unique_ptr<BasicConnectionPool<FakeConnection>> g_pool;
+
+/// Ожидание соединения, заведомо достаточное для бенчмарка
+constexpr std::chrono::milliseconds kAcquireTimeout{1000};
+
+}  // namespace
+
+/**
+ * @brief Acquire/Release из нескольких потоков
+ *
+ * @param state.range(0) Размер пула
+ */
+static void BmAcquireRelease(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        g_pool = std::make_unique<BasicConnectionPool<FakeConnection>>(
+            static_cast<uint64_t>(state.range(0)));
+    }
+    for (auto _ : state) {
+        auto connection = g_pool->Acquire(kAcquireTimeout);
+        ++connection->queries;
+        benchmark::DoNotOptimize(connection->queries);
+    }
+    if (state.thread_index() == 0) {
+        g_pool.reset();
+    }
+}
+BENCHMARK(BmAcquireRelease)
+    ->Arg(4)
+    ->Arg(16)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+/**
+ * @brief TryAcquire/Release из нескольких потоков без ожидания
+ *
+ * Неудачные попытки на исчерпанном пуле тоже входят в итерации:
+ * измеряется стоимость отказа, который Session превращает в ответ 503.
+ *
+ * @param state.range(0) Размер пула
+ */
+static void BmTryAcquire(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        g_pool = std::make_unique<BasicConnectionPool<FakeConnection>>(
+            static_cast<uint64_t>(state.range(0)));
+    }
+    int64_t misses = 0;
+    for (auto _ : state) {
+        auto connection = g_pool->TryAcquire();
+        if (connection) {
+            ++(*connection)->queries;
+        } else {
+            ++misses;
+        }
+    }
+    state.counters["misses"] = benchmark::Counter(
+        static_cast<double>(misses), benchmark::Counter::kIsRate);
+    if (state.thread_index() == 0) {
+        g_pool.reset();
+    }
+}
+BENCHMARK(BmTryAcquire)
+    ->Arg(4)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
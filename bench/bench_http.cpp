@@ -0,0 +1,88 @@
+/**
+ * @file bench_http.cpp
+ * @brief Бенчмарки разбора HTTP запросов и построения ответов
+ *
+ * Измеряются:
+ * - Разбор типичного запроса браузера целиком и по частям
+ * - Сборка ответа HttpResponseBuilder в последовательность буферов
+ *
+ * @date 2025
+ */
+
+#include "src/http_parser.hpp"
+#include "src/http_response.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <string_view>
+
+namespace {
+
+/// Запрос, который присылает браузер при открытии страницы
+constexpr std::string_view kBrowserRequest =
+    "GET / HTTP/1.1\r\n"
+    "Host: localhost:8000\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:128.0) Gecko/20100101 Firefox/128.0\r\n"
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+    "Accept-Language: en-US,en;q=0.5\r\n"
+    "Accept-Encoding: gzip, deflate, br, zstd\r\n"
+    "Connection: keep-alive\r\n"
+    "Upgrade-Insecure-Requests: 1\r\n"
+    "Sec-Fetch-Dest: document\r\n"
+    "Sec-Fetch-Mode: navigate\r\n"
+    "Sec-Fetch-Site: none\r\n"
+    "\r\n";
+
+}  // namespace
+
+/**
+ * @brief Разбор запроса, полностью находящегося в буфере
+ */
+static void BmParseRequest(benchmark::State& state) {
+    HttpRequestParser parser;
+    for (auto _ : state) {
+        parser.Reset();
+        benchmark::DoNotOptimize(parser.Parse(kBrowserRequest));
+        const HttpRequest request = parser.Request(kBrowserRequest);
+        benchmark::DoNotOptimize(request.KeepAlive());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * kBrowserRequest.size()));
+}
+BENCHMARK(BmParseRequest);
+
+/**
+ * @brief Разбор запроса, пришедшего несколькими чтениями
+ *
+ * @param state.range(0) Количество частей
+ */
+static void BmParseRequestFragmented(benchmark::State& state) {
+    const auto parts = static_cast<std::size_t>(state.range(0));
+    const std::size_t step = kBrowserRequest.size() / parts;
+    HttpRequestParser parser;
+    for (auto _ : state) {
+        parser.Reset();
+        for (std::size_t size = step; size < kBrowserRequest.size(); size += step) {
+            benchmark::DoNotOptimize(parser.Parse(kBrowserRequest.substr(0, size)));
+        }
+        benchmark::DoNotOptimize(parser.Parse(kBrowserRequest));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * kBrowserRequest.size()));
+}
+BENCHMARK(BmParseRequestFragmented)->Arg(2)->Arg(8)->Arg(64);
+
+/**
+ * @brief Сборка ответа со счетчиком посещений
+ */
+static void BmBuildResponse(benchmark::State& state) {
+    HttpResponseBuilder builder;
+    uint64_t visits = 1234567;
+    for (auto _ : state) {
+        builder.Start(HttpResponseBuilder::kHeadOkHtml);
+        builder.AppendBody("Hello, world! Visits: ");
+        builder.AppendBody(visits++);
+        builder.SetKeepAlive(true);
+        benchmark::DoNotOptimize(builder.Finish());
+    }
+}
+BENCHMARK(BmBuildResponse);
@@ -0,0 +1,137 @@
+/**
+ * @file bench_storage.cpp
+ * @brief Бенчмарки записи и чтения встроенных хранилищ
+ *
+ * Сравниваются хранилище в памяти процесса и журнал в отображаемых
+ * сегментах на тех же операциях, что выполняют BatchedVisitRecorder и
+ * MessageStore: запись пакета посещений, групповая запись сообщений,
+ * чтение страницы истории.
+ *
+ * @date 2025
+ */
+
+#include "src/log_database.hpp"
+#include "src/memory_database.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+/// Каталог журнала бенчмарков
+const std::filesystem::path kLogDir =
+    std::filesystem::temp_directory_path() / "p2p_chat_bench_storage";
+
+/// Хранилище, общее для всех потоков одного запуска бенчмарка
+std::unique_ptr<IDatabaseService> g_db;
+
+/**
+ * @brief Создает хранилище: 0 - в памяти, 1 - журнал со сбросом раз в секунду
+ */
+std::unique_ptr<IDatabaseService> MakeBackend(int64_t kind) {
+    if (kind == 0) {
+        return std::make_unique<InMemoryDatabase>();
+    }
+    std::filesystem::remove_all(kLogDir);
+    return std::make_unique<LogDatabase>(LogDatabase::Options{
+        kLogDir.string(), std::size_t{64} << 20, std::chrono::milliseconds(1000)});
+}
+
+/**
+ * @brief Закрывает хранилище и удаляет журнал
+ */
+void DropBackend() {
+    g_db.reset();
+    std::filesystem::remove_all(kLogDir);
+}
+
+/**
+ * @brief Пакет сообщений комнаты с идентификаторами с first
+ */
+std::vector<ChatMessage> MessageBatch(uint16_t room, uint64_t first, std::size_t size) {
+    std::vector<ChatMessage> batch;
+    batch.reserve(size);
+    const auto now = std::chrono::system_clock::now();
+    for (std::size_t i = 0; i < size; ++i) {
+        batch.push_back(ChatMessage{first + i, room, "alice", std::string(64, 'x'), now});
+    }
+    return batch;
+}
+
+}  // namespace
+
+/**
+ * @brief Запись пакетов по 256 посещений из нескольких потоков
+ *
+ * @param state.range(0) Хранилище: 0 - в памяти, 1 - журнал
+ */
+static void BmMarkVisits(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        g_db = MakeBackend(state.range(0));
+    }
+    const std::vector<std::chrono::system_clock::time_point> batch(
+        256, std::chrono::system_clock::now());
+    for (auto _ : state) {
+        g_db->MarkVisits(batch);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(batch.size()));
+    if (state.thread_index() == 0) {
+        DropBackend();
+    }
+}
+BENCHMARK(BmMarkVisits)->Arg(0)->Arg(1)->ThreadRange(1, 8)->UseRealTime();
+
+/**
+ * @brief Групповая запись сообщений: поток пишет в свою комнату
+ *
+ * @param state.range(0) Хранилище: 0 - в памяти, 1 - журнал
+ */
+static void BmAppendMessages(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        g_db = MakeBackend(state.range(0));
+    }
+    constexpr std::size_t kBatch = 64;
+    const auto room = static_cast<uint16_t>(state.thread_index());
+    uint64_t next_id = 1;
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto batch = MessageBatch(room, next_id, kBatch);
+        next_id += kBatch;
+        state.ResumeTiming();
+        g_db->AppendMessages(batch);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kBatch));
+    if (state.thread_index() == 0) {
+        DropBackend();
+    }
+}
+BENCHMARK(BmAppendMessages)->Arg(0)->Arg(1)->ThreadRange(1, 8)->UseRealTime();
+
+/**
+ * @brief Чтение последней страницы истории из комнаты с 10000 сообщений
+ *
+ * @param state.range(0) Хранилище: 0 - в памяти, 1 - журнал
+ */
+static void BmGetMessages(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        g_db = MakeBackend(state.range(0));
+        for (uint64_t id = 1; id <= 10000; id += 100) {
+            g_db->AppendMessages(MessageBatch(1, id, 100));
+        }
+    }
+    for (auto _ : state) {
+        auto page = g_db->GetMessages(1, UINT64_MAX, 50);
+        benchmark::DoNotOptimize(page.data());
+    }
+    if (state.thread_index() == 0) {
+        DropBackend();
+    }
+}
+BENCHMARK(BmGetMessages)->Arg(0)->Arg(1)->ThreadRange(1, 8)->UseRealTime();
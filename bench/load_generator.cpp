@@ -0,0 +1,580 @@
+/**
+ * @file load_generator.cpp
+ * @brief Нагрузочный генератор HTTP запросов к встроенному серверу по loopback
+ *
+ * Программа запускает в том же процессе Server с фиктивной базой данных
+ * (MockDatabase) и нагружает его через 127.0.0.1 множеством клиентских
+ * соединений boost::asio. Задержка "базы данных" задается параметром,
+ * поэтому сетевые расходы и стоимость обращения к БД можно измерять раздельно.
+ *
+ * Режимы нагрузки:
+ * - Замкнутый цикл (--rate-start=0): каждое соединение отправляет следующий
+ *   запрос сразу после получения ответа
+ * - Открытый цикл: суммарная частота запросов линейно растет от --rate-start
+ *   до --rate-end за --ramp-s секунд. Задержка отсчитывается от запланированного
+ *   момента отправки, поэтому отставание сервера от расписания попадает
+ *   в измерения, а не скрывается (coordinated omission)
+ * - Без keep-alive (--keep-alive=false) каждый запрос открывает новое соединение,
+ *   и задержка включает установку TCP соединения
+ *
+ * Реализация сессий сервера выбирается параметром --session
+ * (callback - Session с пулом, coroutine - CoSession).
+ *
+ * Запросы, запланированные в первые --warmup-s секунд, в статистику не попадают:
+ * так из измерений исключается одновременная установка тысяч соединений на старте.
+ *
+ * Пример: bazel run --config=release //bench:load_generator -- --connections=2000
+ *
+ * @note Для тысяч соединений может понадобиться увеличить лимит файловых
+ *       дескрипторов (ulimit -n)
+ *
+ * @date 2025
+ */
+
+#include "src/co_session.hpp"
+#include "src/config.hpp"
+#include "src/database.hpp"
+#include "src/logger.hpp"
+#include "src/metrics.hpp"
+#include "src/server.hpp"
+#include "src/session_pool.hpp"
+
+#include <boost/asio.hpp>
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;  ///< Часы для расписания и измерения задержек
+using Strand = boost::asio::strand<boost::asio::io_context::executor_type>;  ///< Strand клиента
+
+/**
+ * @brief Параметры нагрузки, задаваемые в командной строке
+ */
+struct LoadOptions {
+    std::size_t connections = 1000;     ///< Количество одновременных клиентских соединений
+    int duration_s = 10;                ///< Длительность измерения в секундах
+    int warmup_s = 0;                   ///< Разогрев без учета в статистике в секундах
+    bool keep_alive = true;             ///< Переиспользовать соединение для следующих запросов
+    double rate_start = 0.0;            ///< Начальная суммарная частота запросов (0 - без лимита)
+    double rate_end = 0.0;              ///< Конечная суммарная частота запросов
+    int ramp_s = 0;                     ///< Время линейного роста частоты в секундах
+    int server_threads = 1;             ///< Потоки io_context сервера
+    int client_threads = 1;             ///< Потоки io_context клиентов
+    uint64_t db_latency_us = 0;         ///< Искусственная задержка MockDatabase::GetCount()
+    std::string path = "/";             ///< Запрашиваемый путь
+    std::string session = "callback";   ///< Реализация сессий сервера (callback/coroutine)
+    std::string config = ".config";     ///< Файл конфигурации сервера
+    std::string log_level = "warning";  ///< Уровень логирования сервера
+};
+
+/**
+ * @brief Фиктивная база данных в памяти процесса
+ *
+ * Счетчик посещений хранится в атомарной переменной. GetCount() может
+ * блокировать поток на заданное время, имитируя синхронный запрос к PostgreSQL.
+ */
+class MockDatabase : public IDatabaseService {
+   public:
+    /**
+     * @brief Конструктор
+     *
+     * @param latency Задержка каждого вызова GetCount()
+     */
+    explicit MockDatabase(std::chrono::microseconds latency) : latency_(latency) {
+    }
+
+    void Initialize() override {
+    }
+
+    void MarkVisit() override {
+        visits_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t GetCount() override {
+        if (latency_.count() > 0) {
+            std::this_thread::sleep_for(latency_);
+        }
+        return visits_.load(std::memory_order_relaxed);
+    }
+
+   private:
+    std::chrono::microseconds latency_;  ///< Имитируемая задержка запроса
+    std::atomic<uint64_t> visits_{0};    ///< Количество посещений
+};
+
+/**
+ * @brief Расписание суммарной частоты запросов
+ */
+class RatePlan {
+   public:
+    /**
+     * @brief Конструктор
+     *
+     * @param options Параметры нагрузки
+     * @param start Момент начала нагрузки
+     */
+    RatePlan(const LoadOptions& options, Clock::time_point start)
+        : start_(start)
+        , rate_start_(options.rate_start)
+        , rate_end_(options.rate_end > 0.0 ? options.rate_end : options.rate_start)
+        , ramp_(std::chrono::seconds(options.ramp_s)) {
+    }
+
+    /**
+     * @brief Работает ли генератор в замкнутом цикле (без ограничения частоты)
+     */
+    [[nodiscard]] bool Unlimited() const {
+        return rate_start_ <= 0.0;
+    }
+
+    /**
+     * @brief Суммарная частота запросов в момент now (запросов в секунду)
+     */
+    [[nodiscard]] double RateAt(Clock::time_point now) const {
+        if (ramp_.count() <= 0 || now - start_ >= ramp_) {
+            return rate_end_;
+        }
+        const double progress = std::chrono::duration<double>(now - start_) / ramp_;
+        return rate_start_ + (rate_end_ - rate_start_) * std::max(progress, 0.0);
+    }
+
+   private:
+    Clock::time_point start_;             ///< Начало нагрузки
+    double rate_start_;                   ///< Начальная частота
+    double rate_end_;                     ///< Конечная частота
+    std::chrono::duration<double> ramp_;  ///< Время роста частоты
+};
+
+/**
+ * @brief Статистика одного клиентского соединения
+ *
+ * Изменяется только на strand соединения и объединяется после остановки io_context.
+ */
+struct ClientStats {
+    HistogramSnapshot latency;  ///< Задержки запросов в микросекундах
+    uint64_t completed = 0;     ///< Полученные ответы 2xx
+    uint64_t failed = 0;        ///< Ответы с другим статусом
+    uint64_t errors = 0;        ///< Ошибки соединения, записи или чтения
+    uint64_t connects = 0;      ///< Установленные TCP соединения
+};
+
+/**
+ * @brief Клиентское соединение, отправляющее запросы по расписанию
+ *
+ * Цикл работы: Schedule() -> [Connect()] -> Send() -> ReadHead() -> ReadBody()
+ * -> Complete() -> Schedule(). Новые запросы не планируются после deadline,
+ * поэтому io_context клиентов завершается сам, когда все соединения закрыты.
+ */
+class Client : public std::enable_shared_from_this<Client> {
+   public:
+    /**
+     * @brief Конструктор
+     *
+     * @param io_context Контекст ввода-вывода клиентов
+     * @param endpoint Адрес сервера
+     * @param request Текст HTTP запроса
+     * @param plan Расписание частоты запросов
+     * @param options Параметры нагрузки
+     * @param measure_from Момент, с которого запросы учитываются в статистике
+     * @param deadline Момент, после которого новые запросы не отправляются
+     */
+    Client(boost::asio::io_context& io_context, const BoostTcp::endpoint& endpoint,
+           std::string_view request, const RatePlan& plan, const LoadOptions& options,
+           Clock::time_point measure_from, Clock::time_point deadline)
+        : strand_(boost::asio::make_strand(io_context))
+        , socket_(strand_)
+        , timer_(strand_)
+        , endpoint_(endpoint)
+        , request_(request)
+        , plan_(plan)
+        , connections_(static_cast<double>(options.connections))
+        , keep_alive_(options.keep_alive)
+        , measure_from_(measure_from)
+        , deadline_(deadline)
+        , scheduled_(Clock::now()) {
+    }
+
+    /**
+     * @brief Запускает цикл запросов
+     */
+    void Start() {
+        boost::asio::post(strand_, [self = shared_from_this()] { self->Schedule(); });
+    }
+
+    /**
+     * @brief Статистика соединения (читать только после остановки io_context)
+     */
+    [[nodiscard]] const ClientStats& Stats() const {
+        return stats_;
+    }
+
+   private:
+    /// Пауза перед повтором после ошибки, чтобы отказ сервера не превращался в цикл ошибок
+    static constexpr std::chrono::milliseconds kRetryDelay{10};
+
+    /**
+     * @brief Планирует следующий запрос
+     *
+     * В открытом цикле соединение отвечает за 1/connections долю суммарной
+     * частоты, и момент отправки сдвигается на соответствующий интервал
+     * от предыдущего запланированного, а не от фактического.
+     */
+    void Schedule() {
+        const auto now = Clock::now();
+        if (plan_.Unlimited()) {
+            scheduled_ = now;
+        } else {
+            const double rate = plan_.RateAt(now) / connections_;
+            if (rate <= 0.0) {
+                Close();
+                return;
+            }
+            scheduled_ += std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(1.0 / rate));
+        }
+        if (scheduled_ >= deadline_) {
+            Close();
+            return;
+        }
+        if (scheduled_ <= now) {
+            Begin();
+            return;
+        }
+        timer_.expires_at(scheduled_);
+        timer_.async_wait([self = shared_from_this()](boost::system::error_code ec) {
+            if (!ec) {
+                self->Begin();
+            }
+        });
+    }
+
+    /**
+     * @brief Отправляет запрос, при необходимости сначала открывая соединение
+     */
+    void Begin() {
+        if (socket_.is_open()) {
+            Send();
+        } else {
+            Connect();
+        }
+    }
+
+    void Connect() {
+        socket_.async_connect(endpoint_, [self = shared_from_this()](boost::system::error_code ec) {
+            if (ec) {
+                self->Fail();
+                return;
+            }
+            if (Clock::now() >= self->measure_from_) {
+                ++self->stats_.connects;
+            }
+            self->socket_.set_option(BoostTcp::no_delay(true));
+            self->Send();
+        });
+    }
+
+    void Send() {
+        boost::asio::async_write(
+            socket_, boost::asio::buffer(request_),
+            [self = shared_from_this()](boost::system::error_code ec, std::size_t /*length*/) {
+                if (ec) {
+                    self->Fail();
+                    return;
+                }
+                self->ReadHead();
+            });
+    }
+
+    void ReadHead() {
+        boost::asio::async_read_until(
+            socket_, boost::asio::dynamic_buffer(buffer_), "\r\n\r\n",
+            [self = shared_from_this()](boost::system::error_code ec, std::size_t head_size) {
+                if (ec) {
+                    self->Fail();
+                    return;
+                }
+                self->ReadBody(head_size);
+            });
+    }
+
+    /**
+     * @brief Дочитывает тело ответа по заголовку Content-Length
+     *
+     * @param head_size Размер статусной строки и заголовков вместе с пустой строкой
+     */
+    void ReadBody(std::size_t head_size) {
+        const std::string_view head(buffer_.data(), head_size);
+        response_size_ = head_size + ContentLength(head);
+        close_after_ = !keep_alive_ || head.find("Connection: close") != std::string_view::npos;
+        ok_ = head.starts_with("HTTP/1.1 2");
+        if (buffer_.size() >= response_size_) {
+            Complete();
+            return;
+        }
+        boost::asio::async_read(
+            socket_, boost::asio::dynamic_buffer(buffer_),
+            boost::asio::transfer_exactly(response_size_ - buffer_.size()),
+            [self = shared_from_this()](boost::system::error_code ec, std::size_t /*length*/) {
+                if (ec) {
+                    self->Fail();
+                    return;
+                }
+                self->Complete();
+            });
+    }
+
+    void Complete() {
+        if (scheduled_ >= measure_from_) {
+            const auto latency =
+                std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - scheduled_);
+            stats_.latency.Record(static_cast<uint64_t>(latency.count()));
+            ++(ok_ ? stats_.completed : stats_.failed);
+        }
+        buffer_.erase(0, response_size_);
+        if (close_after_) {
+            Close();
+        }
+        Schedule();
+    }
+
+    /**
+     * @brief Учитывает ошибку и переоткрывает соединение после паузы kRetryDelay
+     */
+    void Fail() {
+        ++stats_.errors;
+        Close();
+        timer_.expires_after(kRetryDelay);
+        timer_.async_wait([self = shared_from_this()](boost::system::error_code ec) {
+            if (!ec) {
+                self->Schedule();
+            }
+        });
+    }
+
+    void Close() {
+        boost::system::error_code ignored;
+        socket_.shutdown(BoostTcp::socket::shutdown_both, ignored);
+        socket_.close(ignored);
+        timer_.cancel();
+        buffer_.clear();
+    }
+
+    static std::size_t ContentLength(std::string_view head) {
+        constexpr std::string_view kHeader = "Content-Length: ";
+        const auto position = head.find(kHeader);
+        std::size_t length = 0;
+        if (position != std::string_view::npos) {
+            const char* begin = head.data() + position + kHeader.size();
+            std::from_chars(begin, head.data() + head.size(), length);
+        }
+        return length;
+    }
+
+    Strand strand_;                    ///< Strand соединения
+    BoostTcp::socket socket_;          ///< Сокет клиента
+    boost::asio::steady_timer timer_;  ///< Таймер расписания запросов
+    BoostTcp::endpoint endpoint_;      ///< Адрес сервера
+    std::string_view request_;         ///< Текст запроса (общий для всех клиентов)
+    const RatePlan& plan_;             ///< Расписание частоты запросов
+    double connections_;               ///< Количество соединений, делящих частоту
+    bool keep_alive_;                  ///< Использовать keep-alive
+    Clock::time_point measure_from_;   ///< Начало измерения (конец разогрева)
+    Clock::time_point deadline_;       ///< Конец нагрузки
+    Clock::time_point scheduled_;      ///< Запланированный момент текущего запроса
+    std::string buffer_;               ///< Буфер принятых данных
+    std::size_t response_size_ = 0;    ///< Полный размер текущего ответа
+    bool close_after_ = false;         ///< Сервер или клиент закрывает соединение после ответа
+    bool ok_ = false;                  ///< Текущий ответ имеет статус 2xx
+    ClientStats stats_;                ///< Статистика соединения
+};
+
+/**
+ * @brief Разбирает параметры командной строки
+ *
+ * @return true если нагрузку нужно запускать (не запрошена справка)
+ */
+bool ParseOptions(int argc, char** argv, LoadOptions& options) {
+    namespace po = boost::program_options;
+    po::options_description desc("load_generator options");
+    desc.add_options()("help", "Show this help")(
+        "connections", po::value(&options.connections)->default_value(options.connections),
+        "Concurrent client connections")(
+        "duration-s", po::value(&options.duration_s)->default_value(options.duration_s),
+        "Measured load duration in seconds")(
+        "warmup-s", po::value(&options.warmup_s)->default_value(options.warmup_s),
+        "Seconds of load excluded from statistics")(
+        "keep-alive", po::value(&options.keep_alive)->default_value(options.keep_alive),
+        "Reuse connections for subsequent requests")(
+        "rate-start", po::value(&options.rate_start)->default_value(options.rate_start),
+        "Initial total request rate per second (0 - closed loop)")(
+        "rate-end", po::value(&options.rate_end)->default_value(options.rate_end),
+        "Final total request rate per second (0 - same as rate-start)")(
+        "ramp-s", po::value(&options.ramp_s)->default_value(options.ramp_s),
+        "Seconds to ramp from rate-start to rate-end")(
+        "server-threads", po::value(&options.server_threads)->default_value(options.server_threads),
+        "Server io_context threads")(
+        "client-threads", po::value(&options.client_threads)->default_value(options.client_threads),
+        "Client io_context threads")(
+        "db-latency-us", po::value(&options.db_latency_us)->default_value(options.db_latency_us),
+        "Simulated latency of each database read in microseconds")(
+        "path", po::value(&options.path)->default_value(options.path), "Request path")(
+        "session", po::value(&options.session)->default_value(options.session),
+        "Server session implementation: callback or coroutine")(
+        "config", po::value(&options.config)->default_value(options.config),
+        "Server configuration file")(
+        "log-level", po::value(&options.log_level)->default_value(options.log_level),
+        "Server log level");
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+    if (vm.count("help") != 0) {
+        std::cout << desc << '\n';
+        return false;
+    }
+    options.connections = std::max<std::size_t>(options.connections, 1);
+    options.server_threads = std::max(options.server_threads, 1);
+    options.client_threads = std::max(options.client_threads, 1);
+    return true;
+}
+
+/**
+ * @brief Запускает io_context в нескольких потоках и ждет их завершения
+ */
+std::vector<std::thread> RunThreads(boost::asio::io_context& io_context, int threads) {
+    std::vector<std::thread> workers;
+    workers.reserve(static_cast<std::size_t>(threads));
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back([&io_context] { io_context.run(); });
+    }
+    return workers;
+}
+
+void Join(std::vector<std::thread>& workers) {
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+/**
+ * @brief Печатает перцентили гистограммы в миллисекундах
+ */
+void PrintPercentiles(std::string_view title, const HistogramSnapshot& histogram) {
+    const auto millis = [&histogram](double quantile) {
+        return static_cast<double>(histogram.Percentile(quantile)) / 1000.0;
+    };
+    std::cout << std::left << std::setw(14) << title << std::right << std::fixed
+              << std::setprecision(3) << " p50 " << std::setw(9) << millis(0.5) << " ms"
+              << "  p99 " << std::setw(9) << millis(0.99) << " ms"
+              << "  p999 " << std::setw(9) << millis(0.999) << " ms\n";
+}
+
+}  // namespace
+
+/**
+ * @brief Точка входа нагрузочного генератора
+ *
+ * Порядок работы:
+ * 1. Загрузка конфигурации сервера (порт, keep-alive, размер пула сессий)
+ * 2. Запуск Server с MockDatabase в server-threads потоках
+ * 3. Запуск клиентов в client-threads потоках в течение warmup-s + duration-s секунд
+ * 4. Вывод пропускной способности, перцентилей задержки и метрик сервера
+ *
+ * @return int 0 при успешном завершении, 1 при ошибке
+ */
+int main(int argc, char** argv) {
+    try {
+        LoadOptions options;
+        if (!ParseOptions(argc, argv, options)) {
+            return 0;
+        }
+        InitializeConfig(options.config);
+        InitializeLogger(options.log_level);
+
+        boost::asio::io_context server_io(options.server_threads);
+        auto db = std::make_shared<MockDatabase>(std::chrono::microseconds(options.db_latency_us));
+        std::shared_ptr<ISessionFactory> session_factory;
+        if (options.session == "coroutine") {
+            session_factory = std::make_shared<CoSessionFactory>();
+        } else {
+            session_factory = std::make_shared<PooledSessionFactory>(options.connections);
+        }
+        auto server = std::make_unique<Server>(server_io, db, session_factory);
+        auto server_workers = RunThreads(server_io, options.server_threads);
+
+        const std::string request = "GET " + options.path +
+                                    " HTTP/1.1\r\nHost: 127.0.0.1\r\n" +
+                                    (options.keep_alive ? "" : "Connection: close\r\n") + "\r\n";
+        const BoostTcp::endpoint endpoint(
+            boost::asio::ip::address_v4::loopback(),
+            static_cast<unsigned short>(GetConfig().GetCentralServerPort()));
+
+        boost::asio::io_context client_io(options.client_threads);
+        const auto start = Clock::now();
+        const auto measure_from = start + std::chrono::seconds(options.warmup_s);
+        const auto deadline = measure_from + std::chrono::seconds(options.duration_s);
+        const RatePlan plan(options, start);
+
+        std::vector<std::shared_ptr<Client>> clients;
+        clients.reserve(options.connections);
+        for (std::size_t i = 0; i < options.connections; ++i) {
+            clients.push_back(std::make_shared<Client>(
+                client_io, endpoint, request, plan, options, measure_from, deadline));
+            clients.back()->Start();
+        }
+        auto client_workers = RunThreads(client_io, options.client_threads);
+        Join(client_workers);
+        const std::chrono::duration<double> elapsed = Clock::now() - measure_from;
+
+        // Клиенты закрыли соединения, поэтому после остановки приема
+        // у io_context сервера не остается работы и его потоки завершаются
+        server->Stop();
+        Join(server_workers);
+
+        ClientStats total;
+        for (const auto& client : clients) {
+            const ClientStats& stats = client->Stats();
+            total.latency.Merge(stats.latency);
+            total.completed += stats.completed;
+            total.failed += stats.failed;
+            total.errors += stats.errors;
+            total.connects += stats.connects;
+        }
+
+        std::cout << "io backend    " << kIoBackend << '\n'
+                  << "connections   " << options.connections
+                  << (options.keep_alive ? " (keep-alive)" : " (connection per request)") << '\n'
+                  << "duration      " << std::fixed << std::setprecision(2) << elapsed.count()
+                  << " s\n"
+                  << "responses     " << total.completed << " ok, " << total.failed
+                  << " non-2xx, " << total.errors << " errors\n"
+                  << "throughput    " << std::setprecision(0)
+                  << static_cast<double>(total.completed + total.failed) / elapsed.count()
+                  << " req/s\n"
+                  << "connects      " << std::setprecision(0)
+                  << static_cast<double>(total.connects) / elapsed.count() << " /s\n";
+        PrintPercentiles("latency", total.latency);
+        PrintPercentiles("server read", GetMetrics().Snapshot(Histogram::kRead));
+        PrintPercentiles("server db", GetMetrics().Snapshot(Histogram::kDb));
+        PrintPercentiles("server write", GetMetrics().Snapshot(Histogram::kWrite));
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
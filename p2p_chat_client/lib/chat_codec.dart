@@ -0,0 +1,309 @@
+/// Binding to the native chat protocol codec (`src/chat_codec.h`).
+///
+/// Framing, compression and payload parsing run in the same C++ code as the
+/// server. Buffers are owned by the codec: incoming socket bytes are copied
+/// once into native memory, and frames, payloads and outgoing batches are
+/// exposed as [Uint8List] views over that memory without further copies.
+library;
+
+import 'dart:convert';
+import 'dart:ffi';
+import 'dart:io';
+import 'dart:typed_data';
+
+/// Frame types of the chat protocol (`FrameType` in `src/chat_protocol.hpp`).
+enum FrameType {
+  hello(1),
+  welcome(2),
+  message(3),
+  ping(4),
+  pong(5),
+  error(6),
+  join(7),
+  leave(8),
+  register(9),
+  lookup(10),
+  peer(11),
+  history(12);
+
+  const FrameType(this.code);
+
+  /// Wire value of the type.
+  final int code;
+
+  static FrameType fromCode(int code) => FrameType.values[code - 1];
+}
+
+/// Hello/Welcome capability: the peer accepts compressed frames.
+const int capabilityCompression = 0x01;
+
+/// Default payload limit, matching the server's `CHAT_MAX_FRAME_SIZE`.
+const int defaultMaxPayload = 65536;
+
+/// Default compression threshold, matching `CHAT_COMPRESSION_MIN_SIZE`.
+const int defaultCompressionMinSize = 512;
+
+/// Thrown when the incoming stream is malformed; the connection must be closed.
+class ChatCodecException implements Exception {
+  ChatCodecException(this.message);
+
+  final String message;
+
+  @override
+  String toString() => 'ChatCodecException: $message';
+}
+
+final class _Slice extends Struct {
+  external Pointer<Uint8> data;
+
+  @Size()
+  external int size;
+}
+
+final class _Frame extends Struct {
+  @Int32()
+  external int status;
+
+  @Uint8()
+  external int type;
+
+  @Uint8()
+  external int flags;
+
+  @Uint16()
+  external int channel;
+
+  external _Slice payload;
+}
+
+final class _Named extends Struct {
+  @Int32()
+  external int ok;
+
+  external _Slice name;
+
+  external _Slice rest;
+}
+
+final class _HistoryEntry extends Struct {
+  @Int32()
+  external int ok;
+
+  @Uint64()
+  external int id;
+
+  @Uint64()
+  external int micros;
+
+  external _Slice author;
+
+  external _Slice text;
+}
+
+final class _Reader extends Opaque {}
+
+final class _Writer extends Opaque {}
+
+const int _frameComplete = 0;
+const int _frameIncomplete = 1;
+const List<String> _frameErrors = [
+  '',
+  '',
+  'frame payload is too large',
+  'unknown frame type or reserved flags',
+  'compressed payload is corrupt',
+];
+
+DynamicLibrary _open() {
+  if (Platform.isLinux) {
+    return DynamicLibrary.open('libchat_codec.so');
+  }
+  if (Platform.isWindows) {
+    return DynamicLibrary.open('chat_codec.dll');
+  }
+  if (Platform.isMacOS) {
+    final contents = File(Platform.resolvedExecutable).parent.parent.path;
+    return DynamicLibrary.open('$contents/Frameworks/libchat_codec.dylib');
+  }
+  throw UnsupportedError('chat codec is not built for ${Platform.operatingSystem}');
+}
+
+final DynamicLibrary _lib = _open();
+
+final _readerCreate = _lib.lookupFunction<Pointer<_Reader> Function(Size),
+    Pointer<_Reader> Function(int)>('chat_reader_create');
+final _readerPrepare = _lib.lookupFunction<
+    Pointer<Uint8> Function(Pointer<_Reader>, Size),
+    Pointer<Uint8> Function(Pointer<_Reader>, int)>('chat_reader_prepare');
+final _readerCommit = _lib.lookupFunction<Void Function(Pointer<_Reader>, Size),
+    void Function(Pointer<_Reader>, int)>('chat_reader_commit');
+final _readerNext = _lib.lookupFunction<_Frame Function(Pointer<_Reader>),
+    _Frame Function(Pointer<_Reader>)>('chat_reader_next');
+final _readerDestroyPointer =
+    _lib.lookup<NativeFunction<Void Function(Pointer<_Reader>)>>('chat_reader_destroy');
+final _readerDestroy = _readerDestroyPointer.asFunction<void Function(Pointer<_Reader>)>();
+final _readerFinalizer = NativeFinalizer(_readerDestroyPointer.cast());
+
+final _writerCreate = _lib.lookupFunction<Pointer<_Writer> Function(Size),
+    Pointer<_Writer> Function(int)>('chat_writer_create');
+final _writerEnableCompression = _lib.lookupFunction<
+    Void Function(Pointer<_Writer>, Int32),
+    void Function(Pointer<_Writer>, int)>('chat_writer_enable_compression');
+final _writerPrepare = _lib.lookupFunction<
+    Pointer<Uint8> Function(Pointer<_Writer>, Size),
+    Pointer<Uint8> Function(Pointer<_Writer>, int)>('chat_writer_prepare');
+final _writerAppend = _lib.lookupFunction<
+    Void Function(Pointer<_Writer>, Uint8, Uint16, Size),
+    void Function(Pointer<_Writer>, int, int, int)>('chat_writer_append');
+final _writerData = _lib.lookupFunction<_Slice Function(Pointer<_Writer>),
+    _Slice Function(Pointer<_Writer>)>('chat_writer_data');
+final _writerClear = _lib.lookupFunction<Void Function(Pointer<_Writer>),
+    void Function(Pointer<_Writer>)>('chat_writer_clear');
+final _writerDestroyPointer =
+    _lib.lookup<NativeFunction<Void Function(Pointer<_Writer>)>>('chat_writer_destroy');
+final _writerDestroy = _writerDestroyPointer.asFunction<void Function(Pointer<_Writer>)>();
+final _writerFinalizer = NativeFinalizer(_writerDestroyPointer.cast());
+
+final _parseNamed = _lib.lookupFunction<_Named Function(_Slice),
+    _Named Function(_Slice)>('chat_parse_named');
+final _parseHistory = _lib.lookupFunction<_HistoryEntry Function(_Slice),
+    _HistoryEntry Function(_Slice)>('chat_parse_history');
+
+Uint8List _view(_Slice slice) =>
+    slice.size == 0 ? Uint8List(0) : slice.data.asTypedList(slice.size);
+
+/// `[name length][name][rest]` payload of `message` and `peer` frames.
+class NamedPayload {
+  NamedPayload._(this.name, this.rest);
+
+  /// Participant name.
+  final String name;
+
+  /// Message text or peer `host:port` as a view into codec memory.
+  final Uint8List rest;
+}
+
+/// One message of a `history` response.
+class HistoryEntry {
+  HistoryEntry._(this.id, this.time, this.author, this.text);
+
+  final int id;
+  final DateTime time;
+  final String author;
+  final String text;
+}
+
+/// A parsed frame. [payload] is a view into codec memory and is valid only
+/// until the next [ChatReader.add] or [ChatReader.next] call.
+class ChatFrame {
+  ChatFrame._(this.type, this.flags, this.channel, this._payload);
+
+  final FrameType type;
+  final int flags;
+  final int channel;
+  final _Slice _payload;
+
+  /// Uncompressed payload, without copying.
+  Uint8List get payload => _view(_payload);
+
+  /// Decodes a `message` or `peer` payload sent by the server.
+  NamedPayload named() {
+    final named = _parseNamed(_payload);
+    if (named.ok == 0) {
+      throw ChatCodecException('malformed ${type.name} payload');
+    }
+    return NamedPayload._(utf8.decode(_view(named.name)), _view(named.rest));
+  }
+
+  /// Decodes a non-empty `history` payload; an empty one ends the page.
+  HistoryEntry historyEntry() {
+    final entry = _parseHistory(_payload);
+    if (entry.ok == 0) {
+      throw ChatCodecException('malformed history payload');
+    }
+    return HistoryEntry._(
+      entry.id,
+      DateTime.fromMicrosecondsSinceEpoch(entry.micros, isUtc: true),
+      utf8.decode(_view(entry.author)),
+      utf8.decode(_view(entry.text)),
+    );
+  }
+}
+
+/// Splits the incoming byte stream into frames.
+class ChatReader implements Finalizable {
+  ChatReader({int maxPayload = defaultMaxPayload})
+      : _reader = _readerCreate(maxPayload) {
+    _readerFinalizer.attach(this, _reader.cast(), detach: this);
+  }
+
+  final Pointer<_Reader> _reader;
+
+  /// Appends bytes received from the socket.
+  void add(List<int> bytes) {
+    final buffer = _readerPrepare(_reader, bytes.length);
+    buffer.asTypedList(bytes.length).setAll(0, bytes);
+    _readerCommit(_reader, bytes.length);
+  }
+
+  /// Returns the next complete frame, or null if more bytes are needed.
+  ChatFrame? next() {
+    final frame = _readerNext(_reader);
+    if (frame.status == _frameIncomplete) {
+      return null;
+    }
+    if (frame.status != _frameComplete) {
+      throw ChatCodecException(_frameErrors[frame.status]);
+    }
+    return ChatFrame._(
+        FrameType.fromCode(frame.type), frame.flags, frame.channel, frame.payload);
+  }
+
+  /// Releases native memory now instead of at garbage collection.
+  void dispose() {
+    _readerFinalizer.detach(this);
+    _readerDestroy(_reader);
+  }
+}
+
+/// Batches outgoing frames into one buffer for a single socket write.
+class ChatWriter implements Finalizable {
+  ChatWriter({int compressionMinSize = defaultCompressionMinSize})
+      : _writer = _writerCreate(compressionMinSize) {
+    _writerFinalizer.attach(this, _writer.cast(), detach: this);
+  }
+
+  final Pointer<_Writer> _writer;
+
+  /// Enables compression once the server announced [capabilityCompression].
+  set compression(bool enabled) =>
+      _writerEnableCompression(_writer, enabled ? 1 : 0);
+
+  /// Appends a frame with a binary payload.
+  void add(FrameType type, int channel, List<int> payload) {
+    final buffer = _writerPrepare(_writer, payload.length);
+    if (payload.isNotEmpty) {
+      buffer.asTypedList(payload.length).setAll(0, payload);
+    }
+    _writerAppend(_writer, type.code, channel, payload.length);
+  }
+
+  /// Appends a frame with a UTF-8 text payload.
+  void addText(FrameType type, int channel, String text) =>
+      add(type, channel, utf8.encode(text));
+
+  /// Frames appended since the last [clear], as a view into codec memory.
+  /// Pass it to `RawSocket.write`, which copies synchronously, before
+  /// appending more frames or calling [clear]; `Socket.add` keeps the list
+  /// until a later write, so it needs `Uint8List.fromList(data)` instead.
+  Uint8List get data => _view(_writerData(_writer));
+
+  /// Drops written frames, keeping the buffer capacity.
+  void clear() => _writerClear(_writer);
+
+  /// Releases native memory now instead of at garbage collection.
+  void dispose() {
+    _writerFinalizer.detach(this);
+    _writerDestroy(_writer);
+  }
+}
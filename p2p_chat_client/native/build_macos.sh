@@ -0,0 +1,22 @@
+#!/bin/sh
+# Собирает нативный кодек протокола чата и кладет его в Frameworks
+# приложения macOS. Вызывается фазой сборки "Build Chat Codec" Runner.
+set -e
+
+SOURCE_DIR="$(cd "$(dirname "$0")" && pwd)"
+BUILD_DIR="${DERIVED_FILE_DIR:-${SOURCE_DIR}/build}/chat_codec"
+BUILD_TYPE=Release
+if [ "${CONFIGURATION}" = "Debug" ]; then
+  BUILD_TYPE=Debug
+fi
+
+cmake -S "${SOURCE_DIR}" -B "${BUILD_DIR}" \
+  -DCMAKE_BUILD_TYPE="${BUILD_TYPE}" \
+  -DCMAKE_OSX_ARCHITECTURES="$(echo "${ARCHS}" | tr ' ' ';')" \
+  -DCMAKE_OSX_DEPLOYMENT_TARGET="${MACOSX_DEPLOYMENT_TARGET}"
+cmake --build "${BUILD_DIR}" --config "${BUILD_TYPE}"
+
+FRAMEWORKS_DIR="${BUILT_PRODUCTS_DIR}/${FRAMEWORKS_FOLDER_PATH}"
+mkdir -p "${FRAMEWORKS_DIR}"
+cp "${BUILD_DIR}/libchat_codec.dylib" "${FRAMEWORKS_DIR}/"
+codesign --force --sign "${EXPANDED_CODE_SIGN_IDENTITY:--}" "${FRAMEWORKS_DIR}/libchat_codec.dylib"
@@ -0,0 +1,296 @@
+#pragma once
+
+#include <boost/asio/ip/address.hpp>
+#include <boost/asio/ip/address_v4.hpp>
+#include <boost/asio/ip/address_v6.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Решение контроля допуска о новом соединении
+ */
+enum class Admission : uint8_t {
+    kAdmitted,      ///< Соединение принято
+    kSessionLimit,  ///< Достигнут лимит одновременных сессий
+    kRateLimited,   ///< Адрес источника исчерпал свой лимит подключений
+};
+
+/**
+ * @brief Ограничение частоты подключений по адресам источников
+ *
+ * Класс IpRateLimiter хранит по корзине токенов (token bucket) на адрес
+ * в компактной хеш-таблице фиксированного размера с открытой адресацией:
+ * корзина занимает 24 байта, память не выделяется после создания.
+ * Корзина пополняется на rate токенов в секунду до burst, каждое
+ * подключение забирает один токен.
+ *
+ * Если все ячейки в пределах kProbeLimit от позиции адреса заняты,
+ * вытесняется корзина, дольше всех не использовавшаяся. Полная корзина
+ * неотличима от отсутствующей, поэтому вытеснение простаивающих адресов
+ * не ослабляет ограничение для активных.
+ *
+ * @note Класс не потокобезопасен: каждый Server вызывает его на strand
+ * своего акцептора.
+ */
+class IpRateLimiter {
+   public:
+    using Clock = std::chrono::steady_clock;  ///< Часы пополнения корзин
+
+    static constexpr std::size_t kProbeLimit = 8;  ///< Просматриваемых ячеек на адрес
+
+    /**
+     * @brief Конструктор
+     *
+     * @param rate Подключений в секунду на адрес (0 - без ограничения)
+     * @param burst Максимальное количество подключений подряд
+     * @param buckets Количество ячеек таблицы (округляется вверх до степени двойки)
+     */
+    IpRateLimiter(double rate, double burst, std::size_t buckets)
+        : rate_(rate), burst_(std::max(burst, 1.0)), table_(RoundUp(buckets)) {
+    }
+
+    /**
+     * @brief Забирает токен из корзины адреса
+     *
+     * @param address Адрес источника
+     * @param now Текущее время
+     * @return true если подключение разрешено
+     */
+    bool Allow(const boost::asio::ip::address& address, Clock::time_point now = Clock::now()) {
+        if (rate_ <= 0) {
+            return true;
+        }
+        const uint64_t key = Key(address);
+        const int64_t now_ns = now.time_since_epoch().count();
+        const std::size_t mask = table_.size() - 1;
+
+        Bucket* victim = nullptr;
+        for (std::size_t i = 0; i < kProbeLimit; ++i) {
+            Bucket& bucket = table_[(key + i) & mask];
+            if (bucket.key == key) {
+                return Take(bucket, now_ns);
+            }
+            if (bucket.key == 0) {
+                victim = &bucket;
+                break;
+            }
+            if (victim == nullptr || bucket.last_ns < victim->last_ns) {
+                victim = &bucket;
+            }
+        }
+        *victim = Bucket{key, burst_, now_ns};
+        return Take(*victim, now_ns);
+    }
+
+   private:
+    /**
+     * @brief Корзина токенов одного адреса
+     */
+    struct Bucket {
+        uint64_t key = 0;     ///< Ключ адреса (0 - свободная ячейка)
+        double tokens = 0;    ///< Доступные токены
+        int64_t last_ns = 0;  ///< Время последнего пополнения
+    };
+
+    /**
+     * @brief Пополняет корзину по прошедшему времени и забирает токен
+     */
+    bool Take(Bucket& bucket, int64_t now_ns) const {
+        const double elapsed = static_cast<double>(now_ns - bucket.last_ns) * 1e-9;
+        bucket.tokens = std::min(burst_, bucket.tokens + elapsed * rate_);
+        bucket.last_ns = now_ns;
+        if (bucket.tokens < 1.0) {
+            return false;
+        }
+        bucket.tokens -= 1.0;
+        return true;
+    }
+
+    /**
+     * @brief Ненулевой 64-битный ключ адреса
+     *
+     * IPv4 и IPv4-mapped IPv6 адреса дают один и тот же ключ.
+     */
+    static uint64_t Key(const boost::asio::ip::address& address) {
+        uint64_t hash = 0;
+        if (address.is_v4() || (address.is_v6() && address.to_v6().is_v4_mapped())) {
+            const auto v4 = address.is_v4() ? address.to_v4()
+                                            : boost::asio::ip::make_address_v4(
+                                                  boost::asio::ip::v4_mapped, address.to_v6());
+            hash = Mix(v4.to_uint());
+        } else {
+            const auto bytes = address.to_v6().to_bytes();
+            for (std::size_t i = 0; i < bytes.size(); i += 8) {
+                uint64_t word = 0;
+                for (std::size_t j = 0; j < 8; ++j) {
+                    word = (word << 8U) | bytes[i + j];
+                }
+                hash = Mix(hash ^ word);
+            }
+        }
+        return hash == 0 ? 1 : hash;
+    }
+
+    /**
+     * @brief Перемешивание битов (финализатор splitmix64)
+     */
+    static uint64_t Mix(uint64_t x) {
+        x ^= x >> 30U;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27U;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31U;
+        return x;
+    }
+
+    /**
+     * @brief Округляет размер таблицы вверх до степени двойки
+     */
+    static std::size_t RoundUp(std::size_t size) {
+        std::size_t result = kProbeLimit;
+        while (result < size) {
+            result <<= 1U;
+        }
+        return result;
+    }
+
+    double rate_;                ///< Токенов в секунду
+    double burst_;               ///< Емкость корзины
+    std::vector<Bucket> table_;  ///< Таблица корзин
+};
+
+class AdmissionController;
+
+/**
+ * @brief Место сессии, выданное AdmissionController
+ *
+ * Место освобождается при уничтожении объекта или вызове Reset().
+ * Объект только перемещается.
+ */
+class AdmissionSlot {
+   public:
+    AdmissionSlot() = default;
+
+    /**
+     * @brief Конструктор занятого места
+     *
+     * @param owner Контроллер, выдавший место
+     */
+    explicit AdmissionSlot(std::shared_ptr<AdmissionController> owner) : owner_(std::move(owner)) {
+    }
+
+    /**
+     * @brief Деструктор - освобождает место
+     */
+    ~AdmissionSlot() {
+        Reset();
+    }
+
+    AdmissionSlot(const AdmissionSlot&) = delete;             ///< Запрет копирования
+    AdmissionSlot& operator=(const AdmissionSlot&) = delete;  ///< Запрет присваивания
+
+    /**
+     * @brief Перемещающий конструктор
+     */
+    AdmissionSlot(AdmissionSlot&& other) noexcept = default;
+
+    /**
+     * @brief Перемещающее присваивание - освобождает текущее место
+     */
+    AdmissionSlot& operator=(AdmissionSlot&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            owner_ = std::move(other.owner_);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Освобождает место, если оно занято
+     */
+    inline void Reset();
+
+   private:
+    std::shared_ptr<AdmissionController> owner_;  ///< Контроллер (nullptr - место свободно)
+};
+
+/**
+ * @brief Контроль допуска новых соединений
+ *
+ * Класс AdmissionController решает, принимать ли соединение, до того как
+ * сервер отметит посещение в БД или создаст объект сессии:
+ * - Число одновременных сессий ограничено max_sessions; место сессии
+ *   (AdmissionSlot) освобождается вместе с сессией
+ * - Частота подключений с одного адреса ограничена IpRateLimiter
+ *
+ * Admit() вызывается на strand акцептора; места освобождаются из любого
+ * потока.
+ */
+class AdmissionController : public std::enable_shared_from_this<AdmissionController> {
+   public:
+    /**
+     * @brief Конструктор контроллера
+     *
+     * @param max_sessions Лимит одновременных сессий (0 - без ограничения)
+     * @param rate Подключений в секунду на адрес (0 - без ограничения)
+     * @param burst Максимальное количество подключений подряд с одного адреса
+     * @param buckets Количество ячеек таблицы адресов
+     */
+    AdmissionController(std::size_t max_sessions, double rate, double burst, std::size_t buckets)
+        : max_sessions_(max_sessions), limiter_(rate, burst, buckets) {
+    }
+
+    /**
+     * @brief Решает, принимать ли соединение с адреса
+     *
+     * @param address Адрес источника
+     * @param slot Сюда записывается место сессии при kAdmitted
+     * @return Admission Решение
+     */
+    Admission Admit(const boost::asio::ip::address& address, AdmissionSlot& slot) {
+        if (max_sessions_ > 0 && active_.load(std::memory_order_relaxed) >= max_sessions_) {
+            return Admission::kSessionLimit;
+        }
+        if (!limiter_.Allow(address)) {
+            return Admission::kRateLimited;
+        }
+        active_.fetch_add(1, std::memory_order_relaxed);
+        slot = AdmissionSlot(shared_from_this());
+        return Admission::kAdmitted;
+    }
+
+    /**
+     * @brief Количество занятых мест
+     */
+    [[nodiscard]] std::size_t Active() const {
+        return active_.load(std::memory_order_relaxed);
+    }
+
+   private:
+    friend class AdmissionSlot;
+
+    /**
+     * @brief Освобождает место сессии
+     */
+    void Release() {
+        active_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    std::size_t max_sessions_;            ///< Лимит одновременных сессий
+    std::atomic<std::size_t> active_{0};  ///< Занятые места
+    IpRateLimiter limiter_;               ///< Ограничение частоты по адресам
+};
+
+inline void AdmissionSlot::Reset() {
+    if (owner_) {
+        owner_->Release();
+        owner_.reset();
+    }
+}
@@ -7,18 +7,213 @@
  *
  * Сервер предоставляет:
  * - API для подсчета посещений
- * - Интеграцию с базой данных PostgreSQL
+ * - Хранилище на выбор: PostgreSQL, память процесса или журнал на диске
+ * - Бинарный протокол чата с комнатами и реестром пиров
+ * - HTTPS с возобновлением сессий по билетам и шифрованием в ядре (kTLS)
+ * - Перезагрузку конфигурации по SIGHUP
+ * - Плавную остановку по SIGINT/SIGTERM с завершением открытых соединений
+ *   и записью буферизованных данных
  *
  * @date 2025
  */
 
+#include "async_database.hpp"
+#include "chat_session.hpp"
+#include "co_session.hpp"
 #include "config.hpp"
+#include "log_database.hpp"
+#include "logger.hpp"
+#include "memory_database.hpp"
+#include "peer_snapshotter.hpp"
 #include "server.hpp"
+#include "session_pool.hpp"
+#include "tls_session.hpp"
+#include "visit_counter.hpp"
+#include "visit_recorder.hpp"
 
 #include <boost/asio/io_context.hpp>
+#include <boost/asio/signal_set.hpp>
+#include <boost/asio/steady_timer.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
 #include <exception>
-#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/// Соединений неблокирующего чтения истории чата: запросы идут конвейером
+constexpr uint64_t kHistoryConnections = 2;
+
+/**
+ * @brief Создает хранилище, выбранное параметром STORAGE_BACKEND
+ *
+ * @return std::shared_ptr<IDatabaseService> PostgreSQL, память процесса или журнал
+ * @throws std::invalid_argument для неизвестного хранилища
+ */
+std::shared_ptr<IDatabaseService> MakeStorageBackend() {
+    const std::string backend = GetConfig().GetStorageBackend();
+    if (backend == "postgres") {
+        return std::make_shared<PostgresDatabase>();
+    }
+    if (backend == "memory") {
+        return std::make_shared<InMemoryDatabase>();
+    }
+    if (backend == "log") {
+        return std::make_shared<LogDatabase>();
+    }
+    throw std::invalid_argument("Unknown STORAGE_BACKEND: " + backend);
+}
+
+/**
+ * @brief Перезагружает конфигурацию по каждому SIGHUP
+ *
+ * Уровень логирования применяется сразу, остальные перезагружаемые
+ * параметры компоненты читают из нового снимка сами. Если файл не
+ * удалось разобрать, продолжает действовать прежний снимок.
+ *
+ * @param signals Набор сигналов, содержащий SIGHUP
+ */
+void WatchReload(boost::asio::signal_set& signals) {
+    signals.async_wait([&signals](const boost::system::error_code& ec, int /*signal*/) {
+        if (ec) {
+            return;
+        }
+        try {
+            const auto previous = GetLiveConfig().Load();
+            const auto snapshot = ReloadConfig();
+            InitializeLogger(snapshot->log_level);
+            if (snapshot->connection_pool_size != previous->connection_pool_size ||
+                snapshot->db_conn_string != previous->db_conn_string) {
+                LOG_WARNING << "Database connection settings take effect after a restart";
+            }
+            LOG_INFO << "Configuration reloaded";
+        } catch (const std::exception& e) {
+            LOG_ERROR << "Failed to reload configuration: " << e.what();
+        }
+        WatchReload(signals);
+    });
+}
+
+/// Интервал проверки, остались ли открытые соединения при остановке
+constexpr std::chrono::milliseconds kDrainPollInterval{50};
+
+/**
+ * @brief Ждет завершения открытых сессий после остановки серверов
+ *
+ * Пока сессии есть, проверка повторяется каждые kDrainPollInterval; после
+ * срока оставшиеся соединения закрываются принудительно. Когда сессий не
+ * осталось, отменяется ожидание сигналов, и у io_context не остается
+ * работы - io_context::run() возвращается.
+ *
+ * @param timer Таймер проверки
+ * @param servers Остановленные серверы
+ * @param deadline Срок мягкого завершения
+ * @param signals Наборы сигналов, ожидание которых нужно отменить
+ */
+void DrainSessions(
+    const std::shared_ptr<boost::asio::steady_timer>& timer, const std::vector<Server*>& servers,
+    std::chrono::steady_clock::time_point deadline,
+    const std::vector<boost::asio::signal_set*>& signals) {
+    std::size_t open = 0;
+    for (const Server* server : servers) {
+        open += server->ActiveSessions();
+    }
+    if (open == 0) {
+        LOG_INFO << "All connections closed";
+        for (boost::asio::signal_set* set : signals) {
+            set->cancel();
+        }
+        return;
+    }
+    if (std::chrono::steady_clock::now() >= deadline) {
+        LOG_WARNING << "Closing " << open << " connection(s) left after the shutdown timeout";
+        for (Server* server : servers) {
+            server->Abort();
+        }
+    }
+    timer->expires_after(kDrainPollInterval);
+    timer->async_wait([timer, servers, deadline, signals](const boost::system::error_code& ec) {
+        if (!ec) {
+            DrainSessions(timer, servers, deadline, signals);
+        }
+    });
+}
+
+/**
+ * @brief Останавливает серверы по SIGINT/SIGTERM
+ *
+ * Первый сигнал закрывает акцепторы и мягко завершает открытые сессии,
+ * давая им SHUTDOWN_TIMEOUT_MS; повторный сигнал закрывает оставшиеся
+ * соединения сразу.
+ *
+ * @param signals Набор сигналов SIGINT и SIGTERM
+ * @param reload_signals Набор сигналов перезагрузки, отменяемый при остановке
+ * @param servers Серверы приложения
+ */
+void WatchShutdown(
+    boost::asio::signal_set& signals, boost::asio::signal_set& reload_signals,
+    std::vector<Server*> servers) {
+    signals.async_wait([&signals, &reload_signals, servers = std::move(servers)](
+                           const boost::system::error_code& ec, int signal) mutable {
+        if (ec) {
+            return;
+        }
+        LOG_INFO << "Received signal " << signal << ", shutting down";
+        for (Server* server : servers) {
+            server->Stop();
+        }
+        const auto deadline = std::chrono::steady_clock::now() +
+                              std::chrono::milliseconds(GetConfig().GetShutdownTimeoutMs());
+        DrainSessions(
+            std::make_shared<boost::asio::steady_timer>(signals.get_executor()), servers,
+            deadline, {&signals, &reload_signals});
+
+        // Повторный сигнал не ждет срока
+        signals.async_wait([servers](const boost::system::error_code& ec, int /*signal*/) {
+            if (!ec) {
+                LOG_WARNING << "Received second signal, closing all connections";
+                for (Server* server : servers) {
+                    server->Abort();
+                }
+            }
+        });
+    });
+}
+
+/**
+ * @brief Обрабатывает события io_context в текущем потоке до остановки
+ *
+ * Исключение из обработчика (CoSession::Start() перебрасывает исключения
+ * корутин в run()) не доходит до границы потока, где вызвало бы
+ * std::terminate: оно записывается в журнал, и io_context
+ * останавливается во всех потоках.
+ *
+ * @param io_context Контекст ввода-вывода
+ * @return true если run() завершился без исключения
+ */
+bool RunIoContext(boost::asio::io_context& io_context) noexcept {
+    try {
+        io_context.run();
+        return true;
+    } catch (const std::exception& e) {
+        LOG_ERROR << "IO thread failed: " << e.what();
+    } catch (...) {
+        LOG_ERROR << "IO thread failed with an unknown exception";
+    }
+    io_context.stop();
+    return false;
+}
+
+}  // namespace
 
 /**
  * @brief Главная функция приложения
@@ -30,39 +225,151 @@
  * Последовательность действий:
  * 1. Инициализация конфигурации из файла/переменных окружения
  * 2. Создание контекста ввода-вывода boost::asio
- * 3. Инициализация сервиса базы данных PostgreSQL
+ * 3. Инициализация хранилища (STORAGE_BACKEND) с отложенной записью посещений
  * 4. Создание фабрики сессий для обработки клиентов
  * 5. Запуск TCP сервера на настроенном порту
- * 6. Запуск основного цикла обработки событий
+ * 6. Подписка на SIGHUP для перезагрузки конфигурации и на SIGINT/SIGTERM
+ *    для остановки
+ * 7. Запуск основного цикла обработки событий в IO_THREADS потоках
+ * 8. После остановки - запись буферизованных посещений, сообщений и
+ *    снимка реестра пиров; хранилище закрывается последним
  *
- * @return int Код возврата (0 при успешном завершении)
+ * @return int Код возврата (0 при успешном завершении, EXIT_FAILURE если
+ *         запуск не удался или поток обработки событий завершился исключением)
  */
 int main() {
     try {
         // Инициализируем глобальную конфигурацию из файла .config
         InitializeConfig();
 
+        // Настраиваем асинхронный логгер по параметру LOG_LEVEL
+        InitializeLogger(GetConfig().GetLogLevel());
+
+        // Количество потоков, обслуживающих io_context
+        const int io_threads = GetConfig().GetIoThreads();
+
         // Создаем контекст ввода-вывода для асинхронных операций
-        boost::asio::io_context io_context;
+        boost::asio::io_context io_context(io_threads);
 
-        // Создаем и инициализируем сервис базы данных PostgreSQL
-        auto db_service = std::make_shared<PostgresDatabase>();
+        // Создаем и инициализируем хранилище, выбранное в конфигурации.
+        // Посещения записываются в него пакетами через буфер отложенной записи,
+        // а счетчик посещений кешируется в памяти процесса.
+        auto backend = MakeStorageBackend();
+        auto recorder = std::make_shared<BatchedVisitRecorder>(backend);
+        auto db_service = std::make_shared<CachedVisitCounter>(recorder);
         db_service->Initialize();
 
-        // Создаем фабрику для создания HTTP сессий
-        auto session_factory = std::make_shared<SessionFactory>();
+        // Создаем фабрику HTTP сессий: на корутинах или на обработчиках
+        // с переиспользованием объектов сессий
+        std::shared_ptr<ISessionFactory> session_factory;
+        if (GetConfig().GetSessionImpl() == "coroutine") {
+            session_factory = std::make_shared<CoSessionFactory>();
+        } else {
+            session_factory = std::make_shared<PooledSessionFactory>();
+        }
 
         // Создаем и настраиваем TCP сервер
-        const Server s(io_context, db_service, session_factory);
+        Server s(io_context, db_service, session_factory);
 
-        std::cout << "Server started on port " << GetConfig().GetCentralServerPort() << "...\n";
+        LOG_INFO << "Server started on port " << GetConfig().GetCentralServerPort() << " with "
+                 << io_threads << " IO thread(s) on " << kIoBackend << ", storage "
+                 << GetConfig().GetStorageBackend();
 
-        // Запускаем основной цикл обработки событий (блокирующий вызов)
-        io_context.run();
+        // Слушатель бинарного протокола чата на отдельном порту
+        // вместе с реестром пиров, снимки которого пишутся в хранилище
+        // (если оно переживает перезапуск), и хранилищем сообщений с
+        // групповой записью
+        std::unique_ptr<Server> chat_server;
+        std::unique_ptr<PeerSnapshotter> peer_snapshotter;
+        std::shared_ptr<MessageStore> message_store;
+        if (const int chat_port = GetConfig().GetChatServerPort(); chat_port > 0) {
+            auto registry = std::make_shared<PeerRegistry>(
+                std::chrono::milliseconds(GetConfig().GetPeerTtlMs()));
+            peer_snapshotter = std::make_unique<PeerSnapshotter>(
+                registry, std::dynamic_pointer_cast<IPeerStore>(backend));
+            // С PostgreSQL страницы истории читаются неблокирующим libpq
+            // прямо в io_context, иначе - в пуле потоков MessageStore
+            std::shared_ptr<IHistoryReader> history_reader;
+            if (GetConfig().GetStorageBackend() == "postgres") {
+                history_reader =
+                    std::make_shared<AsyncPostgresDatabase>(io_context, kHistoryConnections);
+            }
+            message_store = std::make_shared<MessageStore>(backend, std::move(history_reader));
+            auto chat_factory = std::make_shared<ChatSessionFactory>(
+                std::make_shared<RoomHub>(), registry, message_store);
+            chat_server = std::make_unique<Server>(
+                io_context, db_service, std::move(chat_factory),
+                static_cast<unsigned short>(chat_port), false);
+            LOG_INFO << "Chat server started on port " << chat_port;
+        }
+
+        // Слушатель HTTPS с тем же HTTP API: TLS завершается в процессе,
+        // без отдельного прокси перед сервером. Соединения HTTPS тоже
+        // считаются посещениями.
+        std::unique_ptr<Server> tls_server;
+        if (const int tls_port = GetConfig().GetTlsServerPort(); tls_port > 0) {
+            auto tls_factory = std::make_shared<TlsSessionFactory>(MakeTlsContext(GetConfig()));
+            tls_server = std::make_unique<Server>(
+                io_context, db_service, std::move(tls_factory),
+                static_cast<unsigned short>(tls_port), true);
+            LOG_INFO << "TLS server started on port " << tls_port;
+        }
+
+        // SIGHUP перечитывает конфигурацию без перезапуска
+        boost::asio::signal_set reload_signals(io_context, SIGHUP);
+        WatchReload(reload_signals);
+
+        // SIGINT/SIGTERM останавливают прием и дают соединениям завершиться
+        std::vector<Server*> servers{&s};
+        if (chat_server) {
+            servers.push_back(chat_server.get());
+        }
+        if (tls_server) {
+            servers.push_back(tls_server.get());
+        }
+        boost::asio::signal_set stop_signals(io_context, SIGINT, SIGTERM);
+        WatchShutdown(stop_signals, reload_signals, servers);
+
+        // Запускаем дополнительные потоки обработки событий
+        std::atomic<bool> io_failed{false};
+        std::vector<std::thread> workers;
+        workers.reserve(static_cast<std::size_t>(io_threads - 1));
+        for (int i = 1; i < io_threads; ++i) {
+            workers.emplace_back([&io_context, &io_failed] {
+                if (!RunIoContext(io_context)) {
+                    io_failed.store(true, std::memory_order_relaxed);
+                }
+            });
+        }
+
+        // Основной поток тоже обрабатывает события (блокирующий вызов)
+        if (!RunIoContext(io_context)) {
+            io_failed.store(true, std::memory_order_relaxed);
+        }
+
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        // Соединений больше нет: записываем все, что ждет отложенной записи.
+        // Хранилище (пул соединений PostgresDatabase, сегменты журнала)
+        // закрывается при выходе из блока, после всех своих пользователей.
+        LOG_INFO << "Flushing buffered writes";
+        peer_snapshotter.reset();
+        if (message_store) {
+            message_store->Flush();
+        }
+        recorder->Flush();
+        if (io_failed.load(std::memory_order_relaxed)) {
+            LOG_ERROR << "Server stopped after an IO thread failure";
+            return EXIT_FAILURE;
+        }
+        LOG_INFO << "Server stopped";
 
     } catch (const std::exception& e) {
         // Обрабатываем любые исключения и выводим информацию об ошибке
-        std::cerr << "Exception: " << e.what() << "\n";
+        LOG_ERROR << "Exception: " << e.what();
+        return EXIT_FAILURE;
     }
 
     return 0;
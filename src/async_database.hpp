@@ -0,0 +1,855 @@
+#pragma once
+
+#include "config.hpp"
+#include "database_service.hpp"
+
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <libpq-fe.h>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Коды ошибок асинхронного слоя базы данных
+ */
+enum class AsyncDbError {
+    kConnectionFailed = 1,  ///< Не удалось установить соединение
+    kConnectionLost,        ///< Соединение разорвано во время выполнения запроса
+    kQueryFailed,           ///< Сервер вернул ошибку выполнения запроса
+};
+
+/**
+ * @brief Категория ошибок boost::system для AsyncDbError
+ */
+class AsyncDbErrorCategory : public boost::system::error_category {
+   public:
+    [[nodiscard]] const char* name() const noexcept override {
+        return "async_db";
+    }
+
+    [[nodiscard]] std::string message(int value) const override {
+        switch (static_cast<AsyncDbError>(value)) {
+            case AsyncDbError::kConnectionFailed:
+                return "database connection failed";
+            case AsyncDbError::kConnectionLost:
+                return "database connection lost";
+            case AsyncDbError::kQueryFailed:
+                return "database query failed";
+        }
+        return "unknown database error";
+    }
+};
+
+/**
+ * @brief Создает error_code из кода ошибки асинхронного слоя БД
+ *
+ * @param error Код ошибки
+ * @return boost::system::error_code Код ошибки в категории AsyncDbErrorCategory
+ */
+inline boost::system::error_code MakeErrorCode(AsyncDbError error) {
+    static const AsyncDbErrorCategory kCategory;
+    return {static_cast<int>(error), kCategory};
+}
+
+/**
+ * @brief Результат асинхронного запроса
+ *
+ * Владеет PGresult и освобождает его при уничтожении. Значения полей
+ * возвращаются как string_view в память результата без копирования.
+ */
+class AsyncQueryResult {
+   public:
+    AsyncQueryResult() = default;
+
+    /**
+     * @brief Принимает владение результатом libpq
+     *
+     * @param result Результат запроса (может быть nullptr)
+     */
+    explicit AsyncQueryResult(PGresult* result) : result_(result) {
+    }
+
+    /**
+     * @brief Количество строк в результате
+     */
+    [[nodiscard]] int Rows() const {
+        return result_ ? PQntuples(result_.get()) : 0;
+    }
+
+    /**
+     * @brief Количество столбцов в результате
+     */
+    [[nodiscard]] int Columns() const {
+        return result_ ? PQnfields(result_.get()) : 0;
+    }
+
+    /**
+     * @brief Проверяет, является ли значение поля NULL
+     */
+    [[nodiscard]] bool IsNull(int row, int column) const {
+        return !result_ || PQgetisnull(result_.get(), row, column) != 0;
+    }
+
+    /**
+     * @brief Возвращает текстовое значение поля без копирования
+     *
+     * @param row Номер строки
+     * @param column Номер столбца
+     * @return std::string_view Значение, действительное пока жив результат
+     */
+    [[nodiscard]] std::string_view Value(int row, int column) const {
+        if (IsNull(row, column)) {
+            return {};
+        }
+        return {
+            PQgetvalue(result_.get(), row, column),
+            static_cast<std::size_t>(PQgetlength(result_.get(), row, column))};
+    }
+
+    /**
+     * @brief Сообщение об ошибке сервера (пустое при успехе)
+     */
+    [[nodiscard]] std::string_view ErrorMessage() const {
+        return result_ ? PQresultErrorMessage(result_.get()) : "";
+    }
+
+   private:
+    /**
+     * @brief Удалитель для PGresult
+     */
+    struct ResultDeleter {
+        void operator()(PGresult* result) const {
+            PQclear(result);
+        }
+    };
+
+    std::unique_ptr<PGresult, ResultDeleter> result_;  ///< Результат libpq
+};
+
+/**
+ * @brief Асинхронное соединение с PostgreSQL
+ *
+ * Класс AsyncPgConnection использует неблокирующий API libpq
+ * (PQconnectStart/PQsendQueryParams/PQconsumeInput) и ожидает готовности
+ * сокета соединения через boost::asio, поэтому ни подключение, ни запросы
+ * не блокируют поток io_context.
+ *
+ * Особенности:
+ * - Запросы можно отправлять из любого потока, они сериализуются на strand
+ * - Запросы выполняются в порядке поступления
+ * - Соединение работает в режиме конвейера libpq (pipeline mode): все
+ *   ожидающие запросы отправляются сразу, не дожидаясь ответов на
+ *   предыдущие, поэтому несколько запросов делят один round trip.
+ *   Каждый запрос завершается своей точкой синхронизации, так что ошибка
+ *   одного запроса не прерывает остальные
+ * - Результат доставляется через completion token asio (обработчик,
+ *   use_awaitable, use_future и т.д.) с сигнатурой
+ *   void(boost::system::error_code, AsyncQueryResult)
+ * - При разрыве соединения ожидающие запросы завершаются с ошибкой,
+ *   а следующий запрос переподключается автоматически
+ */
+class AsyncPgConnection : public std::enable_shared_from_this<AsyncPgConnection> {
+   public:
+    using Executor = boost::asio::strand<boost::asio::io_context::executor_type>;
+
+    /**
+     * @brief Конструктор асинхронного соединения
+     *
+     * Подключение выполняется лениво при первом запросе или явно через AsyncConnect().
+     *
+     * @param io_context Контекст ввода-вывода для ожидания готовности сокета
+     * @param conn_string Строка подключения к PostgreSQL
+     */
+    AsyncPgConnection(boost::asio::io_context& io_context, std::string conn_string)
+        : strand_(boost::asio::make_strand(io_context))
+        , socket_(strand_)
+        , conn_string_(std::move(conn_string)) {
+    }
+
+    /**
+     * @brief Деструктор - закрывает соединение libpq
+     *
+     * Дескриптор сокета принадлежит libpq, поэтому asio от него отвязывается.
+     */
+    ~AsyncPgConnection() {
+        ReleaseSocket();
+        if (conn_ != nullptr) {
+            PQfinish(conn_);
+        }
+    }
+
+    AsyncPgConnection(const AsyncPgConnection&) = delete;             ///< Запрет копирования
+    AsyncPgConnection& operator=(const AsyncPgConnection&) = delete;  ///< Запрет присваивания
+    AsyncPgConnection(AsyncPgConnection&&) = delete;                  ///< Запрет перемещения
+    AsyncPgConnection& operator=(
+        AsyncPgConnection&&) = delete;  ///< Запрет перемещающего присваивания
+
+    /**
+     * @brief Асинхронно устанавливает соединение
+     *
+     * @param token Completion token с сигнатурой void(boost::system::error_code)
+     */
+    template <typename CompletionToken>
+    auto AsyncConnect(CompletionToken&& token) {
+        return boost::asio::async_initiate<CompletionToken, void(boost::system::error_code)>(
+            [self = shared_from_this()](auto handler) {
+                auto completion = std::make_unique<
+                    Completion<std::decay_t<decltype(handler)>, boost::system::error_code>>(
+                    std::move(handler), self->strand_);
+                boost::asio::post(
+                    self->strand_, [self, completion = std::move(completion)]() mutable {
+                        self->connect_waiters_.push_back(std::move(completion));
+                        self->BeginConnect();
+                    });
+            },
+            token);
+    }
+
+    /**
+     * @brief Асинхронно выполняет параметризованный запрос
+     *
+     * @param sql Текст запроса с параметрами $1, $2, ...
+     * @param params Текстовые значения параметров
+     * @param token Completion token с сигнатурой
+     *        void(boost::system::error_code, AsyncQueryResult)
+     */
+    template <typename CompletionToken>
+    auto AsyncExec(std::string sql, std::vector<std::string> params, CompletionToken&& token) {
+        return boost::asio::async_initiate<
+            CompletionToken, void(boost::system::error_code, AsyncQueryResult)>(
+            [self = shared_from_this()](
+                auto handler, std::string sql, std::vector<std::string> params) {
+                PendingQuery query{
+                    std::move(sql), std::move(params),
+                    std::make_unique<Completion<
+                        std::decay_t<decltype(handler)>, boost::system::error_code,
+                        AsyncQueryResult>>(std::move(handler), self->strand_)};
+                boost::asio::post(self->strand_, [self, query = std::move(query)]() mutable {
+                    self->queue_.push_back(std::move(query));
+                    if (self->state_ == State::kConnected) {
+                        self->StartNext();
+                    } else {
+                        self->BeginConnect();
+                    }
+                });
+            },
+            token, std::move(sql), std::move(params));
+    }
+
+   private:
+    /**
+     * @brief Состояние соединения
+     */
+    enum class State {
+        kDisconnected,  ///< Соединение не установлено
+        kConnecting,    ///< Идет неблокирующее подключение
+        kConnected,     ///< Соединение готово к запросам
+    };
+
+    /**
+     * @brief Стертый по типу обработчик завершения операции
+     */
+    template <typename... Args>
+    class ICompletion {
+       public:
+        virtual ~ICompletion() = default;
+        ICompletion() = default;
+        ICompletion(const ICompletion&) = delete;             ///< Запрет копирования
+        ICompletion& operator=(const ICompletion&) = delete;  ///< Запрет присваивания
+        ICompletion(ICompletion&&) = delete;                  ///< Запрет перемещения
+        ICompletion& operator=(ICompletion&&) = delete;  ///< Запрет перемещающего присваивания
+
+        /**
+         * @brief Доставляет результат обработчику через его executor
+         */
+        virtual void Complete(Args... args) = 0;
+    };
+
+    /**
+     * @brief Реализация ICompletion для конкретного обработчика asio
+     *
+     * Удерживает work guard на executor обработчика, чтобы io_context
+     * не завершился, пока запрос выполняется.
+     */
+    template <typename Handler, typename... Args>
+    class Completion final : public ICompletion<Args...> {
+       public:
+        Completion(Handler handler, const Executor& fallback)
+            : handler_(std::move(handler))
+            , work_(boost::asio::get_associated_executor(handler_, fallback)) {
+        }
+
+        void Complete(Args... args) override {
+            auto executor = work_.get_executor();
+            boost::asio::post(
+                executor,
+                [handler = std::move(handler_), ... args = std::move(args)]() mutable {
+                    std::move(handler)(std::move(args)...);
+                });
+            work_.reset();
+        }
+
+       private:
+        Handler handler_;  ///< Обработчик завершения
+        boost::asio::executor_work_guard<boost::asio::associated_executor_t<Handler, Executor>>
+            work_;  ///< Удерживает executor обработчика
+    };
+
+    using QueryCompletion = ICompletion<boost::system::error_code, AsyncQueryResult>;
+    using ConnectCompletion = ICompletion<boost::system::error_code>;
+
+    /**
+     * @brief Запрос, ожидающий выполнения
+     */
+    struct PendingQuery {
+        std::string sql;                              ///< Текст запроса
+        std::vector<std::string> params;              ///< Значения параметров
+        std::unique_ptr<QueryCompletion> completion;  ///< Обработчик результата
+    };
+
+    /**
+     * @brief Начинает неблокирующее подключение, если оно еще не идет
+     */
+    void BeginConnect() {
+        if (state_ != State::kDisconnected) {
+            return;
+        }
+        ReleaseSocket();
+        if (conn_ != nullptr) {
+            PQfinish(conn_);
+        }
+
+        state_ = State::kConnecting;
+        conn_ = PQconnectStart(conn_string_.c_str());
+        if (conn_ == nullptr || PQstatus(conn_) == CONNECTION_BAD) {
+            FailConnect();
+            return;
+        }
+        PollConnect(PGRES_POLLING_WRITING);
+    }
+
+    /**
+     * @brief Шаг неблокирующего подключения
+     *
+     * @param status Результат последнего вызова PQconnectPoll
+     */
+    void PollConnect(PostgresPollingStatusType status) {
+        if (status == PGRES_POLLING_OK) {
+            if (PQsetnonblocking(conn_, 1) != 0 || PQenterPipelineMode(conn_) == 0) {
+                FailConnect();
+                return;
+            }
+            state_ = State::kConnected;
+            for (auto& waiter : connect_waiters_) {
+                waiter->Complete({});
+            }
+            connect_waiters_.clear();
+            StartNext();
+            return;
+        }
+        if (status == PGRES_POLLING_FAILED || !AttachSocket()) {
+            FailConnect();
+            return;
+        }
+
+        const auto wait_type = status == PGRES_POLLING_READING
+                                   ? boost::asio::posix::stream_descriptor::wait_read
+                                   : boost::asio::posix::stream_descriptor::wait_write;
+        socket_.async_wait(wait_type, [self = shared_from_this()](boost::system::error_code ec) {
+            if (ec == boost::asio::error::operation_aborted) {
+                return;
+            }
+            if (ec) {
+                self->FailConnect();
+                return;
+            }
+            self->PollConnect(PQconnectPoll(self->conn_));
+        });
+    }
+
+    /**
+     * @brief Завершает с ошибкой подключение и все ожидающие запросы
+     */
+    void FailConnect() {
+        state_ = State::kDisconnected;
+        const auto ec = MakeErrorCode(AsyncDbError::kConnectionFailed);
+        for (auto& waiter : connect_waiters_) {
+            waiter->Complete(ec);
+        }
+        connect_waiters_.clear();
+        FailQueries(ec);
+    }
+
+    /**
+     * @brief Отправляет в конвейер все еще не отправленные запросы
+     *
+     * Первые in_flight_ запросов очереди уже отправлены и ждут ответа,
+     * остальные ставятся в конвейер вслед за ними.
+     */
+    void StartNext() {
+        if (state_ != State::kConnected || in_flight_ == queue_.size()) {
+            return;
+        }
+
+        for (; in_flight_ < queue_.size(); ++in_flight_) {
+            auto& query = queue_[in_flight_];
+            std::vector<const char*> values;
+            values.reserve(query.params.size());
+            for (const auto& param : query.params) {
+                values.push_back(param.c_str());
+            }
+
+            if (PQsendQueryParams(
+                    conn_, query.sql.c_str(), static_cast<int>(values.size()), nullptr,
+                    values.data(), nullptr, nullptr, 0) == 0 ||
+                PQpipelineSync(conn_) == 0) {
+                LoseConnection();
+                return;
+            }
+        }
+        FlushOutgoing();
+        WaitForResult();
+    }
+
+    /**
+     * @brief Дописывает исходящие данные запросов в сокет
+     */
+    void FlushOutgoing() {
+        if (flushing_) {
+            return;
+        }
+        const int flushed = PQflush(conn_);
+        if (flushed < 0) {
+            LoseConnection();
+            return;
+        }
+        if (flushed > 0) {
+            flushing_ = true;
+            socket_.async_wait(
+                boost::asio::posix::stream_descriptor::wait_write,
+                [self = shared_from_this()](boost::system::error_code ec) {
+                    if (ec == boost::asio::error::operation_aborted) {
+                        return;
+                    }
+                    self->flushing_ = false;
+                    if (ec) {
+                        self->LoseConnection();
+                        return;
+                    }
+                    self->FlushOutgoing();
+                });
+        }
+    }
+
+    /**
+     * @brief Ожидает данных от сервера для отправленных запросов
+     */
+    void WaitForResult() {
+        if (reading_ || in_flight_ == 0) {
+            return;
+        }
+        reading_ = true;
+        socket_.async_wait(
+            boost::asio::posix::stream_descriptor::wait_read,
+            [self = shared_from_this()](boost::system::error_code ec) {
+                if (ec == boost::asio::error::operation_aborted) {
+                    return;
+                }
+                self->reading_ = false;
+                if (ec || PQconsumeInput(self->conn_) == 0) {
+                    self->LoseConnection();
+                    return;
+                }
+                self->ReadResults();
+            });
+    }
+
+    /**
+     * @brief Забирает готовые результаты без блокировки
+     *
+     * В режиме конвейера результаты запроса завершаются nullptr, за которым
+     * следует результат PGRES_PIPELINE_SYNC его точки синхронизации - по нему
+     * запрос считается выполненным. Для запроса из нескольких команд
+     * сохраняется результат последней.
+     */
+    void ReadResults() {
+        while (in_flight_ > 0 && PQisBusy(conn_) == 0) {
+            PGresult* result = PQgetResult(conn_);
+            if (result == nullptr) {
+                continue;
+            }
+            const ExecStatusType status = PQresultStatus(result);
+            if (status == PGRES_PIPELINE_SYNC) {
+                PQclear(result);
+                CompleteFront();
+                continue;
+            }
+            current_ = AsyncQueryResult(result);
+            current_failed_ = current_failed_ || status == PGRES_FATAL_ERROR ||
+                              status == PGRES_PIPELINE_ABORTED;
+        }
+        // Пока ответ читался, исходящие данные могли освободить место в буфере
+        FlushOutgoing();
+        WaitForResult();
+    }
+
+    /**
+     * @brief Завершает самый старый отправленный запрос
+     */
+    void CompleteFront() {
+        auto query = std::move(queue_.front());
+        queue_.pop_front();
+        --in_flight_;
+
+        const boost::system::error_code ec =
+            current_failed_ ? MakeErrorCode(AsyncDbError::kQueryFailed)
+                            : boost::system::error_code{};
+        current_failed_ = false;
+        query.completion->Complete(ec, std::move(current_));
+        current_ = AsyncQueryResult();
+    }
+
+    /**
+     * @brief Обрабатывает разрыв соединения
+     */
+    void LoseConnection() {
+        state_ = State::kDisconnected;
+        in_flight_ = 0;
+        flushing_ = false;
+        reading_ = false;
+        current_ = AsyncQueryResult();
+        current_failed_ = false;
+        ReleaseSocket();
+        FailQueries(MakeErrorCode(AsyncDbError::kConnectionLost));
+    }
+
+    /**
+     * @brief Завершает с ошибкой все запросы из очереди
+     *
+     * @param ec Код ошибки
+     */
+    void FailQueries(boost::system::error_code ec) {
+        auto failed = std::move(queue_);
+        queue_.clear();
+        for (auto& query : failed) {
+            query.completion->Complete(ec, AsyncQueryResult());
+        }
+    }
+
+    /**
+     * @brief Привязывает asio к текущему сокету libpq
+     *
+     * Во время подключения libpq может сменить сокет (например, при переборе адресов).
+     *
+     * @return true если сокет доступен
+     */
+    bool AttachSocket() {
+        const int fd = PQsocket(conn_);
+        if (fd < 0) {
+            return false;
+        }
+        if (socket_.is_open() && socket_.native_handle() == fd) {
+            return true;
+        }
+        ReleaseSocket();
+        boost::system::error_code ec;
+        socket_.assign(fd, ec);
+        return !ec;
+    }
+
+    /**
+     * @brief Отвязывает asio от сокета, не закрывая его
+     */
+    void ReleaseSocket() {
+        if (socket_.is_open()) {
+            socket_.release();
+        }
+    }
+
+    Executor strand_;                                               ///< Strand соединения
+    boost::asio::posix::stream_descriptor socket_;                  ///< Сокет libpq для ожидания
+    std::string conn_string_;                                       ///< Строка подключения
+    PGconn* conn_ = nullptr;                                        ///< Соединение libpq
+    State state_ = State::kDisconnected;                            ///< Состояние соединения
+    std::size_t in_flight_ = 0;  ///< Число отправленных запросов в начале очереди
+    bool flushing_ = false;      ///< Ожидается ли готовность сокета к записи
+    bool reading_ = false;       ///< Ожидается ли готовность сокета к чтению
+    std::deque<PendingQuery> queue_;                                ///< Очередь запросов
+    std::vector<std::unique_ptr<ConnectCompletion>> connect_waiters_;  ///< Ожидающие подключения
+    AsyncQueryResult current_;                                      ///< Результат текущего запроса
+    bool current_failed_ = false;  ///< Завершилась ли команда текущего запроса ошибкой
+};
+
+/**
+ * @brief Асинхронный сервис базы данных PostgreSQL
+ *
+ * Класс AsyncPostgresDatabase распределяет запросы по набору
+ * AsyncPgConnection (round-robin), поэтому медленный запрос задерживает
+ * только запросы своего соединения и никогда не блокирует io_context.
+ *
+ * Все методы принимают completion token asio и могут использоваться
+ * как с обработчиками, так и с корутинами (boost::asio::use_awaitable).
+ * Как IHistoryReader сервис читает страницы истории для
+ * MessageStore::AsyncHistory(). Схему создает PostgresDatabase::Initialize().
+ */
+class AsyncPostgresDatabase : public IHistoryReader {
+   public:
+    /**
+     * @brief Конструктор асинхронного сервиса
+     *
+     * @param io_context Контекст ввода-вывода
+     * @param num_connections Количество соединений (0 = использовать значение из конфигурации)
+     */
+    explicit AsyncPostgresDatabase(boost::asio::io_context& io_context, uint64_t num_connections = 0)
+        : io_context_(io_context) {
+        const uint64_t size =
+            num_connections > 0 ? num_connections
+                                : static_cast<uint64_t>(GetConfig().GetConnectionPoolSize());
+        const std::string conn_string = GetConfigSnapshot().db_conn_string;
+        connections_.reserve(size);
+        for (uint64_t i = 0; i < size; ++i) {
+            connections_.push_back(std::make_shared<AsyncPgConnection>(io_context, conn_string));
+        }
+    }
+
+    /**
+     * @brief Асинхронно выполняет параметризованный запрос
+     *
+     * @param sql Текст запроса
+     * @param params Текстовые значения параметров
+     * @param token Completion token с сигнатурой
+     *        void(boost::system::error_code, AsyncQueryResult)
+     */
+    template <typename CompletionToken>
+    auto AsyncExec(std::string sql, std::vector<std::string> params, CompletionToken&& token) {
+        return Next().AsyncExec(
+            std::move(sql), std::move(params), std::forward<CompletionToken>(token));
+    }
+
+    /**
+     * @brief Асинхронно регистрирует посещение
+     *
+     * Записывает посещение так же, как PostgresDatabase::MarkVisits():
+     * одной командой вставляет сырое посещение, прибавляет его к агрегату
+     * visits_per_minute и увеличивает счетчик visits_counter. Пока раздел
+     * visits текущего месяца не подтвержден, вставка ждет завершения
+     * visits_ensure_partition(): месяц публикуется только после создания
+     * раздела, поэтому вставка на любом соединении не опережает раздел.
+     * Схему и функции создает PostgresDatabase::Initialize().
+     *
+     * @param token Completion token с сигнатурой void(boost::system::error_code)
+     */
+    template <typename CompletionToken>
+    auto AsyncMarkVisit(CompletionToken&& token) {
+        return boost::asio::async_initiate<CompletionToken, void(boost::system::error_code)>(
+            [this](auto handler) {
+                const auto now = std::chrono::system_clock::now();
+                const int64_t micros =
+                    std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch())
+                        .count();
+                const std::chrono::year_month_day date{
+                    std::chrono::floor<std::chrono::days>(now)};
+                const int64_t month = (static_cast<int64_t>(static_cast<int>(date.year())) * 12) +
+                                      static_cast<unsigned>(date.month());
+
+                if (partition_month_.load(std::memory_order_acquire) == month) {
+                    InsertVisit(now, std::move(handler));
+                    return;
+                }
+                auto executor =
+                    boost::asio::get_associated_executor(handler, io_context_.get_executor());
+                Next().AsyncExec(
+                    R"(SELECT visits_ensure_partition(to_timestamp($1::bigint / 1000000.0)))",
+                    {std::to_string(micros)},
+                    boost::asio::bind_executor(
+                        executor, [this, now, month, handler = std::move(handler)](
+                                      boost::system::error_code ec, AsyncQueryResult) mutable {
+                            if (ec) {
+                                std::move(handler)(ec);
+                                return;
+                            }
+                            partition_month_.store(month, std::memory_order_release);
+                            InsertVisit(now, std::move(handler));
+                        }));
+            },
+            token);
+    }
+
+    /**
+     * @brief Асинхронно получает количество посещений
+     *
+     * @param token Completion token с сигнатурой void(boost::system::error_code, uint64_t)
+     */
+    template <typename CompletionToken>
+    auto AsyncGetCount(CompletionToken&& token) {
+        return boost::asio::async_initiate<
+            CompletionToken, void(boost::system::error_code, uint64_t)>(
+            [this](auto handler) {
+                auto executor =
+                    boost::asio::get_associated_executor(handler, io_context_.get_executor());
+                Next().AsyncExec(
+                    R"(SELECT count FROM visits_counter WHERE id = 1)", {},
+                    boost::asio::bind_executor(
+                        executor, [handler = std::move(handler)](
+                                      boost::system::error_code ec,
+                                      AsyncQueryResult result) mutable {
+                            uint64_t count = 0;
+                            if (!ec && result.Rows() > 0) {
+                                count = std::stoull(std::string(result.Value(0, 0)));
+                            }
+                            std::move(handler)(ec, count);
+                        }));
+            },
+            token);
+    }
+
+    /**
+     * @brief Асинхронно читает страницу истории комнаты по курсору
+     *
+     * Запрос тот же, что у PostgresDatabase::GetMessages(): обход первичного
+     * ключа (room_id, id) в обратном порядке до limit строк.
+     *
+     * @param room Комната
+     * @param before_id Курсор: возвращаются сообщения с id меньше него
+     * @param limit Максимальное количество сообщений
+     * @param token Completion token с сигнатурой
+     *        void(boost::system::error_code, std::vector<ChatMessage>)
+     */
+    template <typename CompletionToken>
+    auto AsyncGetMessages(
+        uint16_t room, uint64_t before_id, std::size_t limit, CompletionToken&& token) {
+        return boost::asio::async_initiate<
+            CompletionToken, void(boost::system::error_code, std::vector<ChatMessage>)>(
+            [this, room, before_id, limit](auto handler) {
+                auto executor =
+                    boost::asio::get_associated_executor(handler, io_context_.get_executor());
+                Next().AsyncExec(
+                    "SELECT id, author, body, (extract(epoch FROM time) * 1000000)::bigint "
+                    "FROM messages WHERE room_id = $1 AND id < $2 ORDER BY id DESC LIMIT $3",
+                    {std::to_string(room),
+                     std::to_string(std::min<uint64_t>(before_id, INT64_MAX)),
+                     std::to_string(limit)},
+                    boost::asio::bind_executor(
+                        executor, [handler = std::move(handler), room](
+                                      boost::system::error_code ec,
+                                      AsyncQueryResult result) mutable {
+                            std::vector<ChatMessage> messages;
+                            if (!ec) {
+                                try {
+                                    messages = ParseMessages(room, result);
+                                } catch (const std::exception&) {
+                                    ec = MakeErrorCode(AsyncDbError::kQueryFailed);
+                                }
+                            }
+                            std::move(handler)(ec, std::move(messages));
+                        }));
+            },
+            token);
+    }
+
+    /**
+     * @brief Читает страницу истории для MessageStore
+     *
+     * Ошибка запроса передается как DatabaseUnavailableError.
+     *
+     * @param room Комната
+     * @param before_id Курсор: возвращаются сообщения с id меньше него
+     * @param limit Максимальное количество сообщений
+     * @param callback Обработчик результата, вызывается в strand соединения
+     */
+    void ReadMessages(
+        uint16_t room, uint64_t before_id, std::size_t limit, Callback callback) override {
+        AsyncGetMessages(
+            room, before_id, limit,
+            [callback = std::move(callback)](
+                boost::system::error_code ec, std::vector<ChatMessage> messages) {
+                if (ec) {
+                    callback(
+                        std::make_exception_ptr(DatabaseUnavailableError(ec.message())), {});
+                    return;
+                }
+                callback(nullptr, std::move(messages));
+            });
+    }
+
+   private:
+    /**
+     * @brief Вставляет посещение в раздел, который уже существует
+     *
+     * @param time Время посещения
+     * @param handler Обработчик с сигнатурой void(boost::system::error_code)
+     */
+    template <typename Handler>
+    void InsertVisit(std::chrono::system_clock::time_point time, Handler handler) {
+        auto executor = boost::asio::get_associated_executor(handler, io_context_.get_executor());
+        const int64_t micros =
+            std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+        const int64_t minute =
+            std::chrono::floor<std::chrono::minutes>(time.time_since_epoch()).count();
+        Next().AsyncExec(
+            "WITH inserted AS ("
+            "INSERT INTO visits (time) VALUES (to_timestamp($1::bigint / 1000000.0))), "
+            "rolled_up AS ("
+            "INSERT INTO visits_per_minute (minute, count) VALUES ($2::bigint, 1) "
+            "ON CONFLICT (minute) DO UPDATE SET count = visits_per_minute.count + 1) "
+            "UPDATE visits_counter SET count = count + 1 WHERE id = 1",
+            {std::to_string(micros), std::to_string(minute)},
+            boost::asio::bind_executor(
+                executor, [handler = std::move(handler)](
+                              boost::system::error_code ec, AsyncQueryResult) mutable {
+                    std::move(handler)(ec);
+                }));
+    }
+
+    /**
+     * @brief Разбирает строки страницы истории
+     *
+     * @param room Комната
+     * @param result Строки (id, author, body, время в микросекундах)
+     * @return std::vector<ChatMessage> Сообщения в порядке строк
+     * @throws std::exception если значение поля не число
+     */
+    static std::vector<ChatMessage> ParseMessages(uint16_t room, const AsyncQueryResult& result) {
+        std::vector<ChatMessage> messages;
+        messages.reserve(static_cast<std::size_t>(result.Rows()));
+        for (int row = 0; row < result.Rows(); ++row) {
+            messages.push_back(ChatMessage{
+                std::stoull(std::string(result.Value(row, 0))), room,
+                std::string(result.Value(row, 1)), std::string(result.Value(row, 2)),
+                std::chrono::system_clock::time_point(
+                    std::chrono::microseconds(std::stoll(std::string(result.Value(row, 3)))))});
+        }
+        return messages;
+    }
+
+    /**
+     * @brief Выбирает следующее соединение по кругу
+     */
+    AsyncPgConnection& Next() {
+        const std::size_t index = next_.fetch_add(1, std::memory_order_relaxed);
+        return *connections_[index % connections_.size()];
+    }
+
+    boost::asio::io_context& io_context_;                         ///< Контекст ввода-вывода
+    std::vector<std::shared_ptr<AsyncPgConnection>> connections_;  ///< Асинхронные соединения
+    std::atomic<std::size_t> next_{0};  ///< Индекс следующего соединения
+    std::atomic<int64_t> partition_month_{-1};  ///< Месяц с подтвержденным разделом visits
+};
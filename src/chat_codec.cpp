@@ -0,0 +1,177 @@
+/**
+ * @file chat_codec.cpp
+ * @brief Реализация C ABI кодека протокола чата поверх chat_protocol.hpp
+ *
+ * @date 2025
+ */
+
+#include "chat_codec.h"
+
+#include "chat_protocol.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Разборщик входящего потока: буфер чтения и распаковщик
+ */
+struct ChatReader {
+    explicit ChatReader(std::size_t max_payload) : max_payload(max_payload) {
+    }
+
+    std::size_t max_payload;  ///< Максимальная длина нагрузки
+    std::string buffer;       ///< Буфер чтения
+    std::size_t begin = 0;    ///< Начало необработанных байтов
+    std::size_t end = 0;      ///< Конец принятых байтов
+    FrameInflater inflater;   ///< Распаковщик сжатых нагрузок
+};
+
+/**
+ * @brief Построитель исходящих кадров и место под нагрузку
+ */
+struct ChatWriter {
+    explicit ChatWriter(std::size_t compress_min_size) : writer(compress_min_size) {
+    }
+
+    FrameWriter writer;    ///< Накопленные кадры
+    std::string payload;   ///< Место под нагрузку следующего кадра
+};
+
+namespace {
+
+/**
+ * @brief Участок памяти по строке
+ */
+ChatSlice ToSlice(std::string_view data) {
+    return ChatSlice{reinterpret_cast<const uint8_t*>(data.data()), data.size()};
+}
+
+/**
+ * @brief Строка по участку памяти
+ */
+std::string_view FromSlice(ChatSlice slice) {
+    return {reinterpret_cast<const char*>(slice.data), slice.size};
+}
+
+}  // namespace
+
+static_assert(static_cast<int>(FrameStatus::kComplete) == CHAT_FRAME_COMPLETE);
+static_assert(static_cast<int>(FrameStatus::kIncomplete) == CHAT_FRAME_INCOMPLETE);
+static_assert(static_cast<int>(FrameStatus::kTooLarge) == CHAT_FRAME_TOO_LARGE);
+static_assert(static_cast<int>(FrameStatus::kBadFrame) == CHAT_FRAME_BAD_FRAME);
+
+extern "C" {
+
+ChatReader* chat_reader_create(size_t max_payload) {
+    return new ChatReader(max_payload);
+}
+
+void chat_reader_destroy(ChatReader* reader) {
+    delete reader;
+}
+
+uint8_t* chat_reader_prepare(ChatReader* reader, size_t size) {
+    if (reader->begin > 0) {
+        std::memmove(
+            reader->buffer.data(), reader->buffer.data() + reader->begin,
+            reader->end - reader->begin);
+        reader->end -= reader->begin;
+        reader->begin = 0;
+    }
+    if (reader->buffer.size() < reader->end + size) {
+        reader->buffer.resize(std::max(reader->end + size, reader->buffer.size() * 2));
+    }
+    return reinterpret_cast<uint8_t*>(reader->buffer.data() + reader->end);
+}
+
+void chat_reader_commit(ChatReader* reader, size_t size) {
+    reader->end = std::min(reader->end + size, reader->buffer.size());
+}
+
+ChatFrame chat_reader_next(ChatReader* reader) {
+    ChatFrame result{};
+    Frame frame;
+    const std::string_view pending(
+        reader->buffer.data() + reader->begin, reader->end - reader->begin);
+    const FrameStatus status = ParseFrame(pending, reader->max_payload, frame);
+    result.status = static_cast<int32_t>(status);
+    if (status != FrameStatus::kComplete) {
+        return result;
+    }
+    reader->begin += frame.size;
+
+    std::string_view payload = frame.payload;
+    if ((frame.flags & kFrameCompressed) != 0 &&
+        !reader->inflater.Inflate(frame.payload, reader->max_payload, payload)) {
+        result.status = CHAT_FRAME_BAD_COMPRESSION;
+        return result;
+    }
+    result.type = static_cast<uint8_t>(frame.type);
+    result.flags = frame.flags;
+    result.channel = frame.channel;
+    result.payload = ToSlice(payload);
+    return result;
+}
+
+ChatWriter* chat_writer_create(size_t compress_min_size) {
+    return new ChatWriter(compress_min_size);
+}
+
+void chat_writer_destroy(ChatWriter* writer) {
+    delete writer;
+}
+
+void chat_writer_enable_compression(ChatWriter* writer, int32_t enabled) {
+    writer->writer.EnableCompression(enabled != 0);
+}
+
+uint8_t* chat_writer_prepare(ChatWriter* writer, size_t size) {
+    if (writer->payload.size() < size) {
+        writer->payload.resize(size);
+    }
+    return reinterpret_cast<uint8_t*>(writer->payload.data());
+}
+
+void chat_writer_append(ChatWriter* writer, uint8_t type, uint16_t channel, size_t size) {
+    writer->writer.Append(
+        static_cast<FrameType>(type), channel,
+        std::string_view(writer->payload.data(), std::min(size, writer->payload.size())));
+}
+
+ChatSlice chat_writer_data(const ChatWriter* writer) {
+    return ToSlice(writer->writer.Data());
+}
+
+void chat_writer_clear(ChatWriter* writer) {
+    writer->writer.Clear();
+}
+
+ChatNamed chat_parse_named(ChatSlice payload) {
+    ChatNamed result{};
+    NamedPayload named;
+    if (ParseNamedPayload(FromSlice(payload), named)) {
+        result.ok = 1;
+        result.name = ToSlice(named.name);
+        result.rest = ToSlice(named.rest);
+    }
+    return result;
+}
+
+ChatHistoryEntry chat_parse_history(ChatSlice payload) {
+    ChatHistoryEntry result{};
+    HistoryEntry entry;
+    if (ParseHistoryEntry(FromSlice(payload), entry)) {
+        result.ok = 1;
+        result.id = entry.id;
+        result.micros = entry.micros;
+        result.author = ToSlice(entry.author);
+        result.text = ToSlice(entry.text);
+    }
+    return result;
+}
+
+}  // extern "C"
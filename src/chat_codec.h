@@ -0,0 +1,175 @@
+#pragma once
+
+/**
+ * @file chat_codec.h
+ * @brief C ABI кодека протокола чата для dart:ffi
+ *
+ * Нативная библиотека клиента на Flutter собирается из тех же ParseFrame,
+ * FrameWriter и FrameInflater, что и сервер (chat_protocol.hpp), поэтому
+ * у обеих сторон один кодек кадров и сжатия.
+ *
+ * Данные передаются без копий между Dart и C++: буферы принадлежат
+ * кодеку, Dart получает на них указатели и смотрит через
+ * Pointer.asTypedList(), а не копирует в свою кучу:
+ * - Чтение: chat_reader_prepare() отдает место для байтов из сокета,
+ *   chat_reader_commit() принимает их, chat_reader_next() разбирает
+ *   следующий кадр прямо в буфере (сжатая нагрузка распаковывается во
+ *   внутренний буфер распаковщика)
+ * - Запись: chat_writer_prepare() отдает место для нагрузки,
+ *   chat_writer_append() кодирует из него кадр, chat_writer_data()
+ *   отдает все накопленные кадры одним куском для записи в сокет
+ *
+ * Структуры возвращаются по значению, поэтому вызывающей стороне не
+ * нужно выделять память под результаты.
+ *
+ * Объекты кодека не потокобезопасны: каждый используется одним изолятом.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define CHAT_CODEC_EXPORT __declspec(dllexport)
+#else
+#define CHAT_CODEC_EXPORT __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Результат разбора кадра (совпадает с FrameStatus)
+enum ChatFrameStatus {
+    CHAT_FRAME_COMPLETE = 0,        ///< Кадр получен целиком
+    CHAT_FRAME_INCOMPLETE = 1,      ///< Нужно дочитать данные
+    CHAT_FRAME_TOO_LARGE = 2,       ///< Нагрузка превышает допустимый размер
+    CHAT_FRAME_BAD_FRAME = 3,       ///< Неизвестный тип кадра или зарезервированные флаги
+    CHAT_FRAME_BAD_COMPRESSION = 4  ///< Сжатая нагрузка не распаковывается
+};
+
+/// Непрерывный участок памяти, принадлежащий кодеку
+typedef struct ChatSlice {
+    const uint8_t* data;  ///< Начало участка
+    size_t size;          ///< Длина участка
+} ChatSlice;
+
+/// Разобранный кадр
+typedef struct ChatFrame {
+    int32_t status;     ///< ChatFrameStatus; остальные поля заданы при CHAT_FRAME_COMPLETE
+    uint8_t type;       ///< Тип кадра (FrameType)
+    uint8_t flags;      ///< Флаги кадра как в заголовке
+    uint16_t channel;   ///< Канал чата
+    ChatSlice payload;  ///< Нагрузка, уже распакованная
+} ChatFrame;
+
+/// Нагрузка kMessage и kPeer от сервера: [длина имени: uint8][имя][остаток]
+typedef struct ChatNamed {
+    int32_t ok;      ///< 1 если нагрузка корректна
+    ChatSlice name;  ///< Имя участника
+    ChatSlice rest;  ///< Текст сообщения или адрес пира
+} ChatNamed;
+
+/// Сообщение из ответа kHistory
+typedef struct ChatHistoryEntry {
+    int32_t ok;        ///< 1 если нагрузка корректна
+    uint64_t id;       ///< Идентификатор сообщения
+    uint64_t micros;   ///< Время отправки, микросекунды от эпохи Unix
+    ChatSlice author;  ///< Имя отправителя
+    ChatSlice text;    ///< Текст сообщения
+} ChatHistoryEntry;
+
+typedef struct ChatReader ChatReader;  ///< Разборщик входящего потока
+typedef struct ChatWriter ChatWriter;  ///< Построитель исходящих кадров
+
+/**
+ * @brief Создает разборщик входящего потока
+ *
+ * @param max_payload Максимальная длина (распакованной) нагрузки кадра
+ */
+CHAT_CODEC_EXPORT ChatReader* chat_reader_create(size_t max_payload);
+
+/**
+ * @brief Освобождает разборщик
+ */
+CHAT_CODEC_EXPORT void chat_reader_destroy(ChatReader* reader);
+
+/**
+ * @brief Отдает место под size байтов из сокета
+ *
+ * Сдвигает необработанные байты в начало буфера, поэтому нагрузки,
+ * полученные из chat_reader_next(), после вызова недействительны.
+ *
+ * @return uint8_t* Место для записи не меньше size байтов
+ */
+CHAT_CODEC_EXPORT uint8_t* chat_reader_prepare(ChatReader* reader, size_t size);
+
+/**
+ * @brief Принимает size байтов, записанных в место из chat_reader_prepare()
+ */
+CHAT_CODEC_EXPORT void chat_reader_commit(ChatReader* reader, size_t size);
+
+/**
+ * @brief Разбирает следующий кадр принятых байтов
+ *
+ * Нагрузка указывает в буфер разборщика или распаковщика и действительна
+ * до следующего вызова chat_reader_next() или chat_reader_prepare().
+ * При CHAT_FRAME_INCOMPLETE нужно дочитать данные; остальные ошибки
+ * означают, что соединение нужно закрыть.
+ */
+CHAT_CODEC_EXPORT ChatFrame chat_reader_next(ChatReader* reader);
+
+/**
+ * @brief Создает построитель исходящих кадров
+ *
+ * @param compress_min_size Минимальный размер сжимаемой нагрузки (0 - не сжимать)
+ */
+CHAT_CODEC_EXPORT ChatWriter* chat_writer_create(size_t compress_min_size);
+
+/**
+ * @brief Освобождает построитель
+ */
+CHAT_CODEC_EXPORT void chat_writer_destroy(ChatWriter* writer);
+
+/**
+ * @brief Разрешает сжатие, если сервер объявил kCapabilityCompression в Welcome
+ */
+CHAT_CODEC_EXPORT void chat_writer_enable_compression(ChatWriter* writer, int32_t enabled);
+
+/**
+ * @brief Отдает место под нагрузку следующего кадра
+ *
+ * @return uint8_t* Место для записи не меньше size байтов
+ */
+CHAT_CODEC_EXPORT uint8_t* chat_writer_prepare(ChatWriter* writer, size_t size);
+
+/**
+ * @brief Дописывает кадр с первыми size байтами места из chat_writer_prepare()
+ *
+ * Накопленные кадры из chat_writer_data() после вызова недействительны.
+ */
+CHAT_CODEC_EXPORT void chat_writer_append(
+    ChatWriter* writer, uint8_t type, uint16_t channel, size_t size);
+
+/**
+ * @brief Накопленные кадры одним куском для записи в сокет
+ */
+CHAT_CODEC_EXPORT ChatSlice chat_writer_data(const ChatWriter* writer);
+
+/**
+ * @brief Отбрасывает отправленные кадры, сохраняя емкость буфера
+ */
+CHAT_CODEC_EXPORT void chat_writer_clear(ChatWriter* writer);
+
+/**
+ * @brief Разбирает нагрузку kMessage или kPeer от сервера
+ */
+CHAT_CODEC_EXPORT ChatNamed chat_parse_named(ChatSlice payload);
+
+/**
+ * @brief Разбирает непустую нагрузку ответа kHistory
+ */
+CHAT_CODEC_EXPORT ChatHistoryEntry chat_parse_history(ChatSlice payload);
+
+#ifdef __cplusplus
+}
+#endif
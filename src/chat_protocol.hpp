@@ -0,0 +1,475 @@
+#pragma once
+
+#include <zlib.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+
+/**
+ * @file chat_protocol.hpp
+ * @brief Бинарный протокол чата поверх TCP
+ *
+ * Поток состоит из кадров. Каждый кадр - заголовок фиксированного размера
+ * (kFrameHeaderSize байт, сетевой порядок байтов) и полезная нагрузка:
+ *
+ *     0      4      5      6      8
+ *     +------+------+------+------+----------------+
+ *     |length| type |flags |channel| payload ...   |
+ *     +------+------+------+------+----------------+
+ *
+ * - length (uint32) - длина полезной нагрузки в байтах
+ * - type (uint8) - FrameType
+ * - flags (uint8) - kFrameCompressed и зарезервированные биты (должны быть 0)
+ * - channel (uint16) - канал (комната) чата
+ *
+ * Сжатая нагрузка начинается с исходной длины (uint32), за которой идет
+ * поток zlib. Участник сжимает кадры только если другая сторона объявила
+ * kCapabilityCompression в Hello/Welcome.
+ *
+ * Заголовок не зависит от boost::asio: тот же кодек собирается в
+ * нативную библиотеку клиента (см. chat_codec.h).
+ */
+
+/// Размер заголовка кадра в байтах
+inline constexpr std::size_t kFrameHeaderSize = 8;
+/// Флаг кадра: полезная нагрузка сжата zlib
+inline constexpr uint8_t kFrameCompressed = 0x01;
+/// Возможность участника: принимает сжатые кадры
+inline constexpr uint8_t kCapabilityCompression = 0x01;
+
+/**
+ * @brief Тип кадра протокола чата
+ */
+enum class FrameType : uint8_t {
+    kHello = 1,     ///< Клиент -> сервер: [возможности: uint8][имя участника]
+    kWelcome = 2,   ///< Сервер -> клиент: [возможности, принятые сервером: uint8]
+    kMessage = 3,   ///< Клиент -> сервер: текст; сервер -> клиент: [длина имени: uint8][имя][текст]
+    kPing = 4,      ///< Проверка соединения, ответ - kPong с той же нагрузкой
+    kPong = 5,      ///< Ответ на kPing
+    kError = 6,     ///< Сервер -> клиент: текст ошибки, после него соединение закрывается
+    kJoin = 7,      ///< Вход в комнату channel, ответ - kJoin с тем же каналом
+    kLeave = 8,     ///< Выход из комнаты channel, ответ - kLeave с тем же каналом
+    kRegister = 9,  ///< Регистрация адреса для прямых подключений: [host:port], см. ChatSession
+    kLookup = 10,   ///< Клиент -> сервер: поиск адреса пира, нагрузка - имя пира
+    kPeer = 11,     ///< Сервер -> клиент: [длина имени: uint8][имя][host:port или пусто]
+    kHistory = 12,  ///< История комнаты channel, см. ChatSession
+};
+
+/**
+ * @brief Результат разбора кадра
+ */
+enum class FrameStatus {
+    kComplete,    ///< Кадр получен целиком
+    kIncomplete,  ///< Нужно дочитать данные
+    kTooLarge,    ///< Нагрузка превышает допустимый размер
+    kBadFrame,    ///< Неизвестный тип кадра или зарезервированные флаги
+};
+
+/**
+ * @brief Кадр, разобранный без копирования
+ *
+ * payload указывает прямо в буфер чтения, поэтому кадр действителен,
+ * пока данные не сдвинуты и не перезаписаны.
+ */
+struct Frame {
+    FrameType type = FrameType::kPing;  ///< Тип кадра
+    uint8_t flags = 0;                  ///< Флаги кадра
+    uint16_t channel = 0;               ///< Канал чата
+    std::string_view payload;           ///< Полезная нагрузка (возможно, сжатая)
+    std::size_t size = 0;               ///< Размер кадра вместе с заголовком
+};
+
+/**
+ * @brief Разбирает кадр в начале буфера
+ *
+ * @param data Прочитанные, но еще не обработанные байты
+ * @param max_payload Максимальная длина полезной нагрузки
+ * @param frame Сюда записывается кадр при kComplete
+ * @return FrameStatus Результат разбора
+ */
+inline FrameStatus ParseFrame(std::string_view data, std::size_t max_payload, Frame& frame) {
+    if (data.size() < kFrameHeaderSize) {
+        return FrameStatus::kIncomplete;
+    }
+    const auto byte = [&data](std::size_t i) { return static_cast<uint8_t>(data[i]); };
+    const uint32_t length = (static_cast<uint32_t>(byte(0)) << 24U) |
+                            (static_cast<uint32_t>(byte(1)) << 16U) |
+                            (static_cast<uint32_t>(byte(2)) << 8U) | byte(3);
+    const uint8_t type = byte(4);
+    const uint8_t flags = byte(5);
+    if (type < static_cast<uint8_t>(FrameType::kHello) ||
+        type > static_cast<uint8_t>(FrameType::kHistory) || (flags & ~kFrameCompressed) != 0) {
+        return FrameStatus::kBadFrame;
+    }
+    if (length > max_payload) {
+        return FrameStatus::kTooLarge;
+    }
+    if (data.size() - kFrameHeaderSize < length) {
+        return FrameStatus::kIncomplete;
+    }
+
+    frame.type = static_cast<FrameType>(type);
+    frame.flags = flags;
+    frame.channel = static_cast<uint16_t>((byte(6) << 8U) | byte(7));
+    frame.payload = data.substr(kFrameHeaderSize, length);
+    frame.size = kFrameHeaderSize + length;
+    return FrameStatus::kComplete;
+}
+
+/**
+ * @brief Кодирует uint64 в сетевом порядке байтов
+ *
+ * @param value Значение
+ * @return std::array<char, 8> Байты значения, старший первым
+ */
+inline std::array<char, 8> EncodeUint64(uint64_t value) {
+    std::array<char, 8> bytes{};
+    for (std::size_t i = 0; i < bytes.size(); ++i) {
+        bytes[i] = static_cast<char>(value >> (56U - 8U * i));
+    }
+    return bytes;
+}
+
+/**
+ * @brief Декодирует uint64 в сетевом порядке байтов
+ *
+ * @param data Не меньше 8 байтов, старший первым
+ * @return uint64_t Значение
+ */
+inline uint64_t DecodeUint64(std::string_view data) {
+    uint64_t value = 0;
+    for (std::size_t i = 0; i < 8; ++i) {
+        value = (value << 8U) | static_cast<uint8_t>(data[i]);
+    }
+    return value;
+}
+
+/**
+ * @brief Нагрузка с именем участника: [длина имени: uint8][имя][остаток]
+ *
+ * Формат kMessage и kPeer от сервера. Поля указывают в разобранную нагрузку.
+ */
+struct NamedPayload {
+    std::string_view name;  ///< Имя участника
+    std::string_view rest;  ///< Текст сообщения или адрес пира
+};
+
+/**
+ * @brief Разбирает нагрузку с именем участника
+ *
+ * @param payload Нагрузка кадра (распакованная)
+ * @param named Сюда записываются имя и остаток
+ * @return true если длина имени не выходит за нагрузку
+ */
+inline bool ParseNamedPayload(std::string_view payload, NamedPayload& named) {
+    if (payload.empty()) {
+        return false;
+    }
+    const auto name_size = static_cast<uint8_t>(payload[0]);
+    if (payload.size() - 1 < name_size) {
+        return false;
+    }
+    named.name = payload.substr(1, name_size);
+    named.rest = payload.substr(1 + name_size);
+    return true;
+}
+
+/**
+ * @brief Сообщение из ответа kHistory
+ *
+ * Формат нагрузки: [id: uint64][время, мкс: uint64][длина имени: uint8][имя][текст].
+ * Строки указывают в разобранную нагрузку.
+ */
+struct HistoryEntry {
+    uint64_t id = 0;          ///< Идентификатор сообщения
+    uint64_t micros = 0;      ///< Время отправки, микросекунды от эпохи Unix
+    std::string_view author;  ///< Имя отправителя
+    std::string_view text;    ///< Текст сообщения
+};
+
+/**
+ * @brief Разбирает сообщение из ответа kHistory
+ *
+ * @param payload Нагрузка кадра (распакованная, непустая)
+ * @param entry Сюда записывается сообщение
+ * @return true если нагрузка корректна
+ */
+inline bool ParseHistoryEntry(std::string_view payload, HistoryEntry& entry) {
+    constexpr std::size_t kFixedSize = 2 * sizeof(uint64_t);
+    NamedPayload named;
+    if (payload.size() < kFixedSize || !ParseNamedPayload(payload.substr(kFixedSize), named)) {
+        return false;
+    }
+    entry.id = DecodeUint64(payload);
+    entry.micros = DecodeUint64(payload.substr(sizeof(uint64_t)));
+    entry.author = named.name;
+    entry.text = named.rest;
+    return true;
+}
+
+/**
+ * @brief Построитель пакета исходящих кадров
+ *
+ * Класс FrameWriter дописывает кадры в один непрерывный буфер, который
+ * отправляется одним вызовом async_write, сколько бы кадров в нем ни было.
+ * Нагрузка собирается из нескольких фрагментов без промежуточных копий.
+ *
+ * Если сжатие разрешено, нагрузки не короче compress_min_size сжимаются
+ * zlib прямо в буфер; сжатие, не уменьшившее кадр, отбрасывается.
+ * Состояние zlib создается при первом сжатии и переиспользуется.
+ */
+class FrameWriter {
+   public:
+    /**
+     * @brief Конструктор построителя
+     *
+     * @param compress_min_size Минимальный размер сжимаемой нагрузки (0 - не сжимать)
+     */
+    explicit FrameWriter(std::size_t compress_min_size = 0)
+        : compress_min_size_(compress_min_size) {
+    }
+
+    /**
+     * @brief Деструктор - освобождает состояние zlib
+     */
+    ~FrameWriter() {
+        if (deflate_ready_) {
+            deflateEnd(&stream_);
+        }
+    }
+
+    FrameWriter(const FrameWriter&) = delete;             ///< Запрет копирования
+    FrameWriter& operator=(const FrameWriter&) = delete;  ///< Запрет присваивания
+    FrameWriter(FrameWriter&&) = delete;                  ///< Запрет перемещения
+    FrameWriter& operator=(FrameWriter&&) = delete;       ///< Запрет перемещающего присваивания
+
+    /**
+     * @brief Разрешает или запрещает сжатие (по возможностям другой стороны)
+     */
+    void EnableCompression(bool enabled) {
+        compression_enabled_ = enabled;
+    }
+
+    /**
+     * @brief Дописывает кадр, нагрузка которого собирается из фрагментов
+     *
+     * @param type Тип кадра
+     * @param channel Канал чата
+     * @param parts Фрагменты нагрузки (приводимые к std::string_view)
+     */
+    template <typename... Parts>
+    void Append(FrameType type, uint16_t channel, const Parts&... parts) {
+        const std::array<std::string_view, sizeof...(Parts)> pieces{std::string_view(parts)...};
+        AppendParts(type, channel, pieces.data(), pieces.size());
+    }
+
+    /**
+     * @brief Накопленные байты
+     */
+    [[nodiscard]] std::string_view Data() const {
+        return buffer_;
+    }
+
+    /**
+     * @brief Количество накопленных кадров
+     */
+    [[nodiscard]] std::size_t Frames() const {
+        return frames_;
+    }
+
+    /**
+     * @brief Есть ли накопленные кадры
+     */
+    [[nodiscard]] bool Empty() const {
+        return frames_ == 0;
+    }
+
+    /**
+     * @brief Отбрасывает отправленные кадры, сохраняя емкость буфера
+     */
+    void Clear() {
+        buffer_.clear();
+        frames_ = 0;
+    }
+
+    /**
+     * @brief Забирает накопленные кадры, оставляя построитель пустым
+     *
+     * Используется, когда пакет уходит в очередь отправки и должен жить
+     * дольше построителя.
+     *
+     * @return std::string Накопленные байты
+     */
+    std::string Release() {
+        std::string data = std::move(buffer_);
+        Clear();
+        return data;
+    }
+
+   private:
+    /**
+     * @brief Дописывает кадр из массива фрагментов
+     */
+    void AppendParts(
+        FrameType type, uint16_t channel, const std::string_view* parts, std::size_t count) {
+        std::size_t raw_size = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            raw_size += parts[i].size();
+        }
+
+        const std::size_t start = buffer_.size();
+        buffer_.resize(start + kFrameHeaderSize);
+        uint8_t flags = 0;
+        if (compression_enabled_ && compress_min_size_ > 0 && raw_size >= compress_min_size_ &&
+            Deflate(parts, count, raw_size)) {
+            flags = kFrameCompressed;
+        } else {
+            for (std::size_t i = 0; i < count; ++i) {
+                buffer_.append(parts[i]);
+            }
+        }
+
+        const auto length = static_cast<uint32_t>(buffer_.size() - start - kFrameHeaderSize);
+        char* header = buffer_.data() + start;
+        header[0] = static_cast<char>(length >> 24U);
+        header[1] = static_cast<char>(length >> 16U);
+        header[2] = static_cast<char>(length >> 8U);
+        header[3] = static_cast<char>(length);
+        header[4] = static_cast<char>(type);
+        header[5] = static_cast<char>(flags);
+        header[6] = static_cast<char>(channel >> 8U);
+        header[7] = static_cast<char>(channel);
+        ++frames_;
+    }
+
+    /**
+     * @brief Сжимает нагрузку в конец буфера
+     *
+     * @return true если сжатая нагрузка записана и короче исходной
+     */
+    bool Deflate(const std::string_view* parts, std::size_t count, std::size_t raw_size) {
+        if (!deflate_ready_) {
+            if (deflateInit(&stream_, Z_BEST_SPEED) != Z_OK) {
+                return false;
+            }
+            deflate_ready_ = true;
+        } else {
+            deflateReset(&stream_);
+        }
+
+        const std::size_t start = buffer_.size();
+        const auto bound = static_cast<std::size_t>(deflateBound(&stream_, raw_size));
+        buffer_.resize(start + sizeof(uint32_t) + bound);
+        char* out = buffer_.data() + start;
+        out[0] = static_cast<char>(raw_size >> 24U);
+        out[1] = static_cast<char>(raw_size >> 16U);
+        out[2] = static_cast<char>(raw_size >> 8U);
+        out[3] = static_cast<char>(raw_size);
+
+        stream_.next_out = reinterpret_cast<Bytef*>(out + sizeof(uint32_t));
+        stream_.avail_out = static_cast<uInt>(bound);
+        int result = Z_OK;
+        for (std::size_t i = 0; i < count && result == Z_OK; ++i) {
+            // zlib не изменяет входные данные, const_cast нужен только из-за его API
+            stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(parts[i].data()));
+            stream_.avail_in = static_cast<uInt>(parts[i].size());
+            result = deflate(&stream_, Z_NO_FLUSH);
+        }
+        if (result == Z_OK) {
+            result = deflate(&stream_, Z_FINISH);
+        }
+
+        const std::size_t compressed = sizeof(uint32_t) + bound - stream_.avail_out;
+        if (result != Z_STREAM_END || compressed >= raw_size) {
+            buffer_.resize(start);
+            return false;
+        }
+        buffer_.resize(start + compressed);
+        return true;
+    }
+
+    std::string buffer_;                ///< Накопленные кадры
+    std::size_t frames_ = 0;            ///< Количество накопленных кадров
+    std::size_t compress_min_size_;     ///< Минимальный размер сжимаемой нагрузки
+    bool compression_enabled_ = false;  ///< Принимает ли другая сторона сжатые кадры
+    bool deflate_ready_ = false;        ///< Инициализировано ли состояние zlib
+    z_stream stream_{};                 ///< Состояние сжатия zlib
+};
+
+/**
+ * @brief Распаковщик сжатых нагрузок кадров
+ *
+ * Буфер результата и состояние zlib переиспользуются между кадрами.
+ */
+class FrameInflater {
+   public:
+    FrameInflater() = default;
+
+    /**
+     * @brief Деструктор - освобождает состояние zlib
+     */
+    ~FrameInflater() {
+        if (inflate_ready_) {
+            inflateEnd(&stream_);
+        }
+    }
+
+    FrameInflater(const FrameInflater&) = delete;             ///< Запрет копирования
+    FrameInflater& operator=(const FrameInflater&) = delete;  ///< Запрет присваивания
+    FrameInflater(FrameInflater&&) = delete;                  ///< Запрет перемещения
+    FrameInflater& operator=(FrameInflater&&) = delete;  ///< Запрет перемещающего присваивания
+
+    /**
+     * @brief Распаковывает нагрузку кадра с флагом kFrameCompressed
+     *
+     * @param payload Сжатая нагрузка
+     * @param max_size Максимальный размер распакованной нагрузки
+     * @param out Сюда записывается распакованная нагрузка (действительна
+     *        до следующего вызова)
+     * @return true если нагрузка корректна и распакована
+     */
+    bool Inflate(std::string_view payload, std::size_t max_size, std::string_view& out) {
+        if (payload.size() < sizeof(uint32_t)) {
+            return false;
+        }
+        const auto byte = [&payload](std::size_t i) { return static_cast<uint8_t>(payload[i]); };
+        const std::size_t raw_size = (static_cast<std::size_t>(byte(0)) << 24U) |
+                                     (static_cast<std::size_t>(byte(1)) << 16U) |
+                                     (static_cast<std::size_t>(byte(2)) << 8U) | byte(3);
+        if (raw_size == 0 || raw_size > max_size) {
+            return false;
+        }
+
+        if (!inflate_ready_) {
+            if (inflateInit(&stream_) != Z_OK) {
+                return false;
+            }
+            inflate_ready_ = true;
+        } else {
+            inflateReset(&stream_);
+        }
+
+        buffer_.resize(raw_size);
+        // zlib не изменяет входные данные, const_cast нужен только из-за его API
+        stream_.next_in =
+            reinterpret_cast<Bytef*>(const_cast<char*>(payload.data() + sizeof(uint32_t)));
+        stream_.avail_in = static_cast<uInt>(payload.size() - sizeof(uint32_t));
+        stream_.next_out = reinterpret_cast<Bytef*>(buffer_.data());
+        stream_.avail_out = static_cast<uInt>(raw_size);
+        if (inflate(&stream_, Z_FINISH) != Z_STREAM_END || stream_.avail_out != 0 ||
+            stream_.avail_in != 0) {
+            return false;
+        }
+        out = std::string_view(buffer_.data(), raw_size);
+        return true;
+    }
+
+   private:
+    std::string buffer_;          ///< Распакованная нагрузка
+    bool inflate_ready_ = false;  ///< Инициализировано ли состояние zlib
+    z_stream stream_{};           ///< Состояние распаковки zlib
+};
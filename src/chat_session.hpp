@@ -0,0 +1,770 @@
+#pragma once
+
+#include "chat_protocol.hpp"
+#include "config.hpp"
+#include "logger.hpp"
+#include "message_store.hpp"
+#include "metrics.hpp"
+#include "peer_registry.hpp"
+#include "room_hub.hpp"
+#include "send_queue.hpp"
+#include "session.hpp"
+
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/redirect_error.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/asio/write.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Сессия чата, говорящая на бинарном протоколе кадров
+ *
+ * Класс BasicChatSession обслуживает соединение отдельного слушателя
+ * чата (CHAT_SERVER_PORT):
+ * - Читает данные в буфер на один максимальный кадр и разбирает все
+ *   пришедшие кадры без копирования (ParseFrame)
+ * - Ответы на все кадры одного чтения накапливаются в FrameWriter
+ *   и ставятся в очередь отправки одним пакетом
+ * - Сжимает исходящие кадры, если клиент объявил kCapabilityCompression,
+ *   и распаковывает входящие кадры с флагом kFrameCompressed
+ *
+ * Порядок работы: клиент отправляет kHello с именем и получает kWelcome,
+ * затем входит в комнаты (kJoin) и отправляет в них kMessage. Сообщение
+ * кодируется один раз и рассылается через RoomHub всем участникам
+ * комнаты, включая отправителя (подтверждение доставки). Ошибка протокола
+ * завершается кадром kError и закрытием соединения.
+ *
+ * Для прямого подключения пиров друг к другу сессия работает с реестром
+ * PeerRegistry: kRegister регистрирует адрес участника под его именем
+ * (повторный kRegister - heartbeat, пустой - снятие регистрации), а
+ * kLookup возвращает адрес другого участника кадром kPeer. Адрес вида
+ * ":port" дополняется адресом, с которого пришло соединение.
+ *
+ * Если задано хранилище MessageStore, сообщения комнат сохраняются, а
+ * kHistory с нагрузкой [курсор: uint64][количество: uint8] возвращает
+ * сообщения комнаты с id меньше курсора (0 - самые новые), от новых к
+ * старым: по кадру kHistory [id: uint64][время, мкс: uint64][длина
+ * имени: uint8][имя][текст] на сообщение и пустой kHistory в конце.
+ * Id последнего полученного сообщения - курсор следующей страницы.
+ *
+ * Исходящие кадры проходят через ограниченную очередь SendQueue:
+ * отдельная корутина-писатель забирает из нее до kMaxBatchFrames кадров
+ * и отправляет их одной scatter-gather записью. Публикующий участник
+ * только ставит ссылку на кадр в очередь и никогда не ждет записи
+ * получателя. Если очередь получателя переполнена, он считается
+ * медленным: по CHAT_SLOW_CONSUMER_POLICY соединение закрывается
+ * ("disconnect") или кадр отбрасывается ("drop").
+ *
+ * Клиент, не приславший ни одного байта за CHAT_IDLE_TIMEOUT_MS,
+ * отключается. Срок отслеживает общее колесо DeadlineWheel, поэтому
+ * простаивающее соединение не держит собственного таймера.
+ *
+ * Обе корутины выполняются на strand сокета, как и CoSession.
+ *
+ * @tparam Stream Поток asio с async_read_some/async_write_some и lowest_layer()
+ */
+template <typename Stream>
+class BasicChatSession : public ISession, public IRoomSubscriber {
+   public:
+    static constexpr std::size_t kMaxNameSize = 64;       ///< Максимальная длина имени участника
+    static constexpr std::size_t kMaxRooms = 64;          ///< Комнат на одного участника
+    static constexpr std::size_t kMaxBatchFrames = 64;    ///< Кадров в одной записи
+    static constexpr std::size_t kMaxEndpointSize = 255;  ///< Максимальная длина адреса пира
+    static constexpr std::size_t kMaxHistoryPage = 100;   ///< Сообщений в одной странице истории
+
+    /**
+     * @brief Конструктор сессии
+     *
+     * Максимальный размер кадра, порог сжатия, лимит очереди отправки
+     * и политика для медленных получателей берутся из текущего снимка
+     * конфигурации.
+     *
+     * @param stream Поток для коммуникации с клиентом
+     * @param hub Общий маршрутизатор комнат
+     * @param registry Реестр пиров (nullptr - обнаружение пиров отключено)
+     * @param store Хранилище сообщений (nullptr - история отключена)
+     */
+    BasicChatSession(
+        Stream stream, std::shared_ptr<RoomHub> hub,
+        std::shared_ptr<PeerRegistry> registry = nullptr,
+        std::shared_ptr<MessageStore> store = nullptr)
+        : stream_(std::move(stream))
+        , hub_(std::move(hub))
+        , registry_(std::move(registry))
+        , store_(std::move(store))
+        , max_payload_(GetConfigSnapshot().chat_max_frame_size)
+        , compress_min_size_(GetConfigSnapshot().chat_compression_min_size)
+        , read_buffer_(kFrameHeaderSize + max_payload_)
+        , writer_(compress_min_size_)
+        , encoder_(compress_min_size_)
+        , queue_(GetConfigSnapshot().chat_send_queue_bytes)
+        , drop_slow_(GetConfigSnapshot().chat_drop_slow)
+        , idle_timeout_(GetConfigSnapshot().chat_idle_timeout)
+        , wake_timer_(stream_.get_executor()) {
+    }
+
+    /**
+     * @brief Деструктор - снимает сессию с учета активных
+     */
+    ~BasicChatSession() override {
+        if (active_) {
+            GetMetrics().Add(Gauge::kChatSessions, -1);
+        }
+    }
+
+    BasicChatSession(const BasicChatSession&) = delete;             ///< Запрет копирования
+    BasicChatSession& operator=(const BasicChatSession&) = delete;  ///< Запрет присваивания
+    BasicChatSession(BasicChatSession&&) = delete;                  ///< Запрет перемещения
+    BasicChatSession& operator=(
+        BasicChatSession&&) = delete;  ///< Запрет перемещающего присваивания
+
+    /**
+     * @brief Запускает цикл обработки кадров
+     */
+    void Start() override {
+        active_ = true;
+        GetMetrics().Add(Gauge::kChatSessions, 1);
+        const auto self = std::static_pointer_cast<BasicChatSession>(shared_from_this());
+        const auto rethrow = [](const std::exception_ptr& error) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        };
+        boost::asio::co_spawn(stream_.get_executor(), WriteLoop(self), rethrow);
+        boost::asio::co_spawn(stream_.get_executor(), ReadLoop(self), rethrow);
+    }
+
+    /**
+     * @brief Завершает сессию при остановке сервера
+     *
+     * При мягком завершении закрывается только прием: чтение завершается,
+     * участник покидает комнаты, а писатель дописывает очередь и закрывает
+     * отправку.
+     *
+     * @param force Закрыть сокет, не дописывая очередь
+     */
+    void Shutdown(bool force) override {
+        boost::asio::post(
+            stream_.get_executor(),
+            [self = std::static_pointer_cast<BasicChatSession>(shared_from_this()), force] {
+                boost::system::error_code ignored;
+                if (force) {
+                    self->Close();
+                } else {
+                    self->stream_.lowest_layer().shutdown(
+                        BoostTcp::socket::shutdown_receive, ignored);
+                }
+            });
+    }
+
+    /**
+     * @brief Ставит кадр рассылки комнаты в очередь отправки
+     *
+     * Вызывается из strand публикующего участника: трогает только
+     * потокобезопасную очередь, а писателя будит через свой strand.
+     *
+     * @param message Сообщение комнаты
+     */
+    void Deliver(const RoomMessage& message) override {
+        switch (queue_.Push(message.For(accepts_compressed_.load(std::memory_order_relaxed)))) {
+            case SendQueue::PushResult::kQueued:
+                GetMetrics().Increment(Counter::kChatFramesSent);
+                return;
+            case SendQueue::PushResult::kQueuedWake:
+                GetMetrics().Increment(Counter::kChatFramesSent);
+                boost::asio::post(
+                    stream_.get_executor(),
+                    [self = std::static_pointer_cast<BasicChatSession>(shared_from_this())] {
+                        self->wake_timer_.cancel();
+                    });
+                return;
+            case SendQueue::PushResult::kOverflow:
+                OnOverflow();
+                return;
+        }
+    }
+
+   private:
+    /**
+     * @brief Цикл чтения и обработки кадров
+     *
+     * Ответы на кадры одного чтения ставятся в очередь одним пакетом.
+     * При завершении участник покидает все комнаты, а писатель
+     * дописывает очередь и закрывает отправку.
+     *
+     * @param self Удерживает сессию, пока корутина выполняется
+     */
+    boost::asio::awaitable<void> ReadLoop([[maybe_unused]] std::shared_ptr<BasicChatSession> self) {
+        boost::system::error_code ec;
+        while (!closing_) {
+            ArmDeadline(stream_.get_executor(), idle_timeout_);
+            const std::size_t size = co_await stream_.async_read_some(
+                boost::asio::buffer(
+                    read_buffer_.data() + read_size_, read_buffer_.size() - read_size_),
+                boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+            if (ec) {
+                break;
+            }
+            GetMetrics().Increment(Counter::kBytesReceived, size);
+            read_size_ += size;
+
+            ProcessFrames();
+            // Кадры после запроса истории обрабатываются, когда страница
+            // прочитана, чтобы ответы шли в порядке запросов
+            while (history_ && !closing_) {
+                co_await SendHistory(*history_);
+                history_.reset();
+                ProcessFrames();
+            }
+
+            if (!writer_.Empty()) {
+                GetMetrics().Increment(Counter::kChatFramesSent, writer_.Frames());
+                Enqueue(queue_.PushUnbounded(
+                    std::make_shared<const std::string>(writer_.Release())));
+                if (queue_.Full()) {
+                    // Клиент не читает ответы на собственные кадры
+                    DisconnectSlow();
+                }
+            }
+        }
+
+        for (const uint16_t room : rooms_) {
+            hub_->Leave(room, this);
+        }
+        rooms_.clear();
+        reader_done_ = true;
+        DisarmDeadline();
+        wake_timer_.cancel();
+    }
+
+    /**
+     * @brief Цикл пакетной отправки кадров из очереди
+     *
+     * Пока очередь пуста, писатель ждет на wake_timer_: таймер никогда
+     * не истекает, его отмена служит пробуждением. Ошибка записи
+     * закрывает сокет, что завершает и чтение.
+     *
+     * @param self Удерживает сессию, пока корутина выполняется
+     */
+    boost::asio::awaitable<void> WriteLoop(
+        [[maybe_unused]] std::shared_ptr<BasicChatSession> self) {
+        boost::system::error_code ec;
+        std::vector<boost::asio::const_buffer> buffers;
+        while (true) {
+            if (queue_.PopBatch(batch_, kMaxBatchFrames) == 0) {
+                if (reader_done_) {
+                    break;
+                }
+                wake_timer_.expires_at(boost::asio::steady_timer::time_point::max());
+                co_await wake_timer_.async_wait(
+                    boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+                continue;
+            }
+
+            buffers.clear();
+            for (const SharedFrame& frame : batch_) {
+                buffers.push_back(boost::asio::buffer(*frame));
+            }
+            const std::size_t length = co_await boost::asio::async_write(
+                stream_, buffers, boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+            GetMetrics().Increment(Counter::kBytesSent, length);
+            batch_.clear();
+            if (ec) {
+                Close();
+                co_return;
+            }
+        }
+
+        boost::system::error_code ignored;
+        stream_.lowest_layer().shutdown(BoostTcp::socket::shutdown_send, ignored);
+    }
+
+    /**
+     * @brief Будит писателя, если очередь вышла из простоя
+     *
+     * Вызывается только на strand сессии.
+     *
+     * @param result Результат постановки кадра в очередь
+     */
+    void Enqueue(SendQueue::PushResult result) {
+        if (result == SendQueue::PushResult::kQueuedWake) {
+            wake_timer_.cancel();
+        }
+    }
+
+    /**
+     * @brief Обрабатывает переполнение очереди медленного получателя
+     *
+     * Вызывается из strand публикующего участника.
+     */
+    void OnOverflow() {
+        if (drop_slow_) {
+            GetMetrics().Increment(Counter::kChatFramesDropped);
+            return;
+        }
+        DisconnectSlow();
+    }
+
+    /**
+     * @brief Закрывает соединение медленного получателя (один раз)
+     */
+    void DisconnectSlow() {
+        if (slow_.exchange(true, std::memory_order_relaxed)) {
+            return;
+        }
+        GetMetrics().Increment(Counter::kChatSlowConsumers);
+        LOG_DEBUG << "Chat peer too slow, disconnecting: " << name_;
+        boost::asio::post(
+            stream_.get_executor(),
+            [self = std::static_pointer_cast<BasicChatSession>(shared_from_this())] {
+                self->Close();
+            });
+    }
+
+    /**
+     * @brief Закрывает соединение клиента, молчавшего дольше CHAT_IDLE_TIMEOUT_MS
+     */
+    void OnDeadline() override {
+        boost::asio::post(
+            stream_.get_executor(),
+            [self = std::static_pointer_cast<BasicChatSession>(shared_from_this())] {
+                LOG_DEBUG << "Chat peer idle, disconnecting: " << self->name_;
+                self->Close();
+            });
+    }
+
+    /**
+     * @brief Закрывает сокет, прерывая чтение и запись
+     */
+    void Close() {
+        boost::system::error_code ignored;
+        stream_.lowest_layer().close(ignored);
+    }
+
+    /**
+     * @brief Обрабатывает все полные кадры в буфере чтения
+     *
+     * Обработанные байты удаляются из буфера, начало неполного кадра
+     * сдвигается в начало. Буфер вмещает кадр максимального размера,
+     * поэтому неполный кадр всегда можно дочитать. Обработка
+     * останавливается после запроса истории: оставшиеся кадры
+     * обрабатываются после его выполнения.
+     */
+    void ProcessFrames() {
+        std::size_t offset = 0;
+        Frame frame;
+        while (!closing_ && !history_) {
+            const FrameStatus status = ParseFrame(
+                std::string_view(read_buffer_.data() + offset, read_size_ - offset), max_payload_,
+                frame);
+            if (status == FrameStatus::kIncomplete) {
+                break;
+            }
+            if (status == FrameStatus::kComplete) {
+                GetMetrics().Increment(Counter::kChatFramesReceived);
+                HandleFrame(frame);
+                offset += frame.size;
+            } else {
+                Fail(status == FrameStatus::kTooLarge ? "frame too large" : "malformed frame");
+            }
+        }
+
+        std::memmove(read_buffer_.data(), read_buffer_.data() + offset, read_size_ - offset);
+        read_size_ -= offset;
+    }
+
+    /**
+     * @brief Обрабатывает один кадр
+     *
+     * @param frame Кадр, ссылающийся на буфер чтения
+     */
+    void HandleFrame(const Frame& frame) {
+        std::string_view payload = frame.payload;
+        if ((frame.flags & kFrameCompressed) != 0 &&
+            !inflater_.Inflate(frame.payload, max_payload_, payload)) {
+            Fail("bad compressed payload");
+            return;
+        }
+
+        switch (frame.type) {
+            case FrameType::kHello:
+                HandleHello(frame.channel, payload);
+                return;
+            case FrameType::kJoin:
+            case FrameType::kLeave:
+            case FrameType::kMessage:
+            case FrameType::kRegister:
+            case FrameType::kLookup:
+            case FrameType::kHistory:
+                if (name_.empty()) {
+                    Fail("hello expected");
+                    return;
+                }
+                HandlePeerFrame(frame.type, frame.channel, payload);
+                return;
+            case FrameType::kPing:
+                writer_.Append(FrameType::kPong, frame.channel, payload);
+                return;
+            case FrameType::kPong:
+                return;
+            default:
+                Fail("unexpected frame type");
+                return;
+        }
+    }
+
+    /**
+     * @brief Регистрирует участника и согласует возможности
+     *
+     * @param channel Канал кадра
+     * @param payload [возможности: uint8][имя участника]
+     */
+    void HandleHello(uint16_t channel, std::string_view payload) {
+        if (!name_.empty()) {
+            Fail("duplicate hello");
+            return;
+        }
+        const std::string_view name = payload.empty() ? payload : payload.substr(1);
+        if (name.empty() || name.size() > kMaxNameSize) {
+            Fail("bad name");
+            return;
+        }
+
+        name_.assign(name);
+        const bool compression = (static_cast<uint8_t>(payload[0]) & kCapabilityCompression) != 0 &&
+                                 compress_min_size_ > 0;
+        writer_.EnableCompression(compression);
+        accepts_compressed_.store(compression, std::memory_order_relaxed);
+        const char capabilities = compression ? static_cast<char>(kCapabilityCompression) : '\0';
+        writer_.Append(FrameType::kWelcome, channel, std::string_view(&capabilities, 1));
+        LOG_DEBUG << "Chat peer joined: " << name_;
+    }
+
+    /**
+     * @brief Обрабатывает кадр участника, прошедшего kHello
+     *
+     * @param type Тип кадра
+     * @param channel Канал кадра
+     * @param payload Нагрузка кадра
+     */
+    void HandlePeerFrame(FrameType type, uint16_t channel, std::string_view payload) {
+        switch (type) {
+            case FrameType::kJoin:
+                JoinRoom(channel);
+                return;
+            case FrameType::kLeave:
+                LeaveRoom(channel);
+                return;
+            case FrameType::kRegister:
+                RegisterPeer(channel, payload);
+                return;
+            case FrameType::kLookup:
+                LookupPeer(channel, payload);
+                return;
+            case FrameType::kHistory:
+                RequestHistory(channel, payload);
+                return;
+            default:
+                PublishMessage(channel, payload);
+                return;
+        }
+    }
+
+    /**
+     * @brief Регистрирует адрес участника в реестре пиров
+     *
+     * Ответ - kRegister с зарегистрированным адресом, по которому клиент
+     * узнает свой внешний адрес.
+     *
+     * @param channel Канал кадра
+     * @param endpoint Адрес host:port, ":port" или пусто для снятия регистрации
+     */
+    void RegisterPeer(uint16_t channel, std::string_view endpoint) {
+        if (!registry_) {
+            Fail("peer discovery disabled");
+            return;
+        }
+        if (endpoint.empty()) {
+            registry_->Unregister(name_);
+            writer_.Append(FrameType::kRegister, channel);
+            return;
+        }
+        if (endpoint.size() > kMaxEndpointSize) {
+            Fail("bad endpoint");
+            return;
+        }
+
+        std::string observed;
+        if (endpoint.front() == ':') {
+            boost::system::error_code ec;
+            const auto remote = stream_.lowest_layer().remote_endpoint(ec);
+            if (ec) {
+                Fail("bad endpoint");
+                return;
+            }
+            observed = remote.address().to_string();
+            observed += endpoint;
+            endpoint = observed;
+        }
+        registry_->Register(name_, endpoint);
+        writer_.Append(FrameType::kRegister, channel, endpoint);
+    }
+
+    /**
+     * @brief Отвечает адресом пира из реестра
+     *
+     * @param channel Канал кадра
+     * @param id Имя пира
+     */
+    void LookupPeer(uint16_t channel, std::string_view id) {
+        if (!registry_) {
+            Fail("peer discovery disabled");
+            return;
+        }
+        if (id.empty() || id.size() > kMaxNameSize) {
+            Fail("bad name");
+            return;
+        }
+        const std::optional<std::string> endpoint = registry_->Lookup(id);
+        const auto id_size = static_cast<char>(id.size());
+        writer_.Append(
+            FrameType::kPeer, channel, std::string_view(&id_size, 1), id,
+            endpoint ? std::string_view(*endpoint) : std::string_view());
+    }
+
+    /**
+     * @brief Запрос страницы истории комнаты
+     */
+    struct HistoryRequest {
+        uint16_t room = 0;       ///< Комната
+        uint64_t before_id = 0;  ///< Курсор: сообщения с id меньше него
+        std::size_t limit = 0;   ///< Максимальное количество сообщений
+    };
+
+    /**
+     * @brief Разбирает запрос истории и откладывает его до SendHistory()
+     *
+     * @param room Идентификатор комнаты
+     * @param request [курсор: uint64][количество: uint8]
+     */
+    void RequestHistory(uint16_t room, std::string_view request) {
+        if (!store_) {
+            Fail("history disabled");
+            return;
+        }
+        if (request.size() != 9) {
+            Fail("bad history request");
+            return;
+        }
+        history_ = HistoryRequest{
+            room, DecodeUint64(request),
+            std::min<std::size_t>(static_cast<uint8_t>(request[8]), kMaxHistoryPage)};
+    }
+
+    /**
+     * @brief Отправляет страницу истории комнаты
+     *
+     * Последние сообщения отдаются из кеша MessageStore, более старые
+     * страницы читаются из БД по курсору в пуле потоков хранилища, не
+     * блокируя поток io_context. Страница обрезается до размера одного
+     * максимального кадра, чтобы не переполнить очередь отправки; клиент
+     * дочитывает остаток следующим запросом.
+     *
+     * @param request Запрос истории
+     */
+    boost::asio::awaitable<void> SendHistory(HistoryRequest request) {
+        const uint16_t room = request.room;
+        std::vector<ChatMessage> messages;
+        try {
+            messages = co_await store_->AsyncHistory(
+                room, request.before_id, request.limit, boost::asio::use_awaitable);
+        } catch (const std::exception& e) {
+            LOG_WARNING << "History unavailable: " << e.what();
+            Fail("history unavailable");
+            co_return;
+        }
+        std::size_t page_size = 0;
+        for (const ChatMessage& message : messages) {
+            page_size += kFrameHeaderSize + 17 + message.author.size() + message.text.size();
+            if (page_size > max_payload_) {
+                break;
+            }
+            const auto time = std::chrono::duration_cast<std::chrono::microseconds>(
+                message.time.time_since_epoch());
+            const std::array<char, 8> id = EncodeUint64(message.id);
+            const std::array<char, 8> micros = EncodeUint64(static_cast<uint64_t>(time.count()));
+            const auto author_size = static_cast<char>(message.author.size());
+            writer_.Append(
+                FrameType::kHistory, room, std::string_view(id.data(), id.size()),
+                std::string_view(micros.data(), micros.size()),
+                std::string_view(&author_size, 1), message.author, message.text);
+        }
+        writer_.Append(FrameType::kHistory, room);
+    }
+
+    /**
+     * @brief Входит в комнату и подтверждает вход
+     *
+     * @param room Идентификатор комнаты
+     */
+    void JoinRoom(uint16_t room) {
+        if (std::find(rooms_.begin(), rooms_.end(), room) == rooms_.end()) {
+            if (rooms_.size() >= kMaxRooms) {
+                Fail("too many rooms");
+                return;
+            }
+            hub_->Join(room, std::static_pointer_cast<BasicChatSession>(shared_from_this()));
+            rooms_.push_back(room);
+        }
+        writer_.Append(FrameType::kJoin, room);
+    }
+
+    /**
+     * @brief Покидает комнату и подтверждает выход
+     *
+     * @param room Идентификатор комнаты
+     */
+    void LeaveRoom(uint16_t room) {
+        const auto it = std::find(rooms_.begin(), rooms_.end(), room);
+        if (it != rooms_.end()) {
+            hub_->Leave(room, this);
+            rooms_.erase(it);
+        }
+        writer_.Append(FrameType::kLeave, room);
+    }
+
+    /**
+     * @brief Кодирует сообщение один раз и рассылает его участникам комнаты
+     *
+     * Сжатый вариант строится, только если нагрузка не короче порога
+     * сжатия, и сохраняется, только если он короче обычного. Если
+     * хранилище сообщений недоступно, сообщение все равно рассылается.
+     *
+     * @param room Идентификатор комнаты
+     * @param text Текст сообщения
+     */
+    void PublishMessage(uint16_t room, std::string_view text) {
+        if (std::find(rooms_.begin(), rooms_.end(), room) == rooms_.end()) {
+            Fail("not a member");
+            return;
+        }
+        if (store_) {
+            try {
+                store_->Append(room, name_, text);
+            } catch (const std::exception& e) {
+                LOG_WARNING << "Message not stored: " << e.what();
+            }
+        }
+
+        const auto name_size = static_cast<char>(name_.size());
+        const std::string_view name_prefix(&name_size, 1);
+        RoomMessage message;
+        encoder_.EnableCompression(false);
+        encoder_.Append(FrameType::kMessage, room, name_prefix, name_, text);
+        message.plain = std::make_shared<const std::string>(encoder_.Release());
+        if (compress_min_size_ > 0 && 1 + name_.size() + text.size() >= compress_min_size_) {
+            encoder_.EnableCompression(true);
+            encoder_.Append(FrameType::kMessage, room, name_prefix, name_, text);
+            std::string compressed = encoder_.Release();
+            if (compressed.size() < message.plain->size()) {
+                message.compressed = std::make_shared<const std::string>(std::move(compressed));
+            }
+        }
+        hub_->Publish(room, message);
+    }
+
+    /**
+     * @brief Отправляет kError и закрывает соединение после записи
+     *
+     * @param reason Описание ошибки
+     */
+    void Fail(std::string_view reason) {
+        LOG_DEBUG << "Chat protocol error: " << reason;
+        writer_.Append(FrameType::kError, 0, reason);
+        closing_ = true;
+    }
+
+    Stream stream_;                                ///< Поток клиента
+    std::shared_ptr<RoomHub> hub_;                 ///< Маршрутизатор комнат
+    std::shared_ptr<PeerRegistry> registry_;       ///< Реестр пиров
+    std::shared_ptr<MessageStore> store_;          ///< Хранилище сообщений
+    std::size_t max_payload_;                      ///< Максимальная длина нагрузки кадра
+    std::size_t compress_min_size_;                ///< Порог сжатия нагрузки
+    std::vector<char> read_buffer_;                ///< Буфер чтения на один максимальный кадр
+    std::size_t read_size_ = 0;                    ///< Количество байтов в буфере
+    FrameWriter writer_;                           ///< Пакет ответов на одно чтение
+    FrameWriter encoder_;                          ///< Кодировщик сообщений для рассылки
+    FrameInflater inflater_;                       ///< Распаковщик входящих кадров
+    SendQueue queue_;                              ///< Очередь отправки
+    std::vector<SharedFrame> batch_;               ///< Кадры текущей записи
+    std::vector<uint16_t> rooms_;                  ///< Комнаты участника
+    std::optional<HistoryRequest> history_;        ///< Отложенный запрос истории
+    std::string name_;                             ///< Имя участника (пусто до kHello)
+    std::atomic<bool> accepts_compressed_{false};  ///< Принимает ли клиент сжатые кадры
+    std::atomic<bool> slow_{false};                ///< Закрывается ли как медленный получатель
+    bool drop_slow_;                               ///< Политика: отбрасывать кадры, а не закрывать
+    std::chrono::milliseconds idle_timeout_;       ///< Простой клиента до отключения (0 - нет)
+    boost::asio::steady_timer wake_timer_;         ///< Ожидание писателем новых кадров
+    bool closing_ = false;                         ///< Закрыть соединение после отправки пакета
+    bool reader_done_ = false;                     ///< Чтение завершено, писатель дописывает
+    bool active_ = false;                          ///< Учтена ли сессия как активная
+};
+
+/// Сессия чата поверх TCP сокета
+using ChatSession = BasicChatSession<BoostTcp::socket>;
+
+/**
+ * @brief Фабрика сессий чата
+ */
+class ChatSessionFactory : public ISessionFactory {
+   public:
+    /**
+     * @brief Конструктор фабрики
+     *
+     * @param hub Маршрутизатор комнат, общий для всех сессий
+     * @param registry Реестр пиров (nullptr - обнаружение пиров отключено)
+     * @param store Хранилище сообщений (nullptr - история отключена)
+     */
+    explicit ChatSessionFactory(
+        std::shared_ptr<RoomHub> hub, std::shared_ptr<PeerRegistry> registry = nullptr,
+        std::shared_ptr<MessageStore> store = nullptr)
+        : hub_(std::move(hub)), registry_(std::move(registry)), store_(std::move(store)) {
+    }
+
+    /**
+     * @brief Создает новую сессию чата
+     *
+     * Сессии чата не обращаются к сервису базы данных напрямую: сообщения
+     * сохраняет MessageStore, поэтому параметр интерфейса не используется.
+     *
+     * @param socket TCP сокет клиентского соединения
+     * @return std::shared_ptr<ISession> Умный указатель на созданную сессию
+     */
+    std::shared_ptr<ISession> Create(
+        BoostTcp::socket socket, std::shared_ptr<IDatabaseService> /*db_service*/) override {
+        return std::make_shared<ChatSession>(std::move(socket), hub_, registry_, store_);
+    }
+
+   private:
+    std::shared_ptr<RoomHub> hub_;            ///< Маршрутизатор комнат
+    std::shared_ptr<PeerRegistry> registry_;  ///< Реестр пиров
+    std::shared_ptr<MessageStore> store_;     ///< Хранилище сообщений
+};
@@ -0,0 +1,382 @@
+#pragma once
+
+#include "database.hpp"
+#include "http_parser.hpp"
+#include "http_response.hpp"
+#include "http_router.hpp"
+#include "logger.hpp"
+#include "metrics.hpp"
+#include "session.hpp"
+
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/redirect_error.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/asio/write.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <string_view>
+#include <utility>
+
+/**
+ * @brief Рукопожатие потока перед первым запросом
+ *
+ * По умолчанию поток готов к обмену сразу после accept. Потоки с
+ * рукопожатием (TLS) специализируют шаблон: kRequired = true и
+ * статические Async(stream, token) для рукопожатия, Established(stream)
+ * после него и Close(stream) перед закрытием соединения сервером
+ * (см. tls_session.hpp).
+ *
+ * @tparam Stream Поток сессии
+ */
+template <typename Stream>
+struct StreamHandshake {
+    static constexpr bool kRequired = false;  ///< Нужно ли рукопожатие
+};
+
+/**
+ * @brief HTTP сессия на корутинах C++20
+ *
+ * Класс BasicCoSession обслуживает то же HTTP API, что и Session
+ * (маршруты HttpRouter, keep-alive, конвейерные запросы, 400/431/503),
+ * но цикл запроса записан линейно на boost::asio::awaitable:
+ * чтение -> разбор -> обработка -> запись -> следующий запрос.
+ *
+ * Особенности:
+ * - Сессия удерживается параметром корутины, а не копией shared_ptr
+ *   в каждом обработчике, поэтому на переходах между операциями нет
+ *   атомарных инкрементов счетчика ссылок
+ * - Кадры корутин размещаются через потоковый кеш asio и переиспользуются
+ *   между запросами, отдельная память для обработчиков не нужна
+ * - Сроки чтения и записи отслеживает общее колесо DeadlineWheel:
+ *   установка срока - атомарная запись, без таймера и корутины-сторожа
+ * - Пишется поверх произвольного потока asio, поэтому тот же цикл
+ *   подходит для TLS и для протоколов с несколькими шагами (чат)
+ *
+ * Корутина выполняется на executor потока; сервер создает сокеты
+ * на strand, поэтому обработчики сессии не выполняются одновременно.
+ *
+ * @tparam Stream Поток asio с async_read_some/async_write_some и lowest_layer()
+ */
+template <typename Stream>
+class BasicCoSession : public ISession {
+   public:
+    static constexpr std::size_t kReadBufferSize = 8192;  ///< Размер буфера чтения
+
+    /**
+     * @brief Конструктор сессии
+     *
+     * @param stream Поток для коммуникации с клиентом
+     * @param db Сервис базы данных для получения информации о посещениях
+     */
+    BasicCoSession(Stream stream, std::shared_ptr<IDatabaseService> db)
+        : stream_(std::move(stream))
+        , db_(std::move(db))  // NOLINT(hicpp-move-const-arg, performance-move-const-arg)
+        , idle_timeout_(GetConfigSnapshot().keep_alive_timeout)
+        , write_timeout_(GetConfigSnapshot().write_timeout)
+        , max_requests_(GetConfigSnapshot().keep_alive_max_requests) {
+    }
+
+    /**
+     * @brief Деструктор - снимает сессию с учета активных
+     */
+    ~BasicCoSession() override {
+        if (active_) {
+            GetMetrics().Add(Gauge::kActiveSessions, -1);
+        }
+    }
+
+    BasicCoSession(const BasicCoSession&) = delete;             ///< Запрет копирования
+    BasicCoSession& operator=(const BasicCoSession&) = delete;  ///< Запрет присваивания
+    BasicCoSession(BasicCoSession&&) = delete;                  ///< Запрет перемещения
+    BasicCoSession& operator=(
+        BasicCoSession&&) = delete;  ///< Запрет перемещающего присваивания
+
+    /**
+     * @brief Запускает цикл обработки запросов
+     *
+     * Исключения, вылетевшие из цикла запросов, пробрасываются в поток,
+     * выполняющий io_context::run(), как и у обработчиков Session.
+     */
+    void Start() override {
+        active_ = true;
+        GetMetrics().Add(Gauge::kActiveSessions, 1);
+
+        auto self = std::static_pointer_cast<BasicCoSession>(shared_from_this());
+        boost::asio::co_spawn(
+            stream_.get_executor(), Run(std::move(self)), [](const std::exception_ptr& error) {
+                if (error) {
+                    std::rethrow_exception(error);
+                }
+            });
+    }
+
+   private:
+    using Status = HttpRequestParser::Status;
+
+    /**
+     * @brief Цикл обработки запросов соединения
+     *
+     * @param self Удерживает сессию, пока корутина выполняется
+     */
+    boost::asio::awaitable<void> Run([[maybe_unused]] std::shared_ptr<BasicCoSession> self) {
+        boost::system::error_code ec;
+        if constexpr (StreamHandshake<Stream>::kRequired) {
+            // Рукопожатие должно уложиться в срок ожидания первого запроса
+            ArmDeadline(stream_.get_executor(), idle_timeout_);
+            co_await StreamHandshake<Stream>::Async(
+                stream_, boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+            DisarmDeadline();
+            if (ec) {
+                co_return;
+            }
+            StreamHandshake<Stream>::Established(stream_);
+        }
+        for (;;) {
+            const Status status = co_await ReadRequest(ec);
+            if (ec) {
+                break;
+            }
+
+            switch (status) {
+                case Status::kComplete:
+                    HandleRequest(parser_.Request(BufferedData()));
+                    break;
+                case Status::kBadRequest:
+                    PrepareError(
+                        HttpResponseBuilder::kHeadBadRequest, HttpRouter::kBadRequestBody);
+                    break;
+                default:
+                    PrepareError(
+                        HttpResponseBuilder::kHeadHeadersTooLarge, HttpRouter::kTooLargeBody);
+                    break;
+            }
+
+            const auto write_start = std::chrono::steady_clock::now();
+            ArmDeadline(stream_.get_executor(), write_timeout_);
+            const std::size_t length = co_await boost::asio::async_write(
+                stream_, response_.Finish(),
+                boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+            DisarmDeadline();
+            GetMetrics().Observe(Histogram::kWrite, std::chrono::steady_clock::now() - write_start);
+            GetMetrics().Increment(Counter::kBytesSent, length);
+            if (ec) {
+                break;
+            }
+            LOG_TRACE << "Response sent";
+
+            if (!keep_alive_) {
+                if constexpr (StreamHandshake<Stream>::kRequired) {
+                    StreamHandshake<Stream>::Close(stream_);
+                }
+                boost::system::error_code ignored;
+                stream_.lowest_layer().shutdown(BoostTcp::socket::shutdown_send, ignored);
+                break;
+            }
+            ConsumeBuffered(parser_.Consumed());
+            parser_.Reset();
+        }
+    }
+
+    /**
+     * @brief Читает данные, пока в буфере не окажется полный запрос или ошибка
+     *
+     * Сначала пропускает остаток тела предыдущего запроса, затем продолжает
+     * разбор уже прочитанных байтов (в том числе конвейерных запросов) и
+     * только при нехватке данных читает из потока в свободную часть буфера.
+     *
+     * Срок чтения ставится один раз на запрос, как у Session: заголовки
+     * должны прийти целиком за KEEP_ALIVE_TIMEOUT_MS. После Shutdown()
+     * новый запрос не ожидается.
+     *
+     * @param ec Сюда записывается ошибка чтения
+     * @return Status Итог разбора (kIncomplete только вместе с ошибкой)
+     */
+    boost::asio::awaitable<Status> ReadRequest(boost::system::error_code& ec) {
+        for (;;) {
+            SkipBody();
+            if (body_to_skip_ == 0 && read_size_ > 0) {
+                if (!request_started_) {
+                    request_started_ = true;
+                    request_start_ = std::chrono::steady_clock::now();
+                }
+                const Status status = parser_.Parse(BufferedData());
+                if (status != Status::kIncomplete) {
+                    co_return status;
+                }
+                if (read_size_ == read_buffer_.size()) {
+                    co_return Status::kHeadersTooLarge;
+                }
+            }
+
+            idle_ = !request_started_ && body_to_skip_ == 0;
+            if (idle_ && draining_) {
+                ec = boost::asio::error::operation_aborted;
+                co_return Status::kIncomplete;
+            }
+            if (!request_started_) {
+                ArmDeadline(stream_.get_executor(), idle_timeout_);
+            }
+            const std::size_t size = co_await stream_.async_read_some(
+                boost::asio::buffer(
+                    read_buffer_.data() + read_size_, read_buffer_.size() - read_size_),
+                boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+            idle_ = false;
+            if (ec) {
+                co_return Status::kIncomplete;
+            }
+            GetMetrics().Increment(Counter::kBytesReceived, size);
+            read_size_ += size;
+        }
+    }
+
+    /**
+     * @brief Завершает сессию при остановке сервера
+     *
+     * Соединение, ожидающее нового запроса, закрывается сразу; начатый
+     * запрос получает ответ с "Connection: close".
+     *
+     * @param force Закрыть поток, не дожидаясь ответа
+     */
+    void Shutdown(bool force) override {
+        boost::asio::post(stream_.get_executor(), [self = shared_from_this(), this, force] {
+            draining_ = true;
+            if (force || idle_) {
+                boost::system::error_code ignored;
+                stream_.lowest_layer().close(ignored);
+            }
+        });
+    }
+
+    /**
+     * @brief Закрывает поток по истечении срока чтения или записи
+     *
+     * Вызывается из strand колеса сроков; закрытие выполняется на
+     * executor сессии и прерывает ожидающую операцию.
+     */
+    void OnDeadline() override {
+        boost::asio::post(stream_.get_executor(), [self = shared_from_this(), this] {
+            boost::system::error_code ignored;
+            stream_.lowest_layer().close(ignored);
+        });
+    }
+
+    /**
+     * @brief Обрабатывает полностью разобранные заголовки запроса
+     *
+     * @param request Запрос, ссылающийся на буфер чтения
+     */
+    void HandleRequest(const HttpRequest& request) {
+        DisarmDeadline();
+        GetMetrics().Observe(Histogram::kRead, std::chrono::steady_clock::now() - request_start_);
+        GetMetrics().Increment(Counter::kRequests);
+        request_started_ = false;
+
+        LOG_DEBUG << "Request: " << request.method << ' ' << request.target << ' '
+                  << request.version;
+
+        keep_alive_ = request.KeepAlive();
+        body_to_skip_ = request.ContentLength();
+
+        // Тело неизвестной длины не поддерживается, поэтому после ответа
+        // соединение закрывается, чтобы не принять тело за следующий запрос
+        ++requests_served_;
+        if (request.HasTransferEncoding() || requests_served_ >= max_requests_ || draining_) {
+            keep_alive_ = false;
+        }
+
+        router_.Route(request.Path(), request.Query(), *db_, response_);
+        response_.SetKeepAlive(keep_alive_);
+    }
+
+    /**
+     * @brief Готовит ответ об ошибке, после которого соединение закрывается
+     *
+     * @param head Начало ответа с нужным статусом
+     * @param body Тело ответа
+     */
+    void PrepareError(std::string_view head, std::string_view body) {
+        keep_alive_ = false;
+        response_.Start(head);
+        response_.AppendBody(body);
+        response_.SetKeepAlive(false);
+    }
+
+    /**
+     * @brief Прочитанные, но еще не обработанные байты
+     */
+    std::string_view BufferedData() const {
+        return {read_buffer_.data(), read_size_};
+    }
+
+    /**
+     * @brief Удаляет обработанные байты из начала буфера
+     *
+     * @param size Количество обработанных байтов
+     */
+    void ConsumeBuffered(std::size_t size) {
+        std::memmove(read_buffer_.data(), read_buffer_.data() + size, read_size_ - size);
+        read_size_ -= size;
+    }
+
+    /**
+     * @brief Пропускает уже прочитанную часть тела предыдущего запроса
+     */
+    void SkipBody() {
+        const auto size = static_cast<std::size_t>(
+            std::min<uint64_t>(body_to_skip_, static_cast<uint64_t>(read_size_)));
+        ConsumeBuffered(size);
+        body_to_skip_ -= size;
+    }
+
+    Stream stream_;                                        ///< Поток клиента
+    std::array<char, kReadBufferSize> read_buffer_;        ///< Буфер для чтения HTTP данных
+    std::size_t read_size_ = 0;                            ///< Количество байтов в буфере
+    uint64_t body_to_skip_ = 0;                            ///< Непрочитанный остаток тела запроса
+    HttpRequestParser parser_;                             ///< Разборщик текущего запроса
+    std::shared_ptr<IDatabaseService> db_;                 ///< Сервис базы данных
+    HttpResponseBuilder response_;                         ///< Построитель отправляемого ответа
+    HttpRouter router_;                                    ///< Маршрутизатор запросов
+    std::chrono::milliseconds idle_timeout_;               ///< Таймаут простоя соединения
+    std::chrono::milliseconds write_timeout_;              ///< Таймаут записи ответа
+    int max_requests_;                                     ///< Лимит запросов на соединение
+    int requests_served_ = 0;                              ///< Количество обработанных запросов
+    bool keep_alive_ = false;                              ///< Сохранять ли соединение после ответа
+    std::chrono::steady_clock::time_point request_start_;  ///< Начало чтения запроса
+    bool request_started_ = false;                         ///< Начато ли чтение текущего запроса
+    bool idle_ = false;                                    ///< Ждет ли сессия нового запроса
+    bool draining_ = false;                                ///< Сервер останавливается
+    bool active_ = false;                                  ///< Учтена ли сессия как активная
+};
+
+/// HTTP сессия на корутинах поверх TCP сокета
+using CoSession = BasicCoSession<BoostTcp::socket>;
+
+/**
+ * @brief Фабрика HTTP сессий на корутинах
+ *
+ * Создает CoSession для каждого принятого соединения.
+ */
+class CoSessionFactory : public ISessionFactory {
+   public:
+    /**
+     * @brief Создает новую HTTP сессию на корутинах
+     *
+     * @param socket TCP сокет клиентского соединения
+     * @param db_service Сервис базы данных для работы с посещениями
+     * @return std::shared_ptr<ISession> Умный указатель на созданную сессию
+     */
+    std::shared_ptr<ISession> Create(
+        BoostTcp::socket socket, std::shared_ptr<IDatabaseService> db_service) override {
+        return std::make_shared<CoSession>(std::move(socket), std::move(db_service));
+    }
+};
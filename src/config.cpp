@@ -31,4 +31,49 @@ const char* const ConfigManager::kDbConnString = "DB_CONN_STRING";
 // Имена параметров для системных настроек
 const char* const ConfigManager::kLogLevel = "LOG_LEVEL";
 const char* const ConfigManager::kConnectionPoolSize = "CONNECTION_POOL_SIZE";
+const char* const ConfigManager::kIoThreads = "IO_THREADS";
+const char* const ConfigManager::kVisitBatchSize = "VISIT_BATCH_SIZE";
+const char* const ConfigManager::kVisitFlushIntervalMs = "VISIT_FLUSH_INTERVAL_MS";
+const char* const ConfigManager::kVisitRetentionDays = "VISIT_RETENTION_DAYS";
+const char* const ConfigManager::kStorageBackend = "STORAGE_BACKEND";
+const char* const ConfigManager::kLogStoreDir = "LOG_STORE_DIR";
+const char* const ConfigManager::kLogStoreSegmentMb = "LOG_STORE_SEGMENT_MB";
+const char* const ConfigManager::kLogStoreFsyncIntervalMs = "LOG_STORE_FSYNC_INTERVAL_MS";
+const char* const ConfigManager::kKeepAliveTimeoutMs = "KEEP_ALIVE_TIMEOUT_MS";
+const char* const ConfigManager::kKeepAliveMaxRequests = "KEEP_ALIVE_MAX_REQUESTS";
+const char* const ConfigManager::kWriteTimeoutMs = "WRITE_TIMEOUT_MS";
+const char* const ConfigManager::kSessionPoolSize = "SESSION_POOL_SIZE";
+const char* const ConfigManager::kShutdownTimeoutMs = "SHUTDOWN_TIMEOUT_MS";
+const char* const ConfigManager::kSessionImpl = "SESSION_IMPL";
+const char* const ConfigManager::kChatServerPort = "CHAT_SERVER_PORT";
+const char* const ConfigManager::kChatMaxFrameSize = "CHAT_MAX_FRAME_SIZE";
+const char* const ConfigManager::kChatCompressionMinSize = "CHAT_COMPRESSION_MIN_SIZE";
+const char* const ConfigManager::kChatSendQueueBytes = "CHAT_SEND_QUEUE_BYTES";
+const char* const ConfigManager::kChatSlowConsumerPolicy = "CHAT_SLOW_CONSUMER_POLICY";
+const char* const ConfigManager::kChatIdleTimeoutMs = "CHAT_IDLE_TIMEOUT_MS";
+const char* const ConfigManager::kPeerTtlMs = "PEER_TTL_MS";
+const char* const ConfigManager::kPeerSnapshotIntervalMs = "PEER_SNAPSHOT_INTERVAL_MS";
+const char* const ConfigManager::kMessageBatchSize = "MESSAGE_BATCH_SIZE";
+const char* const ConfigManager::kMessageFlushIntervalMs = "MESSAGE_FLUSH_INTERVAL_MS";
+const char* const ConfigManager::kMessageCacheRooms = "MESSAGE_CACHE_ROOMS";
+const char* const ConfigManager::kMessageCacheSize = "MESSAGE_CACHE_SIZE";
+const char* const ConfigManager::kMaxSessions = "MAX_SESSIONS";
+const char* const ConfigManager::kIpConnectRate = "IP_CONNECT_RATE";
+const char* const ConfigManager::kIpConnectBurst = "IP_CONNECT_BURST";
+const char* const ConfigManager::kIpTableSize = "IP_TABLE_SIZE";
+const char* const ConfigManager::kAcceptBackoffMaxMs = "ACCEPT_BACKOFF_MAX_MS";
+const char* const ConfigManager::kTcpNoDelay = "TCP_NODELAY";
+const char* const ConfigManager::kTcpDeferAcceptS = "TCP_DEFER_ACCEPT_S";
+const char* const ConfigManager::kListenBacklog = "LISTEN_BACKLOG";
+const char* const ConfigManager::kSoReusePort = "SO_REUSEPORT";
+const char* const ConfigManager::kTlsServerPort = "TLS_SERVER_PORT";
+const char* const ConfigManager::kTlsCertFile = "TLS_CERT_FILE";
+const char* const ConfigManager::kTlsKeyFile = "TLS_KEY_FILE";
+const char* const ConfigManager::kTlsTicketKeyFile = "TLS_TICKET_KEY_FILE";
+const char* const ConfigManager::kTlsSessionTimeoutS = "TLS_SESSION_TIMEOUT_S";
+const char* const ConfigManager::kTlsKtls = "TLS_KTLS";
+const char* const ConfigManager::kDbAcquireTimeoutMs = "DB_ACQUIRE_TIMEOUT_MS";
+const char* const ConfigManager::kDbPoolMinSize = "DB_POOL_MIN_SIZE";
+const char* const ConfigManager::kDbPoolIdleTimeoutMs = "DB_POOL_IDLE_TIMEOUT_MS";
+const char* const ConfigManager::kDbReconnectBackoffMs = "DB_RECONNECT_BACKOFF_MS";
 const char* const ConfigManager::kConfigFilePath = "CONFIG_FILE_PATH";
@@ -1,13 +1,22 @@
 #pragma once
 #include <boost/program_options.hpp>
 
-#include <functional>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <memory>
-#include <regex>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
+
+struct ConfigSnapshot;
 
 /**
  * @brief Центральный менеджер конфигурации приложения
@@ -21,6 +30,11 @@
  * - Интерполяция значений с использованием синтаксиса ${variable}
  * - Типобезопасное получение значений
  * - Значения по умолчанию для отсутствующих параметров
+ *
+ * Геттеры ConfigManager возвращают значения, загруженные при запуске, и
+ * ищут их в variables_map при каждом вызове. Код, который читает
+ * настройки на пути обработки запросов или должен видеть перезагрузку
+ * конфигурации, использует GetConfigSnapshot().
  */
 class ConfigManager {
    public:
@@ -105,6 +119,7 @@ class ConfigManager {
     boost::program_options::options_description desc_{"Configuration"};  ///< Описание опций
     friend ConfigManager& GetConfig();
     friend void InitializeConfig(const std::string& config_file);
+    friend std::shared_ptr<const ConfigSnapshot> ReloadConfig(const std::string& config_file);
 
     /**
      * @brief Инициализирует менеджер конфигурации
@@ -131,7 +146,97 @@ class ConfigManager {
             "Complete database connection string")(
             "LOG_LEVEL", boost::program_options::value<std::string>(), "Logging level")(
             "CONNECTION_POOL_SIZE", boost::program_options::value<int>(),
-            "Size of the database connection pool")(
+            "Maximum size of the database connection pool")(
+            "DB_POOL_MIN_SIZE", boost::program_options::value<int>(),
+            "Database connections kept open even when idle")(
+            "DB_POOL_IDLE_TIMEOUT_MS", boost::program_options::value<int>(),
+            "Idle time after which connections above the minimum are closed")(
+            "DB_RECONNECT_BACKOFF_MS", boost::program_options::value<int>(),
+            "Maximum delay between database reconnect attempts")(
+            "IO_THREADS", boost::program_options::value<int>(),
+            "Number of threads running the io_context (0 = hardware concurrency)")(
+            "VISIT_BATCH_SIZE", boost::program_options::value<int>(),
+            "Number of buffered visits that triggers a flush to the database")(
+            "VISIT_FLUSH_INTERVAL_MS", boost::program_options::value<int>(),
+            "Maximum time in milliseconds a visit stays buffered before a flush")(
+            "VISIT_RETENTION_DAYS", boost::program_options::value<int>(),
+            "Days raw visits are kept before their partitions are dropped (0 = forever)")(
+            "STORAGE_BACKEND", boost::program_options::value<std::string>(),
+            "Storage backend: postgres, memory or log")(
+            "LOG_STORE_DIR", boost::program_options::value<std::string>(),
+            "Directory of the log storage backend segments")(
+            "LOG_STORE_SEGMENT_MB", boost::program_options::value<int>(),
+            "Size in megabytes of one log storage segment")(
+            "LOG_STORE_FSYNC_INTERVAL_MS", boost::program_options::value<int>(),
+            "Interval in milliseconds between log storage syncs (0 = every write)")(
+            "KEEP_ALIVE_TIMEOUT_MS", boost::program_options::value<int>(),
+            "Idle timeout in milliseconds for persistent HTTP connections")(
+            "KEEP_ALIVE_MAX_REQUESTS", boost::program_options::value<int>(),
+            "Maximum number of requests served over one persistent connection")(
+            "WRITE_TIMEOUT_MS", boost::program_options::value<int>(),
+            "Maximum time in milliseconds a client may take to accept one response")(
+            "SESSION_POOL_SIZE", boost::program_options::value<int>(),
+            "Maximum number of idle sessions kept for reuse")(
+            "SHUTDOWN_TIMEOUT_MS", boost::program_options::value<int>(),
+            "Time in milliseconds open connections may drain after SIGINT or SIGTERM")(
+            "SESSION_IMPL", boost::program_options::value<std::string>(),
+            "HTTP session implementation: callback or coroutine")(
+            "CHAT_SERVER_PORT", boost::program_options::value<int>(),
+            "Port of the binary chat protocol listener (0 = disabled)")(
+            "CHAT_MAX_FRAME_SIZE", boost::program_options::value<int>(),
+            "Maximum payload size of a chat protocol frame in bytes")(
+            "CHAT_COMPRESSION_MIN_SIZE", boost::program_options::value<int>(),
+            "Minimum chat frame payload compressed with zlib (0 = no compression)")(
+            "CHAT_SEND_QUEUE_BYTES", boost::program_options::value<int>(),
+            "Maximum bytes of room frames queued for one chat connection")(
+            "CHAT_SLOW_CONSUMER_POLICY", boost::program_options::value<std::string>(),
+            "Action when a chat send queue overflows: disconnect or drop")(
+            "CHAT_IDLE_TIMEOUT_MS", boost::program_options::value<int>(),
+            "Time in milliseconds a chat connection may stay silent (0 = no limit)")(
+            "PEER_TTL_MS", boost::program_options::value<int>(),
+            "Lifetime of a peer registration without a heartbeat in milliseconds")(
+            "PEER_SNAPSHOT_INTERVAL_MS", boost::program_options::value<int>(),
+            "Interval between write-behind snapshots of the peer registry")(
+            "MESSAGE_BATCH_SIZE", boost::program_options::value<int>(),
+            "Number of buffered chat messages that triggers a COPY to the database")(
+            "MESSAGE_FLUSH_INTERVAL_MS", boost::program_options::value<int>(),
+            "Maximum time in milliseconds a chat message stays buffered before a flush")(
+            "MESSAGE_CACHE_ROOMS", boost::program_options::value<int>(),
+            "Number of rooms whose recent messages are cached (0 = no cache)")(
+            "MESSAGE_CACHE_SIZE", boost::program_options::value<int>(),
+            "Number of recent messages cached per room")(
+            "MAX_SESSIONS", boost::program_options::value<int>(),
+            "Maximum concurrent sessions per listener (0 = unlimited)")(
+            "IP_CONNECT_RATE", boost::program_options::value<int>(),
+            "Connections per second allowed from one address (0 = unlimited)")(
+            "IP_CONNECT_BURST", boost::program_options::value<int>(),
+            "Connections one address may open back to back")(
+            "IP_TABLE_SIZE", boost::program_options::value<int>(),
+            "Number of per-address rate limit buckets")(
+            "ACCEPT_BACKOFF_MAX_MS", boost::program_options::value<int>(),
+            "Maximum pause before retrying accept after running out of descriptors")(
+            "TCP_NODELAY", boost::program_options::value<int>(),
+            "Disable Nagle's algorithm on accepted connections (1 = on, 0 = off)")(
+            "TCP_DEFER_ACCEPT_S", boost::program_options::value<int>(),
+            "Seconds the kernel holds a connection until its first data (0 = off)")(
+            "LISTEN_BACKLOG", boost::program_options::value<int>(),
+            "Length of the listen() queue of pending connections (0 = SOMAXCONN)")(
+            "SO_REUSEPORT", boost::program_options::value<int>(),
+            "Let several processes listen on the same port (1 = on, 0 = off)")(
+            "TLS_SERVER_PORT", boost::program_options::value<int>(),
+            "Port of the HTTPS listener (0 = disabled)")(
+            "TLS_CERT_FILE", boost::program_options::value<std::string>(),
+            "PEM certificate chain of the HTTPS listener")(
+            "TLS_KEY_FILE", boost::program_options::value<std::string>(),
+            "PEM private key of the HTTPS listener")(
+            "TLS_TICKET_KEY_FILE", boost::program_options::value<std::string>(),
+            "File with 80 bytes of session ticket keys shared between processes")(
+            "TLS_SESSION_TIMEOUT_S", boost::program_options::value<int>(),
+            "Lifetime of TLS session tickets in seconds")(
+            "TLS_KTLS", boost::program_options::value<int>(),
+            "Offload TLS record encryption to the kernel when supported (1 = on, 0 = off)")(
+            "DB_ACQUIRE_TIMEOUT_MS", boost::program_options::value<int>(),
+            "Maximum time to wait for a free database connection in milliseconds")(
             "CONFIG_FILE_PATH", boost::program_options::value<std::string>(),
             "Path to the configuration file");
         LoadConfig(config_file);
@@ -277,7 +382,27 @@ class ConfigManager {
      * @return true если параметр должен быть числовым, false иначе
      */
     [[nodiscard]] static bool IsKnownIntOption(const std::string& name) {
-        return name == "CENTRAL_SERVER_PORT" || name == "DB_PORT" || name == "CONNECTION_POOL_SIZE";
+        return name == "CENTRAL_SERVER_PORT" || name == "DB_PORT" || name == "CONNECTION_POOL_SIZE" ||
+               name == "IO_THREADS" || name == "VISIT_BATCH_SIZE" ||
+               name == "VISIT_FLUSH_INTERVAL_MS" || name == "VISIT_RETENTION_DAYS" ||
+               name == "LOG_STORE_SEGMENT_MB" || name == "LOG_STORE_FSYNC_INTERVAL_MS" ||
+               name == "KEEP_ALIVE_TIMEOUT_MS" ||
+               name == "KEEP_ALIVE_MAX_REQUESTS" || name == "SESSION_POOL_SIZE" ||
+               name == "DB_ACQUIRE_TIMEOUT_MS" || name == "DB_POOL_MIN_SIZE" ||
+               name == "DB_POOL_IDLE_TIMEOUT_MS" || name == "DB_RECONNECT_BACKOFF_MS" ||
+               name == "CHAT_SERVER_PORT" || name == "CHAT_MAX_FRAME_SIZE" ||
+               name == "CHAT_COMPRESSION_MIN_SIZE" || name == "CHAT_SEND_QUEUE_BYTES" ||
+               name == "PEER_TTL_MS" || name == "PEER_SNAPSHOT_INTERVAL_MS" ||
+               name == "MESSAGE_BATCH_SIZE" || name == "MESSAGE_FLUSH_INTERVAL_MS" ||
+               name == "MESSAGE_CACHE_ROOMS" || name == "MESSAGE_CACHE_SIZE" ||
+               name == "MAX_SESSIONS" || name == "IP_CONNECT_RATE" ||
+               name == "IP_CONNECT_BURST" || name == "IP_TABLE_SIZE" ||
+               name == "ACCEPT_BACKOFF_MAX_MS" || name == "WRITE_TIMEOUT_MS" ||
+               name == "CHAT_IDLE_TIMEOUT_MS" || name == "SHUTDOWN_TIMEOUT_MS" ||
+               name == "TCP_NODELAY" || name == "TCP_DEFER_ACCEPT_S" ||
+               name == "LISTEN_BACKLOG" || name == "SO_REUSEPORT" ||
+               name == "TLS_SERVER_PORT" || name == "TLS_SESSION_TIMEOUT_S" ||
+               name == "TLS_KTLS";
     }
 
     /**
@@ -355,11 +480,21 @@ class ConfigManager {
         return map_file;
     }
 
+   public:
     /**
      * @brief Разрешает вложенные ссылки на переменные (интерполяция)
      *
      * Объединяет значения из окружения и файла, затем разрешает ссылки
-     * в формате ${variable_name}. Обнаруживает и предотвращает циклические зависимости.
+     * в формате ${variable_name}:
+     * - Каждое значение один раз разбивается на литералы и ссылки, без regex
+     * - Параметры разрешаются в топологическом порядке графа ссылок
+     *   (итеративный обход в глубину), поэтому каждое значение собирается
+     *   ровно один раз из уже разрешенных зависимостей
+     * - Ссылка на неизвестный параметр остается в значении как есть
+     * - Параметры, входящие в цикл, сохраняют исходные значения, а цикл
+     *   выводится в stderr
+     *
+     * Время работы линейно по суммарной длине исходных и итоговых значений.
      *
      * @param map_env Карта значений из переменных окружения
      * @param map_file Карта значений из файла конфигурации
@@ -374,77 +509,267 @@ class ConfigManager {
             map_full[name] = value;
         }
 
-        std::unordered_map<std::string, std::string> map_resolved;
-        std::unordered_set<std::string> processing;  // Для обнаружения циклических зависимостей
-
-        // Рекурсивная функция для разрешения ссылок на переменные
-        std::function<std::string(const std::string&, const std::string&)> resolve =
-            [&](const std::string& key, const std::string& value) -> std::string {
-            // Проверяем циклические зависимости
-            if (processing.contains(key)) {
-                std::cerr << "Circular dependency detected for " << key << '\n';
-                return value;
-            }
+        // Узлы графа: параметры в порядке обхода карты
+        std::vector<const std::string*> names;
+        std::vector<const std::string*> values;
+        std::unordered_map<std::string_view, std::size_t> index;
+        names.reserve(map_full.size());
+        values.reserve(map_full.size());
+        index.reserve(map_full.size());
+        for (const auto& [name, value] : map_full) {
+            index.emplace(name, names.size());
+            names.push_back(&name);
+            values.push_back(&value);
+        }
 
-            // Если уже разрешено, возвращаем кешированный результат
-            if (map_resolved.contains(key)) {
-                return map_resolved[key];
-            }
+        // Разбиваем значения на фрагменты: литерал или ссылка на узел
+        std::vector<std::vector<InterpolationToken>> tokens(names.size());
+        for (std::size_t i = 0; i < names.size(); ++i) {
+            tokens[i] = Tokenize(*values[i], index);
+        }
 
-            processing.insert(key);
+        enum class Mark : uint8_t { kNew, kActive, kDone };
+        std::vector<Mark> marks(names.size(), Mark::kNew);
+        std::vector<bool> cyclic(names.size(), false);
+        std::vector<std::string> resolved(names.size());
+        // Стек обхода: узел и номер следующего фрагмента
+        std::vector<std::pair<std::size_t, std::size_t>> stack;
 
-            std::string result = value;
-            const std::regex pattern(R"(\$\{([^}]+)\})");  // Паттерн ${variable}
-            std::smatch match;
+        for (std::size_t root = 0; root < names.size(); ++root) {
+            if (marks[root] != Mark::kNew) {
+                continue;
+            }
+            marks[root] = Mark::kActive;
+            stack.emplace_back(root, 0);
+            while (!stack.empty()) {
+                const std::size_t node = stack.back().first;
+                std::size_t& next = stack.back().second;
+                const auto& parts = tokens[node];
+                while (next < parts.size() && (parts[next].ref == InterpolationToken::kLiteral ||
+                                               marks[parts[next].ref] == Mark::kDone)) {
+                    ++next;
+                }
 
-            // Ищем и заменяем все вхождения ${variable}
-            while (std::regex_search(result, match, pattern)) {
-                const std::string placeholder = match[1].str();
-                std::string replacement;
+                if (next < parts.size()) {
+                    const std::size_t dep = parts[next++].ref;
+                    if (marks[dep] == Mark::kNew) {
+                        marks[dep] = Mark::kActive;
+                        stack.emplace_back(dep, 0);
+                    } else {
+                        // Обратное ребро: все узлы стека от dep до вершины образуют цикл
+                        for (auto it = stack.rbegin(); it != stack.rend(); ++it) {
+                            cyclic[it->first] = true;
+                            if (it->first == dep) {
+                                break;
+                            }
+                        }
+                    }
+                    continue;
+                }
 
-                if (map_full.contains(placeholder)) {
-                    replacement = resolve(placeholder, map_full[placeholder]);
+                // Все зависимости разрешены: собираем значение один раз
+                if (cyclic[node]) {
+                    std::cerr << "Circular dependency detected for " << *names[node] << '\n';
+                    resolved[node] = *values[node];
                 } else {
-                    // Если переменная не найдена, оставляем как есть
-                    replacement = match[0].str();
+                    std::size_t size = 0;
+                    for (const auto& part : parts) {
+                        size += part.ref == InterpolationToken::kLiteral ? part.text.size()
+                                                                        : resolved[part.ref].size();
+                    }
+                    std::string& result = resolved[node];
+                    result.reserve(size);
+                    for (const auto& part : parts) {
+                        if (part.ref == InterpolationToken::kLiteral) {
+                            result.append(part.text);
+                        } else {
+                            result.append(resolved[part.ref]);
+                        }
+                    }
                 }
-
-                result.replace(match.position(), match.length(), replacement);
+                marks[node] = Mark::kDone;
+                stack.pop_back();
             }
-
-            processing.erase(key);
-            map_resolved[key] = result;
-            return result;
-        };
-
-        // Разрешаем все переменные
-        for (const auto& [name, value] : map_full) {
-            resolve(name, value);
         }
 
+        std::unordered_map<std::string, std::string> map_resolved;
+        map_resolved.reserve(names.size());
+        for (std::size_t i = 0; i < names.size(); ++i) {
+            map_resolved.emplace(*names[i], std::move(resolved[i]));
+        }
         return map_resolved;
     }
 
+   private:
+    /**
+     * @brief Фрагмент значения при интерполяции
+     */
+    struct InterpolationToken {
+        /// Значение ref для литерального фрагмента
+        static constexpr std::size_t kLiteral = static_cast<std::size_t>(-1);
+
+        std::string_view text;       ///< Текст литерала (указывает в исходное значение)
+        std::size_t ref = kLiteral;  ///< Индекс параметра, на который ссылается фрагмент
+    };
+
+    /**
+     * @brief Разбивает значение на литералы и ссылки ${name} за один проход
+     *
+     * Ссылки на неизвестные параметры, пустые ${} и незакрытые ${
+     * становятся частью литерала.
+     *
+     * @param value Исходное значение
+     * @param index Индексы известных параметров
+     * @return std::vector<InterpolationToken> Фрагменты значения
+     */
+    static std::vector<InterpolationToken> Tokenize(
+        std::string_view value, const std::unordered_map<std::string_view, std::size_t>& index) {
+        std::vector<InterpolationToken> parts;
+        std::size_t literal_start = 0;
+        std::size_t pos = 0;
+        while ((pos = value.find("${", pos)) != std::string_view::npos) {
+            const std::size_t close = value.find('}', pos + 2);
+            if (close == std::string_view::npos) {
+                break;
+            }
+            const auto it = index.find(value.substr(pos + 2, close - pos - 2));
+            if (close == pos + 2 || it == index.end()) {
+                pos = close + 1;
+                continue;
+            }
+            if (pos > literal_start) {
+                parts.push_back({value.substr(literal_start, pos - literal_start)});
+            }
+            parts.push_back({{}, it->second});
+            pos = close + 1;
+            literal_start = pos;
+        }
+        if (literal_start < value.size()) {
+            parts.push_back({value.substr(literal_start)});
+        }
+        return parts;
+    }
+
    public:
+
     // Константы для имен конфигурационных параметров
-    static const char* const kCentralServerHost;     ///< Имя параметра хоста центрального сервера
-    static const char* const kCentralServerPort;     ///< Имя параметра порта центрального сервера
-    static const char* const kCentralServerAddress;  ///< Имя параметра полного адреса сервера
-    static const char* const kDbHost;                ///< Имя параметра хоста базы данных
-    static const char* const kDbUser;                ///< Имя параметра пользователя БД
-    static const char* const kDbPassword;            ///< Имя параметра пароля БД
-    static const char* const kDbName;                ///< Имя параметра имени БД
-    static const char* const kDbPort;                ///< Имя параметра порта БД
-    static const char* const kDbConnString;          ///< Имя параметра строки подключения к БД
-    static const char* const kLogLevel;              ///< Имя параметра уровня логирования
-    static const char* const kConnectionPoolSize;    ///< Имя параметра размера пула соединений
-    static const char* const kConfigFilePath;        ///< Имя параметра пути к файлу конфигурации
+    static const char* const kCentralServerHost;       ///< Имя параметра хоста центрального сервера
+    static const char* const kCentralServerPort;       ///< Имя параметра порта центрального сервера
+    static const char* const kCentralServerAddress;    ///< Имя параметра полного адреса сервера
+    static const char* const kDbHost;                  ///< Имя параметра хоста базы данных
+    static const char* const kDbUser;                  ///< Имя параметра пользователя БД
+    static const char* const kDbPassword;              ///< Имя параметра пароля БД
+    static const char* const kDbName;                  ///< Имя параметра имени БД
+    static const char* const kDbPort;                  ///< Имя параметра порта БД
+    static const char* const kDbConnString;            ///< Имя параметра строки подключения к БД
+    static const char* const kLogLevel;                ///< Имя параметра уровня логирования
+    static const char* const kConnectionPoolSize;      ///< Имя параметра размера пула соединений
+    static const char* const kIoThreads;               ///< Имя параметра числа потоков io_context
+    static const char* const kVisitBatchSize;          ///< Имя параметра размера пакета посещений
+    static const char* const kVisitFlushIntervalMs;    ///< Имя параметра интервала сброса посещений
+    static const char* const kVisitRetentionDays;      ///< Имя параметра срока хранения посещений
+    static const char* const kStorageBackend;          ///< Имя параметра хранилища
+    static const char* const kLogStoreDir;             ///< Имя параметра каталога журнала
+    static const char* const kLogStoreSegmentMb;       ///< Имя параметра размера сегмента журнала
+    static const char* const kLogStoreFsyncIntervalMs; ///< Имя параметра интервала сброса журнала
+    static const char* const kKeepAliveTimeoutMs;      ///< Имя параметра таймаута keep-alive
+    static const char* const kKeepAliveMaxRequests;    ///< Имя параметра лимита запросов keep-alive
+    static const char* const kWriteTimeoutMs;          ///< Имя параметра таймаута записи ответа
+    static const char* const kSessionPoolSize;         ///< Имя параметра размера пула сессий
+    static const char* const kShutdownTimeoutMs;       ///< Имя параметра срока остановки
+    static const char* const kSessionImpl;             ///< Имя параметра реализации сессий
+    static const char* const kChatServerPort;          ///< Имя параметра порта сервера чата
+    static const char* const kChatMaxFrameSize;        ///< Имя параметра размера кадра чата
+    static const char* const kChatCompressionMinSize;  ///< Имя параметра порога сжатия чата
+    static const char* const kChatSendQueueBytes;      ///< Имя параметра лимита очереди чата
+    static const char* const kChatSlowConsumerPolicy;  ///< Имя параметра политики очереди чата
+    static const char* const kChatIdleTimeoutMs;       ///< Имя параметра таймаута простоя чата
+    static const char* const kPeerTtlMs;               ///< Имя параметра срока регистрации пира
+    static const char* const kPeerSnapshotIntervalMs;  ///< Имя параметра интервала снимков пиров
+    static const char* const kMessageBatchSize;        ///< Имя параметра пакета сообщений
+    static const char* const kMessageFlushIntervalMs;  ///< Имя параметра интервала записи сообщений
+    static const char* const kMessageCacheRooms;       ///< Имя параметра числа комнат в кеше
+    static const char* const kMessageCacheSize;        ///< Имя параметра сообщений комнаты в кеше
+    static const char* const kMaxSessions;             ///< Имя параметра лимита сессий
+    static const char* const kIpConnectRate;           ///< Имя параметра частоты подключений адреса
+    static const char* const kIpConnectBurst;          ///< Имя параметра подключений адреса подряд
+    static const char* const kIpTableSize;             ///< Имя параметра размера таблицы адресов
+    static const char* const kAcceptBackoffMaxMs;      ///< Имя параметра паузы приема соединений
+    static const char* const kTcpNoDelay;              ///< Имя параметра TCP_NODELAY соединений
+    static const char* const kTcpDeferAcceptS;         ///< Имя параметра TCP_DEFER_ACCEPT слушателя
+    static const char* const kListenBacklog;           ///< Имя параметра очереди listen()
+    static const char* const kSoReusePort;             ///< Имя параметра SO_REUSEPORT слушателя
+    static const char* const kTlsServerPort;           ///< Имя параметра порта HTTPS
+    static const char* const kTlsCertFile;             ///< Имя параметра файла сертификата
+    static const char* const kTlsKeyFile;              ///< Имя параметра файла закрытого ключа
+    static const char* const kTlsTicketKeyFile;        ///< Имя параметра файла ключей билетов
+    static const char* const kTlsSessionTimeoutS;      ///< Имя параметра срока билетов сессий
+    static const char* const kTlsKtls;                 ///< Имя параметра шифрования в ядре
+    static const char* const kDbAcquireTimeoutMs;      ///< Имя параметра ожидания соединения БД
+    static const char* const kDbPoolMinSize;           ///< Имя параметра минимума пула соединений
+    static const char* const kDbPoolIdleTimeoutMs;     ///< Имя параметра простоя соединения пула
+    static const char* const kDbReconnectBackoffMs;    ///< Имя параметра паузы переподключения
+    static const char* const kConfigFilePath;          ///< Имя параметра пути к файлу конфигурации
 
     // Значения по умолчанию
     static constexpr int kDefaultCentralServerPort = 8000;  ///< Порт сервера по умолчанию
     static constexpr int kDefaultConnectionPoolSize = 10;   ///< Размер пула соединений по умолчанию
     static constexpr int kDefaultDbPort = 5432;             ///< Порт PostgreSQL по умолчанию
 
+    // Значения по умолчанию для параметров производительности
+    static constexpr int kDefaultIoThreads = 0;                ///< Потоки io_context (0 = по ядрам)
+    static constexpr int kDefaultVisitBatchSize = 256;         ///< Размер пакета посещений
+    static constexpr int kDefaultVisitFlushIntervalMs = 100;   ///< Интервал сброса посещений (мс)
+    static constexpr int kDefaultVisitRetentionDays = 0;       ///< Посещения хранятся бессрочно
+    static constexpr int kDefaultLogStoreSegmentMb = 64;        ///< Сегмент журнала 64 МБ
+    static constexpr int kDefaultLogStoreFsyncIntervalMs = 1000;  ///< Сброс журнала раз в секунду
+    static constexpr int kDefaultKeepAliveTimeoutMs = 5000;    ///< Таймаут простоя keep-alive (мс)
+    static constexpr int kDefaultKeepAliveMaxRequests = 1000;  ///< Запросов на одно соединение
+    static constexpr int kDefaultWriteTimeoutMs = 10000;       ///< Таймаут записи ответа (мс)
+    static constexpr int kDefaultSessionPoolSize = 256;        ///< Свободных сессий в пуле
+    static constexpr int kDefaultShutdownTimeoutMs = 10000;    ///< Срок завершения соединений (мс)
+
+    // Значения по умолчанию для пула соединений к БД
+    static constexpr int kDefaultDbAcquireTimeoutMs = 250;      ///< Ожидание соединения БД (мс)
+    static constexpr int kDefaultDbPoolMinSize = 1;             ///< Минимум соединений пула
+    static constexpr int kDefaultDbPoolIdleTimeoutMs = 60000;   ///< Простой соединения пула (мс)
+    static constexpr int kDefaultDbReconnectBackoffMs = 10000;  ///< Пауза переподключения (мс)
+
+    // Значения по умолчанию для протокола чата
+    static constexpr int kDefaultChatServerPort = 8001;         ///< Порт сервера чата
+    static constexpr int kDefaultChatMaxFrameSize = 65536;      ///< Нагрузка кадра чата (байт)
+    static constexpr int kDefaultChatCompressionMinSize = 512;  ///< Порог сжатия кадра (байт)
+    static constexpr int kDefaultChatSendQueueBytes = 1 << 20;  ///< Очередь отправки (байт)
+    static constexpr int kDefaultChatIdleTimeoutMs = 300000;    ///< Простой соединения чата (мс)
+
+    // Значения по умолчанию для реестра пиров
+    static constexpr int kDefaultPeerTtlMs = 30000;              ///< Срок регистрации пира (мс)
+    static constexpr int kDefaultPeerSnapshotIntervalMs = 5000;  ///< Интервал снимков (мс)
+
+    // Значения по умолчанию для хранилища сообщений
+    static constexpr int kDefaultMessageBatchSize = 256;        ///< Размер пакета сообщений
+    static constexpr int kDefaultMessageFlushIntervalMs = 100;  ///< Интервал записи (мс)
+    static constexpr int kDefaultMessageCacheRooms = 1024;      ///< Комнат в кеше истории
+    static constexpr int kDefaultMessageCacheSize = 50;         ///< Сообщений комнаты в кеше
+
+    // Значения по умолчанию для контроля допуска соединений
+    static constexpr int kDefaultMaxSessions = 10000;        ///< Одновременных сессий слушателя
+    static constexpr int kDefaultIpConnectRate = 0;          ///< Подключений адреса в секунду
+    static constexpr int kDefaultIpConnectBurst = 50;        ///< Подключений адреса подряд
+    static constexpr int kDefaultIpTableSize = 4096;         ///< Корзин в таблице адресов
+    static constexpr int kDefaultAcceptBackoffMaxMs = 1000;  ///< Максимальная пауза приема (мс)
+
+    // Значения по умолчанию для настройки сокетов
+    static constexpr int kDefaultTcpNoDelay = 1;       ///< TCP_NODELAY включен
+    static constexpr int kDefaultTcpDeferAcceptS = 0;  ///< TCP_DEFER_ACCEPT выключен
+    static constexpr int kDefaultListenBacklog = 0;    ///< Очередь listen() (0 = SOMAXCONN)
+    static constexpr int kDefaultSoReusePort = 0;      ///< SO_REUSEPORT выключен
+
+    // Значения по умолчанию для TLS
+    static constexpr int kDefaultTlsServerPort = 0;          ///< Слушатель HTTPS выключен
+    static constexpr int kDefaultTlsSessionTimeoutS = 7200;  ///< Срок билета сессии (с)
+    static constexpr int kDefaultTlsKtls = 1;                ///< Шифрование в ядре включено
+
     /**
      * @brief Получает порт центрального сервера
      *
@@ -550,7 +875,9 @@ class ConfigManager {
     }
 
     /**
-     * @brief Получает размер пула соединений к базе данных
+     * @brief Получает максимальный размер пула соединений к базе данных
+     *
+     * Соединения открываются по мере необходимости, но не больше этого числа.
      *
      * @return int Размер пула соединений или 10 по умолчанию
      */
@@ -558,6 +885,481 @@ class ConfigManager {
         return GetInt("CONNECTION_POOL_SIZE", kDefaultConnectionPoolSize);
     }
 
+    /**
+     * @brief Получает количество потоков, обслуживающих io_context
+     *
+     * Значение 0 (или отрицательное) означает использование всех доступных
+     * аппаратных потоков (std::thread::hardware_concurrency()).
+     *
+     * @return int Количество рабочих потоков (не меньше 1)
+     */
+    [[nodiscard]] int GetIoThreads() const {
+        const int threads = GetInt("IO_THREADS", kDefaultIoThreads);
+        if (threads > 0) {
+            return threads;
+        }
+        const unsigned hardware = std::thread::hardware_concurrency();
+        return hardware > 0 ? static_cast<int>(hardware) : 1;
+    }
+
+    /**
+     * @brief Получает размер пакета посещений для отложенной записи
+     *
+     * @return int Количество посещений, при накоплении которого пакет сбрасывается в БД
+     */
+    [[nodiscard]] int GetVisitBatchSize() const {
+        return GetInt("VISIT_BATCH_SIZE", kDefaultVisitBatchSize);
+    }
+
+    /**
+     * @brief Получает максимальный интервал между сбросами посещений
+     *
+     * @return int Интервал в миллисекундах или 100 по умолчанию
+     */
+    [[nodiscard]] int GetVisitFlushIntervalMs() const {
+        return GetInt("VISIT_FLUSH_INTERVAL_MS", kDefaultVisitFlushIntervalMs);
+    }
+
+    /**
+     * @brief Получает срок хранения сырых посещений
+     *
+     * Месячные разделы таблицы visits, целиком старше срока, удаляются.
+     * Агрегаты по минутам хранятся бессрочно.
+     *
+     * @return int Срок в днях или 0 по умолчанию (хранить бессрочно)
+     */
+    [[nodiscard]] int GetVisitRetentionDays() const {
+        return GetInt("VISIT_RETENTION_DAYS", kDefaultVisitRetentionDays);
+    }
+
+    /**
+     * @brief Получает хранилище данных сервера
+     *
+     * @return std::string "postgres" (по умолчанию), "memory" или "log"
+     */
+    [[nodiscard]] std::string GetStorageBackend() const {
+        return GetString("STORAGE_BACKEND", "postgres");
+    }
+
+    /**
+     * @brief Получает каталог сегментов журнального хранилища
+     *
+     * @return std::string Каталог или "data" по умолчанию
+     */
+    [[nodiscard]] std::string GetLogStoreDir() const {
+        return GetString("LOG_STORE_DIR", "data");
+    }
+
+    /**
+     * @brief Получает размер сегмента журнального хранилища
+     *
+     * @return int Размер в мегабайтах или 64 по умолчанию
+     */
+    [[nodiscard]] int GetLogStoreSegmentMb() const {
+        return GetInt("LOG_STORE_SEGMENT_MB", kDefaultLogStoreSegmentMb);
+    }
+
+    /**
+     * @brief Получает интервал сброса журнального хранилища на диск
+     *
+     * При сбое теряются записи не старше интервала.
+     *
+     * @return int Интервал в миллисекундах (0 - сброс каждой записи) или 1000 по умолчанию
+     */
+    [[nodiscard]] int GetLogStoreFsyncIntervalMs() const {
+        return GetInt("LOG_STORE_FSYNC_INTERVAL_MS", kDefaultLogStoreFsyncIntervalMs);
+    }
+
+    /**
+     * @brief Получает таймаут простоя постоянного HTTP соединения
+     *
+     * @return int Таймаут в миллисекундах или 5000 по умолчанию
+     */
+    [[nodiscard]] int GetKeepAliveTimeoutMs() const {
+        return GetInt("KEEP_ALIVE_TIMEOUT_MS", kDefaultKeepAliveTimeoutMs);
+    }
+
+    /**
+     * @brief Получает максимальное число запросов на одно постоянное соединение
+     *
+     * @return int Лимит запросов или 1000 по умолчанию
+     */
+    [[nodiscard]] int GetKeepAliveMaxRequests() const {
+        return GetInt("KEEP_ALIVE_MAX_REQUESTS", kDefaultKeepAliveMaxRequests);
+    }
+
+    /**
+     * @brief Получает срок, за который клиент должен принять один ответ
+     *
+     * Клиент, который не читает ответ, не удерживает соединение и буфер
+     * ответа дольше этого срока.
+     *
+     * @return int Таймаут в миллисекундах или 10000 по умолчанию
+     */
+    [[nodiscard]] int GetWriteTimeoutMs() const {
+        return GetInt("WRITE_TIMEOUT_MS", kDefaultWriteTimeoutMs);
+    }
+
+    /**
+     * @brief Получает максимальное количество свободных сессий в пуле
+     *
+     * @return int Размер пула сессий или 256 по умолчанию
+     */
+    [[nodiscard]] int GetSessionPoolSize() const {
+        return GetInt("SESSION_POOL_SIZE", kDefaultSessionPoolSize);
+    }
+
+    /**
+     * @brief Получает срок завершения открытых соединений при остановке
+     *
+     * После SIGINT/SIGTERM сервер перестает принимать соединения и ждет,
+     * пока открытые сессии дообслужат начатые запросы; по истечении срока
+     * оставшиеся соединения закрываются принудительно.
+     *
+     * @return int Срок в миллисекундах или 10000 по умолчанию
+     */
+    [[nodiscard]] int GetShutdownTimeoutMs() const {
+        return GetInt("SHUTDOWN_TIMEOUT_MS", kDefaultShutdownTimeoutMs);
+    }
+
+    /**
+     * @brief Получает реализацию HTTP сессий
+     *
+     * "callback" - Session на обработчиках asio с пулом сессий,
+     * "coroutine" - CoSession на корутинах C++20.
+     *
+     * @return std::string Имя реализации или "callback" по умолчанию
+     */
+    [[nodiscard]] std::string GetSessionImpl() const {
+        return GetString("SESSION_IMPL", "callback");
+    }
+
+    /**
+     * @brief Получает порт слушателя бинарного протокола чата
+     *
+     * @return int Порт сервера чата, 8001 по умолчанию (0 - слушатель отключен)
+     */
+    [[nodiscard]] int GetChatServerPort() const {
+        return GetInt("CHAT_SERVER_PORT", kDefaultChatServerPort);
+    }
+
+    /**
+     * @brief Получает максимальную длину нагрузки кадра чата
+     *
+     * Кадр длиннее этого значения считается ошибкой протокола. Буфер чтения
+     * каждой сессии чата вмещает один кадр максимального размера.
+     *
+     * @return int Размер в байтах или 65536 по умолчанию
+     */
+    [[nodiscard]] int GetChatMaxFrameSize() const {
+        return GetInt("CHAT_MAX_FRAME_SIZE", kDefaultChatMaxFrameSize);
+    }
+
+    /**
+     * @brief Получает минимальный размер нагрузки кадра чата, который сжимается
+     *
+     * @return int Размер в байтах, 512 по умолчанию (0 - сжатие отключено)
+     */
+    [[nodiscard]] int GetChatCompressionMinSize() const {
+        return GetInt("CHAT_COMPRESSION_MIN_SIZE", kDefaultChatCompressionMinSize);
+    }
+
+    /**
+     * @brief Получает лимит очереди отправки одного соединения чата
+     *
+     * Кадры рассылки комнаты, не помещающиеся в очередь, обрабатываются
+     * согласно GetChatSlowConsumerPolicy().
+     *
+     * @return int Размер в байтах или 1 МиБ по умолчанию
+     */
+    [[nodiscard]] int GetChatSendQueueBytes() const {
+        return GetInt("CHAT_SEND_QUEUE_BYTES", kDefaultChatSendQueueBytes);
+    }
+
+    /**
+     * @brief Получает политику для медленных получателей чата
+     *
+     * "disconnect" - соединение с переполненной очередью закрывается,
+     * "drop" - кадры рассылки, не поместившиеся в очередь, отбрасываются.
+     *
+     * @return std::string Имя политики или "disconnect" по умолчанию
+     */
+    [[nodiscard]] std::string GetChatSlowConsumerPolicy() const {
+        return GetString("CHAT_SLOW_CONSUMER_POLICY", "disconnect");
+    }
+
+    /**
+     * @brief Получает время, которое соединение чата может молчать
+     *
+     * Клиент, который дольше этого срока не прислал ни одного кадра,
+     * отключается. Зарегистрированные пиры и так обновляют регистрацию
+     * чаще PEER_TTL_MS.
+     *
+     * @return int Таймаут в миллисекундах, 300000 по умолчанию (0 - без ограничения)
+     */
+    [[nodiscard]] int GetChatIdleTimeoutMs() const {
+        return GetInt("CHAT_IDLE_TIMEOUT_MS", kDefaultChatIdleTimeoutMs);
+    }
+
+    /**
+     * @brief Получает срок жизни регистрации пира без heartbeat
+     *
+     * @return int Срок в миллисекундах или 30000 по умолчанию
+     */
+    [[nodiscard]] int GetPeerTtlMs() const {
+        return GetInt("PEER_TTL_MS", kDefaultPeerTtlMs);
+    }
+
+    /**
+     * @brief Получает интервал записи снимков реестра пиров в БД
+     *
+     * Регистрации и heartbeat меняют только реестр в памяти, в БД
+     * изменения попадают одним пакетом раз в этот интервал.
+     *
+     * @return int Интервал в миллисекундах или 5000 по умолчанию
+     */
+    [[nodiscard]] int GetPeerSnapshotIntervalMs() const {
+        return GetInt("PEER_SNAPSHOT_INTERVAL_MS", kDefaultPeerSnapshotIntervalMs);
+    }
+
+    /**
+     * @brief Получает размер пакета записи сообщений чата
+     *
+     * @return int Количество сообщений или 256 по умолчанию
+     */
+    [[nodiscard]] int GetMessageBatchSize() const {
+        return GetInt("MESSAGE_BATCH_SIZE", kDefaultMessageBatchSize);
+    }
+
+    /**
+     * @brief Получает максимальное время ожидания сообщения в буфере записи
+     *
+     * @return int Интервал в миллисекундах или 100 по умолчанию
+     */
+    [[nodiscard]] int GetMessageFlushIntervalMs() const {
+        return GetInt("MESSAGE_FLUSH_INTERVAL_MS", kDefaultMessageFlushIntervalMs);
+    }
+
+    /**
+     * @brief Получает количество комнат в кеше истории сообщений
+     *
+     * @return int Количество комнат, 1024 по умолчанию (0 - кеш отключен)
+     */
+    [[nodiscard]] int GetMessageCacheRooms() const {
+        return GetInt("MESSAGE_CACHE_ROOMS", kDefaultMessageCacheRooms);
+    }
+
+    /**
+     * @brief Получает количество последних сообщений комнаты в кеше истории
+     *
+     * Запрос истории не длиннее этого значения отдается из кеша.
+     *
+     * @return int Количество сообщений или 50 по умолчанию
+     */
+    [[nodiscard]] int GetMessageCacheSize() const {
+        return GetInt("MESSAGE_CACHE_SIZE", kDefaultMessageCacheSize);
+    }
+
+    /**
+     * @brief Получает лимит одновременных сессий одного слушателя
+     *
+     * Соединения сверх лимита закрываются сразу после accept.
+     *
+     * @return int Количество сессий, 10000 по умолчанию (0 - без ограничения)
+     */
+    [[nodiscard]] int GetMaxSessions() const {
+        return GetInt("MAX_SESSIONS", kDefaultMaxSessions);
+    }
+
+    /**
+     * @brief Получает допустимую частоту подключений с одного адреса
+     *
+     * @return int Подключений в секунду, 0 по умолчанию (без ограничения)
+     */
+    [[nodiscard]] int GetIpConnectRate() const {
+        return GetInt("IP_CONNECT_RATE", kDefaultIpConnectRate);
+    }
+
+    /**
+     * @brief Получает количество подключений, которые адрес может открыть подряд
+     *
+     * @return int Емкость корзины токенов адреса или 50 по умолчанию
+     */
+    [[nodiscard]] int GetIpConnectBurst() const {
+        return GetInt("IP_CONNECT_BURST", kDefaultIpConnectBurst);
+    }
+
+    /**
+     * @brief Получает количество корзин в таблице ограничения частоты
+     *
+     * @return int Количество корзин или 4096 по умолчанию
+     */
+    [[nodiscard]] int GetIpTableSize() const {
+        return GetInt("IP_TABLE_SIZE", kDefaultIpTableSize);
+    }
+
+    /**
+     * @brief Получает максимальную паузу перед повтором accept при нехватке ресурсов
+     *
+     * Пауза удваивается после каждой ошибки EMFILE/ENFILE/ENOBUFS/ENOMEM,
+     * начиная с 10 мс, и сбрасывается после успешного accept.
+     *
+     * @return int Пауза в миллисекундах или 1000 по умолчанию
+     */
+    [[nodiscard]] int GetAcceptBackoffMaxMs() const {
+        return GetInt("ACCEPT_BACKOFF_MAX_MS", kDefaultAcceptBackoffMaxMs);
+    }
+
+    /**
+     * @brief Проверяет, отключать ли алгоритм Нейгла для принятых соединений
+     *
+     * @return bool true, если TCP_NODELAY не равен 0 (по умолчанию включен)
+     */
+    [[nodiscard]] bool GetTcpNoDelay() const {
+        return GetInt("TCP_NODELAY", kDefaultTcpNoDelay) != 0;
+    }
+
+    /**
+     * @brief Получает время, которое ядро держит соединение до первых данных
+     *
+     * Пока клиент не отправил запрос, соединение не попадает в accept,
+     * поэтому пустые подключения не занимают сессии. Действует только в Linux.
+     *
+     * @return int Время в секундах или 0 по умолчанию (TCP_DEFER_ACCEPT выключен)
+     */
+    [[nodiscard]] int GetTcpDeferAcceptS() const {
+        return GetInt("TCP_DEFER_ACCEPT_S", kDefaultTcpDeferAcceptS);
+    }
+
+    /**
+     * @brief Получает длину очереди ожидающих accept соединений
+     *
+     * Ядро ограничивает значение параметром net.core.somaxconn.
+     *
+     * @return int Длина очереди или 0 по умолчанию (SOMAXCONN)
+     */
+    [[nodiscard]] int GetListenBacklog() const {
+        return GetInt("LISTEN_BACKLOG", kDefaultListenBacklog);
+    }
+
+    /**
+     * @brief Проверяет, включать ли SO_REUSEPORT для слушателей
+     *
+     * Позволяет запустить несколько процессов на одном порту; ядро
+     * распределяет входящие соединения между ними. Действует только в Linux.
+     *
+     * @return bool true, если SO_REUSEPORT не равен 0 (по умолчанию выключен)
+     */
+    [[nodiscard]] bool GetSoReusePort() const {
+        return GetInt("SO_REUSEPORT", kDefaultSoReusePort) != 0;
+    }
+
+    /**
+     * @brief Получает порт слушателя HTTPS
+     *
+     * @return int Порт или 0 по умолчанию (слушатель выключен)
+     */
+    [[nodiscard]] int GetTlsServerPort() const {
+        return GetInt("TLS_SERVER_PORT", kDefaultTlsServerPort);
+    }
+
+    /**
+     * @brief Получает путь к цепочке сертификатов HTTPS в формате PEM
+     *
+     * @return std::string Путь или "server.crt" по умолчанию
+     */
+    [[nodiscard]] std::string GetTlsCertFile() const {
+        return GetString("TLS_CERT_FILE", "server.crt");
+    }
+
+    /**
+     * @brief Получает путь к закрытому ключу HTTPS в формате PEM
+     *
+     * @return std::string Путь или "server.key" по умолчанию
+     */
+    [[nodiscard]] std::string GetTlsKeyFile() const {
+        return GetString("TLS_KEY_FILE", "server.key");
+    }
+
+    /**
+     * @brief Получает путь к файлу ключей билетов сессий TLS
+     *
+     * Файл из 80 случайных байтов (например, openssl rand 80) позволяет
+     * нескольким процессам на одном порту (SO_REUSEPORT) и перезапущенному
+     * серверу принимать билеты друг друга.
+     *
+     * @return std::string Путь или пустая строка по умолчанию (случайные
+     *         ключи процесса)
+     */
+    [[nodiscard]] std::string GetTlsTicketKeyFile() const {
+        return GetString("TLS_TICKET_KEY_FILE");
+    }
+
+    /**
+     * @brief Получает срок действия билетов сессий TLS
+     *
+     * @return int Срок в секундах или 7200 по умолчанию
+     */
+    [[nodiscard]] int GetTlsSessionTimeoutS() const {
+        return GetInt("TLS_SESSION_TIMEOUT_S", kDefaultTlsSessionTimeoutS);
+    }
+
+    /**
+     * @brief Проверяет, передавать ли шифрование записей TLS ядру (kTLS)
+     *
+     * Действует, если OpenSSL собран с поддержкой kTLS, а в ядре загружен
+     * модуль tls; иначе записи шифрует OpenSSL.
+     *
+     * @return bool true, если TLS_KTLS не равен 0 (по умолчанию включено)
+     */
+    [[nodiscard]] bool GetTlsKtls() const {
+        return GetInt("TLS_KTLS", kDefaultTlsKtls) != 0;
+    }
+
+    /**
+     * @brief Получает максимальное время ожидания свободного соединения с БД
+     *
+     * По истечении этого времени запрос к БД завершается ошибкой вместо
+     * бесконечного ожидания, и клиент получает ответ 503.
+     *
+     * @return int Таймаут в миллисекундах или 250 по умолчанию
+     */
+    [[nodiscard]] int GetDbAcquireTimeoutMs() const {
+        return GetInt("DB_ACQUIRE_TIMEOUT_MS", kDefaultDbAcquireTimeoutMs);
+    }
+
+    /**
+     * @brief Получает количество соединений с БД, которые пул держит открытыми
+     *
+     * Эти соединения открываются в фоне после старта и восстанавливаются
+     * после разрывов; простаивающие соединения сверх минимума закрываются.
+     *
+     * @return int Минимальный размер пула или 1 по умолчанию
+     */
+    [[nodiscard]] int GetDbPoolMinSize() const {
+        return GetInt("DB_POOL_MIN_SIZE", kDefaultDbPoolMinSize);
+    }
+
+    /**
+     * @brief Получает время простоя, после которого лишнее соединение пула закрывается
+     *
+     * @return int Время простоя в миллисекундах или 60000 по умолчанию
+     */
+    [[nodiscard]] int GetDbPoolIdleTimeoutMs() const {
+        return GetInt("DB_POOL_IDLE_TIMEOUT_MS", kDefaultDbPoolIdleTimeoutMs);
+    }
+
+    /**
+     * @brief Получает максимальную паузу между попытками переподключения к БД
+     *
+     * Пауза удваивается после каждой неудачной попытки, начиная со 100 мс.
+     *
+     * @return int Пауза в миллисекундах или 10000 по умолчанию
+     */
+    [[nodiscard]] int GetDbReconnectBackoffMs() const {
+        return GetInt("DB_RECONNECT_BACKOFF_MS", kDefaultDbReconnectBackoffMs);
+    }
+
     /**
      * @brief Получает путь к файлу конфигурации
      *
@@ -578,6 +1380,157 @@ inline ConfigManager& GetConfig() {
     return instance;
 }
 
+/**
+ * @brief Неизменяемый снимок конфигурации с разобранными значениями
+ *
+ * Значения читаются из ConfigManager один раз при создании снимка, поэтому
+ * чтение поля - обычный доступ к памяти без поиска в variables_map и
+ * приведения boost::any, а строка подключения собирается тоже один раз.
+ *
+ * Поля, отмеченные как перезагружаемые, вступают в силу после
+ * ReloadConfig(): параметры сессий - для новых соединений, остальные -
+ * сразу. Прочие поля читаются компонентами при запуске.
+ */
+struct ConfigSnapshot {
+    std::string log_level;                         ///< Уровень логирования (перезагружаемый)
+    std::chrono::milliseconds keep_alive_timeout;  ///< Таймаут простоя HTTP (перезагружаемый)
+    int keep_alive_max_requests = 0;               ///< Запросов на соединение (перезагружаемый)
+    std::chrono::milliseconds write_timeout;       ///< Таймаут записи ответа (перезагружаемый)
+    std::chrono::milliseconds db_acquire_timeout;  ///< Ожидание соединения БД (перезагружаемый)
+    std::size_t chat_max_frame_size = 0;           ///< Нагрузка кадра чата (перезагружаемый)
+    std::size_t chat_compression_min_size = 0;     ///< Порог сжатия чата (перезагружаемый)
+    std::size_t chat_send_queue_bytes = 0;         ///< Очередь отправки чата (перезагружаемый)
+    bool chat_drop_slow = false;                   ///< Отбрасывать кадры медленных получателей
+    std::chrono::milliseconds chat_idle_timeout;   ///< Простой чата, 0 - нет (перезагружаемый)
+    int connection_pool_size = 0;                  ///< Размер пула соединений БД
+    std::string db_conn_string;                    ///< Строка подключения к БД
+
+    /**
+     * @brief Создает снимок из загруженной конфигурации
+     *
+     * @param config Менеджер конфигурации
+     * @return std::shared_ptr<const ConfigSnapshot> Снимок значений
+     */
+    static std::shared_ptr<const ConfigSnapshot> FromConfig(const ConfigManager& config) {
+        auto snapshot = std::make_shared<ConfigSnapshot>();
+        snapshot->log_level = config.GetLogLevel();
+        snapshot->keep_alive_timeout = std::chrono::milliseconds(config.GetKeepAliveTimeoutMs());
+        snapshot->keep_alive_max_requests = config.GetKeepAliveMaxRequests();
+        snapshot->write_timeout = std::chrono::milliseconds(config.GetWriteTimeoutMs());
+        snapshot->db_acquire_timeout = std::chrono::milliseconds(config.GetDbAcquireTimeoutMs());
+        snapshot->chat_max_frame_size = static_cast<std::size_t>(config.GetChatMaxFrameSize());
+        snapshot->chat_compression_min_size =
+            static_cast<std::size_t>(config.GetChatCompressionMinSize());
+        snapshot->chat_send_queue_bytes =
+            static_cast<std::size_t>(config.GetChatSendQueueBytes());
+        snapshot->chat_drop_slow = config.GetChatSlowConsumerPolicy() == "drop";
+        snapshot->chat_idle_timeout = std::chrono::milliseconds(config.GetChatIdleTimeoutMs());
+        snapshot->connection_pool_size = config.GetConnectionPoolSize();
+        snapshot->db_conn_string = config.GetDbConnString();
+        return snapshot;
+    }
+};
+
+/**
+ * @brief Текущий снимок конфигурации, заменяемый целиком (RCU)
+ *
+ * Класс LiveConfig публикует снимки как shared_ptr на неизменяемый объект:
+ * снимок никогда не меняется на месте, а старый освобождается, когда его
+ * отпустит последний читатель.
+ *
+ * Get() кеширует снимок в потоке и сверяет только атомарный номер
+ * поколения, поэтому обычное чтение - одна атомарная загрузка без
+ * блокировки и без изменения счетчика ссылок. Мьютекс берется только
+ * при первом чтении в потоке после публикации.
+ */
+class LiveConfig {
+   public:
+    /**
+     * @brief Конструктор
+     *
+     * @param initial Начальный снимок
+     */
+    explicit LiveConfig(std::shared_ptr<const ConfigSnapshot> initial)
+        : generation_(NextGeneration()), current_(std::move(initial)) {
+    }
+
+    /**
+     * @brief Возвращает текущий снимок
+     *
+     * @return const ConfigSnapshot& Снимок, действительный до следующего
+     *         вызова Get() в этом же потоке
+     */
+    [[nodiscard]] const ConfigSnapshot& Get() const {
+        struct Cache {
+            uint64_t generation = 0;                         ///< Поколение снимка
+            std::shared_ptr<const ConfigSnapshot> snapshot;  ///< Закешированный снимок
+        };
+        thread_local Cache cache;
+
+        const uint64_t generation = generation_.load(std::memory_order_acquire);
+        if (cache.generation != generation) {
+            cache.snapshot = Load();
+            cache.generation = generation;
+        }
+        return *cache.snapshot;
+    }
+
+    /**
+     * @brief Возвращает текущий снимок с владением
+     *
+     * Для кода, который хранит снимок дольше одного обращения.
+     */
+    [[nodiscard]] std::shared_ptr<const ConfigSnapshot> Load() const {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        return current_;
+    }
+
+    /**
+     * @brief Публикует новый снимок
+     *
+     * @param snapshot Новый снимок
+     */
+    void Publish(std::shared_ptr<const ConfigSnapshot> snapshot) {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        current_ = std::move(snapshot);
+        generation_.store(NextGeneration(), std::memory_order_release);
+    }
+
+   private:
+    /**
+     * @brief Выдает номер поколения, уникальный для всего процесса
+     *
+     * Уникальность позволяет кешу потока не путать снимки разных LiveConfig.
+     */
+    static uint64_t NextGeneration() {
+        static std::atomic<uint64_t> counter{0};
+        return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    std::atomic<uint64_t> generation_;               ///< Поколение текущего снимка
+    std::shared_ptr<const ConfigSnapshot> current_;  ///< Текущий снимок (под mutex_)
+    mutable std::mutex mutex_;                       ///< Мьютекс текущего снимка
+};
+
+/**
+ * @brief Получает глобальный текущий снимок конфигурации (Singleton)
+ *
+ * @return LiveConfig& Ссылка на единственный экземпляр LiveConfig
+ */
+inline LiveConfig& GetLiveConfig() {
+    static LiveConfig instance(ConfigSnapshot::FromConfig(GetConfig()));
+    return instance;
+}
+
+/**
+ * @brief Получает текущий снимок конфигурации
+ *
+ * @return const ConfigSnapshot& Снимок, действительный до следующего вызова в этом потоке
+ */
+inline const ConfigSnapshot& GetConfigSnapshot() {
+    return GetLiveConfig().Get();
+}
+
 /**
  * @brief Инициализирует глобальную конфигурацию из файла
  *
@@ -589,4 +1542,25 @@ inline ConfigManager& GetConfig() {
 inline void InitializeConfig(const std::string& config_file = ".config") {
     auto& config = GetConfig();
     config.Initialize(config_file);
+    GetLiveConfig().Publish(ConfigSnapshot::FromConfig(config));
+}
+
+/**
+ * @brief Перечитывает конфигурацию и публикует новый снимок
+ *
+ * Конфигурация загружается в отдельный ConfigManager, поэтому при ошибке
+ * разбора текущий снимок не меняется, а GetConfig() по-прежнему
+ * возвращает значения, загруженные при запуске.
+ *
+ * @param config_file Путь к файлу конфигурации (по умолчанию ".config")
+ * @return std::shared_ptr<const ConfigSnapshot> Опубликованный снимок
+ * @throws std::exception если файл не удалось прочитать или разобрать
+ */
+inline std::shared_ptr<const ConfigSnapshot> ReloadConfig(
+    const std::string& config_file = ".config") {
+    ConfigManager fresh;
+    fresh.Initialize(config_file);
+    auto snapshot = ConfigSnapshot::FromConfig(fresh);
+    GetLiveConfig().Publish(snapshot);
+    return snapshot;
 }
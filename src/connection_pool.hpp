@@ -0,0 +1,507 @@
+#pragma once
+
+#include "logger.hpp"
+#include "metrics.hpp"
+#include "mpmc_queue.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <semaphore>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+template <typename T>
+class BasicConnectionPool;
+
+/**
+ * @brief Исключение: пул не может выдать соединение
+ */
+class ConnectionPoolUnavailable : public std::runtime_error {
+   public:
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * @brief Исключение: свободное соединение не появилось за отведенное время
+ */
+class ConnectionPoolTimeout : public ConnectionPoolUnavailable {
+   public:
+    using ConnectionPoolUnavailable::ConnectionPoolUnavailable;
+};
+
+/**
+ * @brief RAII обертка для соединения с базой данных
+ *
+ * Класс BasicConnection представляет автоматически управляемое соединение
+ * с базой данных из пула соединений. При уничтожении объекта
+ * соединение автоматически возвращается в пул.
+ *
+ * Использует паттерн RAII для безопасного управления ресурсами
+ * и запрещает копирование/перемещение для обеспечения единственности.
+ *
+ * @tparam T Тип соединения (pqxx::connection в рабочем коде)
+ */
+template <typename T>
+class BasicConnection {
+   public:
+    /**
+     * @brief Конструктор соединения
+     *
+     * @param conn Уникальный указатель на соединение
+     * @param pool Указатель на пул соединений для возврата соединения
+     */
+    BasicConnection(std::unique_ptr<T> conn, BasicConnectionPool<T>* pool)
+        : conn_(std::move(conn)), pool_(pool) {
+    }
+
+    /**
+     * @brief Деструктор - автоматически возвращает соединение в пул
+     */
+    ~BasicConnection() noexcept;
+
+    BasicConnection(const BasicConnection&) = delete;             ///< Запрет копирования
+    BasicConnection& operator=(const BasicConnection&) = delete;  ///< Запрет присваивания
+
+    BasicConnection(BasicConnection&&) = delete;             ///< Запрет перемещения
+    BasicConnection& operator=(BasicConnection&&) = delete;  ///< Запрет перемещающего присваивания
+
+    /**
+     * @brief Оператор доступа к соединению через указатель
+     *
+     * @return T* Указатель на объект соединения
+     */
+    T* operator->() {
+        return conn_.get();
+    }
+
+    /**
+     * @brief Оператор разыменования для доступа к соединению
+     *
+     * @return T& Ссылка на объект соединения
+     */
+    T& operator*() {
+        return *conn_;
+    }
+
+   private:
+    std::unique_ptr<T> conn_;       ///< Соединение с базой данных
+    BasicConnectionPool<T>* pool_;  ///< Указатель на пул для возврата соединения
+};
+
+/**
+ * @brief Параметры размера и обслуживания пула соединений
+ */
+struct ConnectionPoolOptions {
+    uint64_t min_size = 1;                                 ///< Соединений, поддерживаемых открытыми
+    uint64_t max_size = 10;                                ///< Максимум открытых соединений
+    std::chrono::milliseconds idle_timeout{60000};         ///< Простой до закрытия лишнего
+    std::chrono::milliseconds maintenance_interval{1000};  ///< Период фонового обслуживания
+    std::chrono::milliseconds initial_backoff{100};        ///< Первая пауза переподключения
+    std::chrono::milliseconds max_backoff{10000};          ///< Предельная пауза переподключения
+};
+
+/**
+ * @brief Эластичный пул соединений с базой данных
+ *
+ * Класс BasicConnectionPool управляет набором соединений с базой данных
+ * размером от min_size до max_size. Обеспечивает:
+ * - Ленивое создание: соединение открывается, только когда свободного нет,
+ *   а конструктор не подключается к БД и не может завершиться ошибкой
+ * - Проверку соединения при возврате и во время простоя (Validator):
+ *   разорванные соединения закрываются, а не выдаются повторно
+ * - Фоновое восстановление до min_size с экспоненциальной паузой
+ *   между неудачными попытками
+ * - Закрытие соединений сверх min_size, простаивающих дольше idle_timeout
+ * - Ожидание освобождения соединения с ограничением по времени
+ *
+ * Количество выдаваемых соединений ограничено семафором на max_size
+ * разрешений, а свободные соединения хранятся в lock-free очереди MpmcQueue,
+ * поэтому получение и возврат не берут мьютекс. Поток, получивший разрешение
+ * и не нашедший свободного соединения, создает новое сам.
+ *
+ * Пока действует пауза после неудачного подключения, запрос без свободного
+ * соединения сразу завершается ConnectionPoolUnavailable, не нагружая
+ * недоступный сервер БД попытками подключения.
+ *
+ * Метрики: Histogram::kPoolWait, Counter::kPoolTimeouts,
+ * Counter::kPoolConnectFailures, Gauge::kPoolSize (открытые соединения),
+ * Gauge::kPoolConnectionsInUse.
+ *
+ * @tparam T Тип соединения (pqxx::connection в рабочем коде)
+ */
+template <typename T>
+class BasicConnectionPool {
+   public:
+    using Factory = std::function<std::unique_ptr<T>()>;  ///< Открывает новое соединение
+    using Validator = std::function<bool(T&)>;            ///< Проверяет, пригодно ли соединение
+
+    /**
+     * @brief Конструктор эластичного пула
+     *
+     * Запускает поток обслуживания, который в фоне открывает min_size соединений.
+     *
+     * @param options Размеры пула и интервалы обслуживания
+     * @param factory Функция открытия соединения (может выбрасывать исключения)
+     * @param validator Проверка соединения; пустая функция считает все соединения пригодными
+     */
+    BasicConnectionPool(ConnectionPoolOptions options, Factory factory, Validator validator = {})
+        : options_(Normalize(options))
+        , factory_(std::move(factory))
+        , validator_(std::move(validator))
+        , idle_(options_.max_size)
+        , available_(static_cast<std::ptrdiff_t>(options_.max_size))
+        , backoff_(options_.initial_backoff) {
+        maintenance_ = std::thread([this] { MaintenanceLoop(); });
+    }
+
+    /**
+     * @brief Конструктор пула фиксированного размера
+     *
+     * @param size Количество соединений в пуле (min_size = max_size = size)
+     * @param args Аргументы конструктора соединения (например, строка подключения)
+     */
+    template <typename... Args>
+    explicit BasicConnectionPool(uint64_t size, const Args&... args)
+        : BasicConnectionPool(
+              ConnectionPoolOptions{.min_size = size, .max_size = size},
+              [args...] { return std::make_unique<T>(args...); }) {
+    }
+
+    /**
+     * @brief Деструктор - останавливает обслуживание и закрывает свободные соединения
+     *
+     * К моменту уничтожения все выданные соединения должны быть возвращены.
+     */
+    ~BasicConnectionPool() {
+        {
+            const std::lock_guard<std::mutex> lock(maintenance_mutex_);
+            stopping_ = true;
+        }
+        maintenance_cv_.notify_one();
+        maintenance_.join();
+
+        IdleConnection item;
+        while (idle_.TryPop(item)) {
+            Destroy(std::move(item.conn));
+        }
+    }
+
+    BasicConnectionPool(const BasicConnectionPool&) = delete;             ///< Запрет копирования
+    BasicConnectionPool& operator=(const BasicConnectionPool&) = delete;  ///< Запрет присваивания
+    BasicConnectionPool(BasicConnectionPool&&) = delete;                  ///< Запрет перемещения
+    BasicConnectionPool& operator=(BasicConnectionPool&&) = delete;       ///< Запрет перемещения
+
+    /**
+     * @brief Получает соединение из пула без ожидания
+     *
+     * @return std::optional<BasicConnection<T>> Соединение или std::nullopt,
+     *         если все соединения заняты
+     * @throws ConnectionPoolUnavailable если соединение нужно открыть,
+     *         но действует пауза после неудачного подключения
+     */
+    std::optional<BasicConnection<T>> TryAcquire() {
+        if (!available_.try_acquire()) {
+            return std::nullopt;
+        }
+        return std::optional<BasicConnection<T>>(std::in_place, Take(), this);
+    }
+
+    /**
+     * @brief Получает соединение из пула, ожидая не дольше timeout
+     *
+     * Если все соединения заняты, поток ожидает освобождения соединения
+     * другим потоком. Ограничение по времени не дает недоступной или
+     * перегруженной базе данных остановить все потоки обработки.
+     *
+     * @param timeout Максимальное время ожидания
+     * @return BasicConnection<T> RAII-обертка для соединения
+     * @throws ConnectionPoolTimeout если соединение не освободилось за timeout
+     * @throws ConnectionPoolUnavailable если действует пауза после неудачного подключения
+     */
+    BasicConnection<T> Acquire(std::chrono::milliseconds timeout) {
+        const ScopedLatency wait(Histogram::kPoolWait);
+        if (!available_.try_acquire_for(timeout)) {
+            GetMetrics().Increment(Counter::kPoolTimeouts);
+            throw ConnectionPoolTimeout("No free database connection within " +
+                                        std::to_string(timeout.count()) + " ms");
+        }
+        return {Take(), this};
+    }
+
+    /**
+     * @brief Количество открытых соединений (свободных и выданных)
+     */
+    [[nodiscard]] uint64_t Size() const {
+        return open_.load(std::memory_order_relaxed);
+    }
+
+   private:
+    friend class BasicConnection<T>;
+
+    using Clock = std::chrono::steady_clock;  ///< Часы для простоя и пауз переподключения
+
+    /**
+     * @brief Свободное соединение в очереди
+     */
+    struct IdleConnection {
+        std::unique_ptr<T> conn;  ///< Соединение
+        Clock::time_point since;  ///< Момент возврата в пул
+    };
+
+    static ConnectionPoolOptions Normalize(ConnectionPoolOptions options) {
+        options.max_size = std::max<uint64_t>(options.max_size, 1);
+        options.min_size = std::min(options.min_size, options.max_size);
+        return options;
+    }
+
+    /**
+     * @brief Выдает соединение держателю разрешения семафора
+     *
+     * Берет свободное соединение из очереди или открывает новое. Держателей
+     * разрешений не больше max_size, и каждый владеет не более чем одним
+     * соединением, поэтому если очередь пуста, место для нового соединения есть.
+     * Исключение - ячейка очереди, запись в которую другой поток еще не завершил:
+     * тогда достаточно нескольких повторов.
+     *
+     * @return std::unique_ptr<T> Соединение
+     * @throws ConnectionPoolUnavailable во время паузы после неудачного подключения
+     */
+    std::unique_ptr<T> Take() {
+        IdleConnection item;
+        for (;;) {
+            if (idle_.TryPop(item)) {
+                break;
+            }
+            if (ReserveSlot()) {
+                try {
+                    item.conn = Open();
+                } catch (...) {
+                    available_.release();
+                    throw;
+                }
+                break;
+            }
+            std::this_thread::yield();
+        }
+        GetMetrics().Add(Gauge::kPoolConnectionsInUse, 1);
+        return std::move(item.conn);
+    }
+
+    /**
+     * @brief Резервирует место под новое соединение, если открыто меньше max_size
+     */
+    bool ReserveSlot() {
+        uint64_t open = open_.load(std::memory_order_relaxed);
+        while (open < options_.max_size) {
+            if (open_.compare_exchange_weak(open, open + 1, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Открывает соединение в зарезервированном месте
+     *
+     * При ошибке место освобождается, и включается пауза: до ее окончания
+     * новые соединения открывает только поток обслуживания.
+     *
+     * @return std::unique_ptr<T> Новое соединение
+     */
+    std::unique_ptr<T> Open() {
+        const auto now = Clock::now();
+        if (now.time_since_epoch().count() < retry_at_.load(std::memory_order_relaxed)) {
+            open_.fetch_sub(1, std::memory_order_relaxed);
+            throw ConnectionPoolUnavailable("Database reconnect is backing off");
+        }
+        try {
+            auto conn = factory_();
+            GetMetrics().Add(Gauge::kPoolSize, 1);
+            return conn;
+        } catch (const std::exception& e) {
+            open_.fetch_sub(1, std::memory_order_relaxed);
+            GetMetrics().Increment(Counter::kPoolConnectFailures);
+            retry_at_.store((now + options_.initial_backoff).time_since_epoch().count(),
+                            std::memory_order_relaxed);
+            LOG_WARNING << "Failed to open database connection: " << e.what();
+            throw;
+        }
+    }
+
+    /**
+     * @brief Закрывает соединение и освобождает его место
+     */
+    void Destroy(std::unique_ptr<T> conn) {
+        conn.reset();
+        open_.fetch_sub(1, std::memory_order_relaxed);
+        GetMetrics().Add(Gauge::kPoolSize, -1);
+    }
+
+    /**
+     * @brief Проверяет соединение; исключение проверки считается отказом
+     */
+    bool IsValid(T& conn) const {
+        if (!validator_) {
+            return true;
+        }
+        try {
+            return validator_(conn);
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+
+    /**
+     * @brief Возвращает соединение в пул
+     *
+     * Вызывается автоматически деструктором BasicConnection.
+     * Непригодное соединение закрывается, и его место освобождается под новое.
+     * Освобождает разрешение семафора, пробуждая один ожидающий поток.
+     *
+     * @param conn Соединение для возврата в пул
+     */
+    void Release(std::unique_ptr<T> conn) {
+        GetMetrics().Add(Gauge::kPoolConnectionsInUse, -1);
+        PutBack(std::move(conn));
+        available_.release();
+    }
+
+    /**
+     * @brief Кладет проверенное соединение в очередь свободных или закрывает его
+     */
+    void PutBack(std::unique_ptr<T> conn) {
+        if (!IsValid(*conn)) {
+            LOG_WARNING << "Dropping broken database connection";
+            Destroy(std::move(conn));
+            return;
+        }
+        IdleConnection item{std::move(conn), Clock::now()};
+        if (!idle_.TryPush(item)) {
+            Destroy(std::move(item.conn));
+        }
+    }
+
+    /**
+     * @brief Цикл потока обслуживания
+     */
+    void MaintenanceLoop() {
+        std::unique_lock<std::mutex> lock(maintenance_mutex_);
+        while (!stopping_) {
+            lock.unlock();
+            CheckIdle();
+            Replenish();
+            lock.lock();
+            maintenance_cv_.wait_for(
+                lock, options_.maintenance_interval, [this] { return stopping_; });
+        }
+    }
+
+    /**
+     * @brief Проверяет свободные соединения и закрывает лишние простаивающие
+     *
+     * Поток обслуживания сам берет разрешения семафора, поэтому временно
+     * извлеченные из очереди соединения не заставляют других потоков открывать новые.
+     */
+    void CheckIdle() {
+        const auto now = Clock::now();
+        const uint64_t open = open_.load(std::memory_order_relaxed);
+        uint64_t kept = open;
+        for (uint64_t i = 0; i < open; ++i) {
+            if (!available_.try_acquire()) {
+                return;
+            }
+            IdleConnection item;
+            if (!idle_.TryPop(item)) {
+                available_.release();
+                return;
+            }
+            if (kept > options_.min_size && now - item.since >= options_.idle_timeout) {
+                Destroy(std::move(item.conn));
+                --kept;
+            } else if (!IsValid(*item.conn)) {
+                LOG_WARNING << "Dropping broken idle database connection";
+                Destroy(std::move(item.conn));
+                --kept;
+            } else if (!idle_.TryPush(item)) {
+                Destroy(std::move(item.conn));
+            }
+            available_.release();
+        }
+    }
+
+    /**
+     * @brief Открывает соединения до min_size с экспоненциальной паузой после ошибок
+     */
+    void Replenish() {
+        while (open_.load(std::memory_order_relaxed) < options_.min_size) {
+            const auto now = Clock::now();
+            if (now.time_since_epoch().count() < retry_at_.load(std::memory_order_relaxed) ||
+                !available_.try_acquire()) {
+                return;
+            }
+            if (!ReserveSlot()) {
+                available_.release();
+                return;
+            }
+            try {
+                auto conn = factory_();
+                GetMetrics().Add(Gauge::kPoolSize, 1);
+                PutBack(std::move(conn));
+                backoff_ = options_.initial_backoff;
+                retry_at_.store(0, std::memory_order_relaxed);
+            } catch (const std::exception& e) {
+                open_.fetch_sub(1, std::memory_order_relaxed);
+                GetMetrics().Increment(Counter::kPoolConnectFailures);
+                retry_at_.store((now + backoff_).time_since_epoch().count(),
+                                std::memory_order_relaxed);
+                LOG_WARNING << "Failed to open database connection, retrying in "
+                            << backoff_.count() << " ms: " << e.what();
+                backoff_ = std::min(backoff_ * 2, options_.max_backoff);
+            }
+            available_.release();
+        }
+    }
+
+    const ConnectionPoolOptions options_;     ///< Размеры и интервалы пула
+    const Factory factory_;                   ///< Открытие соединения
+    const Validator validator_;               ///< Проверка соединения
+    MpmcQueue<IdleConnection> idle_;          ///< Очередь свободных соединений
+    std::counting_semaphore<> available_;     ///< Разрешения на получение соединения
+    std::atomic<uint64_t> open_{0};           ///< Открытые и открываемые соединения
+    std::atomic<Clock::rep> retry_at_{0};     ///< Конец паузы переподключения (тики Clock)
+    std::chrono::milliseconds backoff_;       ///< Текущая пауза (только поток обслуживания)
+    std::mutex maintenance_mutex_;            ///< Мьютекс ожидания потока обслуживания
+    std::condition_variable maintenance_cv_;  ///< Пробуждение потока обслуживания
+    bool stopping_ = false;                   ///< Пул уничтожается
+    std::thread maintenance_;                 ///< Поток обслуживания
+};
+
+
+/**
+ * @brief Реализация деструктора BasicConnection
+ *
+ * Возвращает соединение в пул при уничтожении объекта.
+ * Обрабатывает исключения для обеспечения безопасности в деструкторе.
+ */
+template <typename T>
+BasicConnection<T>::~BasicConnection() noexcept {
+    if (conn_) {
+        try {
+            pool_->Release(std::move(conn_));
+        } catch (std::exception& e) {
+            // Логируем ошибку, но не выбрасываем исключение из деструктора
+            LOG_ERROR << "Failed to release connection: " << e.what();
+        }
+    }
+}
@@ -0,0 +1,81 @@
+"""
+Общие флаги компиляции и линковки для пакетов src, bench и tests.
+
+Отладочная сборка (по умолчанию) собирается с -O0 и отладочной информацией.
+Сборка с --compilation_mode=opt (bazel build --config=release) включает
+-O3, LTO и отключает assert/отладочные макросы.
+"""
+
+common_copts = [
+    "-std=c++20",
+    "-fexceptions",
+    "-frtti",
+    "-fno-omit-frame-pointer",
+] + select({
+    "//src:opt_build": [
+        "-O3",
+        "-DNDEBUG",
+        "-flto=auto",
+        "-ffat-lto-objects",
+        # Сообщения уровня trace удаляются на этапе компиляции
+        "-DLOG_ACTIVE_LEVEL=1",
+    ],
+    "//conditions:default": [
+        "-g3",
+        "-ggdb3",
+        "-gdwarf-4",
+        "-O0",
+        "-DDEBUG",
+    ],
+})
+
+common_linkopts = select({
+    "//src:opt_build": [
+        "-O3",
+        "-flto=auto",
+    ],
+    "//conditions:default": [
+        "-g3",
+        "-ggdb3",
+        "-gdwarf-4",
+    ],
+})
+
+# Пути к заголовкам и библиотекам libpqxx/libpq для целей, включающих database.hpp
+postgres_copts = select({
+    "@platforms//os:macos": [
+        "-I/usr/local/include",
+    ],
+    "@platforms//os:linux": [
+        "-I/usr/include/postgresql",
+        "-I/usr/local/include",
+    ],
+    "//conditions:default": [
+        "-I/usr/local/include",
+    ],
+})
+
+postgres_linkopts = select({
+    "@platforms//os:macos": [
+        "-L/usr/local/lib",
+        "-lpqxx",
+        "-lpq",
+    ],
+    "@platforms//os:linux": [
+        "-L/usr/lib/x86_64-linux-gnu",
+        "-L/usr/local/lib",
+        "-lpqxx",
+        "-lpq",
+    ],
+    "//conditions:default": [
+        "-L/usr/local/lib",
+        "-lpqxx",
+        "-lpq",
+    ],
+})
+
+# Системный OpenSSL для целей с TLS: kTLS требует OpenSSL 3, собранного с enable-ktls
+tls_linkopts = [
+    "-lssl",
+    "-lcrypto",
+]
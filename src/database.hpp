@@ -1,274 +1,630 @@
 #pragma once
 
 #include "config.hpp"
+#include "connection_pool.hpp"
+#include "database_service.hpp"
+#include "peer_registry.hpp"
+#include "visit_histogram.hpp"
 
-#include <condition_variable>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
-#include <exception>
-#include <iostream>
+#include <ctime>
 #include <memory>
-#include <mutex>
 #include <pqxx/pqxx>
-#include <queue>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <tuple>
 #include <utility>
-
-class ConnectionPool;
+#include <vector>
 
 /**
- * @brief RAII обертка для соединения с базой данных
- *
- * Класс Connection представляет автоматически управляемое соединение
- * с базой данных из пула соединений. При уничтожении объекта
- * соединение автоматически возвращается в пул.
+ * @brief Соединение libpqxx с подготовленными запросами сервиса
  *
- * Использует паттерн RAII для безопасного управления ресурсами
- * и запрещает копирование/перемещение для обеспечения единственности.
+ * Запросы готовятся один раз на соединение при первом использовании, а не
+ * при подключении: пул открывает соединения в фоне, возможно до Initialize(),
+ * когда таблиц для подготовки еще нет. После переподключения пул создает
+ * новый объект, и запросы готовятся заново.
  */
-class Connection {
-   public:
+struct PreparedConnection {
+    /// Имя подготовленного запроса пакетной регистрации посещений
+    static constexpr const char* kMarkVisits = "mark_visits";
+    /// Имя подготовленного запроса количества посещений по интервалам
+    static constexpr const char* kGetVisitCounts = "get_visit_counts";
+    /// Имя подготовленного запроса чтения счетчика посещений
+    static constexpr const char* kGetCount = "get_count";
+    /// Имя подготовленного запроса пакетной записи регистраций пиров
+    static constexpr const char* kUpsertPeers = "upsert_peers";
+    /// Имя подготовленного запроса пакетного удаления регистраций пиров
+    static constexpr const char* kRemovePeers = "remove_peers";
+    /// Имя подготовленного запроса чтения не истекших регистраций пиров
+    static constexpr const char* kLoadPeers = "load_peers";
+    /// Имя подготовленного запроса резервирования блока идентификаторов сообщений
+    static constexpr const char* kReserveMessageIds = "reserve_message_ids";
+    /// Имя подготовленного запроса страницы истории комнаты
+    static constexpr const char* kGetMessages = "get_messages";
+
     /**
-     * @brief Конструктор соединения
+     * @brief Открывает соединение с PostgreSQL
      *
-     * @param conn Уникальный указатель на соединение libpqxx
-     * @param pool Указатель на пул соединений для возврата соединения
+     * @param conn_string Строка подключения
      */
-    Connection(std::unique_ptr<pqxx::connection> conn, ConnectionPool* pool)
-        : conn_(std::move(conn)), pool_(pool) {
+    explicit PreparedConnection(const std::string& conn_string) : conn(conn_string) {
     }
 
     /**
-     * @brief Деструктор - автоматически возвращает соединение в пул
+     * @brief Готовит запросы сервиса, если это еще не сделано
      */
-    ~Connection() noexcept;
+    void EnsurePrepared() {
+        if (prepared) {
+            return;
+        }
+        // Разделы, сырые посещения, агрегаты по минутам и общий счетчик - одна команда
+        conn.prepare(
+            kMarkVisits,
+            "SELECT visits_mark($1::bigint[], $2::bigint[], $3::bigint[], $4::int)");
+        conn.prepare(
+            kGetVisitCounts,
+            "SELECT minute - minute % $3::bigint, SUM(count)::bigint FROM visits_per_minute "
+            "WHERE minute >= $1::bigint AND minute < $2::bigint GROUP BY 1 ORDER BY 1");
+        conn.prepare(kGetCount, R"(SELECT count FROM visits_counter WHERE id = 1)");
+        conn.prepare(
+            kUpsertPeers,
+            "INSERT INTO peers (id, endpoint, expires_at) "
+            "SELECT id, endpoint, to_timestamp(t / 1000000.0) "
+            "FROM unnest($1::text[], $2::text[], $3::bigint[]) AS p(id, endpoint, t) "
+            "ON CONFLICT (id) DO UPDATE "
+            "SET endpoint = EXCLUDED.endpoint, expires_at = EXCLUDED.expires_at");
+        conn.prepare(kRemovePeers, R"(DELETE FROM peers WHERE id = ANY($1::text[]))");
+        conn.prepare(
+            kLoadPeers,
+            "SELECT id, endpoint, (extract(epoch FROM expires_at) * 1000000)::bigint "
+            "FROM peers WHERE expires_at > NOW()");
+        conn.prepare(kReserveMessageIds, R"(SELECT nextval('messages_id_seq'))");
+        conn.prepare(
+            kGetMessages,
+            "SELECT id, author, body, (extract(epoch FROM time) * 1000000)::bigint "
+            "FROM messages WHERE room_id = $1 AND id < $2 ORDER BY id DESC LIMIT $3");
+        prepared = true;
+    }
 
-    Connection(const Connection&) = delete;             ///< Запрет копирования
-    Connection& operator=(const Connection&) = delete;  ///< Запрет присваивания
+    pqxx::connection conn;  ///< Соединение libpqxx
+    bool prepared = false;  ///< Подготовлены ли запросы на этом соединении
+};
 
-    Connection(Connection&&) = delete;                  ///< Запрет перемещения
-    Connection& operator=(Connection&&) = delete;       ///< Запрет перемещающего присваивания
+/// Соединение libpqxx, взятое из пула
+using Connection = BasicConnection<PreparedConnection>;
+/// Пул соединений libpqxx
+using ConnectionPool = BasicConnectionPool<PreparedConnection>;
 
+/**
+ * @brief Реализация сервиса базы данных для PostgreSQL
+ *
+ * Класс PostgresDatabase предоставляет конкретную реализацию
+ * интерфейса IDatabaseService для работы с PostgreSQL.
+ *
+ * Особенности:
+ * - Использует пул соединений для эффективной работы в многопоточной среде
+ * - Автоматически создает необходимые таблицы при инициализации
+ * - Рабочие запросы выполняются как подготовленные и без BEGIN/COMMIT
+ *   (каждый из них - одна команда в режиме autocommit)
+ * - DDL инициализации выполняется в транзакции
+ * - Получает параметры подключения из конфигурации
+ * - Хранит снимки реестра пиров (IPeerStore) в таблице peers
+ * - Хранит посещения в месячных разделах visits, удаляет разделы старше
+ *   VISIT_RETENTION_DAYS и отвечает на запросы аналитики по агрегатам
+ *   visits_per_minute
+ */
+class PostgresDatabase : public IDatabaseService, public IPeerStore {
+   public:
     /**
-     * @brief Оператор доступа к соединению через указатель
+     * @brief Конструктор с настройкой пула соединений
+     *
+     * @param num_connections Максимальное количество соединений в пуле
+     * (0 = использовать значение из конфигурации)
      *
-     * @return pqxx::connection* Указатель на объект соединения libpqxx
+     * Если num_connections равно 0, размер пула берется из конфигурации.
+     * Строка подключения, минимальный размер пула, время простоя, пауза
+     * переподключения и время ожидания соединения всегда берутся из конфигурации
+     * (время ожидания - из текущего снимка, см. WithConnection()).
+     * Конструктор не подключается к серверу: соединения открываются в фоне
+     * и по мере необходимости, поэтому недоступная БД не мешает запуску.
      */
-    pqxx::connection* operator->() {
-        return conn_.get();
+    explicit PostgresDatabase(uint64_t num_connections = 0)
+        : conn_pool_(
+              MakePoolOptions(num_connections),
+              [conn_string = GetConfigSnapshot().db_conn_string] {
+                  return std::make_unique<PreparedConnection>(conn_string);
+              },
+              [](PreparedConnection& conn) { return conn.conn.is_open(); }) {
     }
 
     /**
-     * @brief Оператор разыменования для доступа к соединению
+     * @brief Регистрирует посещение в базе данных
      *
-     * @return pqxx::connection& Ссылка на объект соединения libpqxx
+     * Записывает пакет из одного посещения с текущим временем.
      */
-    pqxx::connection& operator*() {
-        return *conn_;
+    void MarkVisit() override {
+        MarkVisits({std::chrono::system_clock::now()});
     }
 
-   private:
-    std::unique_ptr<pqxx::connection> conn_;  ///< Соединение с базой данных
-    ConnectionPool* pool_;                    ///< Указатель на пул для возврата соединения
-};
-
-/**
- * @brief Пул соединений с базой данных
- *
- * Класс ConnectionPool управляет набором предварительно созданных
- * соединений с базой данных PostgreSQL. Обеспечивает:
- * - Эффективное переиспользование соединений
- * - Потокобезопасный доступ к соединениям
- * - Автоматическое ожидание освобождения соединений
- *
- * Использует мьютекс и условную переменную для синхронизации
- * доступа между потоками.
- */
-class ConnectionPool {
-   public:
     /**
-     * @brief Конструктор пула соединений
+     * @brief Регистрирует пакет посещений одним запросом
      *
-     * Создает указанное количество соединений с базой данных
-     * и помещает их в очередь для последующего использования.
+     * Пакет заранее агрегируется по минутам в процессе (VisitHistogram).
+     * Подготовленная команда получает массивы временных меток (в
+     * микросекундах от эпохи), минут и количеств и за один сетевой round
+     * trip вызывает visits_mark(): та создает недостающие месячные разделы,
+     * вставляет сырые посещения, прибавляет агрегаты к visits_per_minute,
+     * увеличивает общий счетчик и, если разделы создавались, удаляет
+     * разделы старше VISIT_RETENTION_DAYS.
      *
-     * @param size Количество соединений в пуле
-     * @param options Строка подключения к PostgreSQL
+     * @param times Временные метки посещений
      */
-    ConnectionPool(uint64_t size, const std::string& options) : size_(size) {
-        // Создаем все соединения заранее
-        for (uint64_t i = 0; i < size_; ++i) {
-            connections_.push(std::make_unique<pqxx::connection>(options));
+    void MarkVisits(const std::vector<std::chrono::system_clock::time_point>& times) override {
+        if (times.empty()) {
+            return;
+        }
+
+        VisitHistogram histogram;
+        std::string array_literal = "{";
+        for (std::size_t i = 0; i < times.size(); ++i) {
+            if (i > 0) {
+                array_literal += ',';
+            }
+            const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                times[i].time_since_epoch());
+            array_literal += std::to_string(micros.count());
+            histogram.Add(times[i]);
+        }
+        array_literal += '}';
+
+        std::string minutes = "{";
+        std::string counts = "{";
+        for (std::size_t i = 0; i < histogram.Buckets().size(); ++i) {
+            if (i > 0) {
+                minutes += ',';
+                counts += ',';
+            }
+            minutes += std::to_string(histogram.Buckets()[i].minute);
+            counts += std::to_string(histogram.Buckets()[i].count);
         }
+        minutes += '}';
+        counts += '}';
+
+        ExecutePrepared(
+            PreparedConnection::kMarkVisits, array_literal, minutes, counts,
+            GetConfig().GetVisitRetentionDays());
     }
 
     /**
-     * @brief Получает соединение из пула
+     * @brief Получает общее количество посещений
      *
-     * Если все соединения заняты, поток будет ожидать
-     * освобождения соединения другим потоком.
+     * Читает единственную строку счетчика visits_counter, которую
+     * увеличивает команда записи посещений, поэтому стоимость запроса
+     * не зависит от размера таблицы.
      *
-     * @return Connection RAII-обертка для соединения
+     * @return uint64_t Количество записей в таблице visits
      */
-    Connection Acquire() {
-        std::unique_lock<std::mutex> lock(mutex_);
-        // Ожидаем, пока не появится свободное соединение
-        cv_.wait(lock, [this] { return !connections_.empty(); });
-
-        // Извлекаем соединение из очереди
-        auto conn = std::move(connections_.front());
-        connections_.pop();
-        return {std::move(conn), this};
+    uint64_t GetCount() override {
+        auto res = ExecutePrepared(PreparedConnection::kGetCount);
+        return res.empty() ? 0 : res[0][0].as<uint64_t>();
     }
 
-   private:
-    friend class Connection;
-
     /**
-     * @brief Возвращает соединение в пул
+     * @brief Получает количество посещений по интервалам времени
      *
-     * Вызывается автоматически деструктором Connection.
-     * Уведомляет ожидающие потоки о доступности соединения.
+     * Читает агрегаты visits_per_minute по первичному ключу: период в
+     * сутки - не больше 1440 строк независимо от количества посещений.
      *
-     * @param conn Соединение для возврата в пул
+     * @param from Начало периода (включительно, округляется вниз до интервала)
+     * @param to Конец периода (не включительно)
+     * @param granularity Размер интервала
+     * @return std::vector<VisitBucket> Непустые интервалы в порядке возрастания
      */
-    void Release(std::unique_ptr<pqxx::connection> conn) {
-        const std::unique_lock<std::mutex> lock(mutex_);
-        connections_.push(std::move(conn));
-        cv_.notify_one();                                        // Уведомляем один ожидающий поток
-    }
-
-    std::queue<std::unique_ptr<pqxx::connection>> connections_;  ///< Очередь доступных соединений
-    std::mutex mutex_;                                           ///< Мьютекс для потокобезопасности
-    uint64_t size_;                                              ///< Размер пула соединений
-    std::condition_variable cv_;  ///< Условная переменная для ожидания
-};
+    std::vector<VisitBucket> GetVisitCounts(
+        std::chrono::system_clock::time_point from, std::chrono::system_clock::time_point to,
+        VisitGranularity granularity) override {
+        const int64_t width = MinutesPerBucket(granularity);
+        const int64_t first = VisitHistogram::AlignDown(VisitHistogram::MinuteOf(from), width);
+        const int64_t last = VisitHistogram::MinuteOf(to - std::chrono::microseconds(1));
+        const pqxx::result res =
+            ExecutePrepared(PreparedConnection::kGetVisitCounts, first, last + 1, width);
 
-/**
- * @brief Реализация деструктора Connection
- *
- * Возвращает соединение в пул при уничтожении объекта.
- * Обрабатывает исключения для обеспечения безопасности в деструкторе.
- */
-inline Connection::~Connection() noexcept {
-    if (conn_) {
-        try {
-            pool_->Release(std::move(conn_));
-        } catch (std::exception& e) {
-            // Логируем ошибку, но не выбрасываем исключение из деструктора
-            std::cout << e.what() << "\n";
+        std::vector<VisitBucket> buckets;
+        buckets.reserve(res.size());
+        for (const auto& row : res) {
+            buckets.push_back(VisitBucket{row[0].as<int64_t>(), row[1].as<uint64_t>()});
         }
+        return buckets;
     }
-}
 
-/**
- * @brief Абстрактный интерфейс для работы с базой данных
- *
- * Интерфейс IDatabaseService определяет основные операции для работы
- * с базой данных в рамках приложения P2P чата:
- * - Инициализация схемы базы данных
- * - Регистрация посещений
- * - Подсчет общего количества посещений
- *
- * Применяет правило пяти с запретом копирования и перемещения.
- */
-class IDatabaseService {
-   public:
-    virtual ~IDatabaseService() = default;
+    /**
+     * @brief Инициализирует схему базы данных
+     *
+     * Создает таблицу visits, секционированную по времени посещения
+     * (PARTITION BY RANGE, месячные разделы visits_YYYYMM):
+     * - id: BIGSERIAL, не переполняется, в отличие от SERIAL
+     * - time: временная метка посещения с часовым поясом
+     * - BRIN индекс по time: несколько страниц на раздел, запрос за
+     *   период читает только диапазоны блоков своего раздела
+     *
+     * Разделы создаются функцией visits_mark() в той же команде, что
+     * записывает пакет, а разделы старше VISIT_RETENTION_DAYS удаляются целиком
+     * (DROP TABLE вместо DELETE). Агрегаты по минутам visits_per_minute
+     * и счетчик visits_counter из одной строки не удаляются.
+     *
+     * Несекционированная таблица visits прежних версий переименовывается
+     * в visits_legacy: ее посещения учитываются в агрегатах, строки
+     * остаются на месте, и таблицу можно удалить вручную.
+     */
+    void Initialize() override {
+        ExecuteQuery(R"(CREATE TABLE IF NOT EXISTS visits_per_minute (
+                               minute BIGINT PRIMARY KEY,
+                               count BIGINT NOT NULL
+                               );
+                        DO $$
+                        BEGIN
+                            IF (SELECT relkind FROM pg_class
+                                 WHERE oid = to_regclass('visits')) = 'r' THEN
+                                ALTER TABLE visits RENAME TO visits_legacy;
+                                DROP TRIGGER IF EXISTS visits_counter_trigger ON visits_legacy;
+                                INSERT INTO visits_per_minute (minute, count)
+                                       SELECT floor(extract(epoch FROM time) / 60)::bigint,
+                                              COUNT(*)
+                                         FROM visits_legacy
+                                        WHERE time IS NOT NULL
+                                        GROUP BY 1
+                                       ON CONFLICT (minute) DO UPDATE
+                                       SET count = visits_per_minute.count + EXCLUDED.count;
+                            END IF;
+                        END;
+                        $$;
+                        DROP FUNCTION IF EXISTS visits_counter_increment();
+                        CREATE TABLE IF NOT EXISTS visits (
+                               id BIGSERIAL,
+                               time TIMESTAMP WITH TIME ZONE NOT NULL
+                               ) PARTITION BY RANGE (time);
+                        CREATE INDEX IF NOT EXISTS visits_time_brin ON visits USING BRIN (time);
+                        CREATE TABLE IF NOT EXISTS visits_counter (
+                               id SMALLINT PRIMARY KEY CHECK (id = 1),
+                               count BIGINT NOT NULL
+                               );
+                        INSERT INTO visits_counter (id, count)
+                               SELECT 1, COALESCE(SUM(count), 0) FROM visits_per_minute
+                               ON CONFLICT (id) DO NOTHING;)");
+        ExecuteQuery(R"(CREATE OR REPLACE FUNCTION visits_ensure_partition(visit_time TIMESTAMPTZ)
+                        RETURNS VOID AS $$
+                        DECLARE
+                            month_start TIMESTAMP := date_trunc('month', visit_time AT TIME ZONE 'UTC');
+                        BEGIN
+                            EXECUTE format(
+                                'CREATE TABLE IF NOT EXISTS %I PARTITION OF visits '
+                                'FOR VALUES FROM (%L) TO (%L)',
+                                'visits_' || to_char(month_start, 'YYYYMM'),
+                                month_start AT TIME ZONE 'UTC',
+                                (month_start + INTERVAL '1 month') AT TIME ZONE 'UTC');
+                        EXCEPTION WHEN duplicate_table THEN
+                            -- Раздел одновременно создал другой процесс
+                        END;
+                        $$ LANGUAGE plpgsql;
+                        CREATE OR REPLACE FUNCTION visits_drop_partitions(cutoff TIMESTAMPTZ)
+                        RETURNS INTEGER AS $$
+                        DECLARE
+                            part RECORD;
+                            dropped INTEGER := 0;
+                        BEGIN
+                            FOR part IN SELECT c.relname
+                                          FROM pg_inherits i
+                                          JOIN pg_class c ON c.oid = i.inhrelid
+                                         WHERE i.inhparent = 'visits'::regclass
+                                           AND c.relname ~ '^visits_[0-9]{6}$'
+                            LOOP
+                                IF to_date(substr(part.relname, 8), 'YYYYMM') + INTERVAL '1 month'
+                                       <= cutoff AT TIME ZONE 'UTC' THEN
+                                    EXECUTE format('DROP TABLE %I', part.relname);
+                                    dropped := dropped + 1;
+                                END IF;
+                            END LOOP;
+                            RETURN dropped;
+                        END;
+                        $$ LANGUAGE plpgsql;
+                        CREATE OR REPLACE FUNCTION visits_mark(
+                            visit_times BIGINT[], visit_minutes BIGINT[],
+                            visit_counts BIGINT[], retention_days INTEGER)
+                        RETURNS VOID AS $$
+                        DECLARE
+                            month_start TIMESTAMP;
+                            created BOOLEAN := FALSE;
+                        BEGIN
+                            FOR month_start IN
+                                SELECT DISTINCT date_trunc('month', to_timestamp(m * 60) AT TIME ZONE 'UTC')
+                                  FROM unnest(visit_minutes) AS m
+                            LOOP
+                                IF to_regclass('visits_' || to_char(month_start, 'YYYYMM')) IS NULL THEN
+                                    PERFORM visits_ensure_partition(month_start AT TIME ZONE 'UTC');
+                                    created := TRUE;
+                                END IF;
+                            END LOOP;
+                            INSERT INTO visits (time)
+                                   SELECT to_timestamp(t / 1000000.0) FROM unnest(visit_times) AS t;
+                            INSERT INTO visits_per_minute (minute, count)
+                                   SELECT m, c FROM unnest(visit_minutes, visit_counts) AS r(m, c)
+                                   ON CONFLICT (minute) DO UPDATE
+                                   SET count = visits_per_minute.count + EXCLUDED.count;
+                            UPDATE visits_counter SET count = count + cardinality(visit_times)
+                             WHERE id = 1;
+                            -- После вставки: раздел пакета старше срока хранения удаляется
+                            -- вместе с посещениями, агрегаты их учитывают
+                            IF created AND retention_days > 0 THEN
+                                PERFORM visits_drop_partitions(
+                                    NOW() - make_interval(days => retention_days));
+                            END IF;
+                        END;
+                        $$ LANGUAGE plpgsql;)");
+        ExecuteQuery(R"(CREATE TABLE IF NOT EXISTS peers (
+                               id TEXT PRIMARY KEY,
+                               endpoint TEXT NOT NULL,
+                               expires_at TIMESTAMP WITH TIME ZONE NOT NULL
+                               );)");
+        ExecuteQuery(R"(CREATE SEQUENCE IF NOT EXISTS messages_id_seq
+                               INCREMENT BY 1024;
+                        CREATE TABLE IF NOT EXISTS messages (
+                               room_id INTEGER NOT NULL,
+                               id BIGINT NOT NULL,
+                               author TEXT NOT NULL,
+                               body TEXT NOT NULL,
+                               time TIMESTAMP WITH TIME ZONE NOT NULL,
+                               PRIMARY KEY (room_id, id)
+                               );)");
+        // Раздел текущего месяца и заранее - следующего. Подготовленные
+        // запросы здесь не выполняются: первый ExecutePrepared() готовит все
+        // запросы сервиса сразу, и к этому моменту должны существовать все таблицы
+        ExecuteQuery(R"(SELECT visits_ensure_partition(NOW()),
+                               visits_ensure_partition(
+                                   (date_trunc('month', NOW() AT TIME ZONE 'UTC') +
+                                    INTERVAL '1 month') AT TIME ZONE 'UTC');)");
+    }
 
-    IDatabaseService() = default;
-    IDatabaseService(const IDatabaseService&) = delete;             ///< Запрет копирования
-    IDatabaseService& operator=(const IDatabaseService&) = delete;  ///< Запрет присваивания
-    IDatabaseService(IDatabaseService&&) = delete;                  ///< Запрет перемещения
-    IDatabaseService& operator=(
-        IDatabaseService&&) = delete;  ///< Запрет перемещающего присваивания
+    /**
+     * @brief Резервирует блок идентификаторов сообщений
+     *
+     * Последовательность messages_id_seq растет с шагом kMessageIdBlock,
+     * поэтому одно значение nextval() закрепляет за процессом весь блок.
+     *
+     * @return uint64_t Первый идентификатор блока
+     */
+    uint64_t ReserveMessageIds() override {
+        static_assert(kMessageIdBlock == 1024, "messages_id_seq uses INCREMENT BY 1024");
+        const pqxx::result res = ExecutePrepared(PreparedConnection::kReserveMessageIds);
+        return res[0][0].as<uint64_t>();
+    }
 
     /**
-     * @brief Инициализирует схему базы данных
+     * @brief Записывает пакет сообщений одной командой COPY
+     *
+     * COPY передает строки потоком без разбора и планирования INSERT на
+     * каждую строку; весь пакет - одна транзакция (групповая фиксация).
      *
-     * Создает необходимые таблицы и структуры данных.
-     * Должна быть вызвана перед началом работы с базой.
+     * @param messages Сообщения с назначенными идентификаторами
      */
-    virtual void Initialize() = 0;
+    void AppendMessages(const std::vector<ChatMessage>& messages) override {
+        if (messages.empty()) {
+            return;
+        }
+        WithConnection([&messages](PreparedConnection& conn) {
+            pqxx::work transaction(conn.conn);
+            pqxx::stream_to stream(
+                transaction, "messages",
+                std::vector<std::string>{"room_id", "id", "author", "body", "time"});
+            for (const ChatMessage& message : messages) {
+                stream << std::make_tuple(
+                    static_cast<int>(message.room), static_cast<int64_t>(message.id),
+                    message.author, message.text, FormatTimestamp(message.time));
+            }
+            stream.complete();
+            transaction.commit();
+            return pqxx::result();
+        });
+    }
 
     /**
-     * @brief Регистрирует новое посещение
+     * @brief Читает страницу истории комнаты по курсору
      *
-     * Добавляет запись о посещении с текущим временем в базу данных.
+     * Запрос идет по первичному ключу (room_id, id) в обратном порядке и
+     * останавливается после limit строк, поэтому стоимость страницы не
+     * зависит от ее глубины, в отличие от OFFSET.
+     *
+     * @param room Комната
+     * @param before_id Курсор: возвращаются сообщения с id меньше него
+     * @param limit Максимальное количество сообщений
+     * @return std::vector<ChatMessage> Сообщения от новых к старым
      */
-    virtual void MarkVisit() = 0;
+    std::vector<ChatMessage> GetMessages(
+        uint16_t room, uint64_t before_id, std::size_t limit) override {
+        const pqxx::result res = ExecutePrepared(
+            PreparedConnection::kGetMessages, static_cast<int>(room),
+            static_cast<int64_t>(std::min<uint64_t>(before_id, INT64_MAX)),
+            static_cast<int64_t>(limit));
+
+        std::vector<ChatMessage> messages;
+        messages.reserve(res.size());
+        for (const auto& row : res) {
+            messages.push_back(ChatMessage{
+                row[0].as<uint64_t>(), room, row[1].as<std::string>(), row[2].as<std::string>(),
+                std::chrono::system_clock::time_point(
+                    std::chrono::microseconds(row[3].as<int64_t>()))});
+        }
+        return messages;
+    }
 
     /**
-     * @brief Получает общее количество посещений
+     * @brief Загружает не истекшие регистрации пиров
      *
-     * @return uint64_t Общее число зарегистрированных посещений
+     * Заодно удаляет строки, истекшие, пока сервер не работал.
+     *
+     * @return std::vector<PeerRecord> Сохраненные регистрации
      */
-    virtual uint64_t GetCount() = 0;
-};
+    std::vector<PeerRecord> LoadPeers() override {
+        ExecuteQuery(R"(DELETE FROM peers WHERE expires_at <= NOW())");
+        const pqxx::result res = ExecutePrepared(PreparedConnection::kLoadPeers);
+
+        std::vector<PeerRecord> records;
+        records.reserve(res.size());
+        for (const auto& row : res) {
+            records.push_back(PeerRecord{
+                row[0].as<std::string>(), row[1].as<std::string>(),
+                std::chrono::system_clock::time_point(
+                    std::chrono::microseconds(row[2].as<int64_t>()))});
+        }
+        return records;
+    }
 
-/**
- * @brief Реализация сервиса базы данных для PostgreSQL
- *
- * Класс PostgresDatabase предоставляет конкретную реализацию
- * интерфейса IDatabaseService для работы с PostgreSQL.
- *
- * Особенности:
- * - Использует пул соединений для эффективной работы в многопоточной среде
- * - Автоматически создает необходимые таблицы при инициализации
- * - Поддерживает транзакции для обеспечения целостности данных
- * - Получает параметры подключения из конфигурации
- */
-class PostgresDatabase : public IDatabaseService {
-   public:
     /**
-     * @brief Конструктор с настройкой пула соединений
+     * @brief Записывает изменения реестра пиров одной транзакцией
      *
-     * @param num_connections Количество соединений в пуле (0 = использовать значение из
-     * конфигурации)
+     * Новые и продленные регистрации передаются подготовленному UPSERT
+     * тремя массивами, удаленные - одним массивом в DELETE, поэтому
+     * снимок любого размера - две команды.
      *
-     * Если num_connections равно 0, размер пула берется из конфигурации.
-     * Строка подключения всегда берется из конфигурации.
+     * @param changes Изменения с прошлого снимка
      */
-    explicit PostgresDatabase(uint64_t num_connections = 0)
-        : conn_pool_(
-              num_connections > 0 ? num_connections : GetConfig().GetConnectionPoolSize(),
-              GetConfig().GetDbConnString()) {
+    void SavePeers(const PeerChanges& changes) override {
+        if (changes.Empty()) {
+            return;
+        }
+
+        std::string ids = "{";
+        std::string endpoints = "{";
+        std::string expires = "{";
+        for (std::size_t i = 0; i < changes.upserts.size(); ++i) {
+            const PeerRecord& record = changes.upserts[i];
+            AppendArrayElement(ids, record.id, i == 0);
+            AppendArrayElement(endpoints, record.endpoint, i == 0);
+            if (i > 0) {
+                expires += ',';
+            }
+            expires += std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(
+                                          record.expires_at.time_since_epoch())
+                                          .count());
+        }
+        ids += '}';
+        endpoints += '}';
+        expires += '}';
+
+        std::string removed = "{";
+        for (std::size_t i = 0; i < changes.removed.size(); ++i) {
+            AppendArrayElement(removed, changes.removed[i], i == 0);
+        }
+        removed += '}';
+
+        WithConnection([&](PreparedConnection& conn) {
+            conn.EnsurePrepared();
+            pqxx::work transaction(conn.conn);
+            pqxx::result res;
+            if (!changes.upserts.empty()) {
+                res = transaction.exec_prepared(
+                    PreparedConnection::kUpsertPeers, ids, endpoints, expires);
+            }
+            if (!changes.removed.empty()) {
+                res = transaction.exec_prepared(PreparedConnection::kRemovePeers, removed);
+            }
+            transaction.commit();
+            return res;
+        });
     }
 
+   private:
     /**
-     * @brief Регистрирует посещение в базе данных
+     * @brief Форматирует момент времени для COPY в столбец TIMESTAMP WITH TIME ZONE
      *
-     * Вставляет новую запись в таблицу visits с текущим временем.
+     * @param time Момент времени
+     * @return std::string Время UTC вида "2025-01-31 12:00:00.123456+00"
      */
-    void MarkVisit() override {
-        ExecuteQuery(R"(INSERT INTO visits (time) VALUES (NOW()))");
+    static std::string FormatTimestamp(std::chrono::system_clock::time_point time) {
+        const auto micros =
+            std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+        const std::time_t seconds = static_cast<std::time_t>(micros / 1000000);
+        std::tm utc{};
+        gmtime_r(&seconds, &utc);
+        std::array<char, 40> buffer{};
+        const std::size_t size =
+            std::strftime(buffer.data(), buffer.size(), "%Y-%m-%d %H:%M:%S", &utc);
+        std::string result(buffer.data(), size);
+        const std::string fraction = std::to_string(1000000 + micros % 1000000);
+        result += '.';
+        result.append(fraction, 1, std::string::npos);
+        result += "+00";
+        return result;
     }
 
     /**
-     * @brief Получает общее количество посещений
+     * @brief Дописывает элемент в литерал текстового массива PostgreSQL
      *
-     * @return uint64_t Количество записей в таблице visits
+     * Элемент заключается в кавычки, кавычки и обратные слэши экранируются.
+     *
+     * @param literal Литерал массива
+     * @param value Значение элемента
+     * @param first Первый ли это элемент (без разделителя)
      */
-    uint64_t GetCount() override {
-        auto res = ExecuteQuery(R"(SELECT COUNT(*) FROM visits)");
-        return res[0][0].as<uint64_t>();
+    static void AppendArrayElement(std::string& literal, std::string_view value, bool first) {
+        if (!first) {
+            literal += ',';
+        }
+        literal += '"';
+        for (const char c : value) {
+            if (c == '"' || c == '\\') {
+                literal += '\\';
+            }
+            literal += c;
+        }
+        literal += '"';
     }
 
     /**
-     * @brief Инициализирует схему базы данных
+     * @brief Собирает параметры пула соединений из конфигурации
      *
-     * Создает таблицу visits для хранения информации о посещениях,
-     * если она еще не существует. Таблица содержит:
-     * - id: автоинкрементный первичный ключ
-     * - time: временная метка посещения с часовым поясом
+     * @param num_connections Максимальный размер пула (0 = CONNECTION_POOL_SIZE)
+     * @return ConnectionPoolOptions Параметры пула
      */
-    void Initialize() override {
-        ExecuteQuery(R"(CREATE TABLE IF NOT EXISTS visits (
-                               id SERIAL PRIMARY KEY,
-                               time TIMESTAMP WITH TIME ZONE
-                               );)");
+    static ConnectionPoolOptions MakePoolOptions(uint64_t num_connections) {
+        const auto& config = GetConfig();
+        ConnectionPoolOptions options;
+        options.max_size = num_connections > 0
+                               ? num_connections
+                               : static_cast<uint64_t>(config.GetConnectionPoolSize());
+        options.min_size = static_cast<uint64_t>(config.GetDbPoolMinSize());
+        options.idle_timeout = std::chrono::milliseconds(config.GetDbPoolIdleTimeoutMs());
+        options.max_backoff = std::chrono::milliseconds(config.GetDbReconnectBackoffMs());
+        return options;
+    }
+
+    /**
+     * @brief Выполняет подготовленный запрос без явной транзакции
+     *
+     * Запрос - одна команда, поэтому pqxx::nontransaction (autocommit)
+     * сохраняет атомарность и экономит BEGIN/COMMIT. Текст запроса не
+     * разбирается и не планируется сервером повторно.
+     *
+     * @param name Имя подготовленного запроса PreparedConnection
+     * @param args Параметры запроса
+     * @return pqxx::result Результат выполнения запроса
+     * @throws DatabaseUnavailableError см. WithConnection()
+     */
+    template <typename... Args>
+    pqxx::result ExecutePrepared(const char* name, const Args&... args) {
+        return WithConnection([&](PreparedConnection& conn) {
+            conn.EnsurePrepared();
+            pqxx::nontransaction transaction(conn.conn);
+            pqxx::result res = transaction.exec_prepared(name, args...);
+            transaction.commit();
+            return res;
+        });
     }
 
-   private:
     /**
      * @brief Выполняет SQL запрос с использованием транзакции
      *
@@ -278,13 +634,40 @@ class PostgresDatabase : public IDatabaseService {
      *
      * @param query SQL запрос для выполнения
      * @return pqxx::result Результат выполнения запроса
+     * @throws DatabaseUnavailableError см. WithConnection()
      */
     pqxx::result ExecuteQuery(const std::string& query) {
-        auto conn = conn_pool_.Acquire();                  // Получаем соединение из пула
-        pqxx::work transaction(*conn);                     // Создаем транзакцию
-        const pqxx::result res = transaction.exec(query);  // Выполняем запрос
-        transaction.commit();                              // Подтверждаем транзакцию
-        return res;
+        return WithConnection([&query](PreparedConnection& conn) {
+            pqxx::work transaction(conn.conn);                 // Создаем транзакцию
+            const pqxx::result res = transaction.exec(query);  // Выполняем запрос
+            transaction.commit();                              // Подтверждаем транзакцию
+            return res;
+        });
+    }
+
+    /**
+     * @brief Выполняет действие с соединением из пула
+     *
+     * Время ожидания соединения читается из текущего снимка конфигурации,
+     * поэтому меняется перезагрузкой без перезапуска.
+     *
+     * @param body Функция, принимающая PreparedConnection&
+     * @return pqxx::result Результат body
+     * @throws DatabaseUnavailableError если свободное соединение не появилось
+     *         за DB_ACQUIRE_TIMEOUT_MS, пул ждет переподключения или соединение
+     *         с сервером разорвано
+     */
+    template <typename Body>
+    pqxx::result WithConnection(Body&& body) {
+        try {
+            // Получаем соединение из пула
+            auto conn = conn_pool_.Acquire(GetConfigSnapshot().db_acquire_timeout);
+            return body(*conn);
+        } catch (const ConnectionPoolUnavailable& e) {
+            throw DatabaseUnavailableError(e.what());
+        } catch (const pqxx::broken_connection& e) {
+            throw DatabaseUnavailableError(e.what());
+        }
     }
 
     ConnectionPool conn_pool_;  ///< Пул соединений с базой данных
@@ -0,0 +1,194 @@
+#pragma once
+
+#include "visit_histogram.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Исключение: база данных временно недоступна или перегружена
+ *
+ * Выбрасывается реализациями IDatabaseService, когда запрос не может быть
+ * выполнен в разумное время (нет свободного соединения, соединение разорвано).
+ * HTTP сессия отвечает на него кодом 503 вместо ожидания.
+ */
+class DatabaseUnavailableError : public std::runtime_error {
+   public:
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * @brief Сообщение комнаты чата в хранилище
+ */
+struct ChatMessage {
+    uint64_t id = 0;                              ///< Идентификатор, растущий со временем
+    uint16_t room = 0;                            ///< Комната (канал протокола чата)
+    std::string author;                           ///< Имя отправителя
+    std::string text;                             ///< Текст сообщения
+    std::chrono::system_clock::time_point time;  ///< Время отправки
+};
+
+/**
+ * @brief Абстрактный интерфейс для работы с базой данных
+ *
+ * Интерфейс IDatabaseService определяет основные операции для работы
+ * с базой данных в рамках приложения P2P чата:
+ * - Инициализация схемы базы данных
+ * - Регистрация посещений (по одному и пакетами)
+ * - Подсчет общего количества посещений и посещений по интервалам времени
+ * - Хранение сообщений чата и постраничное чтение истории комнат
+ *
+ * Применяет правило пяти с запретом копирования и перемещения.
+ */
+class IDatabaseService {
+   public:
+    virtual ~IDatabaseService() = default;
+
+    IDatabaseService() = default;
+    IDatabaseService(const IDatabaseService&) = delete;             ///< Запрет копирования
+    IDatabaseService& operator=(const IDatabaseService&) = delete;  ///< Запрет присваивания
+    IDatabaseService(IDatabaseService&&) = delete;                  ///< Запрет перемещения
+    IDatabaseService& operator=(
+        IDatabaseService&&) = delete;  ///< Запрет перемещающего присваивания
+
+    /**
+     * @brief Инициализирует схему базы данных
+     *
+     * Создает необходимые таблицы и структуры данных.
+     * Должна быть вызвана перед началом работы с базой.
+     */
+    virtual void Initialize() = 0;
+
+    /**
+     * @brief Регистрирует новое посещение
+     *
+     * Добавляет запись о посещении с текущим временем в базу данных.
+     */
+    virtual void MarkVisit() = 0;
+
+    /**
+     * @brief Регистрирует пакет посещений
+     *
+     * Реализация по умолчанию вызывает MarkVisit() для каждого посещения.
+     * Хранилища, умеющие пакетную вставку, должны переопределить метод,
+     * чтобы записать весь пакет за одну транзакцию.
+     *
+     * @param times Временные метки посещений
+     */
+    virtual void MarkVisits(const std::vector<std::chrono::system_clock::time_point>& times) {
+        for (std::size_t i = 0; i < times.size(); ++i) {
+            MarkVisit();
+        }
+    }
+
+    /**
+     * @brief Получает общее количество посещений
+     *
+     * @return uint64_t Общее число зарегистрированных посещений
+     */
+    virtual uint64_t GetCount() = 0;
+
+    /**
+     * @brief Получает количество посещений по интервалам времени
+     *
+     * Реализация по умолчанию сообщает, что хранилище не ведет аналитику.
+     *
+     * @param from Начало периода (включительно, округляется вниз до интервала)
+     * @param to Конец периода (не включительно)
+     * @param granularity Размер интервала
+     * @return std::vector<VisitBucket> Непустые интервалы в порядке возрастания
+     * @throws DatabaseUnavailableError если аналитика не поддерживается
+     */
+    virtual std::vector<VisitBucket> GetVisitCounts(
+        [[maybe_unused]] std::chrono::system_clock::time_point from,
+        [[maybe_unused]] std::chrono::system_clock::time_point to,
+        [[maybe_unused]] VisitGranularity granularity) {
+        throw DatabaseUnavailableError("visit analytics is not supported");
+    }
+
+    /// Количество идентификаторов сообщений, резервируемых ReserveMessageIds()
+    static constexpr uint64_t kMessageIdBlock = 1024;
+
+    /**
+     * @brief Резервирует блок идентификаторов сообщений
+     *
+     * Идентификаторы назначаются в процессе до записи, чтобы сообщение
+     * сразу попадало в кеш истории и пакет записи. Блоки разных процессов
+     * не пересекаются.
+     *
+     * Реализация по умолчанию сообщает, что хранилище не поддерживает сообщения.
+     *
+     * @return uint64_t Первый из kMessageIdBlock идентификаторов блока
+     * @throws DatabaseUnavailableError если сообщения не хранятся
+     */
+    virtual uint64_t ReserveMessageIds() {
+        throw DatabaseUnavailableError("message storage is not supported");
+    }
+
+    /**
+     * @brief Записывает пакет сообщений
+     *
+     * @param messages Сообщения с назначенными идентификаторами
+     * @throws DatabaseUnavailableError если сообщения не хранятся
+     */
+    virtual void AppendMessages(const std::vector<ChatMessage>& messages) {
+        if (!messages.empty()) {
+            throw DatabaseUnavailableError("message storage is not supported");
+        }
+    }
+
+    /**
+     * @brief Читает страницу истории комнаты
+     *
+     * @param room Комната
+     * @param before_id Курсор: возвращаются сообщения с id меньше него
+     * @param limit Максимальное количество сообщений
+     * @return std::vector<ChatMessage> Сообщения от новых к старым
+     * @throws DatabaseUnavailableError если сообщения не хранятся
+     */
+    virtual std::vector<ChatMessage> GetMessages(
+        [[maybe_unused]] uint16_t room, [[maybe_unused]] uint64_t before_id,
+        [[maybe_unused]] std::size_t limit) {
+        throw DatabaseUnavailableError("message storage is not supported");
+    }
+};
+
+/**
+ * @brief Асинхронный источник страниц истории комнат
+ *
+ * Реализация читает страницу, не блокируя вызывающий поток, и вызывает
+ * callback в своем потоке. Ошибка передается как исключение
+ * (DatabaseUnavailableError), как и в IDatabaseService::GetMessages().
+ *
+ * Применяет правило пяти с запретом копирования и перемещения.
+ */
+class IHistoryReader {
+   public:
+    /// Обработчик результата: ошибка или сообщения от новых к старым
+    using Callback = std::function<void(std::exception_ptr, std::vector<ChatMessage>)>;
+
+    virtual ~IHistoryReader() = default;
+
+    IHistoryReader() = default;
+    IHistoryReader(const IHistoryReader&) = delete;             ///< Запрет копирования
+    IHistoryReader& operator=(const IHistoryReader&) = delete;  ///< Запрет присваивания
+    IHistoryReader(IHistoryReader&&) = delete;                  ///< Запрет перемещения
+    IHistoryReader& operator=(IHistoryReader&&) = delete;  ///< Запрет перемещающего присваивания
+
+    /**
+     * @brief Начинает чтение страницы истории комнаты
+     *
+     * @param room Комната
+     * @param before_id Курсор: возвращаются сообщения с id меньше него
+     * @param limit Максимальное количество сообщений
+     * @param callback Обработчик результата, вызывается ровно один раз
+     */
+    virtual void ReadMessages(
+        uint16_t room, uint64_t before_id, std::size_t limit, Callback callback) = 0;
+};
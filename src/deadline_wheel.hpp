@@ -0,0 +1,287 @@
+#pragma once
+
+#include "timer_wheel.hpp"
+
+#include <boost/asio/execution/context.hpp>
+#include <boost/asio/execution_context.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/query.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+class DeadlineWheel;
+
+/**
+ * @brief Объект со сроком, который отслеживает DeadlineWheel
+ *
+ * Класс DeadlineTarget хранит один срок в виде атомарного числа:
+ * ArmDeadline() лишь записывает новый срок и обращается к колесу,
+ * только если таймера в нем еще нет. Поэтому продление срока на каждом
+ * чтении стоит одну атомарную запись, без таймера asio и без выделения
+ * памяти на сессию.
+ *
+ * Когда срок истекает, колесо вызывает OnDeadline() из своего strand;
+ * наследник сам переходит на свой executor (обычно чтобы закрыть сокет).
+ *
+ * Объект должен принадлежать std::shared_ptr: колесо хранит weak_ptr
+ * и не продлевает жизнь объекта.
+ */
+class DeadlineTarget {
+   public:
+    using Clock = std::chrono::steady_clock;  ///< Часы сроков
+
+    virtual ~DeadlineTarget() {
+        ForgetDeadline();
+    }
+
+    DeadlineTarget(const DeadlineTarget&) = delete;             ///< Запрет копирования
+    DeadlineTarget& operator=(const DeadlineTarget&) = delete;  ///< Запрет присваивания
+    DeadlineTarget(DeadlineTarget&&) = delete;                  ///< Запрет перемещения
+    DeadlineTarget& operator=(DeadlineTarget&&) = delete;  ///< Запрет перемещающего присваивания
+
+   protected:
+    DeadlineTarget() = default;
+
+    /**
+     * @brief Вызывается колесом из его strand, когда срок истек
+     */
+    virtual void OnDeadline() = 0;
+
+    /**
+     * @brief Слабый указатель на этот объект, который хранит колесо
+     */
+    virtual std::weak_ptr<DeadlineTarget> DeadlineOwner() = 0;
+
+    /**
+     * @brief Устанавливает срок через timeout от текущего момента
+     *
+     * @tparam Executor Executor на io_context
+     * @param executor Executor объекта; срок отслеживает колесо его io_context
+     * @param timeout Время до срока (не больше нуля - срок снимается)
+     */
+    template <typename Executor>
+    void ArmDeadline(const Executor& executor, Clock::duration timeout);
+
+    /**
+     * @brief Снимает срок; таймер в колесе будет отброшен при срабатывании
+     */
+    void DisarmDeadline() {
+        deadline_.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Снимает срок и отвязывает объект от таймера в колесе
+     *
+     * Вызывается при уничтожении и перед переиспользованием объекта для
+     * нового соединения: старый таймер колеса указывает на прежний
+     * управляющий блок shared_ptr и будет отброшен.
+     */
+    inline void ForgetDeadline();
+
+   private:
+    friend class DeadlineWheel;
+
+    std::atomic<int64_t> deadline_{0};  ///< Срок в тиках Clock (0 - срок не установлен)
+    std::atomic<bool> queued_{false};   ///< Есть ли таймер объекта в колесе
+    DeadlineWheel* wheel_ = nullptr;    ///< Колесо, в котором стоит таймер
+};
+
+/**
+ * @brief Общее колесо сроков сессий одного io_context
+ *
+ * Сервис asio, создаваемый на io_context при первом use_service():
+ * все сессии контекста делят одно TimerWheel и один steady_timer, который
+ * тикает с шагом kTick, пока в колесе есть таймеры живых объектов.
+ * Когда таймеров не осталось, тик останавливается и не держит
+ * io_context::run().
+ *
+ * Точность сроков - один тик: срок срабатывает не раньше заданного и не
+ * позже чем через kTick после него.
+ */
+class DeadlineWheel : public boost::asio::execution_context::service {
+   public:
+    using Clock = DeadlineTarget::Clock;  ///< Часы сроков
+    using key_type = DeadlineWheel;       ///< Ключ сервиса asio
+
+    static constexpr Clock::duration kTick = std::chrono::milliseconds(50);  ///< Шаг колеса
+    static constexpr std::size_t kSlots = 1024;  ///< Ячеек колеса (оборот ~51 с)
+
+    static inline boost::asio::execution_context::id id;  ///< Идентификатор сервиса asio
+
+    /**
+     * @brief Конструктор сервиса (вызывается asio из use_service)
+     *
+     * @param context Контекст, на котором тикает колесо
+     */
+    explicit DeadlineWheel(boost::asio::io_context& context)
+        : service(context), strand_(boost::asio::make_strand(context)), timer_(strand_) {
+    }
+
+    /**
+     * @brief Количество объектов, для которых в колесе стоит таймер
+     */
+    [[nodiscard]] std::size_t Size() {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        return live_;
+    }
+
+   private:
+    friend class DeadlineTarget;
+
+    using Key = std::weak_ptr<DeadlineTarget>;                                   ///< Ключ таймера
+    using Targets = std::vector<std::shared_ptr<DeadlineTarget>>;                ///< Объекты тика
+    using Strand = boost::asio::strand<boost::asio::io_context::executor_type>;  ///< Strand колеса
+
+    /**
+     * @brief Ставит таймер объекта и запускает тик, если он остановлен
+     */
+    void Schedule(Key key, int64_t deadline) {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        ++live_;
+        wheel_.Schedule(std::move(key), ToTime(deadline));
+        if (!ticking_) {
+            ticking_ = true;
+            boost::asio::post(strand_, [this] { Tick(); });
+        }
+    }
+
+    /**
+     * @brief Учитывает объект, который больше не ждет своего таймера
+     */
+    void Forget() {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        --live_;
+    }
+
+    /**
+     * @brief Обрабатывает завершившиеся тики и ждет следующего
+     *
+     * Для каждого сработавшего таймера живого объекта:
+     * - срок снят - таймер отбрасывается
+     * - срок сдвинут вперед - таймер ставится на новый срок
+     * - срок истек - срок снимается и вызывается OnDeadline()
+     *
+     * Объекты удерживаются до выхода из-под мьютекса: деструктор
+     * объекта сам обращается к колесу.
+     */
+    void Tick() {
+        {
+            const std::lock_guard<std::mutex> lock(mutex_);
+            if (live_ == 0) {
+                // Остались только таймеры уничтоженных объектов
+                wheel_ = TimerWheel<Key>(kTick, kSlots);
+                ticking_ = false;
+                return;
+            }
+            const Clock::time_point now = Clock::now();
+            wheel_.Advance(now, [this, now](Key key) {
+                std::shared_ptr<DeadlineTarget> target = key.lock();
+                if (!target) {
+                    return;
+                }
+                int64_t deadline = target->deadline_.load(std::memory_order_relaxed);
+                while (deadline != 0 && ToTime(deadline) <= now &&
+                       !target->deadline_.compare_exchange_weak(
+                           deadline, 0, std::memory_order_relaxed)) {
+                }
+                if (deadline != 0 && ToTime(deadline) > now) {
+                    wheel_.Schedule(std::move(key), ToTime(deadline));
+                    held_.push_back(std::move(target));
+                    return;
+                }
+                Unqueue(*target, std::move(key));
+                if (deadline != 0) {
+                    expired_.push_back(std::move(target));
+                } else {
+                    held_.push_back(std::move(target));
+                }
+            });
+        }
+        for (const auto& target : expired_) {
+            target->OnDeadline();
+        }
+        expired_.clear();
+        held_.clear();
+
+        timer_.expires_after(kTick);
+        timer_.async_wait([this](boost::system::error_code ec) {
+            if (!ec) {
+                Tick();
+            }
+        });
+    }
+
+    /**
+     * @brief Убирает объект из колеса (под мьютексом)
+     *
+     * Если объект успел установить новый срок, пока таймер считался
+     * стоящим в колесе, таймер ставится заново.
+     */
+    void Unqueue(DeadlineTarget& target, Key key) {
+        if (!target.queued_.exchange(false, std::memory_order_acq_rel)) {
+            return;
+        }
+        const int64_t deadline = target.deadline_.load(std::memory_order_relaxed);
+        if (deadline != 0 && !target.queued_.exchange(true, std::memory_order_acq_rel)) {
+            wheel_.Schedule(std::move(key), ToTime(deadline));
+            return;
+        }
+        --live_;
+    }
+
+    /**
+     * @brief Срок из атомарного представления
+     */
+    static Clock::time_point ToTime(int64_t deadline) {
+        return Clock::time_point(Clock::duration(deadline));
+    }
+
+    /**
+     * @brief Останавливает сервис при уничтожении io_context
+     */
+    void shutdown() override {
+    }
+
+    Strand strand_;                         ///< Strand тика
+    boost::asio::steady_timer timer_;       ///< Таймер тика
+    TimerWheel<Key> wheel_{kTick, kSlots};  ///< Таймеры объектов
+    Targets expired_;                       ///< Объекты тика с истекшим сроком
+    Targets held_;                          ///< Прочие объекты тика
+    std::size_t live_ = 0;                  ///< Объекты с таймером в колесе
+    bool ticking_ = false;                  ///< Запущен ли тик
+    std::mutex mutex_;                      ///< Защищает wheel_, live_ и ticking_
+};
+
+template <typename Executor>
+void DeadlineTarget::ArmDeadline(const Executor& executor, Clock::duration timeout) {
+    if (timeout <= Clock::duration::zero()) {
+        DisarmDeadline();
+        return;
+    }
+    const int64_t deadline = (Clock::now() + timeout).time_since_epoch().count();
+    deadline_.store(deadline, std::memory_order_relaxed);
+    if (!queued_.exchange(true, std::memory_order_acq_rel)) {
+        auto& context = static_cast<boost::asio::io_context&>(
+            boost::asio::query(executor, boost::asio::execution::context));
+        wheel_ = &boost::asio::use_service<DeadlineWheel>(context);
+        wheel_->Schedule(DeadlineOwner(), deadline);
+    }
+}
+
+inline void DeadlineTarget::ForgetDeadline() {
+    DisarmDeadline();
+    if (queued_.exchange(false, std::memory_order_acq_rel)) {
+        wheel_->Forget();
+    }
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Память для повторного использования обработчиками asio
+ *
+ * Класс HandlerMemory хранит небольшой выровненный блок внутри объекта
+ * (например, сессии). Асинхронная операция, чей обработчик обернут через
+ * MakeCustomAllocHandler, размещает свое состояние в этом блоке вместо кучи.
+ * Одновременно блок может использовать только одна операция; если блок
+ * занят или слишком мал, память выделяется обычным operator new.
+ */
+class HandlerMemory {
+   public:
+    HandlerMemory() = default;
+    ~HandlerMemory() = default;
+    HandlerMemory(const HandlerMemory&) = delete;             ///< Запрет копирования
+    HandlerMemory& operator=(const HandlerMemory&) = delete;  ///< Запрет присваивания
+    HandlerMemory(HandlerMemory&&) = delete;                  ///< Запрет перемещения
+    HandlerMemory& operator=(HandlerMemory&&) = delete;       ///< Запрет перемещающего присваивания
+
+    /**
+     * @brief Выделяет память для состояния операции
+     *
+     * @param size Требуемый размер в байтах
+     * @return void* Указатель на внутренний блок или на память из кучи
+     */
+    void* Allocate(std::size_t size) {
+        if (!in_use_ && size <= storage_.size()) {
+            in_use_ = true;
+            return storage_.data();
+        }
+        return ::operator new(size);
+    }
+
+    /**
+     * @brief Освобождает память, выделенную через Allocate()
+     *
+     * @param pointer Указатель, полученный от Allocate()
+     */
+    void Deallocate(void* pointer) {
+        if (pointer == storage_.data()) {
+            in_use_ = false;
+        } else {
+            ::operator delete(pointer);
+        }
+    }
+
+   private:
+    /// Размер блока: с запасом вмещает операции чтения/записи сокета с обработчиком
+    static constexpr std::size_t kStorageSize = 1024;
+
+    alignas(std::max_align_t) std::array<unsigned char, kStorageSize> storage_{};  ///< Блок памяти
+    bool in_use_ = false;  ///< Занят ли блок операцией
+};
+
+/**
+ * @brief Аллокатор, выделяющий память из HandlerMemory
+ *
+ * Удовлетворяет требованиям стандартного аллокатора и используется asio
+ * через associated_allocator обработчика.
+ *
+ * @tparam T Тип выделяемых объектов
+ */
+template <typename T>
+class HandlerAllocator {
+   public:
+    using value_type = T;
+
+    /**
+     * @brief Конструктор аллокатора
+     *
+     * @param memory Память, из которой выделяются блоки
+     */
+    explicit HandlerAllocator(HandlerMemory& memory) : memory_(&memory) {
+    }
+
+    /**
+     * @brief Конструктор преобразования для rebind
+     */
+    template <typename U>
+    HandlerAllocator(const HandlerAllocator<U>& other) noexcept  // NOLINT(google-explicit-constructor)
+        : memory_(other.memory_) {
+    }
+
+    /**
+     * @brief Выделяет память для n объектов типа T
+     */
+    T* allocate(std::size_t n) const {
+        return static_cast<T*>(memory_->Allocate(sizeof(T) * n));
+    }
+
+    /**
+     * @brief Освобождает память, выделенную через allocate()
+     */
+    void deallocate(T* pointer, std::size_t /*n*/) const {
+        memory_->Deallocate(pointer);
+    }
+
+    template <typename U>
+    bool operator==(const HandlerAllocator<U>& other) const noexcept {
+        return memory_ == other.memory_;
+    }
+
+    template <typename U>
+    bool operator!=(const HandlerAllocator<U>& other) const noexcept {
+        return memory_ != other.memory_;
+    }
+
+   private:
+    template <typename>
+    friend class HandlerAllocator;
+
+    HandlerMemory* memory_;  ///< Память для выделения
+};
+
+/**
+ * @brief Обертка обработчика с собственным аллокатором
+ *
+ * Объявляет allocator_type и get_allocator(), благодаря чему
+ * boost::asio::associated_allocator возвращает HandlerAllocator
+ * и состояние операции размещается в HandlerMemory.
+ *
+ * @tparam Handler Тип оборачиваемого обработчика
+ */
+template <typename Handler>
+class CustomAllocHandler {
+   public:
+    using allocator_type = HandlerAllocator<Handler>;
+
+    /**
+     * @brief Конструктор обертки
+     *
+     * @param memory Память для операции
+     * @param handler Оборачиваемый обработчик
+     */
+    CustomAllocHandler(HandlerMemory& memory, Handler handler)
+        : memory_(memory), handler_(std::move(handler)) {
+    }
+
+    /**
+     * @brief Возвращает аллокатор для состояния операции
+     */
+    allocator_type get_allocator() const noexcept {  // NOLINT(readability-identifier-naming)
+        return allocator_type(memory_);
+    }
+
+    /**
+     * @brief Вызывает обернутый обработчик
+     */
+    template <typename... Args>
+    void operator()(Args&&... args) {
+        handler_(std::forward<Args>(args)...);
+    }
+
+   private:
+    HandlerMemory& memory_;  ///< Память для операции
+    Handler handler_;        ///< Обернутый обработчик
+};
+
+/**
+ * @brief Оборачивает обработчик так, чтобы его операция использовала HandlerMemory
+ *
+ * @param memory Память для операции (должна жить дольше операции)
+ * @param handler Обработчик завершения
+ * @return CustomAllocHandler Обертка обработчика
+ */
+template <typename Handler>
+inline CustomAllocHandler<std::decay_t<Handler>> MakeCustomAllocHandler(
+    HandlerMemory& memory, Handler&& handler) {
+    return CustomAllocHandler<std::decay_t<Handler>>(memory, std::forward<Handler>(handler));
+}
@@ -0,0 +1,489 @@
+#pragma once
+
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <system_error>
+
+/**
+ * @brief Заголовок HTTP запроса
+ *
+ * Имя и значение указывают прямо в буфер чтения сессии.
+ */
+struct HttpHeader {
+    std::string_view name;   ///< Имя заголовка
+    std::string_view value;  ///< Значение без начальных и конечных пробелов
+};
+
+/**
+ * @brief Разобранный HTTP запрос
+ *
+ * Все строки - string_view в буфер чтения, поэтому запрос действителен,
+ * пока данные запроса не сдвинуты и не перезаписаны в буфере.
+ */
+struct HttpRequest {
+    static constexpr std::size_t kMaxHeaders = 32;  ///< Максимум заголовков в запросе
+
+    std::string_view method;                         ///< Метод запроса (GET, POST, ...)
+    std::string_view target;                         ///< Цель запроса (путь и query)
+    std::string_view version;                        ///< Версия протокола (HTTP/1.1)
+    std::array<HttpHeader, kMaxHeaders> headers;     ///< Заголовки
+    std::size_t header_count = 0;                    ///< Количество заголовков
+
+    /**
+     * @brief Сравнивает ASCII строки без учета регистра
+     */
+    static bool EqualsIgnoreCase(std::string_view lhs, std::string_view rhs) {
+        if (lhs.size() != rhs.size()) {
+            return false;
+        }
+        for (std::size_t i = 0; i < lhs.size(); ++i) {
+            if (ToLower(lhs[i]) != ToLower(rhs[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Проверяет, содержит ли строка подстроку без учета регистра
+     */
+    static bool ContainsIgnoreCase(std::string_view haystack, std::string_view needle) {
+        if (needle.size() > haystack.size()) {
+            return false;
+        }
+        for (std::size_t i = 0; i + needle.size() <= haystack.size(); ++i) {
+            if (EqualsIgnoreCase(haystack.substr(i, needle.size()), needle)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Ищет заголовок по имени без учета регистра
+     *
+     * @param name Имя заголовка
+     * @return std::string_view Значение первого найденного заголовка или пустая строка
+     */
+    [[nodiscard]] std::string_view Header(std::string_view name) const {
+        for (std::size_t i = 0; i < header_count; ++i) {
+            if (EqualsIgnoreCase(headers[i].name, name)) {
+                return headers[i].value;
+            }
+        }
+        return {};
+    }
+
+    /**
+     * @brief Путь запроса без query-строки
+     */
+    [[nodiscard]] std::string_view Path() const {
+        return target.substr(0, target.find('?'));
+    }
+
+    /**
+     * @brief Query-строка запроса без '?' (пустая, если ее нет)
+     */
+    [[nodiscard]] std::string_view Query() const {
+        const std::size_t question = target.find('?');
+        return question == std::string_view::npos ? std::string_view() : target.substr(question + 1);
+    }
+
+    /**
+     * @brief Значение параметра query-строки без декодирования
+     *
+     * @param query Query-строка (см. Query())
+     * @param name Имя параметра
+     * @return std::string_view Значение первого параметра с этим именем или пустая строка
+     */
+    static std::string_view QueryParam(std::string_view query, std::string_view name) {
+        while (!query.empty()) {
+            const std::size_t amp = query.find('&');
+            const std::string_view pair = query.substr(0, amp);
+            const std::size_t eq = pair.find('=');
+            if (pair.substr(0, eq) == name) {
+                return eq == std::string_view::npos ? std::string_view() : pair.substr(eq + 1);
+            }
+            if (amp == std::string_view::npos) {
+                break;
+            }
+            query.remove_prefix(amp + 1);
+        }
+        return {};
+    }
+
+    /**
+     * @brief Определяет, нужно ли сохранить соединение после ответа
+     *
+     * Для HTTP/1.1 соединение постоянное, если нет "Connection: close",
+     * для HTTP/1.0 - только при "Connection: keep-alive".
+     */
+    [[nodiscard]] bool KeepAlive() const {
+        const std::string_view connection = Header("Connection");
+        if (version == "HTTP/1.1") {
+            return !ContainsIgnoreCase(connection, "close");
+        }
+        return ContainsIgnoreCase(connection, "keep-alive");
+    }
+
+    /**
+     * @brief Длина тела запроса по заголовку Content-Length
+     *
+     * Значение проверено разборщиком (HttpRequestParser отклоняет
+     * запросы с некорректным Content-Length).
+     *
+     * @return uint64_t Длина тела или 0, если заголовок отсутствует
+     */
+    [[nodiscard]] uint64_t ContentLength() const {
+        uint64_t length = 0;
+        ParseContentLength(Header("Content-Length"), length);
+        return length;
+    }
+
+    /**
+     * @brief Разбирает значение Content-Length
+     *
+     * Допускаются только десятичные цифры (RFC 9110, 1*DIGIT) без
+     * переполнения uint64_t.
+     *
+     * @param value Значение заголовка без окружающих пробелов
+     * @param length Сюда записывается длина
+     * @return true если значение корректно
+     */
+    static bool ParseContentLength(std::string_view value, uint64_t& length) {
+        if (value.empty() || value.front() < '0' || value.front() > '9') {
+            return false;
+        }
+        const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), length);
+        return ec == std::errc() && ptr == value.data() + value.size();
+    }
+
+    /**
+     * @brief Использует ли запрос Transfer-Encoding (тело неизвестной длины)
+     */
+    [[nodiscard]] bool HasTransferEncoding() const {
+        return !Header("Transfer-Encoding").empty();
+    }
+
+   private:
+    static char ToLower(char c) {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+};
+
+/**
+ * @brief Инкрементальный разборщик заголовков HTTP запроса
+ *
+ * Класс HttpRequestParser - конечный автомат, который разбирает строку
+ * запроса и заголовки прямо в буфере чтения без копирования:
+ * - Parse() можно вызывать повторно по мере поступления данных; разбор
+ *   продолжается с места остановки, уже просмотренные байты повторно не сканируются
+ * - Конец строки распознается как "\r\n" или одиночный "\n"
+ * - Некорректный или повторенный с другим значением Content-Length -
+ *   kBadRequest: иначе граница тела у сервера и у прокси перед ним
+ *   может различаться (request smuggling)
+ * - Результат содержит string_view в переданный буфер
+ *
+ * Буфер между вызовами Parse() должен содержать те же данные с того же
+ * начала (допускается только дописывание новых байтов в конец).
+ */
+class HttpRequestParser {
+   public:
+    /**
+     * @brief Результат разбора
+     */
+    enum class Status {
+        kIncomplete,       ///< Нужны еще данные
+        kComplete,         ///< Заголовки запроса разобраны полностью
+        kBadRequest,       ///< Синтаксическая ошибка
+        kHeadersTooLarge,  ///< Слишком много заголовков
+    };
+
+    /**
+     * @brief Продолжает разбор запроса
+     *
+     * @param data Все доступные байты, начиная с первого байта запроса
+     * @return Status Состояние разбора
+     */
+    Status Parse(std::string_view data) {
+        if (state_ == State::kDone) {
+            return status_;
+        }
+        while (position_ < data.size()) {
+            const char c = data[position_];
+            switch (state_) {
+                case State::kMethod:
+                    if (c == ' ') {
+                        if (position_ == token_start_) {
+                            return Fail();
+                        }
+                        method_ = {token_start_, position_ - token_start_};
+                        token_start_ = position_ + 1;
+                        state_ = State::kTarget;
+                    } else if (!IsTokenChar(c)) {
+                        return Fail();
+                    }
+                    break;
+                case State::kTarget: {
+                    // Быстрый поиск конца цели запроса
+                    const std::size_t space = data.find(' ', position_);
+                    if (space == std::string_view::npos) {
+                        if (HasLineBreak(data, position_, data.size())) {
+                            return Fail();
+                        }
+                        position_ = data.size();
+                        return Status::kIncomplete;
+                    }
+                    if (space == token_start_ || HasLineBreak(data, position_, space)) {
+                        return Fail();
+                    }
+                    target_ = {token_start_, space - token_start_};
+                    position_ = space;
+                    token_start_ = space + 1;
+                    state_ = State::kVersion;
+                    break;
+                }
+                case State::kVersion:
+                    if (c == '\r' || c == '\n') {
+                        if (position_ == token_start_) {
+                            return Fail();
+                        }
+                        version_ = {token_start_, position_ - token_start_};
+                        state_ = c == '\r' ? State::kRequestLineEnd : State::kHeaderStart;
+                        token_start_ = position_ + 1;
+                    }
+                    break;
+                case State::kRequestLineEnd:
+                    if (c != '\n') {
+                        return Fail();
+                    }
+                    state_ = State::kHeaderStart;
+                    token_start_ = position_ + 1;
+                    break;
+                case State::kHeaderStart:
+                    if (c == '\r') {
+                        state_ = State::kFinalLineEnd;
+                    } else if (c == '\n') {
+                        return Complete(data, position_ + 1);
+                    } else if (IsTokenChar(c)) {
+                        if (header_count_ == HttpRequest::kMaxHeaders) {
+                            return Finish(Status::kHeadersTooLarge);
+                        }
+                        token_start_ = position_;
+                        state_ = State::kHeaderName;
+                    } else {
+                        return Fail();
+                    }
+                    break;
+                case State::kHeaderName:
+                    if (c == ':') {
+                        headers_[header_count_].name = {token_start_, position_ - token_start_};
+                        token_start_ = position_ + 1;
+                        state_ = State::kHeaderValue;
+                    } else if (!IsTokenChar(c)) {
+                        return Fail();
+                    }
+                    break;
+                case State::kHeaderValue: {
+                    // Быстрый поиск конца строки через memchr; '\r' перед '\n' отбрасывается
+                    const void* found =
+                        std::memchr(data.data() + position_, '\n', data.size() - position_);
+                    if (found == nullptr) {
+                        position_ = data.size();
+                        return Status::kIncomplete;
+                    }
+                    const auto end = static_cast<std::size_t>(static_cast<const char*>(found) -
+                                                              data.data());
+                    const std::size_t value_end =
+                        end > token_start_ && data[end - 1] == '\r' ? end - 1 : end;
+                    headers_[header_count_].value = {token_start_, value_end - token_start_};
+                    ++header_count_;
+                    position_ = end;
+                    state_ = State::kHeaderStart;
+                    token_start_ = end + 1;
+                    break;
+                }
+                case State::kFinalLineEnd:
+                    if (c != '\n') {
+                        return Fail();
+                    }
+                    return Complete(data, position_ + 1);
+                case State::kDone:
+                    return status_;
+            }
+            ++position_;
+        }
+        return Status::kIncomplete;
+    }
+
+    /**
+     * @brief Строит разобранный запрос поверх переданного буфера
+     *
+     * Вызывается после того, как Parse() вернул kComplete.
+     *
+     * @param data Тот же буфер, что передавался в Parse()
+     * @return HttpRequest Запрос со string_view в data
+     */
+    [[nodiscard]] HttpRequest Request(std::string_view data) const {
+        HttpRequest request;
+        request.method = Slice(data, method_);
+        request.target = Slice(data, target_);
+        request.version = Slice(data, version_);
+        request.header_count = header_count_;
+        for (std::size_t i = 0; i < header_count_; ++i) {
+            request.headers[i].name = Slice(data, headers_[i].name);
+            request.headers[i].value = Trim(Slice(data, headers_[i].value));
+        }
+        return request;
+    }
+
+    /**
+     * @brief Длина блока заголовков, включая завершающую пустую строку
+     *
+     * @return std::size_t Количество байтов запроса, занятых заголовками
+     */
+    [[nodiscard]] std::size_t Consumed() const {
+        return consumed_;
+    }
+
+    /**
+     * @brief Сбрасывает разборщик для следующего запроса
+     */
+    void Reset() {
+        *this = HttpRequestParser();
+    }
+
+   private:
+    /**
+     * @brief Состояние конечного автомата
+     */
+    enum class State {
+        kMethod,          ///< Метод запроса
+        kTarget,          ///< Цель запроса
+        kVersion,         ///< Версия протокола
+        kRequestLineEnd,  ///< Ожидание '\n' после строки запроса
+        kHeaderStart,     ///< Начало строки заголовка или пустая строка
+        kHeaderName,      ///< Имя заголовка
+        kHeaderValue,     ///< Значение заголовка
+        kFinalLineEnd,    ///< Ожидание '\n' после пустой строки
+        kDone,            ///< Разбор завершен
+    };
+
+    /**
+     * @brief Диапазон байтов внутри буфера
+     */
+    struct Span {
+        std::size_t offset = 0;  ///< Смещение от начала запроса
+        std::size_t length = 0;  ///< Длина
+    };
+
+    /**
+     * @brief Диапазоны имени и значения заголовка
+     */
+    struct HeaderSpan {
+        Span name;   ///< Имя заголовка
+        Span value;  ///< Значение заголовка
+    };
+
+    Status Finish(Status status) {
+        state_ = State::kDone;
+        status_ = status;
+        return status;
+    }
+
+    Status Fail() {
+        return Finish(Status::kBadRequest);
+    }
+
+    Status Complete(std::string_view data, std::size_t consumed) {
+        consumed_ = consumed;
+        position_ = consumed;
+        return Finish(HasValidContentLength(data) ? Status::kComplete : Status::kBadRequest);
+    }
+
+    /**
+     * @brief Проверяет заголовки Content-Length
+     *
+     * @param data Буфер запроса
+     * @return true если заголовков нет или все они содержат одну корректную длину
+     */
+    [[nodiscard]] bool HasValidContentLength(std::string_view data) const {
+        bool seen = false;
+        uint64_t expected = 0;
+        for (std::size_t i = 0; i < header_count_; ++i) {
+            if (!HttpRequest::EqualsIgnoreCase(Slice(data, headers_[i].name), "Content-Length")) {
+                continue;
+            }
+            uint64_t length = 0;
+            if (!HttpRequest::ParseContentLength(Trim(Slice(data, headers_[i].value)), length) ||
+                (seen && length != expected)) {
+                return false;
+            }
+            seen = true;
+            expected = length;
+        }
+        return true;
+    }
+
+    /// Таблица символов, допустимых в токене (RFC 9110, tchar)
+    static constexpr std::array<bool, 256> kTokenChars = [] {
+        std::array<bool, 256> table{};
+        for (char c = 'a'; c <= 'z'; ++c) {
+            table[static_cast<unsigned char>(c)] = true;
+            table[static_cast<unsigned char>(c - 'a' + 'A')] = true;
+        }
+        for (char c = '0'; c <= '9'; ++c) {
+            table[static_cast<unsigned char>(c)] = true;
+        }
+        for (const char c : std::string_view("!#$%&'*+-.^_`|~")) {
+            table[static_cast<unsigned char>(c)] = true;
+        }
+        return table;
+    }();
+
+    /**
+     * @brief Проверяет, допустим ли символ в токене (метод, имя заголовка)
+     */
+    static bool IsTokenChar(char c) {
+        return kTokenChars[static_cast<unsigned char>(c)];
+    }
+
+    /**
+     * @brief Проверяет, есть ли перевод строки в диапазоне [from, to)
+     */
+    static bool HasLineBreak(std::string_view data, std::size_t from, std::size_t to) {
+        const std::string_view range = data.substr(from, to - from);
+        return std::memchr(range.data(), '\n', range.size()) != nullptr ||
+               std::memchr(range.data(), '\r', range.size()) != nullptr;
+    }
+
+    static std::string_view Slice(std::string_view data, Span span) {
+        return data.substr(span.offset, span.length);
+    }
+
+    static std::string_view Trim(std::string_view value) {
+        while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+            value.remove_prefix(1);
+        }
+        while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+            value.remove_suffix(1);
+        }
+        return value;
+    }
+
+    State state_ = State::kMethod;         ///< Текущее состояние
+    std::size_t position_ = 0;             ///< Следующий непросмотренный байт
+    std::size_t token_start_ = 0;          ///< Начало текущего токена
+    std::size_t consumed_ = 0;             ///< Длина блока заголовков
+    Status status_ = Status::kIncomplete;  ///< Итог завершенного разбора
+    Span method_;                          ///< Метод запроса
+    Span target_;                          ///< Цель запроса
+    Span version_;                         ///< Версия протокола
+    /// Диапазоны заголовков запроса
+    std::array<HeaderSpan, HttpRequest::kMaxHeaders> headers_{};
+    std::size_t header_count_ = 0;         ///< Количество заголовков
+};
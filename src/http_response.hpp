@@ -0,0 +1,196 @@
+#pragma once
+
+#include <boost/asio/buffer.hpp>
+
+#include <array>
+#include <cassert>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * @brief Построитель HTTP ответов без выделения памяти
+ *
+ * Класс HttpResponseBuilder собирает ответ из фрагментов и отдает его
+ * как последовательность буферов для одного вызова async_write
+ * (scatter-gather запись):
+ * - Статусная строка и неизменные заголовки хранятся в заранее
+ *   собранных константах (kHeadOkHtml и т.д.)
+ * - Числа форматируются через std::to_chars в небольшие буферы
+ *   внутри объекта
+ * - Тело передается фрагментами (string_view) без копирования
+ *
+ * Построитель должен жить до завершения асинхронной записи, поэтому
+ * его следует хранить как член сессии. Фрагменты тела, переданные через
+ * AppendBody(std::string_view), также должны оставаться валидными до конца записи.
+ *
+ * Тело не может содержать больше kMaxBodyFragments фрагментов и kMaxNumbers
+ * чисел. Превышение лимита - ошибка обработчика: в отладочной сборке
+ * срабатывает assert, в сборке с NDEBUG Finish() вместо усеченного тела
+ * отдает пустой ответ 500 с закрытием соединения (см. Overflowed()).
+ */
+class HttpResponseBuilder {
+   public:
+    static constexpr std::size_t kMaxBodyFragments = 6;  ///< Максимум фрагментов тела
+    static constexpr std::size_t kMaxNumbers = 3;        ///< Максимум чисел в теле
+    static constexpr std::size_t kMaxBuffers = 3 + kMaxBodyFragments;  ///< Буферов в ответе
+
+    using Buffers = std::array<boost::asio::const_buffer, kMaxBuffers>;  ///< Буферы для записи
+
+    // Заранее собранные начала ответов (статус и неизменные заголовки)
+    static constexpr std::string_view kHeadOkHtml =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/html\r\n"
+        "Content-Length: ";  ///< 200 OK с HTML телом
+    static constexpr std::string_view kHeadOkMetrics =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/plain; version=0.0.4\r\n"
+        "Content-Length: ";  ///< 200 OK с метриками Prometheus
+    static constexpr std::string_view kHeadOkJson =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: application/json\r\n"
+        "Content-Length: ";  ///< 200 OK с JSON телом
+    static constexpr std::string_view kHeadBadRequest =
+        "HTTP/1.1 400 Bad Request\r\n"
+        "Content-Type: text/plain\r\n"
+        "Content-Length: ";  ///< 400 для некорректного запроса
+    static constexpr std::string_view kHeadNotFound =
+        "HTTP/1.1 404 Not Found\r\n"
+        "Content-Type: text/plain\r\n"
+        "Content-Length: ";  ///< 404 для неизвестного пути
+    static constexpr std::string_view kHeadHeadersTooLarge =
+        "HTTP/1.1 431 Request Header Fields Too Large\r\n"
+        "Content-Type: text/plain\r\n"
+        "Content-Length: ";  ///< 431 для слишком больших заголовков
+    static constexpr std::string_view kHeadInternalError =
+        "HTTP/1.1 500 Internal Server Error\r\n"
+        "Content-Type: text/plain\r\n"
+        "Content-Length: ";  ///< 500 при ошибке обработчика
+    static constexpr std::string_view kHeadServiceUnavailable =
+        "HTTP/1.1 503 Service Unavailable\r\n"
+        "Content-Type: text/plain\r\n"
+        "Retry-After: 1\r\n"
+        "Content-Length: ";  ///< 503 при недоступной базе данных
+
+    /**
+     * @brief Начинает новый ответ
+     *
+     * @param head Заранее собранное начало ответа, заканчивающееся на "Content-Length: "
+     */
+    void Start(std::string_view head) {
+        head_ = head;
+        body_count_ = 0;
+        number_count_ = 0;
+        body_length_ = 0;
+        keep_alive_ = false;
+        overflowed_ = false;
+    }
+
+    /**
+     * @brief Добавляет фрагмент тела без копирования
+     *
+     * @param fragment Фрагмент, который должен жить до завершения записи
+     */
+    void AppendBody(std::string_view fragment) {
+        if (body_count_ == kMaxBodyFragments) {
+            assert(!"HttpResponseBuilder: too many body fragments");
+            overflowed_ = true;
+            return;
+        }
+        body_[body_count_++] = fragment;
+        body_length_ += fragment.size();
+    }
+
+    /**
+     * @brief Добавляет в тело десятичное представление числа
+     *
+     * @param value Число для форматирования
+     */
+    void AppendBody(uint64_t value) {
+        if (number_count_ == kMaxNumbers) {
+            assert(!"HttpResponseBuilder: too many numbers in body");
+            overflowed_ = true;
+            return;
+        }
+        auto& storage = numbers_[number_count_++];
+        AppendBody(Format(storage, value));
+    }
+
+    /**
+     * @brief Устанавливает заголовок Connection
+     *
+     * @param keep_alive true для "keep-alive", false для "close"
+     */
+    void SetKeepAlive(bool keep_alive) {
+        keep_alive_ = keep_alive;
+    }
+
+    /**
+     * @brief Проверяет, превысило ли тело ответа лимиты построителя
+     *
+     * @return true, если часть тела была отброшена и Finish() отдаст ответ 500
+     */
+    [[nodiscard]] bool Overflowed() const {
+        return overflowed_;
+    }
+
+    /**
+     * @brief Завершает ответ и возвращает последовательность буферов
+     *
+     * Неиспользованные элементы массива - пустые буферы, которые
+     * async_write пропускает. Если тело переполнилось, вместо него
+     * отправляется пустой ответ kHeadInternalError с Connection: close.
+     *
+     * @return Buffers Буферы ответа в порядке отправки
+     */
+    [[nodiscard]] Buffers Finish() {
+        Buffers buffers{};
+        if (overflowed_) {
+            buffers[0] = boost::asio::buffer(kHeadInternalError);
+            buffers[1] = boost::asio::buffer(Format(content_length_, 0));
+            buffers[2] = boost::asio::buffer(kTailClose);
+            return buffers;
+        }
+        buffers[0] = boost::asio::buffer(head_);
+        buffers[1] = boost::asio::buffer(Format(content_length_, body_length_));
+        buffers[2] = boost::asio::buffer(keep_alive_ ? kTailKeepAlive : kTailClose);
+        for (std::size_t i = 0; i < body_count_; ++i) {
+            buffers[3 + i] = boost::asio::buffer(body_[i]);
+        }
+        return buffers;
+    }
+
+   private:
+    /// Достаточно для десятичной записи uint64_t
+    static constexpr std::size_t kNumberCapacity = 20;
+
+    using NumberStorage = std::array<char, kNumberCapacity>;  ///< Буфер для одного числа
+
+    /// Конец заголовков для постоянного соединения
+    static constexpr std::string_view kTailKeepAlive = "\r\nConnection: keep-alive\r\n\r\n";
+    /// Конец заголовков для закрываемого соединения
+    static constexpr std::string_view kTailClose = "\r\nConnection: close\r\n\r\n";
+
+    /**
+     * @brief Форматирует число в переданный буфер
+     *
+     * @param storage Буфер для цифр
+     * @param value Число
+     * @return std::string_view Представление числа внутри storage
+     */
+    static std::string_view Format(NumberStorage& storage, uint64_t value) {
+        const auto result = std::to_chars(storage.data(), storage.data() + storage.size(), value);
+        return {storage.data(), static_cast<std::size_t>(result.ptr - storage.data())};
+    }
+
+    std::string_view head_;                                 ///< Начало ответа
+    std::array<std::string_view, kMaxBodyFragments> body_;  ///< Фрагменты тела
+    std::array<NumberStorage, kMaxNumbers> numbers_{};      ///< Отформатированные числа тела
+    NumberStorage content_length_{};                        ///< Значение Content-Length
+    std::size_t body_count_ = 0;                            ///< Число фрагментов тела
+    std::size_t number_count_ = 0;                          ///< Число отформатированных чисел
+    std::size_t body_length_ = 0;                           ///< Длина тела в байтах
+    bool keep_alive_ = false;                               ///< Значение заголовка Connection
+    bool overflowed_ = false;                               ///< Тело превысило лимиты
+};
@@ -0,0 +1,208 @@
+#pragma once
+
+#include "database.hpp"
+#include "http_parser.hpp"
+#include "http_response.hpp"
+#include "logger.hpp"
+#include "metrics.hpp"
+
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Маршрутизатор HTTP запросов сервера посещений
+ *
+ * Класс HttpRouter выбирает обработчик по пути запроса и собирает ответ
+ * в HttpResponseBuilder сессии:
+ * - "/" - количество посещений (503, если база данных недоступна)
+ * - "/metrics" - метрики в текстовом формате Prometheus
+ * - "/visits" - количество посещений по интервалам времени в JSON
+ *   (параметры by=minute|hour|day, from и to в секундах Unix; по умолчанию
+ *   последние 24 интервала по часу; 500 при ошибке базы данных)
+ * - остальные пути - 404
+ *
+ * Маршрутизатор не зависит от способа ввода-вывода, поэтому его разделяют
+ * сессии на обработчиках (Session) и на корутинах (CoSession). Объект
+ * хранится в сессии: собранный ответ ссылается на его буферы до конца записи.
+ */
+class HttpRouter {
+   public:
+    static constexpr std::string_view kNotFoundBody = "Not Found";      ///< Тело ответа 404
+    static constexpr std::string_view kBadRequestBody = "Bad Request";  ///< Тело ответа 400
+    static constexpr std::string_view kTooLargeBody = "Request Header Fields Too Large";  ///< 431
+    static constexpr std::string_view kUnavailableBody = "Service Unavailable";  ///< Тело 503
+    static constexpr std::string_view kInternalErrorBody = "Internal Server Error";  ///< Тело 500
+
+    /**
+     * @brief Собирает ответ на запрос
+     *
+     * Заголовок Connection ответа выставляет вызывающая сторона.
+     *
+     * @param path Путь запроса без строки параметров
+     * @param query Строка параметров запроса без '?'
+     * @param db Сервис базы данных
+     * @param response Построитель ответа сессии
+     */
+    void Route(
+        std::string_view path, std::string_view query, IDatabaseService& db,
+        HttpResponseBuilder& response) {
+        if (path == "/") {
+            // Получаем количество посещений из базы данных
+            uint64_t visit_count = 0;
+            if (ReadVisitCount(db, visit_count)) {
+                // Собираем ответ из заранее подготовленных фрагментов без выделения памяти
+                response.Start(HttpResponseBuilder::kHeadOkHtml);
+                response.AppendBody(kVisitsBodyPrefix);
+                response.AppendBody(visit_count);
+            } else {
+                response.Start(HttpResponseBuilder::kHeadServiceUnavailable);
+                response.AppendBody(kUnavailableBody);
+            }
+        } else if (path == "/metrics") {
+            // Текст метрик хранится в маршрутизаторе: емкость строки переиспользуется
+            metrics_body_.clear();
+            GetMetrics().Render(metrics_body_);
+            response.Start(HttpResponseBuilder::kHeadOkMetrics);
+            response.AppendBody(metrics_body_);
+        } else if (path == "/visits") {
+            RouteVisits(query, db, response);
+        } else {
+            response.Start(HttpResponseBuilder::kHeadNotFound);
+            response.AppendBody(kNotFoundBody);
+        }
+    }
+
+    /// Максимум интервалов в ответе /visits
+    static constexpr int64_t kMaxVisitBuckets = 10080;
+
+   private:
+    /// Неизменная часть тела ответа
+    static constexpr std::string_view kVisitsBodyPrefix = "Hello, world! Visits: ";
+
+    /**
+     * @brief Читает количество посещений из базы данных
+     *
+     * Недоступность базы данных (например, истекшее ожидание соединения
+     * из пула) не блокирует сессию: клиент сразу получает 503 и может
+     * повторить запрос, а соединение остается открытым.
+     *
+     * @param db Сервис базы данных
+     * @param visit_count Сюда записывается количество посещений
+     * @return true если значение получено, false если база данных недоступна или вернула ошибку
+     */
+    static bool ReadVisitCount(IDatabaseService& db, uint64_t& visit_count) {
+        const ScopedLatency latency(Histogram::kDb);
+        try {
+            visit_count = db.GetCount();
+            return true;
+        } catch (const DatabaseUnavailableError& e) {
+            LOG_DEBUG << "Database unavailable: " << e.what();
+            return false;
+        } catch (const std::exception& e) {
+            LOG_ERROR << "Failed to read visit count: " << e.what();
+            return false;
+        }
+    }
+
+    /**
+     * @brief Собирает ответ /visits
+     *
+     * Тело - {"by":"hour","buckets":[[начало в секундах Unix,количество],...]}
+     * с непустыми интервалами в порядке возрастания. Некорректные
+     * параметры и период длиннее kMaxVisitBuckets интервалов - 400.
+     *
+     * Исключение сервиса не должно выйти за пределы обработчика: оно
+     * завершило бы поток io_context и весь сервер. Недоступность базы
+     * данных - 503, любая другая ошибка - 500.
+     *
+     * @param query Строка параметров запроса
+     * @param db Сервис базы данных
+     * @param response Построитель ответа сессии
+     */
+    void RouteVisits(std::string_view query, IDatabaseService& db, HttpResponseBuilder& response) {
+        std::string_view by = HttpRequest::QueryParam(query, "by");
+        if (by.empty()) {
+            by = "hour";
+        }
+        const std::optional<VisitGranularity> granularity = ParseVisitGranularity(by);
+        const int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+                                std::chrono::system_clock::now().time_since_epoch())
+                                .count();
+        const int64_t width = granularity ? MinutesPerBucket(*granularity) * 60 : 1;
+        const std::optional<int64_t> to = ParseSeconds(HttpRequest::QueryParam(query, "to"), now);
+        const std::optional<int64_t> from = to ? ParseSeconds(
+                                                     HttpRequest::QueryParam(query, "from"),
+                                                     *to - (24 * width))
+                                               : std::nullopt;
+        if (!granularity || !from || *from >= *to || (*to - *from) / width >= kMaxVisitBuckets) {
+            response.Start(HttpResponseBuilder::kHeadBadRequest);
+            response.AppendBody(kBadRequestBody);
+            return;
+        }
+
+        std::vector<VisitBucket> buckets;
+        try {
+            const ScopedLatency latency(Histogram::kDb);
+            buckets = db.GetVisitCounts(
+                std::chrono::system_clock::time_point(std::chrono::seconds(*from)),
+                std::chrono::system_clock::time_point(std::chrono::seconds(*to)), *granularity);
+        } catch (const DatabaseUnavailableError& e) {
+            LOG_DEBUG << "Visit analytics unavailable: " << e.what();
+            response.Start(HttpResponseBuilder::kHeadServiceUnavailable);
+            response.AppendBody(kUnavailableBody);
+            return;
+        } catch (const std::exception& e) {
+            LOG_ERROR << "Failed to read visit analytics: " << e.what();
+            response.Start(HttpResponseBuilder::kHeadInternalError);
+            response.AppendBody(kInternalErrorBody);
+            return;
+        }
+
+        // Тело хранится в маршрутизаторе: емкость строки переиспользуется
+        visits_body_.clear();
+        visits_body_ += R"({"by":")";
+        visits_body_ += by;
+        visits_body_ += R"(","buckets":[)";
+        for (std::size_t i = 0; i < buckets.size(); ++i) {
+            if (i > 0) {
+                visits_body_ += ',';
+            }
+            visits_body_ += '[';
+            visits_body_ += std::to_string(buckets[i].minute * 60);
+            visits_body_ += ',';
+            visits_body_ += std::to_string(buckets[i].count);
+            visits_body_ += ']';
+        }
+        visits_body_ += "]}";
+        response.Start(HttpResponseBuilder::kHeadOkJson);
+        response.AppendBody(visits_body_);
+    }
+
+    /**
+     * @brief Разбирает время в секундах Unix
+     *
+     * @param value Значение параметра
+     * @param fallback Значение для отсутствующего параметра
+     * @return std::optional<int64_t> Время или nullopt, если значение не число
+     */
+    static std::optional<int64_t> ParseSeconds(std::string_view value, int64_t fallback) {
+        if (value.empty()) {
+            return fallback;
+        }
+        int64_t seconds = 0;
+        const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), seconds);
+        if (ec != std::errc() || ptr != value.data() + value.size() || seconds < 0) {
+            return std::nullopt;
+        }
+        return seconds;
+    }
+
+    std::string metrics_body_;  ///< Тело ответа /metrics
+    std::string visits_body_;   ///< Тело ответа /visits
+};
@@ -0,0 +1,805 @@
+#pragma once
+
+#include "config.hpp"
+#include "database_service.hpp"
+#include "logger.hpp"
+#include "peer_registry.hpp"
+#include "visit_histogram.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Сегмент журнала, отображенный в память
+ *
+ * Файл фиксированного размера, отображенный целиком (MAP_SHARED): запись
+ * в журнал - memcpy в отображение без системного вызова, а сброс на
+ * диск - msync() уже записанного диапазона.
+ */
+class LogSegment {
+   public:
+    /**
+     * @brief Открывает или создает сегмент
+     *
+     * Новый файл расширяется до size байтов нулями (ftruncate), у
+     * существующего отображается весь текущий размер.
+     *
+     * @param path Путь к файлу сегмента
+     * @param size Размер нового сегмента в байтах
+     * @throws std::system_error если файл не открыт или не отображен
+     */
+    LogSegment(std::string path, std::size_t size) : path_(std::move(path)) {
+        fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            throw std::system_error(errno, std::generic_category(), "open " + path_);
+        }
+        struct stat st {};
+        if (::fstat(fd_, &st) != 0) {
+            Fail("fstat");
+        }
+        size_ = static_cast<std::size_t>(st.st_size);
+        if (size_ == 0) {
+            if (::ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+                Fail("ftruncate");
+            }
+            size_ = size;
+        }
+        void* data = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (data == MAP_FAILED) {
+            Fail("mmap");
+        }
+        data_ = static_cast<char*>(data);
+    }
+
+    ~LogSegment() {
+        if (data_ != nullptr) {
+            ::munmap(data_, size_);
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    LogSegment(const LogSegment&) = delete;             ///< Запрет копирования
+    LogSegment& operator=(const LogSegment&) = delete;  ///< Запрет присваивания
+    LogSegment(LogSegment&&) = delete;                  ///< Запрет перемещения
+    LogSegment& operator=(LogSegment&&) = delete;       ///< Запрет перемещающего присваивания
+
+    /**
+     * @brief Начало отображения
+     */
+    [[nodiscard]] char* Data() const {
+        return data_;
+    }
+
+    /**
+     * @brief Размер сегмента в байтах
+     */
+    [[nodiscard]] std::size_t Size() const {
+        return size_;
+    }
+
+    /**
+     * @brief Синхронно сбрасывает диапазон [from, to) на диск
+     *
+     * @return bool true при успехе
+     */
+    bool Sync(std::size_t from, std::size_t to) const {
+        if (from >= to) {
+            return true;
+        }
+        static const auto kPage = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        const std::size_t start = from - (from % kPage);
+        return ::msync(data_ + start, to - start, MS_SYNC) == 0;
+    }
+
+   private:
+    /**
+     * @brief Закрывает файл и выбрасывает ошибку системного вызова
+     */
+    [[noreturn]] void Fail(const char* call) {
+        const int error = errno;
+        ::close(fd_);
+        fd_ = -1;
+        throw std::system_error(error, std::generic_category(), std::string(call) + ' ' + path_);
+    }
+
+    std::string path_;       ///< Путь к файлу
+    int fd_ = -1;            ///< Дескриптор файла
+    char* data_ = nullptr;   ///< Отображение файла
+    std::size_t size_ = 0;   ///< Размер отображения
+};
+
+/**
+ * @brief Встроенное хранилище: журнал только на дозапись в отображаемых сегментах
+ *
+ * Класс LogDatabase хранит данные одиночного узла без сервера
+ * PostgreSQL и сетевого round trip:
+ * - Каждая операция записи - одна запись журнала: пакет посещений,
+ *   сообщение, резервирование блока идентификаторов, изменения реестра
+ *   пиров. Запись копируется в отображенный сегмент (memcpy) под
+ *   мьютексом; сегмент фиксированного размера, заполненный сегмент
+ *   сбрасывается на диск и сменяется новым
+ * - Фоновый поток раз в fsync_interval сбрасывает записанное (msync), то
+ *   есть при сбое теряется не больше интервала; при нулевом интервале
+ *   каждая запись сбрасывается до возврата
+ * - Индексы в памяти (счетчик и гистограмма посещений, ссылки на
+ *   сообщения комнат, пиры) восстанавливаются чтением журнала при
+ *   открытии. Сообщения не копируются в индекс: история читается прямо
+ *   из отображения
+ *
+ * Формат записи (порядок байтов хоста): u32 длина данных, u32 CRC-32 типа
+ * и данных, u8 тип, данные. Чтение журнала останавливается на нулевой
+ * длине (конец записанного) или на записи с неверной CRC (оборванная
+ * при сбое запись), хвост после нее обнуляется.
+ *
+ * Все методы потокобезопасны. Журнал не уплотняется.
+ */
+class LogDatabase : public IDatabaseService, public IPeerStore {
+   public:
+    /**
+     * @brief Параметры хранилища
+     */
+    struct Options {
+        std::string dir;                                     ///< Каталог сегментов
+        std::size_t segment_bytes = std::size_t{64} << 20;   ///< Размер сегмента
+        std::chrono::milliseconds fsync_interval{1000};      ///< Интервал сброса (0 - каждая запись)
+    };
+
+    /**
+     * @brief Открывает журнал и восстанавливает индексы
+     *
+     * @param options Параметры хранилища
+     * @throws std::system_error если каталог или сегменты недоступны
+     */
+    explicit LogDatabase(Options options) : options_(std::move(options)) {
+        std::filesystem::create_directories(options_.dir);
+        Replay();
+        if (options_.fsync_interval.count() > 0) {
+            worker_ = std::thread([this] { Run(); });
+        }
+    }
+
+    /**
+     * @brief Конструктор с параметрами из конфигурации
+     */
+    LogDatabase()
+        : LogDatabase(Options{
+              GetConfig().GetLogStoreDir(),
+              static_cast<std::size_t>(std::max(GetConfig().GetLogStoreSegmentMb(), 1)) << 20,
+              std::chrono::milliseconds(GetConfig().GetLogStoreFsyncIntervalMs())}) {
+    }
+
+    /**
+     * @brief Деструктор - останавливает фоновый поток и сбрасывает журнал
+     */
+    ~LogDatabase() override {
+        {
+            const std::lock_guard<std::mutex> lock(sync_mutex_);
+            stopped_ = true;
+        }
+        sync_cv_.notify_one();
+        if (worker_.joinable()) {
+            worker_.join();
+        }
+        Sync();
+    }
+
+    LogDatabase(const LogDatabase&) = delete;             ///< Запрет копирования
+    LogDatabase& operator=(const LogDatabase&) = delete;  ///< Запрет присваивания
+    LogDatabase(LogDatabase&&) = delete;                  ///< Запрет перемещения
+    LogDatabase& operator=(LogDatabase&&) = delete;       ///< Запрет перемещающего присваивания
+
+    /**
+     * @brief Журнал открывается в конструкторе, схема не нужна
+     */
+    void Initialize() override {
+    }
+
+    /**
+     * @brief Регистрирует посещение с текущим временем
+     */
+    void MarkVisit() override {
+        MarkVisits({std::chrono::system_clock::now()});
+    }
+
+    /**
+     * @brief Записывает пакет посещений одной записью журнала
+     *
+     * @param times Временные метки посещений
+     */
+    void MarkVisits(const std::vector<std::chrono::system_clock::time_point>& times) override {
+        if (times.empty()) {
+            return;
+        }
+        RecordWriter record;
+        record.PutU32(static_cast<uint32_t>(times.size()));
+        for (const auto time : times) {
+            record.PutI64(Micros(time));
+        }
+        const std::unique_lock<std::shared_mutex> lock(mutex_);
+        Append(RecordType::kVisits, record.Data());
+        ApplyVisits(times);
+    }
+
+    /**
+     * @brief Получает общее количество посещений
+     */
+    uint64_t GetCount() override {
+        return visits_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Получает количество посещений по интервалам времени
+     *
+     * @param from Начало периода (включительно, округляется вниз до интервала)
+     * @param to Конец периода (не включительно)
+     * @param granularity Размер интервала
+     * @return std::vector<VisitBucket> Непустые интервалы в порядке возрастания
+     */
+    std::vector<VisitBucket> GetVisitCounts(
+        std::chrono::system_clock::time_point from, std::chrono::system_clock::time_point to,
+        VisitGranularity granularity) override {
+        const std::shared_lock<std::shared_mutex> lock(mutex_);
+        return histogram_.Query(from, to, granularity);
+    }
+
+    /**
+     * @brief Резервирует блок идентификаторов сообщений
+     *
+     * Граница следующего блока записывается в журнал до возврата, поэтому
+     * после перезапуска идентификаторы не повторяются.
+     *
+     * @return uint64_t Первый идентификатор блока
+     */
+    uint64_t ReserveMessageIds() override {
+        const std::unique_lock<std::shared_mutex> lock(mutex_);
+        const uint64_t first = next_message_id_;
+        RecordWriter record;
+        record.PutU64(first + kMessageIdBlock);
+        Append(RecordType::kMessageIds, record.Data());
+        next_message_id_ = first + kMessageIdBlock;
+        return first;
+    }
+
+    /**
+     * @brief Записывает сообщения, по записи журнала на сообщение
+     *
+     * @param messages Сообщения с назначенными идентификаторами
+     */
+    void AppendMessages(const std::vector<ChatMessage>& messages) override {
+        const std::unique_lock<std::shared_mutex> lock(mutex_);
+        for (const ChatMessage& message : messages) {
+            RecordWriter record;
+            EncodeMessage(record, message);
+            const MessageRef ref = Append(RecordType::kMessage, record.Data());
+            ApplyMessage(message.room, message.id, ref);
+        }
+    }
+
+    /**
+     * @brief Читает страницу истории комнаты из отображенных сегментов
+     *
+     * @param room Комната
+     * @param before_id Курсор: возвращаются сообщения с id меньше него
+     * @param limit Максимальное количество сообщений
+     * @return std::vector<ChatMessage> Сообщения от новых к старым
+     */
+    std::vector<ChatMessage> GetMessages(
+        uint16_t room, uint64_t before_id, std::size_t limit) override {
+        const std::shared_lock<std::shared_mutex> lock(mutex_);
+        std::vector<ChatMessage> page;
+        const auto it = rooms_.find(room);
+        if (it == rooms_.end()) {
+            return page;
+        }
+        const std::vector<MessageRef>& refs = it->second;
+        auto end = std::lower_bound(
+            refs.begin(), refs.end(), before_id,
+            [](const MessageRef& ref, uint64_t id) { return ref.id < id; });
+        while (end != refs.begin() && page.size() < limit) {
+            --end;
+            RecordReader reader(segments_[end->segment]->Data() + end->offset, end->size);
+            ChatMessage message;
+            if (DecodeMessage(reader, message)) {
+                page.push_back(std::move(message));
+            }
+        }
+        return page;
+    }
+
+    /**
+     * @brief Загружает не истекшие регистрации пиров
+     *
+     * @return std::vector<PeerRecord> Сохраненные регистрации
+     */
+    std::vector<PeerRecord> LoadPeers() override {
+        const auto now = std::chrono::system_clock::now();
+        const std::shared_lock<std::shared_mutex> lock(mutex_);
+        std::vector<PeerRecord> records;
+        records.reserve(peers_.size());
+        for (const auto& [id, record] : peers_) {
+            if (record.expires_at > now) {
+                records.push_back(record);
+            }
+        }
+        return records;
+    }
+
+    /**
+     * @brief Записывает изменения реестра пиров одной записью журнала
+     *
+     * @param changes Изменения с прошлого снимка
+     */
+    void SavePeers(const PeerChanges& changes) override {
+        if (changes.Empty()) {
+            return;
+        }
+        RecordWriter record;
+        record.PutU32(static_cast<uint32_t>(changes.upserts.size()));
+        for (const PeerRecord& peer : changes.upserts) {
+            record.PutString(peer.id);
+            record.PutString(peer.endpoint);
+            record.PutI64(Micros(peer.expires_at));
+        }
+        record.PutU32(static_cast<uint32_t>(changes.removed.size()));
+        for (const std::string& id : changes.removed) {
+            record.PutString(id);
+        }
+        const std::unique_lock<std::shared_mutex> lock(mutex_);
+        Append(RecordType::kPeers, record.Data());
+        ApplyPeers(changes);
+    }
+
+    /**
+     * @brief Синхронно сбрасывает на диск все записанное
+     */
+    void Sync() {
+        LogSegment* segment = nullptr;
+        std::size_t from = 0;
+        std::size_t to = 0;
+        {
+            const std::shared_lock<std::shared_mutex> lock(mutex_);
+            if (segments_.empty()) {
+                return;
+            }
+            segment = segments_.back().get();
+            from = synced_;
+            to = used_;
+        }
+        if (!segment->Sync(from, to)) {
+            LOG_ERROR << "Failed to sync log segment: " << std::strerror(errno);
+            return;
+        }
+        const std::unique_lock<std::shared_mutex> lock(mutex_);
+        if (segment == segments_.back().get()) {
+            synced_ = std::max(synced_, to);
+        }
+    }
+
+   private:
+    /// Тип записи журнала
+    enum class RecordType : uint8_t {
+        kVisits = 1,      ///< Пакет посещений
+        kMessage = 2,     ///< Сообщение комнаты
+        kMessageIds = 3,  ///< Граница зарезервированных идентификаторов сообщений
+        kPeers = 4,       ///< Изменения реестра пиров
+    };
+
+    /// Размер заголовка записи: длина, CRC, тип
+    static constexpr std::size_t kHeaderSize = 9;
+
+    /// Положение данных записи сообщения в журнале
+    struct MessageRef {
+        uint64_t id;        ///< Идентификатор сообщения
+        uint32_t segment;   ///< Номер сегмента в segments_
+        uint32_t size;      ///< Длина данных записи
+        std::size_t offset; ///< Смещение данных записи в сегменте
+    };
+
+    /**
+     * @brief Построитель данных записи
+     */
+    class RecordWriter {
+       public:
+        void PutU16(uint16_t value) {
+            Put(&value, sizeof(value));
+        }
+        void PutU32(uint32_t value) {
+            Put(&value, sizeof(value));
+        }
+        void PutU64(uint64_t value) {
+            Put(&value, sizeof(value));
+        }
+        void PutI64(int64_t value) {
+            Put(&value, sizeof(value));
+        }
+        void PutString(std::string_view value) {
+            PutU32(static_cast<uint32_t>(value.size()));
+            data_.append(value);
+        }
+        [[nodiscard]] std::string_view Data() const {
+            return data_;
+        }
+
+       private:
+        void Put(const void* value, std::size_t size) {
+            data_.append(static_cast<const char*>(value), size);
+        }
+
+        std::string data_;  ///< Данные записи
+    };
+
+    /**
+     * @brief Чтение данных записи с проверкой границ
+     *
+     * Методы возвращают false, если данных не хватает.
+     */
+    class RecordReader {
+       public:
+        RecordReader(const char* data, std::size_t size) : data_(data), size_(size) {
+        }
+        bool GetU16(uint16_t& value) {
+            return Get(&value, sizeof(value));
+        }
+        bool GetU32(uint32_t& value) {
+            return Get(&value, sizeof(value));
+        }
+        bool GetU64(uint64_t& value) {
+            return Get(&value, sizeof(value));
+        }
+        bool GetI64(int64_t& value) {
+            return Get(&value, sizeof(value));
+        }
+        bool GetString(std::string& value) {
+            uint32_t size = 0;
+            if (!GetU32(size) || size_ - offset_ < size) {
+                return false;
+            }
+            value.assign(data_ + offset_, size);
+            offset_ += size;
+            return true;
+        }
+
+       private:
+        bool Get(void* value, std::size_t size) {
+            if (size_ - offset_ < size) {
+                return false;
+            }
+            std::memcpy(value, data_ + offset_, size);
+            offset_ += size;
+            return true;
+        }
+
+        const char* data_;        ///< Данные записи
+        std::size_t size_;        ///< Длина данных
+        std::size_t offset_ = 0;  ///< Прочитано байтов
+    };
+
+    /**
+     * @brief Микросекунды от эпохи Unix
+     */
+    static int64_t Micros(std::chrono::system_clock::time_point time) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch())
+            .count();
+    }
+
+    /**
+     * @brief Момент времени по микросекундам от эпохи Unix
+     */
+    static std::chrono::system_clock::time_point FromMicros(int64_t micros) {
+        return std::chrono::system_clock::time_point(std::chrono::microseconds(micros));
+    }
+
+    /**
+     * @brief CRC-32 типа и данных записи
+     */
+    static uint32_t Checksum(uint8_t type, const char* data, std::size_t size) {
+        uLong crc = crc32(0L, &type, 1);
+        crc = crc32(crc, reinterpret_cast<const Bytef*>(data), static_cast<uInt>(size));
+        return static_cast<uint32_t>(crc);
+    }
+
+    /**
+     * @brief Кодирует сообщение в данные записи
+     */
+    static void EncodeMessage(RecordWriter& record, const ChatMessage& message) {
+        record.PutU64(message.id);
+        record.PutU16(message.room);
+        record.PutI64(Micros(message.time));
+        record.PutString(message.author);
+        record.PutString(message.text);
+    }
+
+    /**
+     * @brief Декодирует сообщение из данных записи
+     */
+    static bool DecodeMessage(RecordReader& reader, ChatMessage& message) {
+        int64_t micros = 0;
+        if (!reader.GetU64(message.id) || !reader.GetU16(message.room) ||
+            !reader.GetI64(micros) || !reader.GetString(message.author) ||
+            !reader.GetString(message.text)) {
+            return false;
+        }
+        message.time = FromMicros(micros);
+        return true;
+    }
+
+    /**
+     * @brief Путь к сегменту с номером
+     */
+    [[nodiscard]] std::string SegmentPath(uint64_t number) const {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%08llu.log", static_cast<unsigned long long>(number));
+        return (std::filesystem::path(options_.dir) / name).string();
+    }
+
+    /**
+     * @brief Дописывает запись в журнал (под уникальной блокировкой mutex_)
+     *
+     * @param type Тип записи
+     * @param data Данные записи
+     * @return MessageRef Положение данных записи (id не заполняется)
+     * @throws DatabaseUnavailableError если запись больше сегмента,
+     *         новый сегмент не создан или не удался синхронный сброс
+     *         (FSYNC_INTERVAL_MS = 0; тогда запись отменяется)
+     */
+    MessageRef Append(RecordType type, std::string_view data) {
+        const std::size_t total = kHeaderSize + data.size();
+        if (total > options_.segment_bytes) {
+            throw DatabaseUnavailableError("log record is larger than a segment");
+        }
+        if (segments_.empty() || used_ + total > segments_.back()->Size()) {
+            Roll();
+        }
+
+        LogSegment& segment = *segments_.back();
+        char* at = segment.Data() + used_;
+        const auto size = static_cast<uint32_t>(data.size());
+        const auto type_byte = static_cast<uint8_t>(type);
+        const uint32_t crc = Checksum(type_byte, data.data(), data.size());
+        std::memcpy(at + kHeaderSize, data.data(), data.size());
+        std::memcpy(at + 4, &crc, sizeof(crc));
+        at[8] = static_cast<char>(type_byte);
+        // Длина пишется последней: запись без длины - конец журнала
+        std::memcpy(at, &size, sizeof(size));
+
+        const MessageRef ref{
+            0, static_cast<uint32_t>(segments_.size() - 1), size, used_ + kHeaderSize};
+        if (options_.fsync_interval.count() == 0) {
+            if (!segment.Sync(synced_, used_ + total)) {
+                const int error = errno;
+                // Нулевая длина снова делает запись концом журнала
+                std::memset(at, 0, sizeof(size));
+                throw DatabaseUnavailableError(
+                    std::string("Failed to sync log segment: ") + std::strerror(error));
+            }
+            synced_ = used_ + total;
+        }
+        used_ += total;
+        return ref;
+    }
+
+    /**
+     * @brief Сбрасывает заполненный сегмент и открывает следующий
+     */
+    void Roll() {
+        if (!segments_.empty() && !segments_.back()->Sync(synced_, used_)) {
+            // Сегмент остается отображенным, ядро запишет его позже
+            LOG_ERROR << "Failed to sync log segment: " << std::strerror(errno);
+        }
+        try {
+            segments_.push_back(
+                std::make_unique<LogSegment>(SegmentPath(next_segment_), options_.segment_bytes));
+        } catch (const std::system_error& e) {
+            throw DatabaseUnavailableError(e.what());
+        }
+        ++next_segment_;
+        used_ = 0;
+        synced_ = 0;
+    }
+
+    /**
+     * @brief Открывает сегменты по порядку номеров и применяет их записи
+     */
+    void Replay() {
+        std::vector<uint64_t> numbers;
+        for (const auto& entry : std::filesystem::directory_iterator(options_.dir)) {
+            const std::string stem = entry.path().stem().string();
+            if (entry.path().extension() == ".log" && !stem.empty() &&
+                std::all_of(stem.begin(), stem.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+                numbers.push_back(std::stoull(stem));
+            }
+        }
+        std::sort(numbers.begin(), numbers.end());
+
+        std::size_t records = 0;
+        for (const uint64_t number : numbers) {
+            segments_.push_back(
+                std::make_unique<LogSegment>(SegmentPath(number), options_.segment_bytes));
+            const LogSegment& segment = *segments_.back();
+            std::size_t offset = 0;
+            while (offset + kHeaderSize <= segment.Size()) {
+                const char* at = segment.Data() + offset;
+                uint32_t size = 0;
+                uint32_t crc = 0;
+                std::memcpy(&size, at, sizeof(size));
+                std::memcpy(&crc, at + 4, sizeof(crc));
+                const auto type = static_cast<uint8_t>(at[8]);
+                if (size == 0 || size > segment.Size() - offset - kHeaderSize ||
+                    Checksum(type, at + kHeaderSize, size) != crc) {
+                    break;
+                }
+                ApplyRecord(
+                    static_cast<RecordType>(type), at + kHeaderSize, size,
+                    static_cast<uint32_t>(segments_.size() - 1), offset + kHeaderSize);
+                offset += kHeaderSize + size;
+                ++records;
+            }
+            // Хвост после последней целой записи (оборванная запись) обнуляется
+            std::memset(segment.Data() + offset, 0, segment.Size() - offset);
+            used_ = offset;
+            next_segment_ = number + 1;
+        }
+        synced_ = used_;
+        LOG_INFO << "Opened log store " << options_.dir << ": " << segments_.size()
+                 << " segment(s), " << records << " record(s)";
+    }
+
+    /**
+     * @brief Применяет прочитанную запись к индексам
+     */
+    void ApplyRecord(
+        RecordType type, const char* data, std::size_t size, uint32_t segment,
+        std::size_t offset) {
+        RecordReader reader(data, size);
+        switch (type) {
+            case RecordType::kVisits: {
+                uint32_t count = 0;
+                reader.GetU32(count);
+                std::vector<std::chrono::system_clock::time_point> times;
+                times.reserve(count);
+                int64_t micros = 0;
+                for (uint32_t i = 0; i < count && reader.GetI64(micros); ++i) {
+                    times.push_back(FromMicros(micros));
+                }
+                ApplyVisits(times);
+                break;
+            }
+            case RecordType::kMessage: {
+                ChatMessage message;
+                if (DecodeMessage(reader, message)) {
+                    ApplyMessage(
+                        message.room, message.id,
+                        MessageRef{0, segment, static_cast<uint32_t>(size), offset});
+                    next_message_id_ = std::max(next_message_id_, message.id + 1);
+                }
+                break;
+            }
+            case RecordType::kMessageIds: {
+                uint64_t next = 0;
+                if (reader.GetU64(next)) {
+                    next_message_id_ = std::max(next_message_id_, next);
+                }
+                break;
+            }
+            case RecordType::kPeers: {
+                PeerChanges changes;
+                uint32_t count = 0;
+                reader.GetU32(count);
+                for (uint32_t i = 0; i < count; ++i) {
+                    PeerRecord record;
+                    int64_t micros = 0;
+                    if (!reader.GetString(record.id) || !reader.GetString(record.endpoint) ||
+                        !reader.GetI64(micros)) {
+                        break;
+                    }
+                    record.expires_at = FromMicros(micros);
+                    changes.upserts.push_back(std::move(record));
+                }
+                reader.GetU32(count);
+                std::string id;
+                for (uint32_t i = 0; i < count && reader.GetString(id); ++i) {
+                    changes.removed.push_back(id);
+                }
+                ApplyPeers(changes);
+                break;
+            }
+        }
+    }
+
+    /**
+     * @brief Учитывает посещения в счетчике и гистограмме
+     */
+    void ApplyVisits(const std::vector<std::chrono::system_clock::time_point>& times) {
+        histogram_.Add(times);
+        visits_.fetch_add(times.size(), std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Добавляет ссылку на сообщение в индекс комнаты
+     *
+     * Ссылки комнаты упорядочены по id: сообщение не по порядку
+     * вставляется на свое место.
+     */
+    void ApplyMessage(uint16_t room, uint64_t id, MessageRef ref) {
+        ref.id = id;
+        std::vector<MessageRef>& refs = rooms_[room];
+        if (refs.empty() || refs.back().id < id) {
+            refs.push_back(ref);
+            return;
+        }
+        const auto it = std::lower_bound(
+            refs.begin(), refs.end(), id,
+            [](const MessageRef& existing, uint64_t value) { return existing.id < value; });
+        refs.insert(it, ref);
+    }
+
+    /**
+     * @brief Применяет изменения реестра пиров
+     */
+    void ApplyPeers(const PeerChanges& changes) {
+        for (const PeerRecord& record : changes.upserts) {
+            peers_[record.id] = record;
+        }
+        for (const std::string& id : changes.removed) {
+            peers_.erase(id);
+        }
+    }
+
+    /**
+     * @brief Цикл фонового потока сброса
+     */
+    void Run() {
+        std::unique_lock<std::mutex> lock(sync_mutex_);
+        while (!stopped_) {
+            sync_cv_.wait_for(lock, options_.fsync_interval, [this] { return stopped_; });
+            if (stopped_) {
+                break;
+            }
+            lock.unlock();
+            Sync();
+            lock.lock();
+        }
+    }
+
+    Options options_;                                                  ///< Параметры хранилища
+    std::shared_mutex mutex_;                                          ///< Журнал и индексы
+    std::vector<std::unique_ptr<LogSegment>> segments_;                ///< Сегменты по порядку
+    uint64_t next_segment_ = 1;                                        ///< Номер следующего сегмента
+    std::size_t used_ = 0;                                             ///< Записано в последний сегмент
+    std::size_t synced_ = 0;                                           ///< Сброшено в последнем сегменте
+    std::atomic<uint64_t> visits_{0};                                  ///< Общее количество посещений
+    VisitHistogram histogram_;                                         ///< Посещения по минутам
+    uint64_t next_message_id_ = 1;                                     ///< Начало следующего блока
+    std::unordered_map<uint16_t, std::vector<MessageRef>> rooms_;      ///< Сообщения комнат по id
+    std::unordered_map<std::string, PeerRecord> peers_;                ///< Регистрации пиров
+    bool stopped_ = false;                                             ///< Остановлен ли сброс
+    std::mutex sync_mutex_;                                            ///< Мьютекс потока сброса
+    std::condition_variable sync_cv_;                                  ///< Пробуждение потока сброса
+    std::thread worker_;                                               ///< Фоновый поток сброса
+};
@@ -0,0 +1,375 @@
+#pragma once
+
+#include "mpmc_queue.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+/**
+ * @brief Минимальный уровень логирования, компилируемый в программу
+ *
+ * Вызовы LOG_* ниже этого уровня удаляются на этапе компиляции.
+ * Значения соответствуют LogLevel: 0 - trace, 1 - debug, 2 - info,
+ * 3 - warning, 4 - error.
+ */
+#ifndef LOG_ACTIVE_LEVEL
+#define LOG_ACTIVE_LEVEL 0
+#endif
+
+/**
+ * @brief Уровни логирования
+ */
+enum class LogLevel : uint8_t {
+    kTrace = 0,    ///< Подробная трассировка (каждый запрос)
+    kDebug = 1,    ///< Отладочная информация
+    kInfo = 2,     ///< Информационные сообщения
+    kWarning = 3,  ///< Предупреждения
+    kError = 4,    ///< Ошибки
+    kOff = 5,      ///< Логирование отключено
+};
+
+/// Минимальный уровень, сообщения которого компилируются в программу
+inline constexpr LogLevel kCompiledLogLevel = static_cast<LogLevel>(LOG_ACTIVE_LEVEL);
+
+/**
+ * @brief Преобразует строковое значение LOG_LEVEL в уровень логирования
+ *
+ * Регистр не учитывается; неизвестные значения дают kInfo.
+ *
+ * @param name Имя уровня ("trace", "debug", "info", "warning", "error", "off")
+ * @return LogLevel Уровень логирования
+ */
+inline LogLevel ParseLogLevel(std::string_view name) {
+    std::string lower(name);
+    for (char& c : lower) {
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+    }
+    if (lower == "trace") {
+        return LogLevel::kTrace;
+    }
+    if (lower == "debug") {
+        return LogLevel::kDebug;
+    }
+    if (lower == "warning" || lower == "warn") {
+        return LogLevel::kWarning;
+    }
+    if (lower == "error") {
+        return LogLevel::kError;
+    }
+    if (lower == "off" || lower == "none") {
+        return LogLevel::kOff;
+    }
+    return LogLevel::kInfo;
+}
+
+/**
+ * @brief Сообщение лога фиксированного размера
+ *
+ * Хранится в очереди логгера по значению, поэтому запись в лог
+ * не выделяет память. Слишком длинные сообщения обрезаются.
+ */
+struct LogMessage {
+    static constexpr std::size_t kCapacity = 240;  ///< Максимальная длина текста
+
+    std::array<char, kCapacity> text;  ///< Текст сообщения
+    uint16_t size = 0;                 ///< Длина текста
+    LogLevel level = LogLevel::kInfo;  ///< Уровень сообщения
+};
+
+/**
+ * @brief Асинхронный логгер
+ *
+ * Класс Logger принимает сообщения из любых потоков и выводит их
+ * в фоновом потоке:
+ * - Сообщения передаются через lock-free очередь MpmcQueue, поэтому
+ *   поток обработки запросов никогда не ждет stdout
+ * - Если очередь заполнена, сообщение отбрасывается, а количество
+ *   отброшенных сообщений выводится позже
+ * - Уровень фильтруется во время выполнения (LOG_LEVEL) и на этапе
+ *   компиляции (LOG_ACTIVE_LEVEL)
+ *
+ * Используется через макросы LOG_TRACE, LOG_DEBUG, LOG_INFO, LOG_WARNING, LOG_ERROR.
+ */
+class Logger {
+   public:
+    static constexpr std::size_t kQueueCapacity = 8192;  ///< Емкость очереди сообщений
+
+    /**
+     * @brief Конструктор логгера
+     *
+     * Запускает фоновый поток вывода.
+     *
+     * @param level Минимальный выводимый уровень
+     * @param output Поток вывода сообщений
+     */
+    explicit Logger(LogLevel level = LogLevel::kInfo, std::FILE* output = stdout)
+        : level_(level), output_(output), queue_(kQueueCapacity), worker_([this] { Run(); }) {
+    }
+
+    /**
+     * @brief Деструктор - выводит оставшиеся сообщения и останавливает поток
+     */
+    ~Logger() {
+        stopping_.store(true, std::memory_order_release);
+        Wake();
+        worker_.join();
+    }
+
+    Logger(const Logger&) = delete;             ///< Запрет копирования
+    Logger& operator=(const Logger&) = delete;  ///< Запрет присваивания
+    Logger(Logger&&) = delete;                  ///< Запрет перемещения
+    Logger& operator=(Logger&&) = delete;       ///< Запрет перемещающего присваивания
+
+    /**
+     * @brief Устанавливает минимальный выводимый уровень
+     */
+    void SetLevel(LogLevel level) {
+        level_.store(level, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Проверяет, выводятся ли сообщения данного уровня
+     */
+    [[nodiscard]] bool IsEnabled(LogLevel level) const {
+        return level >= level_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Ставит сообщение в очередь вывода
+     *
+     * Не блокируется: при заполненной очереди сообщение отбрасывается.
+     *
+     * @param message Сообщение
+     */
+    void Submit(LogMessage& message) {
+        if (!queue_.TryPush(message)) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        submitted_.fetch_add(1, std::memory_order_release);
+        Wake();
+    }
+
+    /**
+     * @brief Ожидает, пока фоновый поток выведет все поставленные сообщения
+     */
+    void Flush() {
+        const uint64_t target = submitted_.load(std::memory_order_acquire);
+        uint64_t written = written_.load(std::memory_order_acquire);
+        while (written < target) {
+            written_.wait(written, std::memory_order_acquire);
+            written = written_.load(std::memory_order_acquire);
+        }
+    }
+
+   private:
+    /**
+     * @brief Будит фоновый поток
+     */
+    void Wake() {
+        wake_.fetch_add(1, std::memory_order_release);
+        wake_.notify_one();
+    }
+
+    /**
+     * @brief Цикл фонового потока: выводит сообщения по мере поступления
+     *
+     * Поток спит на счетчике wake_, пока производители не поставят новые сообщения.
+     */
+    void Run() {
+        uint64_t written = 0;
+        LogMessage message;
+        for (;;) {
+            const uint32_t generation = wake_.load(std::memory_order_acquire);
+
+            bool wrote = false;
+            while (queue_.TryPop(message)) {
+                Write(message);
+                ++written;
+                wrote = true;
+            }
+            const uint64_t dropped = dropped_.exchange(0, std::memory_order_relaxed);
+            if (dropped > 0) {
+                std::fprintf(output_, "[WARN ] Logger queue overflow, dropped %llu messages\n",
+                             static_cast<unsigned long long>(dropped));
+                wrote = true;
+            }
+            if (wrote) {
+                std::fflush(output_);
+                written_.store(written, std::memory_order_release);
+                written_.notify_all();
+            }
+
+            // Производитель занял ячейку, но еще не дописал сообщение
+            if (written < submitted_.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+                continue;
+            }
+            if (stopping_.load(std::memory_order_acquire)) {
+                return;
+            }
+            wake_.wait(generation, std::memory_order_acquire);
+        }
+    }
+
+    /**
+     * @brief Выводит одно сообщение с префиксом уровня
+     */
+    void Write(const LogMessage& message) {
+        static constexpr std::array<std::string_view, 5> kPrefixes = {
+            "[TRACE] ", "[DEBUG] ", "[INFO ] ", "[WARN ] ", "[ERROR] "};
+        const auto index = static_cast<std::size_t>(message.level);
+        const std::string_view prefix = index < kPrefixes.size() ? kPrefixes[index] : "";
+        std::fwrite(prefix.data(), 1, prefix.size(), output_);
+        std::fwrite(message.text.data(), 1, message.size, output_);
+        std::fputc('\n', output_);
+    }
+
+    std::atomic<LogLevel> level_;             ///< Минимальный выводимый уровень
+    std::FILE* output_;                       ///< Поток вывода
+    MpmcQueue<LogMessage> queue_;             ///< Очередь сообщений
+    std::atomic<uint64_t> submitted_{0};      ///< Количество поставленных сообщений
+    std::atomic<uint64_t> written_{0};        ///< Количество выведенных сообщений
+    std::atomic<uint32_t> wake_{0};           ///< Счетчик пробуждений фонового потока
+    std::atomic<uint64_t> dropped_{0};        ///< Отброшенные при переполнении сообщения
+    std::atomic<bool> stopping_{false};       ///< Флаг остановки фонового потока
+    std::thread worker_;                      ///< Фоновый поток вывода
+};
+
+/**
+ * @brief Возвращает глобальный экземпляр логгера
+ *
+ * @return Logger& Логгер, создаваемый при первом обращении
+ */
+inline Logger& GetLogger() {
+    static Logger logger;
+    return logger;
+}
+
+/**
+ * @brief Настраивает глобальный логгер
+ *
+ * @param level Значение параметра LOG_LEVEL
+ */
+inline void InitializeLogger(std::string_view level) {
+    GetLogger().SetLevel(ParseLogLevel(level));
+}
+
+/**
+ * @brief Построитель одного сообщения лога
+ *
+ * Форматирует аргументы operator<< в LogMessage без выделения памяти
+ * (числа - через std::to_chars) и отправляет сообщение логгеру
+ * в деструкторе. Создается макросами LOG_*.
+ */
+class LogLine {
+   public:
+    /**
+     * @brief Начинает сообщение указанного уровня
+     */
+    explicit LogLine(LogLevel level, Logger& logger = GetLogger()) : logger_(logger) {
+        message_.level = level;
+    }
+
+    /**
+     * @brief Отправляет сообщение логгеру
+     */
+    ~LogLine() {
+        logger_.Submit(message_);
+    }
+
+    LogLine(const LogLine&) = delete;             ///< Запрет копирования
+    LogLine& operator=(const LogLine&) = delete;  ///< Запрет присваивания
+    LogLine(LogLine&&) = delete;                  ///< Запрет перемещения
+    LogLine& operator=(LogLine&&) = delete;       ///< Запрет перемещающего присваивания
+
+    /**
+     * @brief Добавляет строку
+     */
+    LogLine& operator<<(std::string_view text) {
+        const std::size_t size = std::min(text.size(), Free());
+        std::memcpy(message_.text.data() + message_.size, text.data(), size);
+        message_.size = static_cast<uint16_t>(message_.size + size);
+        return *this;
+    }
+
+    /**
+     * @brief Добавляет C-строку
+     */
+    LogLine& operator<<(const char* text) {
+        return *this << std::string_view(text);
+    }
+
+    /**
+     * @brief Добавляет строку std::string
+     */
+    LogLine& operator<<(const std::string& text) {
+        return *this << std::string_view(text);
+    }
+
+    /**
+     * @brief Добавляет символ
+     */
+    LogLine& operator<<(char c) {
+        return *this << std::string_view(&c, 1);
+    }
+
+    /**
+     * @brief Добавляет логическое значение
+     */
+    LogLine& operator<<(bool value) {
+        return *this << (value ? std::string_view("true") : std::string_view("false"));
+    }
+
+    /**
+     * @brief Добавляет число (целое или с плавающей точкой)
+     */
+    template <typename Number, typename = std::enable_if_t<std::is_arithmetic_v<Number>>>
+    LogLine& operator<<(Number value) {
+        char* begin = message_.text.data() + message_.size;
+        const auto result = std::to_chars(begin, begin + Free(), value);
+        if (result.ec == std::errc()) {
+            message_.size = static_cast<uint16_t>(result.ptr - message_.text.data());
+        }
+        return *this;
+    }
+
+   private:
+    [[nodiscard]] std::size_t Free() const {
+        return LogMessage::kCapacity - message_.size;
+    }
+
+    Logger& logger_;      ///< Логгер, которому отправляется сообщение
+    LogMessage message_;  ///< Формируемое сообщение
+};
+
+/**
+ * @brief Начинает сообщение уровня level, если он включен
+ *
+ * Уровни ниже LOG_ACTIVE_LEVEL отбрасываются на этапе компиляции,
+ * остальные - проверкой Logger::IsEnabled() до форматирования аргументов.
+ * Использование: LOG_INFO << "Server started on port " << port;
+ */
+#define LOG_AT(level)                                                 \
+    if constexpr ((level) < kCompiledLogLevel) {                      \
+    } else if (!GetLogger().IsEnabled(level)) {                       \
+    } else                                                            \
+        LogLine(level)
+
+#define LOG_TRACE LOG_AT(LogLevel::kTrace)      ///< Сообщение уровня trace
+#define LOG_DEBUG LOG_AT(LogLevel::kDebug)      ///< Сообщение уровня debug
+#define LOG_INFO LOG_AT(LogLevel::kInfo)        ///< Сообщение уровня info
+#define LOG_WARNING LOG_AT(LogLevel::kWarning)  ///< Сообщение уровня warning
+#define LOG_ERROR LOG_AT(LogLevel::kError)      ///< Сообщение уровня error
@@ -0,0 +1,261 @@
+#pragma once
+
+#include "database_service.hpp"
+#include "visit_histogram.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Сервис базы данных в памяти процесса без блокировок
+ *
+ * Класс InMemoryDatabase - хранилище для разработки, CI, одиночных
+ * узлов без PostgreSQL и бенчмарков, где база данных не должна быть
+ * узким местом. Все операции не берут мьютексов:
+ * - Общее количество посещений и следующий блок идентификаторов
+ *   сообщений - атомарные счетчики
+ * - Посещения по минутам хранятся в кольце из kMinuteSlots ячеек
+ *   (последние ~91 день): ячейка - одно 64-битное слово (минута и
+ *   количество), обновляемое compare-and-swap, поэтому ячейку новой
+ *   минуты нельзя занять, потеряв прибавку к старой
+ * - Сообщения каждой комнаты - односвязный список от новых к старым,
+ *   новое сообщение добавляется в голову compare-and-swap. Узлы не
+ *   удаляются до уничтожения хранилища, поэтому читатели обходят список
+ *   без блокировок и без проблемы ABA
+ *
+ * Данные не переживают перезапуск процесса, поэтому класс не реализует
+ * IPeerStore.
+ *
+ * @note Сообщения комнаты должны записываться в порядке возрастания
+ * идентификаторов (так пишет MessageStore), иначе страница истории
+ * может пропустить сообщения.
+ */
+class InMemoryDatabase : public IDatabaseService {
+   public:
+    static constexpr std::size_t kMinuteSlots = std::size_t{1} << 17;  ///< Ячеек кольца минут
+    static constexpr std::size_t kRooms = std::size_t{1} << 16;        ///< Комнат протокола
+
+    InMemoryDatabase()
+        : minutes_(std::make_unique<std::atomic<uint64_t>[]>(kMinuteSlots))
+        , rooms_(std::make_unique<std::atomic<Node*>[]>(kRooms)) {
+    }
+
+    /**
+     * @brief Деструктор - освобождает сообщения всех комнат
+     */
+    ~InMemoryDatabase() override {
+        for (std::size_t room = 0; room < kRooms; ++room) {
+            Node* node = rooms_[room].load(std::memory_order_acquire);
+            while (node != nullptr) {
+                Node* next = node->next;
+                delete node;
+                node = next;
+            }
+        }
+    }
+
+    InMemoryDatabase(const InMemoryDatabase&) = delete;             ///< Запрет копирования
+    InMemoryDatabase& operator=(const InMemoryDatabase&) = delete;  ///< Запрет присваивания
+    InMemoryDatabase(InMemoryDatabase&&) = delete;                  ///< Запрет перемещения
+    InMemoryDatabase& operator=(
+        InMemoryDatabase&&) = delete;  ///< Запрет перемещающего присваивания
+
+    /**
+     * @brief Схема не нужна
+     */
+    void Initialize() override {
+    }
+
+    /**
+     * @brief Регистрирует посещение с текущим временем
+     */
+    void MarkVisit() override {
+        visits_.fetch_add(1, std::memory_order_relaxed);
+        AddMinute(VisitHistogram::MinuteOf(std::chrono::system_clock::now()), 1);
+    }
+
+    /**
+     * @brief Регистрирует пакет посещений
+     *
+     * Пакет сначала агрегируется по минутам, поэтому compare-and-swap
+     * выполняется один раз на минуту, а не на посещение.
+     *
+     * @param times Временные метки посещений
+     */
+    void MarkVisits(const std::vector<std::chrono::system_clock::time_point>& times) override {
+        VisitHistogram histogram;
+        histogram.Add(times);
+        for (const VisitBucket& bucket : histogram.Buckets()) {
+            AddMinute(bucket.minute, bucket.count);
+        }
+        visits_.fetch_add(times.size(), std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Получает общее количество посещений
+     */
+    uint64_t GetCount() override {
+        return visits_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Получает количество посещений по интервалам времени
+     *
+     * Минуты старше kMinuteSlots от самой новой записанной минуты
+     * вытеснены из кольца и не учитываются.
+     *
+     * @param from Начало периода (включительно, округляется вниз до интервала)
+     * @param to Конец периода (не включительно)
+     * @param granularity Размер интервала
+     * @return std::vector<VisitBucket> Непустые интервалы в порядке возрастания
+     */
+    std::vector<VisitBucket> GetVisitCounts(
+        std::chrono::system_clock::time_point from, std::chrono::system_clock::time_point to,
+        VisitGranularity granularity) override {
+        const int64_t width = MinutesPerBucket(granularity);
+        const int64_t newest = newest_minute_.load(std::memory_order_acquire);
+        const int64_t first = std::max(
+            VisitHistogram::AlignDown(VisitHistogram::MinuteOf(from), width),
+            newest - static_cast<int64_t>(kMinuteSlots) + 1);
+        const int64_t last =
+            std::min(VisitHistogram::MinuteOf(to - std::chrono::microseconds(1)), newest);
+
+        std::vector<VisitBucket> result;
+        for (int64_t minute = first; minute <= last; ++minute) {
+            const uint64_t word = SlotOf(minute).load(std::memory_order_relaxed);
+            if (word == 0 || MinuteOfWord(word) != minute) {
+                continue;
+            }
+            const int64_t start = VisitHistogram::AlignDown(minute, width);
+            if (!result.empty() && result.back().minute == start) {
+                result.back().count += CountOfWord(word);
+            } else {
+                result.push_back(VisitBucket{start, CountOfWord(word)});
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief Резервирует блок идентификаторов сообщений
+     *
+     * @return uint64_t Первый идентификатор блока
+     */
+    uint64_t ReserveMessageIds() override {
+        return next_message_id_.fetch_add(kMessageIdBlock, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Добавляет сообщения в головы списков их комнат
+     *
+     * @param messages Сообщения с назначенными идентификаторами
+     */
+    void AppendMessages(const std::vector<ChatMessage>& messages) override {
+        for (const ChatMessage& message : messages) {
+            auto* node = new Node{message, nullptr};
+            std::atomic<Node*>& head = rooms_[message.room];
+            node->next = head.load(std::memory_order_relaxed);
+            while (!head.compare_exchange_weak(
+                node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+            }
+        }
+    }
+
+    /**
+     * @brief Читает страницу истории комнаты
+     *
+     * @param room Комната
+     * @param before_id Курсор: возвращаются сообщения с id меньше него
+     * @param limit Максимальное количество сообщений
+     * @return std::vector<ChatMessage> Сообщения от новых к старым
+     */
+    std::vector<ChatMessage> GetMessages(
+        uint16_t room, uint64_t before_id, std::size_t limit) override {
+        std::vector<ChatMessage> page;
+        for (const Node* node = rooms_[room].load(std::memory_order_acquire);
+             node != nullptr && page.size() < limit; node = node->next) {
+            if (node->message.id < before_id) {
+                page.push_back(node->message);
+            }
+        }
+        return page;
+    }
+
+   private:
+    /// Узел списка сообщений комнаты
+    struct Node {
+        ChatMessage message;  ///< Сообщение
+        Node* next;           ///< Предыдущее (более старое) сообщение
+    };
+
+    /// Битов количества в слове ячейки минуты; старшие 26 бит - минута + 1 (до 2097 года)
+    static constexpr unsigned kCountBits = 38;
+    /// Маска количества в слове ячейки
+    static constexpr uint64_t kCountMask = (uint64_t{1} << kCountBits) - 1;
+
+    /**
+     * @brief Минута слова ячейки (слово 0 - пустая ячейка)
+     */
+    static int64_t MinuteOfWord(uint64_t word) {
+        return static_cast<int64_t>(word >> kCountBits) - 1;
+    }
+
+    /**
+     * @brief Количество посещений слова ячейки
+     */
+    static uint64_t CountOfWord(uint64_t word) {
+        return word & kCountMask;
+    }
+
+    /**
+     * @brief Ячейка кольца для минуты
+     */
+    std::atomic<uint64_t>& SlotOf(int64_t minute) {
+        return minutes_[static_cast<uint64_t>(minute) & (kMinuteSlots - 1)];
+    }
+
+    /**
+     * @brief Прибавляет посещения к ячейке минуты
+     *
+     * Ячейку с более старой минутой занимает новая; посещения минуты,
+     * вытесненной более новой, отбрасываются. Минуты до эпохи Unix не
+     * учитываются.
+     */
+    void AddMinute(int64_t minute, uint64_t count) {
+        if (minute < 0) {
+            return;
+        }
+        std::atomic<uint64_t>& slot = SlotOf(minute);
+        uint64_t word = slot.load(std::memory_order_relaxed);
+        for (;;) {
+            uint64_t next = 0;
+            if (word != 0 && MinuteOfWord(word) == minute) {
+                next = word + std::min(count, kCountMask - CountOfWord(word));
+            } else if (word == 0 || MinuteOfWord(word) < minute) {
+                next = (static_cast<uint64_t>(minute + 1) << kCountBits) |
+                       std::min(count, kCountMask);
+            } else {
+                return;
+            }
+            if (slot.compare_exchange_weak(word, next, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        int64_t newest = newest_minute_.load(std::memory_order_relaxed);
+        while (newest < minute &&
+               !newest_minute_.compare_exchange_weak(newest, minute, std::memory_order_release)) {
+        }
+    }
+
+    std::atomic<uint64_t> visits_{0};                            ///< Общее количество посещений
+    std::atomic<uint64_t> next_message_id_{1};                   ///< Начало следующего блока
+    std::atomic<int64_t> newest_minute_{-1};                     ///< Самая новая минута кольца
+    std::unique_ptr<std::atomic<uint64_t>[]> minutes_;           ///< Кольцо посещений по минутам
+    std::unique_ptr<std::atomic<Node*>[]> rooms_;                ///< Головы списков комнат
+};
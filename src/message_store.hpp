@@ -0,0 +1,551 @@
+#pragma once
+
+#include "config.hpp"
+#include "database_service.hpp"
+#include "logger.hpp"
+
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/system_executor.hpp>
+#include <boost/asio/thread_pool.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <iterator>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Хранилище сообщений чата с групповой записью и кешем истории
+ *
+ * Класс MessageStore стоит между сессиями чата и IDatabaseService:
+ * - Append() назначает сообщению идентификатор из зарезервированного
+ *   блока, кладет его в буфер записи и в кеш комнаты, не обращаясь к БД.
+ *   Следующий блок из IDatabaseService::kMessageIdBlock идентификаторов
+ *   фоновый поток резервирует заранее, когда текущий использован наполовину
+ * - Фоновый поток записывает буфер одним AppendMessages() (COPY в одной
+ *   транзакции) при достижении размера пакета или по таймеру
+ * - History() читает историю по курсору (id последнего полученного
+ *   сообщения). Кеш хранит последние сообщения комнат и отдает типичный
+ *   запрос "последние N" без обращения к БД; старые страницы читаются
+ *   из БД по индексу (room_id, id). AsyncHistory() читает БД через
+ *   IHistoryReader или в своем пуле потоков и не блокирует поток вызывающего
+ *
+ * Кеш хранит до cache_rooms комнат (вытесняется давно не использованная)
+ * и до cache_messages последних сообщений каждой. Сообщения в кеше всегда
+ * образуют непрерывный хвост истории комнаты. Страница, прочитанная из БД,
+ * дополняется еще не записанными сообщениями комнаты из буфера, поэтому
+ * сообщение, вытесненное из кеша до записи, не пропадает из истории.
+ */
+class MessageStore {
+   public:
+    /**
+     * @brief Конструктор хранилища
+     *
+     * @param backend Сервис базы данных
+     * @param batch_size Количество сообщений, при накоплении которого пакет пишется сразу
+     * @param flush_interval Максимальное время ожидания перед записью пакета
+     * @param cache_rooms Количество комнат в кеше истории (0 - кеш отключен)
+     * @param cache_messages Количество последних сообщений комнаты в кеше
+     * @param reader Асинхронный источник страниц истории для AsyncHistory()
+     *        (nullptr - backend->GetMessages() в пуле потоков хранилища)
+     */
+    MessageStore(
+        std::shared_ptr<IDatabaseService> backend, std::size_t batch_size,
+        std::chrono::milliseconds flush_interval, std::size_t cache_rooms,
+        std::size_t cache_messages, std::shared_ptr<IHistoryReader> reader = nullptr)
+        : backend_(std::move(backend))
+        , reader_(std::move(reader))
+        , batch_size_(batch_size > 0 ? batch_size : 1)
+        , flush_interval_(flush_interval)
+        , cache_rooms_(cache_rooms)
+        , cache_messages_(cache_messages) {
+        if (!reader_) {
+            readers_ = std::make_unique<boost::asio::thread_pool>(kHistoryReaders);
+        }
+        pending_.reserve(batch_size_);
+        Prefetch();
+        worker_ = std::thread([this] { Run(); });
+    }
+
+    /**
+     * @brief Конструктор с параметрами из конфигурации
+     *
+     * @param backend Сервис базы данных
+     * @param reader Асинхронный источник страниц истории (nullptr - пул потоков)
+     */
+    explicit MessageStore(
+        std::shared_ptr<IDatabaseService> backend, std::shared_ptr<IHistoryReader> reader = nullptr)
+        : MessageStore(
+              std::move(backend), static_cast<std::size_t>(GetConfig().GetMessageBatchSize()),
+              std::chrono::milliseconds(GetConfig().GetMessageFlushIntervalMs()),
+              static_cast<std::size_t>(GetConfig().GetMessageCacheRooms()),
+              static_cast<std::size_t>(GetConfig().GetMessageCacheSize()), std::move(reader)) {
+    }
+
+    /**
+     * @brief Деструктор - останавливает фоновый поток и записывает остаток буфера
+     */
+    ~MessageStore() {
+        if (readers_) {
+            readers_->join();
+        }
+        {
+            const std::lock_guard<std::mutex> lock(mutex_);
+            stopped_ = true;
+        }
+        cv_.notify_one();
+        worker_.join();
+        Flush();
+    }
+
+    MessageStore(const MessageStore&) = delete;             ///< Запрет копирования
+    MessageStore& operator=(const MessageStore&) = delete;  ///< Запрет присваивания
+    MessageStore(MessageStore&&) = delete;                  ///< Запрет перемещения
+    MessageStore& operator=(MessageStore&&) = delete;       ///< Запрет перемещающего присваивания
+
+    /**
+     * @brief Сохраняет сообщение
+     *
+     * Идентификатор берется из текущего блока или из блока, заранее
+     * зарезервированного фоновым потоком. Append() не обращается к БД:
+     * если резервный блок еще не получен (база данных недоступна),
+     * сообщение не сохраняется, а фоновый поток повторяет резервирование.
+     *
+     * @param room Комната
+     * @param author Имя отправителя
+     * @param text Текст сообщения
+     * @return ChatMessage Сообщение с назначенными идентификатором и временем
+     * @throws DatabaseUnavailableError если свободных идентификаторов нет
+     */
+    ChatMessage Append(uint16_t room, std::string_view author, std::string_view text) {
+        bool notify = false;
+        ChatMessage message{0, room, std::string(author), std::string(text),
+                            std::chrono::system_clock::now()};
+        {
+            const std::lock_guard<std::mutex> lock(mutex_);
+            if (next_id_ == block_end_) {
+                if (spare_id_ == 0) {
+                    cv_.notify_one();
+                    throw DatabaseUnavailableError("message ids are not reserved");
+                }
+                next_id_ = spare_id_;
+                block_end_ = next_id_ + IDatabaseService::kMessageIdBlock;
+                spare_id_ = 0;
+            }
+            message.id = next_id_++;
+            if (cache_rooms_ > 0 && cache_messages_ > 0) {
+                RoomCache& cache = Touch(room);
+                cache.recent.push_back(message);
+                if (cache.recent.size() > cache_messages_) {
+                    cache.recent.pop_front();
+                    cache.complete = false;
+                }
+                Evict();
+            }
+            pending_.push_back(message);
+            notify = pending_.size() >= batch_size_ || NeedsSpareBlock();
+        }
+        if (notify) {
+            cv_.notify_one();
+        }
+        return message;
+    }
+
+    /**
+     * @brief Читает страницу истории комнаты
+     *
+     * @param room Комната
+     * @param before_id Курсор: сообщения с id меньше него (0 - самые новые)
+     * @param limit Максимальное количество сообщений
+     * @return std::vector<ChatMessage> Сообщения от новых к старым
+     * @throws DatabaseUnavailableError если страница не в кеше и БД недоступна
+     */
+    std::vector<ChatMessage> History(uint16_t room, uint64_t before_id, std::size_t limit) {
+        HistoryPage page;
+        if (Lookup(room, before_id, limit, page)) {
+            return std::move(page.messages);
+        }
+        std::vector<ChatMessage> older = backend_->GetMessages(room, page.cursor, page.missing);
+        return Complete(room, before_id, std::move(page), std::move(older));
+    }
+
+    /**
+     * @brief Асинхронно читает страницу истории комнаты
+     *
+     * Страница из кеша отдается сразу. Недостающие сообщения читает
+     * IHistoryReader, а если он не задан - backend->GetMessages() в пуле
+     * потоков хранилища. Результат доставляется через executor
+     * обработчика (для use_awaitable - executor корутины).
+     *
+     * @note Хранилище должно пережить чтения, начатые через IHistoryReader.
+     *
+     * @param room Комната
+     * @param before_id Курсор: сообщения с id меньше него (0 - самые новые)
+     * @param limit Максимальное количество сообщений
+     * @param token Completion token с сигнатурой
+     *        void(std::exception_ptr, std::vector<ChatMessage>)
+     */
+    template <typename CompletionToken>
+    auto AsyncHistory(
+        uint16_t room, uint64_t before_id, std::size_t limit, CompletionToken&& token) {
+        return boost::asio::async_initiate<
+            CompletionToken, void(std::exception_ptr, std::vector<ChatMessage>)>(
+            [this, room, before_id, limit](auto handler) {
+                auto work = boost::asio::make_work_guard(
+                    boost::asio::get_associated_executor(handler, boost::asio::system_executor()));
+                auto page = std::make_shared<HistoryPage>();
+                if (Lookup(room, before_id, limit, *page)) {
+                    boost::asio::post(
+                        work.get_executor(), [handler = std::move(handler),
+                                              messages = std::move(page->messages)]() mutable {
+                            std::move(handler)(nullptr, std::move(messages));
+                        });
+                    return;
+                }
+
+                // Обработчик asio только перемещаемый, а IHistoryReader::Callback копируется
+                auto state = std::make_shared<std::pair<decltype(handler), decltype(work)>>(
+                    std::move(handler), std::move(work));
+                IHistoryReader::Callback done = [this, room, before_id, page, state](
+                                                    std::exception_ptr error,
+                                                    std::vector<ChatMessage> older) {
+                    std::vector<ChatMessage> messages;
+                    if (!error) {
+                        messages = Complete(room, before_id, std::move(*page), std::move(older));
+                    }
+                    auto& [handler, work] = *state;
+                    boost::asio::post(
+                        work.get_executor(), [handler = std::move(handler), error,
+                                              messages = std::move(messages)]() mutable {
+                            std::move(handler)(error, std::move(messages));
+                        });
+                    work.reset();
+                };
+
+                if (reader_) {
+                    reader_->ReadMessages(room, page->cursor, page->missing, std::move(done));
+                    return;
+                }
+                boost::asio::post(
+                    *readers_, [this, room, cursor = page->cursor, missing = page->missing,
+                                done = std::move(done)] {
+                        std::exception_ptr error;
+                        std::vector<ChatMessage> older;
+                        try {
+                            older = backend_->GetMessages(room, cursor, missing);
+                        } catch (...) {
+                            error = std::current_exception();
+                        }
+                        done(error, std::move(older));
+                    });
+            },
+            token);
+    }
+
+    /**
+     * @brief Синхронно записывает все накопленные сообщения
+     *
+     * При ошибке записи пакет возвращается в буфер и будет записан
+     * при следующем сбросе.
+     */
+    void Flush() {
+        const std::lock_guard<std::mutex> flush_lock(flush_mutex_);
+
+        // Пакет остается виден History() в in_flight_, пока не записан
+        {
+            const std::lock_guard<std::mutex> lock(mutex_);
+            if (pending_.empty()) {
+                return;
+            }
+            in_flight_.swap(pending_);
+            pending_.reserve(batch_size_);
+        }
+
+        try {
+            backend_->AppendMessages(in_flight_);
+            const std::lock_guard<std::mutex> lock(mutex_);
+            in_flight_.clear();
+        } catch (const std::exception& e) {
+            LOG_ERROR << "Failed to store " << in_flight_.size() << " messages: " << e.what();
+            Requeue();
+        }
+    }
+
+   private:
+    /// Во сколько раз буфер может превысить размер пакета, пока БД недоступна
+    static constexpr std::size_t kMaxPendingBatches = 64;
+    /// Потоков чтения истории из БД для AsyncHistory()
+    static constexpr std::size_t kHistoryReaders = 2;
+
+    /**
+     * @brief Страница истории, которую нужно дочитать из БД
+     */
+    struct HistoryPage {
+        std::vector<ChatMessage> messages;   ///< Сообщения из кеша, от новых к старым
+        std::vector<ChatMessage> unwritten;  ///< Не записанные сообщения старше cursor
+        bool cached = false;                 ///< Была ли комната в кеше
+        uint64_t evictions = 0;              ///< Значение evictions_ перед чтением БД
+        uint64_t cursor = 0;                 ///< Курсор чтения из БД
+        std::size_t missing = 0;             ///< Сколько сообщений дочитать из БД
+    };
+
+    /**
+     * @brief Кеш последних сообщений комнаты
+     */
+    struct RoomCache {
+        std::deque<ChatMessage> recent;       ///< Хвост истории, от старых к новым
+        bool complete = false;                ///< Кеш содержит всю историю комнаты
+        std::list<uint16_t>::iterator lru{};  ///< Позиция в списке LRU
+    };
+
+    /**
+     * @brief Читает начало страницы истории из кеша
+     *
+     * @param room Комната
+     * @param before_id Курсор: сообщения с id меньше него (0 - самые новые)
+     * @param limit Максимальное количество сообщений
+     * @param page Страница: сообщения из кеша и параметры чтения из БД
+     * @return true если страница полностью отдана из кеша
+     */
+    bool Lookup(uint16_t room, uint64_t before_id, std::size_t limit, HistoryPage& page) {
+        const uint64_t before = before_id == 0 ? std::numeric_limits<uint64_t>::max() : before_id;
+        std::vector<ChatMessage>& messages = page.messages;
+        const std::lock_guard<std::mutex> lock(mutex_);
+        const auto it = cache_.find(room);
+        if (it != cache_.end()) {
+            page.cached = true;
+            lru_.splice(lru_.begin(), lru_, it->second.lru);
+            const auto& recent = it->second.recent;
+            for (auto m = recent.rbegin(); m != recent.rend() && messages.size() < limit; ++m) {
+                if (m->id < before) {
+                    messages.push_back(*m);
+                }
+            }
+            if (messages.size() == limit || it->second.complete) {
+                return true;
+            }
+        }
+        // Сообщения комнаты, которых еще может не быть в БД
+        page.cursor = messages.empty() ? before : messages.back().id;
+        page.missing = limit - messages.size();
+        for (const auto* buffer : {&in_flight_, &pending_}) {
+            for (const ChatMessage& m : *buffer) {
+                if (m.room == room && m.id < page.cursor) {
+                    page.unwritten.push_back(m);
+                }
+            }
+        }
+        page.evictions = evictions_;
+        return false;
+    }
+
+    /**
+     * @brief Дополняет страницу истории сообщениями из БД
+     *
+     * @param room Комната
+     * @param before_id Курсор запроса (0 - самые новые)
+     * @param page Страница, начатая Lookup()
+     * @param older Сообщения из БД старше page.cursor, от новых к старым
+     * @return std::vector<ChatMessage> Страница от новых к старым
+     */
+    std::vector<ChatMessage> Complete(
+        uint16_t room, uint64_t before_id, HistoryPage page, std::vector<ChatMessage> older) {
+        const bool exhausted = older.size() < page.missing;
+
+        // Пакет мог записаться во время чтения: одно сообщение - один раз
+        older.insert(older.end(), std::make_move_iterator(page.unwritten.begin()),
+                     std::make_move_iterator(page.unwritten.end()));
+        std::sort(older.begin(), older.end(),
+                  [](const ChatMessage& a, const ChatMessage& b) { return a.id > b.id; });
+        older.erase(std::unique(older.begin(), older.end(),
+                                [](const ChatMessage& a, const ChatMessage& b) {
+                                    return a.id == b.id;
+                                }),
+                    older.end());
+        const bool truncated = older.size() > page.missing;
+        if (truncated) {
+            older.resize(page.missing);
+        }
+        std::vector<ChatMessage> messages = std::move(page.messages);
+        messages.insert(messages.end(), std::make_move_iterator(older.begin()),
+                        std::make_move_iterator(older.end()));
+
+        if (!page.cached && before_id == 0) {
+            Seed(room, messages, exhausted && !truncated, page.evictions);
+        }
+        return messages;
+    }
+
+    /**
+     * @brief Находит или создает кеш комнаты и делает его самым свежим
+     *
+     * Вызывается под mutex_.
+     */
+    RoomCache& Touch(uint16_t room) {
+        auto [it, inserted] = cache_.try_emplace(room);
+        if (inserted) {
+            lru_.push_front(room);
+            it->second.lru = lru_.begin();
+        } else {
+            lru_.splice(lru_.begin(), lru_, it->second.lru);
+        }
+        return it->second;
+    }
+
+    /**
+     * @brief Вытесняет давно не использованные комнаты сверх лимита
+     *
+     * Вызывается под mutex_.
+     */
+    void Evict() {
+        while (cache_.size() > cache_rooms_) {
+            cache_.erase(lru_.back());
+            lru_.pop_back();
+            ++evictions_;
+        }
+    }
+
+    /**
+     * @brief Заполняет кеш комнаты последними сообщениями из БД и буфера
+     *
+     * Если за время чтения в комнату пришли сообщения, кеш уже создан
+     * Append() и не перезаписывается. Если за это время из кеша вытеснялись
+     * комнаты, кеш, созданный Append(), мог быть уже вытеснен, и пришедших
+     * сообщений может не быть в newest, поэтому кеш не заполняется.
+     *
+     * @param room Комната
+     * @param newest Последние сообщения, от новых к старым
+     * @param exhausted Старше прочитанных сообщений в комнате нет
+     * @param evictions Значение evictions_ перед чтением
+     */
+    void Seed(uint16_t room, const std::vector<ChatMessage>& newest, bool exhausted,
+              uint64_t evictions) {
+        if (cache_rooms_ == 0 || cache_messages_ == 0) {
+            return;
+        }
+        const std::lock_guard<std::mutex> lock(mutex_);
+        if (cache_.find(room) != cache_.end() || evictions_ != evictions) {
+            return;
+        }
+        RoomCache& cache = Touch(room);
+        const std::size_t count = std::min(newest.size(), cache_messages_);
+        cache.recent.assign(newest.rend() - static_cast<std::ptrdiff_t>(count), newest.rend());
+        cache.complete = exhausted && count == newest.size();
+        Evict();
+    }
+
+    /**
+     * @brief Нужно ли заранее зарезервировать следующий блок идентификаторов
+     *
+     * Вызывается под mutex_.
+     */
+    [[nodiscard]] bool NeedsSpareBlock() const {
+        return spare_id_ == 0 && block_end_ - next_id_ <= IDatabaseService::kMessageIdBlock / 2;
+    }
+
+    /**
+     * @brief Резервирует следующий блок идентификаторов вне мьютекса
+     *
+     * Вызывается только из конструктора и фонового потока, поэтому
+     * резервный блок не может быть получен дважды.
+     *
+     * @return true если блок получен, false если база данных недоступна
+     */
+    bool Prefetch() {
+        try {
+            const uint64_t first = backend_->ReserveMessageIds();
+            const std::lock_guard<std::mutex> lock(mutex_);
+            spare_id_ = first;
+            return true;
+        } catch (const std::exception& e) {
+            LOG_WARNING << "Failed to reserve message ids: " << e.what();
+            return false;
+        }
+    }
+
+    /**
+     * @brief Возвращает не записанный пакет in_flight_ в начало буфера
+     *
+     * Если база данных долго недоступна, самые старые сообщения
+     * отбрасываются, чтобы буфер не рос неограниченно.
+     */
+    void Requeue() {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<ChatMessage> batch;
+        batch.swap(in_flight_);
+        batch.insert(batch.end(), std::make_move_iterator(pending_.begin()),
+                     std::make_move_iterator(pending_.end()));
+        const std::size_t limit = batch_size_ * kMaxPendingBatches;
+        if (batch.size() > limit) {
+            const std::size_t dropped = batch.size() - limit;
+            batch.erase(batch.begin(), batch.begin() + static_cast<std::ptrdiff_t>(dropped));
+            LOG_WARNING << "Message buffer overflow, dropped " << dropped << " messages";
+        }
+        pending_.swap(batch);
+    }
+
+    /**
+     * @brief Цикл фонового потока
+     *
+     * Резервирует следующий блок идентификаторов, когда он понадобится,
+     * и записывает буфер. После неудачного резервирования следующая
+     * попытка делается не раньше чем через интервал записи.
+     */
+    void Run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        bool retry_later = false;
+        while (!stopped_) {
+            cv_.wait_for(lock, flush_interval_, [this, retry_later] {
+                return stopped_ || pending_.size() >= batch_size_ ||
+                       (!retry_later && NeedsSpareBlock());
+            });
+            if (stopped_) {
+                break;
+            }
+            const bool prefetch = NeedsSpareBlock();
+            lock.unlock();
+            if (prefetch) {
+                retry_later = !Prefetch();
+            }
+            Flush();
+            lock.lock();
+        }
+    }
+
+    std::shared_ptr<IDatabaseService> backend_;      ///< Сервис базы данных
+    std::shared_ptr<IHistoryReader> reader_;         ///< Источник страниц для AsyncHistory()
+    std::size_t batch_size_;                         ///< Порог размера пакета
+    std::chrono::milliseconds flush_interval_;       ///< Максимальный интервал записи
+    std::size_t cache_rooms_;                        ///< Комнат в кеше истории
+    std::size_t cache_messages_;                     ///< Сообщений комнаты в кеше
+    std::vector<ChatMessage> pending_;               ///< Буфер записи
+    std::vector<ChatMessage> in_flight_;             ///< Записываемый пакет
+    std::unordered_map<uint16_t, RoomCache> cache_;  ///< Кеш истории комнат
+    std::list<uint16_t> lru_;                        ///< Комнаты от свежих к старым
+    uint64_t next_id_ = 0;                           ///< Следующий идентификатор блока
+    uint64_t block_end_ = 0;                         ///< Конец зарезервированного блока
+    uint64_t spare_id_ = 0;                          ///< Начало следующего блока (0 - нет)
+    uint64_t evictions_ = 0;                         ///< Счетчик вытесненных комнат
+    bool stopped_ = false;                           ///< Флаг остановки фонового потока
+    std::mutex mutex_;                               ///< Мьютекс буфера, кеша и блока
+    std::mutex flush_mutex_;                         ///< Сериализует одновременные записи
+    std::condition_variable cv_;                     ///< Пробуждение фонового потока
+    std::thread worker_;                             ///< Фоновый поток записи
+    std::unique_ptr<boost::asio::thread_pool> readers_;  ///< Потоки чтения истории без reader_
+};
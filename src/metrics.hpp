@@ -0,0 +1,520 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Снимок гистограммы задержек
+ *
+ * Хранит количество наблюдений в логарифмически-линейных корзинах
+ * (как в HdrHistogram): значения в микросекундах делятся по степеням двойки,
+ * а каждая степень - на kSubBuckets равных частей. Относительная
+ * погрешность не превышает 1 / kSubBuckets.
+ *
+ * Корзина включает свою верхнюю границу и не включает нижнюю, как
+ * корзины le в Prometheus, поэтому количество наблюдений не больше
+ * границы корзины (например, степени двойки) считается точно.
+ */
+struct HistogramSnapshot {
+    static constexpr std::size_t kSubBucketBits = 4;                   ///< Бит на поддиапазон
+    static constexpr std::size_t kSubBuckets = 1U << kSubBucketBits;   ///< Поддиапазонов
+    static constexpr std::size_t kMaxMagnitude = 27;                   ///< Значения < 2^27 мкс
+    static constexpr std::size_t kBuckets =
+        kSubBuckets + (kMaxMagnitude - kSubBucketBits) * kSubBuckets;  ///< Всего корзин
+
+    std::array<uint64_t, kBuckets> counts{};  ///< Наблюдения по корзинам
+    uint64_t count = 0;                       ///< Общее количество наблюдений
+    uint64_t sum_micros = 0;                  ///< Сумма наблюдений в микросекундах
+
+    /**
+     * @brief Возвращает индекс корзины для значения
+     *
+     * @param micros Значение в микросекундах
+     * @return std::size_t Индекс корзины (значения вне диапазона попадают в последнюю)
+     */
+    static constexpr std::size_t BucketIndex(uint64_t micros) {
+        // Корзина (нижняя граница, верхняя граница]: 0 и 1 попадают в первую
+        const uint64_t value = micros > 0 ? micros - 1 : 0;
+        if (value < kSubBuckets) {
+            return static_cast<std::size_t>(value);
+        }
+        const auto magnitude = static_cast<std::size_t>(std::bit_width(value) - 1);
+        if (magnitude >= kMaxMagnitude) {
+            return kBuckets - 1;
+        }
+        const std::size_t shift = magnitude - kSubBucketBits;
+        const auto sub = static_cast<std::size_t>(value >> shift) - kSubBuckets;
+        return kSubBuckets + shift * kSubBuckets + sub;
+    }
+
+    /**
+     * @brief Возвращает верхнюю границу корзины (включительно)
+     *
+     * @param index Индекс корзины
+     * @return uint64_t Граница в микросекундах
+     */
+    static constexpr uint64_t BucketUpperBound(std::size_t index) {
+        if (index < kSubBuckets) {
+            return index + 1;
+        }
+        const std::size_t shift = (index - kSubBuckets) / kSubBuckets;
+        const std::size_t sub = (index - kSubBuckets) % kSubBuckets;
+        return static_cast<uint64_t>(kSubBuckets + sub + 1) << shift;
+    }
+
+    /**
+     * @brief Добавляет наблюдение (для однопоточного использования)
+     *
+     * @param micros Значение в микросекундах
+     */
+    void Record(uint64_t micros) {
+        ++counts[BucketIndex(micros)];
+        ++count;
+        sum_micros += micros;
+    }
+
+    /**
+     * @brief Добавляет наблюдения другого снимка
+     */
+    void Merge(const HistogramSnapshot& other) {
+        for (std::size_t i = 0; i < kBuckets; ++i) {
+            counts[i] += other.counts[i];
+        }
+        count += other.count;
+        sum_micros += other.sum_micros;
+    }
+
+    /**
+     * @brief Количество наблюдений не больше заданной границы
+     *
+     * Точно для границ, совпадающих с границами корзин (например, степеней двойки).
+     *
+     * @param micros Граница в микросекундах (включительно)
+     * @return uint64_t Количество наблюдений
+     */
+    [[nodiscard]] uint64_t CountAtMost(uint64_t micros) const {
+        const std::size_t end = micros >= BucketUpperBound(kBuckets - 1)
+                                    ? kBuckets
+                                    : BucketIndex(micros) + 1;
+        uint64_t total = 0;
+        for (std::size_t i = 0; i < end; ++i) {
+            total += counts[i];
+        }
+        return total;
+    }
+
+    /**
+     * @brief Оценивает квантиль распределения
+     *
+     * @param quantile Квантиль в диапазоне [0, 1], например 0.99
+     * @return uint64_t Верхняя граница корзины квантиля в микросекундах (0 без наблюдений)
+     */
+    [[nodiscard]] uint64_t Percentile(double quantile) const {
+        if (count == 0) {
+            return 0;
+        }
+        const auto rank = static_cast<uint64_t>(quantile * static_cast<double>(count - 1)) + 1;
+        uint64_t seen = 0;
+        for (std::size_t i = 0; i < kBuckets; ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                return BucketUpperBound(i);
+            }
+        }
+        return BucketUpperBound(kBuckets - 1);
+    }
+};
+
+/**
+ * @brief Гистограмма задержек, пополняемая без блокировок
+ *
+ * Корзины - атомарные счетчики с relaxed-порядком. Каждая гистограмма
+ * принадлежит одному шарду Metrics, поэтому запись почти никогда не конкурирует.
+ */
+class LatencyHistogram {
+   public:
+    /**
+     * @brief Добавляет наблюдение
+     *
+     * @param micros Значение в микросекундах
+     */
+    void Record(uint64_t micros) {
+        counts_[HistogramSnapshot::BucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_micros_.fetch_add(micros, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Добавляет текущие значения в снимок
+     */
+    void AddTo(HistogramSnapshot& snapshot) const {
+        for (std::size_t i = 0; i < HistogramSnapshot::kBuckets; ++i) {
+            snapshot.counts[i] += counts_[i].load(std::memory_order_relaxed);
+        }
+        snapshot.count += count_.load(std::memory_order_relaxed);
+        snapshot.sum_micros += sum_micros_.load(std::memory_order_relaxed);
+    }
+
+   private:
+    std::array<std::atomic<uint64_t>, HistogramSnapshot::kBuckets> counts_{};  ///< Корзины
+    std::atomic<uint64_t> count_{0};       ///< Количество наблюдений
+    std::atomic<uint64_t> sum_micros_{0};  ///< Сумма наблюдений в микросекундах
+};
+
+/**
+ * @brief Счетчики, которые только растут
+ */
+enum class Counter : uint8_t {
+    kAcceptedConnections,  ///< Принятые соединения
+    kRequests,             ///< Обработанные HTTP запросы
+    kBytesReceived,        ///< Прочитанные из сокетов байты
+    kBytesSent,            ///< Отправленные в сокеты байты
+    kPoolTimeouts,         ///< Истекшие ожидания соединения из пула
+    kPoolConnectFailures,  ///< Неудачные попытки открыть соединение пула
+    kChatFramesReceived,   ///< Принятые кадры протокола чата
+    kChatFramesSent,       ///< Отправленные кадры протокола чата
+    kChatFramesDropped,    ///< Кадры рассылки, отброшенные из-за переполнения очереди
+    kChatSlowConsumers,    ///< Соединения чата, закрытые как медленные получатели
+    kRejectedSessions,     ///< Соединения, отклоненные по лимиту одновременных сессий
+    kRejectedRate,         ///< Соединения, отклоненные по лимиту частоты с одного адреса
+    kAcceptBackoffs,       ///< Паузы приема соединений из-за нехватки ресурсов
+    kTlsHandshakes,        ///< Завершенные рукопожатия TLS
+    kTlsResumed,           ///< Рукопожатия TLS, возобновившие сессию по билету
+    kTlsKernelOffload,     ///< Соединения TLS с шифрованием записей в ядре (kTLS)
+    kCount,                ///< Количество счетчиков
+};
+
+/**
+ * @brief Показатели, которые могут расти и убывать
+ */
+enum class Gauge : uint8_t {
+    kActiveSessions,        ///< Активные сессии
+    kPoolSize,              ///< Открытые соединения пула к БД
+    kPoolConnectionsInUse,  ///< Занятые соединения пула
+    kChatSessions,          ///< Активные сессии чата
+    kRegisteredPeers,       ///< Пиры в реестре обнаружения
+    kCount,                 ///< Количество показателей
+};
+
+/**
+ * @brief Гистограммы задержек
+ */
+enum class Histogram : uint8_t {
+    kAccept,    ///< Обработка принятого соединения
+    kRead,      ///< Чтение и разбор заголовков запроса
+    kDb,        ///< Обращение к базе данных при ответе
+    kWrite,     ///< Отправка ответа
+    kPoolWait,  ///< Ожидание соединения из пула
+    kCount,     ///< Количество гистограмм
+};
+
+/**
+ * @brief Метрики сервера в формате Prometheus
+ *
+ * Класс Metrics хранит счетчики, показатели и гистограммы в kShards шардах,
+ * выровненных по строкам кеша. Каждый поток пишет в свой шард (выбирается
+ * при первом обращении потока), поэтому инструментирование не создает
+ * конкуренции между потоками io_context. Render() суммирует шарды.
+ */
+class Metrics {
+   public:
+    static constexpr std::size_t kShards = 32;  ///< Количество шардов
+
+    Metrics() : shards_(std::make_unique<Shard[]>(kShards)) {
+    }
+
+    /**
+     * @brief Увеличивает счетчик
+     *
+     * @param counter Счетчик
+     * @param value Прирост
+     */
+    void Increment(Counter counter, uint64_t value = 1) {
+        LocalShard().counters[static_cast<std::size_t>(counter)].fetch_add(
+            value, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Изменяет показатель
+     *
+     * Изменения из разных потоков суммируются, поэтому увеличение
+     * и уменьшение могут происходить в разных потоках.
+     *
+     * @param gauge Показатель
+     * @param delta Изменение
+     */
+    void Add(Gauge gauge, int64_t delta) {
+        LocalShard().gauges[static_cast<std::size_t>(gauge)].fetch_add(
+            delta, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Добавляет наблюдение в гистограмму
+     *
+     * @param histogram Гистограмма
+     * @param duration Длительность
+     */
+    void Observe(Histogram histogram, std::chrono::nanoseconds duration) {
+        const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(duration);
+        LocalShard().histograms[static_cast<std::size_t>(histogram)].Record(
+            static_cast<uint64_t>(std::max<int64_t>(micros.count(), 0)));
+    }
+
+    /**
+     * @brief Суммарное значение счетчика по всем шардам
+     */
+    [[nodiscard]] uint64_t Value(Counter counter) const {
+        uint64_t total = 0;
+        for (std::size_t i = 0; i < kShards; ++i) {
+            total += shards_[i].counters[static_cast<std::size_t>(counter)].load(
+                std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    /**
+     * @brief Суммарное значение показателя по всем шардам
+     */
+    [[nodiscard]] int64_t Value(Gauge gauge) const {
+        int64_t total = 0;
+        for (std::size_t i = 0; i < kShards; ++i) {
+            total +=
+                shards_[i].gauges[static_cast<std::size_t>(gauge)].load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    /**
+     * @brief Снимок гистограммы, объединенный по всем шардам
+     */
+    [[nodiscard]] HistogramSnapshot Snapshot(Histogram histogram) const {
+        HistogramSnapshot snapshot;
+        for (std::size_t i = 0; i < kShards; ++i) {
+            shards_[i].histograms[static_cast<std::size_t>(histogram)].AddTo(snapshot);
+        }
+        return snapshot;
+    }
+
+    /**
+     * @brief Выводит все метрики в текстовом формате Prometheus
+     *
+     * @param out Строка, в которую дописывается результат (емкость переиспользуется)
+     */
+    void Render(std::string& out) const {
+        RenderCounter(out, "p2p_accepted_connections_total", "Accepted TCP connections",
+                      Counter::kAcceptedConnections);
+        RenderCounter(out, "p2p_http_requests_total", "Handled HTTP requests", Counter::kRequests);
+        RenderCounter(out, "p2p_bytes_received_total", "Bytes read from client sockets",
+                      Counter::kBytesReceived);
+        RenderCounter(out, "p2p_bytes_sent_total", "Bytes written to client sockets",
+                      Counter::kBytesSent);
+        RenderCounter(out, "p2p_db_pool_timeouts_total",
+                      "Database connection requests that timed out", Counter::kPoolTimeouts);
+        RenderCounter(out, "p2p_db_pool_connect_failures_total",
+                      "Failed attempts to open a database connection",
+                      Counter::kPoolConnectFailures);
+        RenderCounter(out, "p2p_chat_frames_received_total", "Chat protocol frames received",
+                      Counter::kChatFramesReceived);
+        RenderCounter(out, "p2p_chat_frames_sent_total", "Chat protocol frames sent",
+                      Counter::kChatFramesSent);
+        RenderCounter(out, "p2p_chat_frames_dropped_total",
+                      "Room frames dropped because a send queue was full",
+                      Counter::kChatFramesDropped);
+        RenderCounter(out, "p2p_chat_slow_consumers_total",
+                      "Chat connections closed for not keeping up with their room",
+                      Counter::kChatSlowConsumers);
+        RenderCounter(out, "p2p_rejected_session_limit_total",
+                      "Connections rejected because the session limit was reached",
+                      Counter::kRejectedSessions);
+        RenderCounter(out, "p2p_rejected_rate_limit_total",
+                      "Connections rejected by the per-address rate limit",
+                      Counter::kRejectedRate);
+        RenderCounter(out, "p2p_accept_backoffs_total",
+                      "Accept pauses caused by exhausted descriptors or memory",
+                      Counter::kAcceptBackoffs);
+        RenderCounter(out, "p2p_tls_handshakes_total", "Completed TLS handshakes",
+                      Counter::kTlsHandshakes);
+        RenderCounter(out, "p2p_tls_resumed_total",
+                      "TLS handshakes that resumed a session from a ticket",
+                      Counter::kTlsResumed);
+        RenderCounter(out, "p2p_tls_kernel_offload_total",
+                      "TLS connections whose records are encrypted by the kernel",
+                      Counter::kTlsKernelOffload);
+
+        RenderGauge(out, "p2p_active_sessions", "Sessions currently serving a client",
+                    Gauge::kActiveSessions);
+        RenderGauge(out, "p2p_db_pool_size", "Open database connections", Gauge::kPoolSize);
+        RenderGauge(out, "p2p_db_pool_connections_in_use", "Database connections checked out",
+                    Gauge::kPoolConnectionsInUse);
+        RenderGauge(out, "p2p_chat_sessions", "Connected chat peers", Gauge::kChatSessions);
+        RenderGauge(out, "p2p_registered_peers", "Peers registered for discovery",
+                    Gauge::kRegisteredPeers);
+
+        out += "# HELP p2p_phase_latency_seconds Latency of request handling phases\n";
+        out += "# TYPE p2p_phase_latency_seconds histogram\n";
+        RenderHistogram(out, "p2p_phase_latency_seconds", "phase=\"accept\"", Histogram::kAccept);
+        RenderHistogram(out, "p2p_phase_latency_seconds", "phase=\"read\"", Histogram::kRead);
+        RenderHistogram(out, "p2p_phase_latency_seconds", "phase=\"db\"", Histogram::kDb);
+        RenderHistogram(out, "p2p_phase_latency_seconds", "phase=\"write\"", Histogram::kWrite);
+
+        out += "# HELP p2p_db_pool_wait_seconds Time spent waiting for a pooled connection\n";
+        out += "# TYPE p2p_db_pool_wait_seconds histogram\n";
+        RenderHistogram(out, "p2p_db_pool_wait_seconds", {}, Histogram::kPoolWait);
+    }
+
+   private:
+    /// Размер строки кеша, по которому выравниваются шарды
+    static constexpr std::size_t kCacheLineSize = 64;
+    /// Экспортируемые границы корзин: 2^0 .. 2^kMaxMagnitude мкс
+    static constexpr std::size_t kExportedBounds = HistogramSnapshot::kMaxMagnitude + 1;
+
+    /**
+     * @brief Метрики одного потока
+     */
+    struct alignas(kCacheLineSize) Shard {
+        std::array<std::atomic<uint64_t>, static_cast<std::size_t>(Counter::kCount)>
+            counters{};  ///< Счетчики
+        std::array<std::atomic<int64_t>, static_cast<std::size_t>(Gauge::kCount)>
+            gauges{};  ///< Показатели
+        std::array<LatencyHistogram, static_cast<std::size_t>(Histogram::kCount)>
+            histograms;  ///< Гистограммы
+    };
+
+    /**
+     * @brief Шард текущего потока
+     */
+    Shard& LocalShard() {
+        static std::atomic<std::size_t> next_shard{0};
+        thread_local const std::size_t index =
+            next_shard.fetch_add(1, std::memory_order_relaxed) % kShards;
+        return shards_[index];
+    }
+
+    static void AppendNumber(std::string& out, uint64_t value) {
+        std::array<char, 24> digits{};
+        const auto result = std::to_chars(digits.data(), digits.data() + digits.size(), value);
+        out.append(digits.data(), result.ptr);
+    }
+
+    static void AppendNumber(std::string& out, int64_t value) {
+        std::array<char, 24> digits{};
+        const auto result = std::to_chars(digits.data(), digits.data() + digits.size(), value);
+        out.append(digits.data(), result.ptr);
+    }
+
+    static void AppendSeconds(std::string& out, uint64_t micros) {
+        std::array<char, 32> digits{};
+        const auto result = std::to_chars(
+            digits.data(), digits.data() + digits.size(), static_cast<double>(micros) / 1e6);
+        out.append(digits.data(), result.ptr);
+    }
+
+    static void AppendHeader(
+        std::string& out, std::string_view name, std::string_view help, std::string_view type) {
+        out.append("# HELP ").append(name).append(" ").append(help).append("\n");
+        out.append("# TYPE ").append(name).append(" ").append(type).append("\n");
+    }
+
+    void RenderCounter(std::string& out, std::string_view name, std::string_view help,
+                       Counter counter) const {
+        AppendHeader(out, name, help, "counter");
+        out.append(name).append(" ");
+        AppendNumber(out, Value(counter));
+        out += '\n';
+    }
+
+    void RenderGauge(
+        std::string& out, std::string_view name, std::string_view help, Gauge gauge) const {
+        AppendHeader(out, name, help, "gauge");
+        out.append(name).append(" ");
+        AppendNumber(out, Value(gauge));
+        out += '\n';
+    }
+
+    /**
+     * @brief Выводит гистограмму с границами корзин по степеням двойки
+     *
+     * @param out Результат
+     * @param name Имя метрики
+     * @param labels Метки без фигурных скобок (могут быть пустыми)
+     * @param histogram Гистограмма
+     */
+    void RenderHistogram(std::string& out, std::string_view name, std::string_view labels,
+                         Histogram histogram) const {
+        const HistogramSnapshot snapshot = Snapshot(histogram);
+        const std::string_view separator = labels.empty() ? "" : ",";
+        for (std::size_t i = 0; i < kExportedBounds; ++i) {
+            const uint64_t bound = uint64_t{1} << i;
+            out.append(name).append("_bucket{").append(labels).append(separator).append("le=\"");
+            AppendSeconds(out, bound);
+            out.append("\"} ");
+            AppendNumber(out, snapshot.CountAtMost(bound));
+            out += '\n';
+        }
+        out.append(name).append("_bucket{").append(labels).append(separator);
+        out.append("le=\"+Inf\"} ");
+        AppendNumber(out, snapshot.count);
+        out += '\n';
+
+        const std::string_view open = labels.empty() ? "" : "{";
+        const std::string_view close = labels.empty() ? "" : "}";
+        out.append(name).append("_sum").append(open).append(labels).append(close).append(" ");
+        AppendSeconds(out, snapshot.sum_micros);
+        out += '\n';
+        out.append(name).append("_count").append(open).append(labels).append(close).append(" ");
+        AppendNumber(out, snapshot.count);
+        out += '\n';
+    }
+
+    std::unique_ptr<Shard[]> shards_;  ///< Шарды метрик
+};
+
+/**
+ * @brief Возвращает глобальный экземпляр метрик
+ *
+ * @return Metrics& Метрики, создаваемые при первом обращении
+ */
+inline Metrics& GetMetrics() {
+    static Metrics metrics;
+    return metrics;
+}
+
+/**
+ * @brief Измеряет время жизни объекта и записывает его в гистограмму
+ */
+class ScopedLatency {
+   public:
+    /**
+     * @brief Начинает измерение
+     *
+     * @param histogram Гистограмма для результата
+     */
+    explicit ScopedLatency(Histogram histogram)
+        : histogram_(histogram), start_(std::chrono::steady_clock::now()) {
+    }
+
+    /**
+     * @brief Записывает прошедшее время
+     */
+    ~ScopedLatency() {
+        GetMetrics().Observe(histogram_, std::chrono::steady_clock::now() - start_);
+    }
+
+    ScopedLatency(const ScopedLatency&) = delete;             ///< Запрет копирования
+    ScopedLatency& operator=(const ScopedLatency&) = delete;  ///< Запрет присваивания
+    ScopedLatency(ScopedLatency&&) = delete;                  ///< Запрет перемещения
+    ScopedLatency& operator=(ScopedLatency&&) = delete;       ///< Запрет перемещающего присваивания
+
+   private:
+    Histogram histogram_;                          ///< Гистограмма для результата
+    std::chrono::steady_clock::time_point start_;  ///< Начало измерения
+};
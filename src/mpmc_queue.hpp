@@ -0,0 +1,143 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+/**
+ * @brief Ограниченная lock-free очередь с несколькими производителями и потребителями
+ *
+ * Класс MpmcQueue - кольцевой буфер по схеме Дмитрия Вьюкова:
+ * - Каждая ячейка хранит счетчик последовательности, по которому
+ *   производители и потребители определяют, свободна ли она
+ * - TryPush()/TryPop() не блокируются и не выделяют память:
+ *   при переполнении или пустой очереди они сразу возвращают false
+ * - Емкость округляется вверх до степени двойки
+ *
+ * @tparam T Тип элементов (должен быть перемещаемым и конструируемым по умолчанию)
+ */
+template <typename T>
+class MpmcQueue {
+   public:
+    /**
+     * @brief Конструктор очереди
+     *
+     * @param capacity Минимальная емкость очереди
+     */
+    explicit MpmcQueue(std::size_t capacity)
+        : mask_(RoundUpToPowerOfTwo(capacity) - 1), cells_(new Cell[mask_ + 1]) {
+        for (std::size_t i = 0; i <= mask_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;             ///< Запрет копирования
+    MpmcQueue& operator=(const MpmcQueue&) = delete;  ///< Запрет присваивания
+    MpmcQueue(MpmcQueue&&) = delete;                  ///< Запрет перемещения
+    MpmcQueue& operator=(MpmcQueue&&) = delete;       ///< Запрет перемещающего присваивания
+    ~MpmcQueue() = default;
+
+    /**
+     * @brief Пытается добавить элемент в очередь
+     *
+     * @param value Добавляемый элемент (перемещается только при успехе)
+     * @return true если элемент добавлен, false если очередь заполнена
+     */
+    bool TryPush(T& value) {
+        Cell* cell = nullptr;
+        std::size_t position = enqueue_position_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells_[position & mask_];
+            const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto diff =
+                static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+            if (diff == 0) {
+                if (enqueue_position_.compare_exchange_weak(
+                        position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                position = enqueue_position_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(value);
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Пытается добавить временный элемент в очередь
+     *
+     * @param value Добавляемый элемент
+     * @return true если элемент добавлен, false если очередь заполнена
+     */
+    bool TryPush(T&& value) {
+        return TryPush(value);
+    }
+
+    /**
+     * @brief Пытается извлечь элемент из очереди
+     *
+     * @param value Сюда перемещается извлеченный элемент
+     * @return true если элемент извлечен, false если очередь пуста
+     */
+    bool TryPop(T& value) {
+        Cell* cell = nullptr;
+        std::size_t position = dequeue_position_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells_[position & mask_];
+            const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto diff =
+                static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+            if (diff == 0) {
+                if (dequeue_position_.compare_exchange_weak(
+                        position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                position = dequeue_position_.load(std::memory_order_relaxed);
+            }
+        }
+        value = std::move(cell->value);
+        cell->sequence.store(position + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Емкость очереди
+     */
+    [[nodiscard]] std::size_t Capacity() const {
+        return mask_ + 1;
+    }
+
+   private:
+    /// Размер строки кеша, по которому разносятся счетчики позиций
+    static constexpr std::size_t kCacheLineSize = 64;
+
+    /**
+     * @brief Ячейка кольцевого буфера
+     */
+    struct Cell {
+        std::atomic<std::size_t> sequence{0};  ///< Счетчик последовательности ячейки
+        T value{};                             ///< Хранимый элемент
+    };
+
+    static std::size_t RoundUpToPowerOfTwo(std::size_t value) {
+        std::size_t result = 2;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const std::size_t mask_;                 ///< Маска индекса (емкость - 1)
+    const std::unique_ptr<Cell[]> cells_;    ///< Ячейки кольцевого буфера
+    alignas(kCacheLineSize) std::atomic<std::size_t> enqueue_position_{0};  ///< Позиция записи
+    alignas(kCacheLineSize) std::atomic<std::size_t> dequeue_position_{0};  ///< Позиция чтения
+};
@@ -0,0 +1,367 @@
+#pragma once
+
+#include "metrics.hpp"
+#include "timer_wheel.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Запись реестра пиров для хранилища
+ */
+struct PeerRecord {
+    std::string id;                                    ///< Идентификатор пира (имя участника)
+    std::string endpoint;                              ///< Адрес для прямого подключения host:port
+    std::chrono::system_clock::time_point expires_at;  ///< Момент истечения регистрации
+};
+
+/**
+ * @brief Изменения реестра с прошлого снимка
+ */
+struct PeerChanges {
+    std::vector<PeerRecord> upserts;   ///< Новые и продленные регистрации
+    std::vector<std::string> removed;  ///< Удаленные и истекшие пиры
+
+    /**
+     * @brief Нет ли изменений
+     */
+    [[nodiscard]] bool Empty() const {
+        return upserts.empty() && removed.empty();
+    }
+};
+
+/**
+ * @brief Хранилище снимков реестра пиров
+ */
+class IPeerStore {
+   public:
+    virtual ~IPeerStore() = default;
+    IPeerStore() = default;
+    IPeerStore(const IPeerStore&) = delete;             ///< Запрет копирования
+    IPeerStore& operator=(const IPeerStore&) = delete;  ///< Запрет присваивания
+    IPeerStore(IPeerStore&&) = delete;                  ///< Запрет перемещения
+    IPeerStore& operator=(IPeerStore&&) = delete;       ///< Запрет перемещающего присваивания
+
+    /**
+     * @brief Загружает не истекшие регистрации
+     *
+     * @return std::vector<PeerRecord> Сохраненные регистрации
+     */
+    virtual std::vector<PeerRecord> LoadPeers() = 0;
+
+    /**
+     * @brief Записывает изменения реестра одним пакетом
+     *
+     * @param changes Изменения с прошлого снимка
+     */
+    virtual void SavePeers(const PeerChanges& changes) = 0;
+};
+
+/**
+ * @brief Реестр пиров для обнаружения и прямого подключения (rendezvous)
+ *
+ * Класс PeerRegistry хранит адреса зарегистрированных пиров в памяти:
+ * - Индекс разбит на kShards частей со своими std::shared_mutex, поэтому
+ *   поиск берет только разделяемую блокировку одной части и не ждет
+ *   регистраций в других частях
+ * - Регистрация живет ttl; повторная регистрация (heartbeat) только
+ *   продлевает срок записи и не трогает колесо таймеров
+ * - Истечение обрабатывает TimerWheel: Expire() проверяет только
+ *   сработавшие таймеры, а не весь индекс. Таймер продленной записи
+ *   ставится заново, таймер удаленной записи отбрасывается по поколению
+ * - Изменения копятся в множестве измененных идентификаторов и забираются
+ *   TakeChanges() для периодической записи снимка (write-behind): сколько
+ *   бы heartbeat ни пришло за интервал, пир записывается один раз
+ *
+ * Все методы потокобезопасны.
+ */
+class PeerRegistry {
+   public:
+    using Clock = std::chrono::steady_clock;  ///< Часы сроков регистрации
+
+    static constexpr std::size_t kShards = 16;  ///< Количество частей индекса
+
+    /**
+     * @brief Конструктор реестра
+     *
+     * @param ttl Время жизни регистрации без heartbeat
+     * @param tick Точность истечения (тик колеса таймеров)
+     */
+    explicit PeerRegistry(
+        std::chrono::milliseconds ttl,
+        std::chrono::milliseconds tick = std::chrono::milliseconds(100))
+        : ttl_(ttl), wheel_(tick, static_cast<std::size_t>(ttl / tick) + 1) {
+    }
+
+    /**
+     * @brief Регистрирует пира или продлевает регистрацию
+     *
+     * @param id Идентификатор пира
+     * @param endpoint Адрес пира
+     * @param now Текущий момент
+     * @return true если пир зарегистрирован впервые
+     */
+    bool Register(
+        std::string_view id, std::string_view endpoint, Clock::time_point now = Clock::now()) {
+        Shard& shard = ShardOf(id);
+        uint64_t generation = 0;
+        {
+            const std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            if (const auto removed = shard.removed.find(id); removed != shard.removed.end()) {
+                shard.removed.erase(removed);
+            }
+            const auto it = shard.peers.find(id);
+            if (it != shard.peers.end()) {
+                it->second.endpoint.assign(endpoint);
+                it->second.expires = now + ttl_;
+                shard.dirty.insert(it->first);
+                return false;
+            }
+            generation = ++shard.generation;
+            Entry entry{std::string(endpoint), now + ttl_, generation};
+            const auto inserted = shard.peers.emplace(std::string(id), std::move(entry)).first;
+            shard.dirty.insert(inserted->first);
+        }
+        GetMetrics().Add(Gauge::kRegisteredPeers, 1);
+
+        const std::lock_guard<std::mutex> lock(wheel_mutex_);
+        wheel_.Schedule(WheelKey{std::string(id), generation}, now + ttl_);
+        return true;
+    }
+
+    /**
+     * @brief Удаляет регистрацию пира
+     *
+     * @param id Идентификатор пира
+     * @return true если пир был зарегистрирован
+     */
+    bool Unregister(std::string_view id) {
+        Shard& shard = ShardOf(id);
+        {
+            const std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            const auto it = shard.peers.find(id);
+            if (it == shard.peers.end()) {
+                return false;
+            }
+            Remove(shard, it);
+        }
+        GetMetrics().Add(Gauge::kRegisteredPeers, -1);
+        return true;
+    }
+
+    /**
+     * @brief Ищет адрес пира
+     *
+     * @param id Идентификатор пира
+     * @param now Текущий момент
+     * @return std::optional<std::string> Адрес или std::nullopt, если пир
+     *         не зарегистрирован или регистрация истекла
+     */
+    [[nodiscard]] std::optional<std::string> Lookup(
+        std::string_view id, Clock::time_point now = Clock::now()) const {
+        const Shard& shard = ShardOf(id);
+        const std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        const auto it = shard.peers.find(id);
+        if (it == shard.peers.end() || it->second.expires <= now) {
+            return std::nullopt;
+        }
+        return it->second.endpoint;
+    }
+
+    /**
+     * @brief Удаляет истекшие регистрации
+     *
+     * @param now Текущий момент
+     * @return std::size_t Количество удаленных пиров
+     */
+    std::size_t Expire(Clock::time_point now = Clock::now()) {
+        const std::lock_guard<std::mutex> wheel_lock(wheel_mutex_);
+        std::size_t expired = 0;
+        wheel_.Advance(now, [&](WheelKey key) {
+            Shard& shard = ShardOf(key.id);
+            const std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            const auto it = shard.peers.find(key.id);
+            if (it == shard.peers.end() || it->second.generation != key.generation) {
+                return;  // Запись удалена или создана заново со своим таймером
+            }
+            if (it->second.expires > now) {
+                const Clock::time_point expires = it->second.expires;
+                wheel_.Schedule(std::move(key), expires);  // Продлена heartbeat
+                return;
+            }
+            Remove(shard, it);
+            ++expired;
+        });
+        if (expired > 0) {
+            GetMetrics().Add(Gauge::kRegisteredPeers, -static_cast<int64_t>(expired));
+        }
+        return expired;
+    }
+
+    /**
+     * @brief Забирает изменения с прошлого вызова для записи снимка
+     *
+     * @param now Текущий момент (для пересчета сроков в системное время)
+     * @return PeerChanges Измененные и удаленные пиры
+     */
+    PeerChanges TakeChanges(Clock::time_point now = Clock::now()) {
+        const auto system_now = std::chrono::system_clock::now();
+        PeerChanges changes;
+        for (Shard& shard : shards_) {
+            const std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            for (const std::string& id : shard.dirty) {
+                const Entry& entry = shard.peers.find(id)->second;
+                changes.upserts.push_back(PeerRecord{
+                    id, entry.endpoint,
+                    system_now + std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                                     entry.expires - now)});
+            }
+            shard.dirty.clear();
+            changes.removed.insert(
+                changes.removed.end(), shard.removed.begin(), shard.removed.end());
+            shard.removed.clear();
+        }
+        return changes;
+    }
+
+    /**
+     * @brief Возвращает не записанные изменения для следующего снимка
+     *
+     * Изменения, устаревшие за время записи (пир удален или
+     * зарегистрирован заново), не возвращаются.
+     *
+     * @param changes Изменения, которые не удалось записать
+     */
+    void Requeue(const PeerChanges& changes) {
+        for (const PeerRecord& record : changes.upserts) {
+            Shard& shard = ShardOf(record.id);
+            const std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            const auto it = shard.peers.find(record.id);
+            if (it != shard.peers.end()) {
+                shard.dirty.insert(it->first);
+            }
+        }
+        for (const std::string& id : changes.removed) {
+            Shard& shard = ShardOf(id);
+            const std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            if (shard.peers.find(id) == shard.peers.end()) {
+                shard.removed.insert(id);
+            }
+        }
+    }
+
+    /**
+     * @brief Восстанавливает регистрации из снимка
+     *
+     * Восстановленные записи не считаются измененными.
+     *
+     * @param records Сохраненные регистрации
+     * @param now Текущий момент
+     */
+    void Restore(const std::vector<PeerRecord>& records, Clock::time_point now = Clock::now()) {
+        const auto system_now = std::chrono::system_clock::now();
+        for (const PeerRecord& record : records) {
+            if (record.expires_at <= system_now) {
+                continue;
+            }
+            const auto remaining =
+                std::chrono::duration_cast<Clock::duration>(record.expires_at - system_now);
+            if (Register(record.id, record.endpoint, now + remaining - ttl_)) {
+                Shard& shard = ShardOf(record.id);
+                const std::unique_lock<std::shared_mutex> lock(shard.mutex);
+                if (const auto dirty = shard.dirty.find(record.id); dirty != shard.dirty.end()) {
+                    shard.dirty.erase(dirty);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Количество зарегистрированных пиров
+     */
+    [[nodiscard]] std::size_t Size() const {
+        std::size_t size = 0;
+        for (const Shard& shard : shards_) {
+            const std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            size += shard.peers.size();
+        }
+        return size;
+    }
+
+   private:
+    /**
+     * @brief Регистрация пира в индексе
+     */
+    struct Entry {
+        std::string endpoint;       ///< Адрес пира
+        Clock::time_point expires;  ///< Срок регистрации
+        uint64_t generation;        ///< Поколение записи для таймера колеса
+    };
+
+    /**
+     * @brief Ключ таймера истечения
+     */
+    struct WheelKey {
+        std::string id;       ///< Идентификатор пира
+        uint64_t generation;  ///< Поколение записи, для которой поставлен таймер
+    };
+
+    /**
+     * @brief Хеш строк с поиском по std::string_view без копирования
+     */
+    struct StringHash {
+        using is_transparent = void;  ///< Разрешает гетерогенный поиск
+
+        std::size_t operator()(std::string_view value) const {
+            return std::hash<std::string_view>{}(value);
+        }
+    };
+
+    using PeerMap = std::unordered_map<std::string, Entry, StringHash, std::equal_to<>>;
+    using PeerSet = std::unordered_set<std::string, StringHash, std::equal_to<>>;
+
+    /**
+     * @brief Часть индекса со своей блокировкой
+     */
+    struct Shard {
+        mutable std::shared_mutex mutex;  ///< Защищает часть индекса
+        PeerMap peers;                    ///< Регистрации
+        PeerSet dirty;                    ///< Измененные с прошлого снимка
+        PeerSet removed;                  ///< Удаленные с прошлого снимка
+        uint64_t generation = 0;          ///< Последнее выданное поколение
+    };
+
+    Shard& ShardOf(std::string_view id) {
+        return shards_[StringHash{}(id) % kShards];
+    }
+
+    const Shard& ShardOf(std::string_view id) const {
+        return shards_[StringHash{}(id) % kShards];
+    }
+
+    /**
+     * @brief Удаляет запись под блокировкой части и помечает ее для снимка
+     */
+    static void Remove(Shard& shard, PeerMap::iterator it) {
+        shard.dirty.erase(it->first);
+        shard.removed.insert(it->first);
+        shard.peers.erase(it);
+    }
+
+    std::chrono::milliseconds ttl_;      ///< Время жизни регистрации
+    std::array<Shard, kShards> shards_;  ///< Части индекса
+    std::mutex wheel_mutex_;             ///< Защищает колесо таймеров
+    TimerWheel<WheelKey> wheel_;         ///< Таймеры истечения регистраций
+};
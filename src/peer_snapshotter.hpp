@@ -0,0 +1,141 @@
+#pragma once
+
+#include "config.hpp"
+#include "logger.hpp"
+#include "peer_registry.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+/**
+ * @brief Фоновое обслуживание реестра пиров
+ *
+ * Класс PeerSnapshotter выполняет в отдельном потоке все, что не должно
+ * происходить на пути обработки кадров:
+ * - Каждый тик продвигает колесо таймеров реестра (PeerRegistry::Expire)
+ * - Раз в snapshot_interval записывает накопленные изменения в IPeerStore
+ *   одним пакетом (write-behind), поэтому heartbeat не обращается к БД
+ * - При запуске восстанавливает реестр из последнего снимка
+ *
+ * Если запись снимка не удалась, изменения возвращаются в реестр и будут
+ * записаны следующим снимком.
+ */
+class PeerSnapshotter {
+   public:
+    /**
+     * @brief Конструктор - загружает снимок и запускает фоновый поток
+     *
+     * @param registry Реестр пиров
+     * @param store Хранилище снимков (nullptr - только истечение регистраций)
+     * @param snapshot_interval Интервал записи снимков
+     * @param tick Интервал продвижения колеса таймеров
+     */
+    PeerSnapshotter(
+        std::shared_ptr<PeerRegistry> registry, std::shared_ptr<IPeerStore> store,
+        std::chrono::milliseconds snapshot_interval,
+        std::chrono::milliseconds tick = std::chrono::milliseconds(100))
+        : registry_(std::move(registry))
+        , store_(std::move(store))
+        , snapshot_interval_(snapshot_interval)
+        , tick_(tick) {
+        if (store_) {
+            try {
+                const auto records = store_->LoadPeers();
+                registry_->Restore(records);
+                LOG_INFO << "Restored " << registry_->Size() << " registered peer(s)";
+            } catch (const std::exception& e) {
+                LOG_WARNING << "Failed to load peer snapshot: " << e.what();
+            }
+        }
+        worker_ = std::thread([this] { Run(); });
+    }
+
+    /**
+     * @brief Конструктор с интервалом снимков из конфигурации
+     *
+     * @param registry Реестр пиров
+     * @param store Хранилище снимков
+     */
+    PeerSnapshotter(std::shared_ptr<PeerRegistry> registry, std::shared_ptr<IPeerStore> store)
+        : PeerSnapshotter(
+              std::move(registry), std::move(store),
+              std::chrono::milliseconds(GetConfig().GetPeerSnapshotIntervalMs())) {
+    }
+
+    /**
+     * @brief Деструктор - останавливает поток и записывает последний снимок
+     */
+    ~PeerSnapshotter() {
+        {
+            const std::lock_guard<std::mutex> lock(mutex_);
+            stopped_ = true;
+        }
+        cv_.notify_one();
+        worker_.join();
+        Flush();
+    }
+
+    PeerSnapshotter(const PeerSnapshotter&) = delete;             ///< Запрет копирования
+    PeerSnapshotter& operator=(const PeerSnapshotter&) = delete;  ///< Запрет присваивания
+    PeerSnapshotter(PeerSnapshotter&&) = delete;                  ///< Запрет перемещения
+    PeerSnapshotter& operator=(PeerSnapshotter&&) = delete;  ///< Запрет перемещающего присваивания
+
+    /**
+     * @brief Синхронно записывает накопленные изменения реестра
+     */
+    void Flush() {
+        if (!store_) {
+            return;
+        }
+        const std::lock_guard<std::mutex> flush_lock(flush_mutex_);
+        const PeerChanges changes = registry_->TakeChanges();
+        if (changes.Empty()) {
+            return;
+        }
+        try {
+            store_->SavePeers(changes);
+        } catch (const std::exception& e) {
+            LOG_ERROR << "Failed to save peer snapshot (" << changes.upserts.size()
+                      << " updated, " << changes.removed.size() << " removed): " << e.what();
+            registry_->Requeue(changes);
+        }
+    }
+
+   private:
+    /**
+     * @brief Цикл фонового потока
+     */
+    void Run() {
+        auto next_snapshot = std::chrono::steady_clock::now() + snapshot_interval_;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stopped_) {
+            cv_.wait_for(lock, tick_, [this] { return stopped_; });
+            if (stopped_) {
+                break;
+            }
+            lock.unlock();
+            const auto now = std::chrono::steady_clock::now();
+            registry_->Expire(now);
+            if (now >= next_snapshot) {
+                Flush();
+                next_snapshot = now + snapshot_interval_;
+            }
+            lock.lock();
+        }
+    }
+
+    std::shared_ptr<PeerRegistry> registry_;       ///< Реестр пиров
+    std::shared_ptr<IPeerStore> store_;            ///< Хранилище снимков
+    std::chrono::milliseconds snapshot_interval_;  ///< Интервал записи снимков
+    std::chrono::milliseconds tick_;               ///< Интервал продвижения колеса
+    bool stopped_ = false;                         ///< Флаг остановки фонового потока
+    std::mutex mutex_;                             ///< Мьютекс флага остановки
+    std::mutex flush_mutex_;                       ///< Сериализует одновременные записи
+    std::condition_variable cv_;                   ///< Пробуждение фонового потока
+    std::thread worker_;                           ///< Фоновый поток
+};
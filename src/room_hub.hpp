@@ -0,0 +1,170 @@
+#pragma once
+
+#include "send_queue.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Сообщение комнаты, закодированное один раз для всех получателей
+ *
+ * Хранит готовый кадр без сжатия и, если сжатие уменьшило кадр, сжатый
+ * вариант. Каждый получатель ставит в свою очередь ссылку на подходящий
+ * вариант, без копирования байтов.
+ */
+struct RoomMessage {
+    SharedFrame plain;       ///< Кадр без сжатия
+    SharedFrame compressed;  ///< Сжатый кадр или nullptr
+
+    /**
+     * @brief Выбирает вариант кадра для получателя
+     *
+     * @param accepts_compressed Принимает ли получатель сжатые кадры
+     * @return const SharedFrame& Кадр для постановки в очередь
+     */
+    [[nodiscard]] const SharedFrame& For(bool accepts_compressed) const {
+        return accepts_compressed && compressed ? compressed : plain;
+    }
+};
+
+/**
+ * @brief Получатель сообщений комнаты
+ */
+class IRoomSubscriber {
+   public:
+    virtual ~IRoomSubscriber() = default;
+    IRoomSubscriber() = default;
+    IRoomSubscriber(const IRoomSubscriber&) = delete;             ///< Запрет копирования
+    IRoomSubscriber& operator=(const IRoomSubscriber&) = delete;  ///< Запрет присваивания
+    IRoomSubscriber(IRoomSubscriber&&) = delete;                  ///< Запрет перемещения
+    IRoomSubscriber& operator=(IRoomSubscriber&&) = delete;  ///< Запрет перемещающего присваивания
+
+    /**
+     * @brief Доставляет сообщение получателю
+     *
+     * Вызывается из потока публикующего участника и не должен блокироваться:
+     * реализация только ставит кадр в свою очередь отправки.
+     *
+     * @param message Сообщение комнаты
+     */
+    virtual void Deliver(const RoomMessage& message) = 0;
+};
+
+/**
+ * @brief Маршрутизатор сообщений между участниками комнат
+ *
+ * Класс RoomHub хранит состав каждой комнаты (канала протокола чата)
+ * и рассылает опубликованные сообщения всем ее участникам.
+ *
+ * Состав комнаты - неизменяемый снимок (copy-on-write): Join()/Leave()
+ * создают новый список, а Publish() под мьютексом только копирует
+ * указатель на текущий снимок и обходит его без блокировки. Поэтому
+ * рассылка тысячам участников не держит мьютекс и не мешает другим
+ * публикациям, а вход и выход участников не ждут рассылки.
+ */
+class RoomHub {
+   public:
+    using Members = std::vector<std::shared_ptr<IRoomSubscriber>>;  ///< Участники комнаты
+
+    /**
+     * @brief Добавляет участника в комнату
+     *
+     * @param room Идентификатор комнаты
+     * @param subscriber Участник
+     * @return true если участник добавлен, false если он уже в комнате
+     */
+    bool Join(uint16_t room, std::shared_ptr<IRoomSubscriber> subscriber) {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        auto& members = rooms_[room];
+        if (members && Contains(*members, subscriber.get())) {
+            return false;
+        }
+        auto updated = members ? std::make_shared<Members>(*members) : std::make_shared<Members>();
+        updated->push_back(std::move(subscriber));
+        members = std::move(updated);
+        return true;
+    }
+
+    /**
+     * @brief Удаляет участника из комнаты
+     *
+     * Пустая комната удаляется.
+     *
+     * @param room Идентификатор комнаты
+     * @param subscriber Участник
+     * @return true если участник был в комнате
+     */
+    bool Leave(uint16_t room, const IRoomSubscriber* subscriber) {
+        std::shared_ptr<const Members> previous;  // Освобождается вне мьютекса
+        const std::lock_guard<std::mutex> lock(mutex_);
+        const auto it = rooms_.find(room);
+        if (it == rooms_.end() || !Contains(*it->second, subscriber)) {
+            return false;
+        }
+        auto updated = std::make_shared<Members>();
+        updated->reserve(it->second->size() - 1);
+        for (const auto& member : *it->second) {
+            if (member.get() != subscriber) {
+                updated->push_back(member);
+            }
+        }
+        previous = std::move(it->second);
+        if (updated->empty()) {
+            rooms_.erase(it);
+        } else {
+            it->second = std::move(updated);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Рассылает сообщение всем участникам комнаты
+     *
+     * @param room Идентификатор комнаты
+     * @param message Сообщение, закодированное один раз
+     * @return std::size_t Количество получателей
+     */
+    std::size_t Publish(uint16_t room, const RoomMessage& message) const {
+        const auto members = Snapshot(room);
+        if (!members) {
+            return 0;
+        }
+        for (const auto& member : *members) {
+            member->Deliver(message);
+        }
+        return members->size();
+    }
+
+    /**
+     * @brief Количество участников комнаты
+     */
+    [[nodiscard]] std::size_t Size(uint16_t room) const {
+        const auto members = Snapshot(room);
+        return members ? members->size() : 0;
+    }
+
+   private:
+    /**
+     * @brief Текущий снимок состава комнаты
+     */
+    std::shared_ptr<const Members> Snapshot(uint16_t room) const {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        const auto it = rooms_.find(room);
+        return it == rooms_.end() ? nullptr : it->second;
+    }
+
+    static bool Contains(const Members& members, const IRoomSubscriber* subscriber) {
+        return std::any_of(members.begin(), members.end(), [subscriber](const auto& member) {
+            return member.get() == subscriber;
+        });
+    }
+
+    mutable std::mutex mutex_;  ///< Защищает таблицу комнат
+    std::unordered_map<uint16_t, std::shared_ptr<const Members>> rooms_;  ///< Снимки составов
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// Неизменяемый закодированный кадр (или пакет кадров), разделяемый получателями
+using SharedFrame = std::shared_ptr<const std::string>;
+
+/**
+ * @brief Ограниченная очередь отправки одного соединения
+ *
+ * Класс SendQueue принимает кадры из любых потоков и отдает их писателю
+ * соединения пакетами, чтобы несколько кадров ушли одной scatter-gather
+ * записью:
+ * - Кадры не копируются: в очереди хранятся SharedFrame
+ * - Объем очереди ограничен в байтах; кадр, превышающий лимит, не ставится,
+ *   и отправитель решает, что делать с медленным получателем
+ * - Push() сообщает, нужно ли будить писателя: это нужно только при
+ *   переходе из простоя, поэтому уведомления сливаются
+ *
+ * Мьютекс удерживается только на время операции с deque, поэтому
+ * публикующий поток не ждет сетевой записи получателя.
+ */
+class SendQueue {
+   public:
+    /**
+     * @brief Результат постановки кадра в очередь
+     */
+    enum class PushResult {
+        kQueued,      ///< Кадр поставлен, писатель уже активен
+        kQueuedWake,  ///< Кадр поставлен, писателя нужно разбудить
+        kOverflow,    ///< Лимит очереди превышен, кадр не поставлен
+    };
+
+    /**
+     * @brief Конструктор очереди
+     *
+     * @param max_bytes Максимальный объем ожидающих отправки кадров в байтах
+     */
+    explicit SendQueue(std::size_t max_bytes) : max_bytes_(max_bytes) {
+    }
+
+    /**
+     * @brief Ставит кадр в очередь с учетом лимита
+     *
+     * @param frame Кадр для отправки
+     * @return PushResult Результат постановки
+     */
+    PushResult Push(SharedFrame frame) {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        if (bytes_ + frame->size() > max_bytes_) {
+            return PushResult::kOverflow;
+        }
+        return Enqueue(std::move(frame));
+    }
+
+    /**
+     * @brief Ставит служебный кадр в очередь без учета лимита
+     *
+     * Используется для ответов самому клиенту (Welcome, Pong, Error),
+     * которые нельзя потерять.
+     *
+     * @param frame Кадр для отправки
+     * @return PushResult kQueued или kQueuedWake
+     */
+    PushResult PushUnbounded(SharedFrame frame) {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        return Enqueue(std::move(frame));
+    }
+
+    /**
+     * @brief Забирает пакет кадров для одной записи
+     *
+     * Если очередь пуста, писатель считается уснувшим, и следующий Push()
+     * вернет kQueuedWake.
+     *
+     * @param out Сюда дописываются кадры пакета
+     * @param max_frames Максимальное количество кадров в пакете
+     * @return std::size_t Количество забранных кадров
+     */
+    std::size_t PopBatch(std::vector<SharedFrame>& out, std::size_t max_frames) {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        std::size_t count = 0;
+        while (count < max_frames && !frames_.empty()) {
+            bytes_ -= frames_.front()->size();
+            out.push_back(std::move(frames_.front()));
+            frames_.pop_front();
+            ++count;
+        }
+        writer_active_ = count > 0;
+        return count;
+    }
+
+    /**
+     * @brief Объем ожидающих отправки кадров в байтах
+     */
+    [[nodiscard]] std::size_t Bytes() const {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        return bytes_;
+    }
+
+    /**
+     * @brief Достигнут ли лимит объема очереди
+     */
+    [[nodiscard]] bool Full() const {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        return bytes_ >= max_bytes_;
+    }
+
+   private:
+    PushResult Enqueue(SharedFrame frame) {
+        bytes_ += frame->size();
+        frames_.push_back(std::move(frame));
+        if (writer_active_) {
+            return PushResult::kQueued;
+        }
+        writer_active_ = true;
+        return PushResult::kQueuedWake;
+    }
+
+    mutable std::mutex mutex_;        ///< Защищает очередь и счетчики
+    std::deque<SharedFrame> frames_;  ///< Ожидающие отправки кадры
+    std::size_t bytes_ = 0;           ///< Объем ожидающих кадров
+    std::size_t max_bytes_;           ///< Лимит объема очереди
+    bool writer_active_ = false;      ///< Разбужен ли писатель
+};
@@ -7,13 +7,20 @@
 #include <boost/asio/streambuf.hpp>
 #include <boost/system/error_code.hpp>
 
+#include <algorithm>
+#include <chrono>
 #include <cstdint>
 #include <memory>
 
 using BoostTcp = boost::asio::ip::tcp;  ///< Псевдоним для TCP протокола boost::asio
 
+#include "admission.hpp"
 #include "database.hpp"
+#include "handler_allocator.hpp"
+#include "logger.hpp"
+#include "metrics.hpp"
 #include "session.hpp"
+#include "socket_tuning.hpp"
 
 /**
  * @brief Основной TCP сервер приложения
@@ -23,16 +30,24 @@ using BoostTcp = boost::asio::ip::tcp;  ///< Псевдоним для TCP пр
  * - Создает новые сессии для каждого клиента
  * - Интегрируется с базой данных для отслеживания посещений
  * - Использует паттерн Factory для создания сессий
+ * - Отклоняет соединения сверх лимита сессий и частоты подключений
+ *   (AdmissionController) до обращения к БД и создания сессии
+ * - Настраивает сокеты параметрами TCP_NODELAY, TCP_DEFER_ACCEPT,
+ *   LISTEN_BACKLOG и SO_REUSEPORT из конфигурации (SocketTuning)
  *
  * Сервер работает в асинхронном режиме на основе boost::asio::io_context.
+ * io_context может обслуживаться несколькими потоками: каждый принятый сокет
+ * привязывается к собственному strand, поэтому обработчики одной сессии
+ * никогда не выполняются параллельно.
  */
 class Server {
    public:
     /**
      * @brief Конструктор сервера
      *
-     * Создает и настраивает TCP сервер для прослушивания входящих соединений.
-     * Инициализирует базу данных и начинает прием соединений.
+     * Создает и настраивает TCP сервер для прослушивания входящих соединений
+     * и начинает прием соединений. Сервис базы данных должен быть
+     * инициализирован заранее (IDatabaseService::Initialize()).
      *
      * @param io_context Контекст ввода-вывода boost::asio для асинхронных операций
      * @param db_service Сервис базы данных для хранения информации о посещениях
@@ -43,12 +58,79 @@ class Server {
     Server(
         boost::asio::io_context& io_context, std::shared_ptr<IDatabaseService> db_service,
         std::shared_ptr<ISessionFactory> session_factory)
-        : db_(std::move(db_service))
+        : Server(
+              io_context, std::move(db_service), std::move(session_factory),
+              static_cast<unsigned short>(GetConfig().GetCentralServerPort()), true) {
+    }
+
+    /**
+     * @brief Конструктор сервера на заданном порту
+     *
+     * Используется для дополнительных слушателей (например, протокола чата),
+     * соединения которых не считаются посещениями.
+     *
+     * @param io_context Контекст ввода-вывода boost::asio для асинхронных операций
+     * @param db_service Сервис базы данных, передаваемый сессиям
+     * @param session_factory Фабрика для создания новых сессий клиентов
+     * @param port Порт для прослушивания
+     * @param record_visits Отмечать ли посещение для каждого принятого соединения
+     */
+    Server(
+        boost::asio::io_context& io_context, std::shared_ptr<IDatabaseService> db_service,
+        std::shared_ptr<ISessionFactory> session_factory, unsigned short port,
+        bool record_visits)
+        : io_context_(io_context)
+        , db_(std::move(db_service))
         , sf_(std::move(session_factory))
-        , acceptor_(
-              io_context, BoostTcp::endpoint(BoostTcp::v4(), GetConfig().GetCentralServerPort())) {
-        db_->Initialize();  // Инициализируем базу данных (создаем таблицы если нужно)
-        DoAccept();         // Начинаем принимать соединения
+        , acceptor_(boost::asio::make_strand(io_context))
+        , backoff_timer_(acceptor_.get_executor())
+        , admission_(std::make_shared<AdmissionController>(
+              static_cast<std::size_t>(std::max(GetConfig().GetMaxSessions(), 0)),
+              GetConfig().GetIpConnectRate(), GetConfig().GetIpConnectBurst(),
+              static_cast<std::size_t>(std::max(GetConfig().GetIpTableSize(), 1))))
+        , max_backoff_(std::max(GetConfig().GetAcceptBackoffMaxMs(), 1))
+        , sessions_(std::make_shared<SessionRegistry>())
+        , tuning_(TuningFromConfig())
+        , record_visits_(record_visits) {
+        ListenTuned(acceptor_, BoostTcp::endpoint(BoostTcp::v4(), port), tuning_);
+        DoAccept();  // Начинаем принимать соединения
+    }
+
+    /**
+     * @brief Прекращает прием новых соединений и завершает открытые сессии
+     *
+     * Акцептор закрывается на своем strand, ожидающая операция accept
+     * завершается с ошибкой и больше не перезапускается, ожидание паузы
+     * после нехватки дескрипторов отменяется. Открытые сессии завершаются
+     * мягко (ISession::Shutdown): начатые запросы дообслуживаются, после
+     * чего соединения закрываются. Когда сессий не останется,
+     * io_context::run() завершается сам; оставшиеся после срока сессии
+     * закрывает Abort().
+     */
+    void Stop() {
+        boost::asio::post(acceptor_.get_executor(), [this] {
+            boost::system::error_code ignored;
+            acceptor_.close(ignored);
+            backoff_timer_.cancel();
+            sessions_->ShutdownAll(false);
+        });
+    }
+
+    /**
+     * @brief Немедленно закрывает соединения всех открытых сессий
+     *
+     * Как и Stop(), выполняется на strand акцептора, чтобы не пересекаться
+     * с DoAccept(), регистрирующим новые сессии.
+     */
+    void Abort() {
+        boost::asio::post(acceptor_.get_executor(), [this] { sessions_->ShutdownAll(true); });
+    }
+
+    /**
+     * @brief Количество открытых сессий слушателя
+     */
+    [[nodiscard]] std::size_t ActiveSessions() const {
+        return sessions_->Size();
     }
 
    private:
@@ -57,30 +139,143 @@ class Server {
      *
      * Метод запускает асинхронное ожидание новых TCP соединений.
      * При поступлении соединения:
-     * 1. Отмечает посещение в базе данных
-     * 2. Создает новую сессию через фабрику
-     * 3. Запускает обработку сессии
-     * 4. Рекурсивно вызывает себя для следующего соединения
+     * 1. Проверяет лимиты AdmissionController; отклоненный сокет сразу закрывается
+     * 2. Отмечает посещение в базе данных
+     * 3. Создает новую сессию через фабрику и передает ей место сессии
+     * 4. Запускает обработку сессии
+     * 5. Рекурсивно вызывает себя для следующего соединения
+     *
+     * Если accept завершился из-за нехватки дескрипторов или памяти, следующий
+     * accept откладывается (см. Backoff()), иначе цикл крутился бы вхолостую,
+     * не давая закрыться существующим сессиям.
+     *
+     * Сокет каждого клиента создается на отдельном strand, что позволяет
+     * безопасно запускать io_context в нескольких потоках. Одновременно ожидает
+     * только одна операция accept, поэтому ее состояние размещается в accept_memory_.
      *
      * @note Метод работает в асинхронном режиме и не блокирует выполнение
      */
     void DoAccept() {
-        acceptor_.async_accept([this](boost::system::error_code ec, BoostTcp::socket socket) {
-            if (!ec) {
-                // Регистрируем новое посещение в базе данных
-                db_->MarkVisit();
-                // Создаем новую сессию для клиента
-                auto session = sf_->Create(std::move(socket), db_);
-                // Запускаем обработку сессии
-                session->Start();
-            }
+        acceptor_.async_accept(
+            boost::asio::make_strand(io_context_),
+            MakeCustomAllocHandler(
+                accept_memory_, [this](boost::system::error_code ec, BoostTcp::socket socket) {
+                    if (!acceptor_.is_open()) {
+                        return;  // Сервер остановлен через Stop()
+                    }
+                    if (IsResourceError(ec)) {
+                        Backoff(ec);
+                        return;
+                    }
+                    if (!ec) {
+                        accept_backoff_ = std::chrono::milliseconds::zero();
+                        Accept(std::move(socket));
+                    }
+
+                    // Продолжаем принимать новые соединения
+                    DoAccept();
+                }));
+    }
+
+    /**
+     * @brief Проверяет лимиты и запускает сессию для принятого сокета
+     *
+     * @param socket Сокет принятого соединения
+     */
+    void Accept(BoostTcp::socket socket) {
+        const ScopedLatency latency(Histogram::kAccept);
+        boost::system::error_code ec;
+        const BoostTcp::endpoint remote = socket.remote_endpoint(ec);
+        if (ec) {
+            return;  // Клиент уже закрыл соединение
+        }
+
+        AdmissionSlot slot;
+        switch (admission_->Admit(remote.address(), slot)) {
+            case Admission::kAdmitted:
+                break;
+            case Admission::kSessionLimit:
+                GetMetrics().Increment(Counter::kRejectedSessions);
+                socket.close(ec);
+                return;
+            case Admission::kRateLimited:
+                GetMetrics().Increment(Counter::kRejectedRate);
+                socket.close(ec);
+                return;
+        }
+
+        GetMetrics().Increment(Counter::kAcceptedConnections);
+        TuneSocket(socket, tuning_);
+        // Регистрируем новое посещение в базе данных
+        if (record_visits_) {
+            db_->MarkVisit();
+        }
+        // Создаем новую сессию для клиента
+        auto session = sf_->Create(std::move(socket), db_);
+        session->HoldAdmission(std::move(slot));
+        session->Register(sessions_);
+        // Запускаем обработку сессии
+        session->Start();
+    }
+
+    /**
+     * @brief Параметры сокетов из конфигурации
+     */
+    static SocketTuning TuningFromConfig() {
+        const ConfigManager& config = GetConfig();
+        SocketTuning tuning;
+        tuning.no_delay = config.GetTcpNoDelay();
+        tuning.defer_accept_s = std::max(config.GetTcpDeferAcceptS(), 0);
+        tuning.backlog = std::max(config.GetListenBacklog(), 0);
+        tuning.reuse_port = config.GetSoReusePort();
+        return tuning;
+    }
+
+    /**
+     * @brief Проверяет, вызвана ли ошибка accept нехваткой ресурсов процесса
+     *
+     * @param ec Код ошибки accept
+     * @return true для EMFILE, ENFILE, ENOBUFS и ENOMEM
+     */
+    static bool IsResourceError(const boost::system::error_code& ec) {
+        return ec == boost::asio::error::no_descriptors ||
+               ec == boost::system::errc::too_many_files_open_in_system ||
+               ec == boost::asio::error::no_buffer_space || ec == boost::asio::error::no_memory;
+    }
 
-            // Продолжаем принимать новые соединения
-            DoAccept();
+    /**
+     * @brief Откладывает следующий accept после нехватки ресурсов
+     *
+     * Пауза начинается с kMinBackoff и удваивается при каждой следующей
+     * ошибке подряд, но не превышает ACCEPT_BACKOFF_MAX_MS.
+     *
+     * @param ec Код ошибки accept
+     */
+    void Backoff(const boost::system::error_code& ec) {
+        accept_backoff_ = std::clamp(accept_backoff_ * 2, kMinBackoff, max_backoff_);
+        GetMetrics().Increment(Counter::kAcceptBackoffs);
+        LOG_WARNING << "accept failed: " << ec.message() << ", retrying in "
+                    << accept_backoff_.count() << " ms";
+        backoff_timer_.expires_after(accept_backoff_);
+        backoff_timer_.async_wait([this](boost::system::error_code wait_ec) {
+            if (!wait_ec && acceptor_.is_open()) {
+                DoAccept();
+            }
         });
     }
 
-    std::shared_ptr<IDatabaseService> db_;  ///< Сервис базы данных
-    std::shared_ptr<ISessionFactory> sf_;   ///< Фабрика сессий
-    BoostTcp::acceptor acceptor_;           ///< Акцептор TCP соединений
+    static constexpr std::chrono::milliseconds kMinBackoff{10};  ///< Первая пауза accept
+
+    boost::asio::io_context& io_context_;             ///< Контекст для сокетов клиентов
+    std::shared_ptr<IDatabaseService> db_;            ///< Сервис базы данных
+    std::shared_ptr<ISessionFactory> sf_;             ///< Фабрика сессий
+    BoostTcp::acceptor acceptor_;                     ///< Акцептор TCP (работает на strand)
+    HandlerMemory accept_memory_;                     ///< Память для операции accept
+    boost::asio::steady_timer backoff_timer_;         ///< Таймер паузы accept (на strand акцептора)
+    std::shared_ptr<AdmissionController> admission_;  ///< Лимиты сессий и подключений
+    std::chrono::milliseconds accept_backoff_{0};     ///< Текущая пауза accept
+    std::chrono::milliseconds max_backoff_;           ///< Максимальная пауза accept
+    std::shared_ptr<SessionRegistry> sessions_;       ///< Открытые сессии слушателя
+    SocketTuning tuning_;                             ///< Параметры сокетов
+    bool record_visits_;                              ///< Отмечать ли посещение для соединений
 };
\ No newline at end of file
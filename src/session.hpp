@@ -1,22 +1,75 @@
 #pragma once
 
+#include "admission.hpp"
 #include "database.hpp"
+#include "deadline_wheel.hpp"
+#include "handler_allocator.hpp"
+#include "http_parser.hpp"
+#include "http_response.hpp"
+#include "http_router.hpp"
+#include "logger.hpp"
+#include "metrics.hpp"
 
 #include <boost/asio/buffer.hpp>
 #include <boost/asio/ip/tcp.hpp>
-#include <boost/asio/read_until.hpp>
-#include <boost/asio/streambuf.hpp>
+#include <boost/asio/post.hpp>
 #include <boost/asio/write.hpp>
 
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <cstddef>
-#include <iostream>
-#include <istream>
+#include <cstdint>
+#include <cstring>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
 
 using BoostTcp = boost::asio::ip::tcp;  ///< Псевдоним для TCP протокола boost::asio
 
+class ISession;
+
+/**
+ * @brief Реестр открытых сессий сервера
+ *
+ * Класс SessionRegistry нужен для остановки сервера: он перечисляет
+ * открытые сессии, чтобы завершить их (ShutdownAll), и сообщает, сколько
+ * их осталось. Сессии связаны в интрузивный список, поэтому регистрация
+ * не выделяет память; сессия выписывается сама при уничтожении или
+ * возврате в пул.
+ */
+class SessionRegistry {
+   public:
+    /**
+     * @brief Количество открытых сессий
+     */
+    [[nodiscard]] std::size_t Size() const {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        return size_;
+    }
+
+    /**
+     * @brief Завершает все открытые сессии
+     *
+     * @param force false - дообслужить начатые запросы и закрыть соединения,
+     *        true - закрыть сокеты немедленно
+     */
+    inline void ShutdownAll(bool force);
+
+   private:
+    friend class ISession;
+
+    inline void Add(ISession* session);
+    inline void Remove(ISession* session);
+
+    mutable std::mutex mutex_;  ///< Защищает список
+    ISession* head_ = nullptr;  ///< Первая сессия списка
+    std::size_t size_ = 0;      ///< Количество сессий в списке
+};
+
 /**
  * @brief Абстрактный интерфейс для сессии клиента
  *
@@ -26,10 +79,15 @@ using BoostTcp = boost::asio::ip::tcp;  ///< Псевдоним для TCP пр
  *
  * Реализует правило пяти (Rule of Five) с запретом копирования и перемещения
  * для обеспечения единственности экземпляра сессии.
+ *
+ * Сроки чтения, записи и простоя сессия ставит через DeadlineTarget:
+ * все сессии io_context делят одно колесо таймеров DeadlineWheel.
  */
-class ISession : public std::enable_shared_from_this<ISession> {
+class ISession : public std::enable_shared_from_this<ISession>, public DeadlineTarget {
    public:
-    virtual ~ISession() = default;
+    virtual ~ISession() {
+        Unregister();
+    }
     ISession(const ISession&) = delete;             ///< Запрет копирования
     ISession& operator=(const ISession&) = delete;  ///< Запрет присваивания
     ISession(ISession&&) = delete;                  ///< Запрет перемещения
@@ -43,6 +101,41 @@ class ISession : public std::enable_shared_from_this<ISession> {
      */
     virtual void Start() = 0;
 
+    /**
+     * @brief Завершает сессию при остановке сервера
+     *
+     * Может вызываться из любого потока: реализация переходит на executor
+     * сессии. При мягком завершении начатый запрос дообслуживается, после
+     * чего соединение закрывается; ожидающее нового запроса соединение
+     * закрывается сразу.
+     *
+     * @param force Закрыть сокет немедленно
+     */
+    virtual void Shutdown(bool force) = 0;
+
+    /**
+     * @brief Вносит сессию в реестр сервера
+     *
+     * @param registry Реестр открытых сессий
+     */
+    void Register(std::shared_ptr<SessionRegistry> registry) {
+        Unregister();
+        registry_ = std::move(registry);
+        registry_->Add(this);
+    }
+
+    /**
+     * @brief Закрепляет за сессией место, выданное контролем допуска
+     *
+     * Место освобождается вместе с сессией, а переиспользуемой сессией -
+     * при возврате в пул.
+     *
+     * @param slot Место сессии
+     */
+    void HoldAdmission(AdmissionSlot slot) {
+        admission_ = std::move(slot);
+    }
+
    protected:
     /**
      * @brief Защищенный конструктор по умолчанию
@@ -51,8 +144,85 @@ class ISession : public std::enable_shared_from_this<ISession> {
      * создание экземпляров абстрактного класса.
      */
     ISession() = default;
+
+    /**
+     * @brief Слабый указатель на сессию для колеса сроков
+     */
+    std::weak_ptr<DeadlineTarget> DeadlineOwner() override {
+        return weak_from_this();
+    }
+
+    /**
+     * @brief Освобождает место контроля допуска до уничтожения сессии
+     */
+    void ReleaseAdmission() {
+        admission_.Reset();
+    }
+
+    /**
+     * @brief Выписывает сессию из реестра сервера
+     */
+    void Unregister() {
+        if (registry_) {
+            registry_->Remove(this);
+            registry_.reset();
+        }
+    }
+
+   private:
+    friend class SessionRegistry;
+
+    AdmissionSlot admission_;                    ///< Место сессии в AdmissionController
+    std::shared_ptr<SessionRegistry> registry_;  ///< Реестр, в который внесена сессия
+    ISession* registry_prev_ = nullptr;          ///< Предыдущая сессия реестра
+    ISession* registry_next_ = nullptr;          ///< Следующая сессия реестра
 };
 
+inline void SessionRegistry::Add(ISession* session) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    session->registry_prev_ = nullptr;
+    session->registry_next_ = head_;
+    if (head_ != nullptr) {
+        head_->registry_prev_ = session;
+    }
+    head_ = session;
+    ++size_;
+}
+
+inline void SessionRegistry::Remove(ISession* session) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (session->registry_prev_ != nullptr) {
+        session->registry_prev_->registry_next_ = session->registry_next_;
+    } else {
+        head_ = session->registry_next_;
+    }
+    if (session->registry_next_ != nullptr) {
+        session->registry_next_->registry_prev_ = session->registry_prev_;
+    }
+    session->registry_prev_ = nullptr;
+    session->registry_next_ = nullptr;
+    --size_;
+}
+
+inline void SessionRegistry::ShutdownAll(bool force) {
+    // Сессии захватываются под мьютексом, а завершаются и отпускаются после
+    // него: уничтожение сессии само выписывает ее из реестра. Сессия, чей
+    // деструктор уже выполняется, не захватывается.
+    std::vector<std::shared_ptr<ISession>> sessions;
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        sessions.reserve(size_);
+        for (ISession* session = head_; session != nullptr; session = session->registry_next_) {
+            if (auto owned = session->weak_from_this().lock()) {
+                sessions.push_back(std::move(owned));
+            }
+        }
+    }
+    for (const auto& session : sessions) {
+        session->Shutdown(force);
+    }
+}
+
 /**
  * @brief Абстрактная фабрика для создания сессий
  *
@@ -84,14 +254,29 @@ class ISessionFactory {
  * @brief Конкретная реализация сессии HTTP
  *
  * Класс Session реализует простой HTTP сервер, который:
- * - Читает HTTP заголовки от клиента
+ * - Читает данные в фиксированный буфер и разбирает заголовки
+ *   инкрементальным HttpRequestParser без копирования строк
  * - Отвечает статическим HTML с информацией о количестве посещений
- * - Закрывает соединение после отправки ответа
+ *   на запросы к "/", метриками Prometheus на "/metrics" и 404 на остальные пути
+ * - Поддерживает постоянные соединения (keep-alive) и конвейерные запросы:
+ *   после ответа снова читает следующий запрос из того же сокета
+ * - Закрывает соединение по "Connection: close", по таймауту простоя
+ *   или после KEEP_ALIVE_MAX_REQUESTS запросов
+ * - Закрывает соединение, если клиент не принял ответ за WRITE_TIMEOUT_MS
+ *
+ * Конвейерные запросы, пришедшие одним пакетом, остаются в буфере
+ * и обрабатываются строго по порядку. Тело запроса с Content-Length
+ * пропускается; если заголовки не помещаются в буфер, клиент получает 431.
+ *
+ * Длительности чтения, обращения к БД и записи, а также счетчики запросов
+ * и байтов публикуются в GetMetrics().
  *
  * Сессия работает в асинхронном режиме с использованием boost::asio.
  */
 class Session : public ISession {
    public:
+    static constexpr std::size_t kReadBufferSize = 8192;  ///< Размер буфера чтения
+
     /**
      * @brief Конструктор сессии
      *
@@ -100,87 +285,332 @@ class Session : public ISession {
      */
     Session(BoostTcp::socket socket, std::shared_ptr<IDatabaseService> db)
         : socket_(std::move(socket))
-        , db_(std::move(db)) {  // NOLINT(hicpp-move-const-arg, performance-move-const-arg)
+        , db_(std::move(db))  // NOLINT(hicpp-move-const-arg, performance-move-const-arg)
+        , idle_timeout_(GetConfigSnapshot().keep_alive_timeout)
+        , write_timeout_(GetConfigSnapshot().write_timeout)
+        , max_requests_(GetConfigSnapshot().keep_alive_max_requests) {
     }
 
+    /**
+     * @brief Деструктор - снимает сессию с учета активных
+     */
+    ~Session() override {
+        Deactivate();
+    }
+
+    Session(const Session&) = delete;             ///< Запрет копирования
+    Session& operator=(const Session&) = delete;  ///< Запрет присваивания
+    Session(Session&&) = delete;                  ///< Запрет перемещения
+    Session& operator=(Session&&) = delete;       ///< Запрет перемещающего присваивания
+
     /**
      * @brief Запускает обработку HTTP сессии
      *
      * Начинает асинхронное чтение HTTP заголовков от клиента.
      */
     void Start() override {
+        active_ = true;
+        GetMetrics().Add(Gauge::kActiveSessions, 1);
         DoRead();
     }
 
+    /**
+     * @brief Завершает сессию при остановке сервера
+     *
+     * Соединение, ожидающее нового запроса, закрывается сразу; начатый
+     * запрос получает ответ с "Connection: close".
+     *
+     * @param force Закрыть сокет, не дожидаясь ответа
+     */
+    void Shutdown(bool force) override {
+        boost::asio::post(socket_.get_executor(), [self = shared_from_this(), this, force] {
+            draining_ = true;
+            if (force || idle_) {
+                boost::system::error_code ignored;
+                socket_.close(ignored);
+            }
+        });
+    }
+
+    /**
+     * @brief Подготавливает сессию к повторному использованию с новым клиентом
+     *
+     * Используется пулом сессий: буфер чтения встроен в объект сессии,
+     * поэтому повторно используется между соединениями. Параметры
+     * keep-alive перечитываются из текущего снимка конфигурации.
+     *
+     * @param socket TCP сокет нового клиента
+     * @param db Сервис базы данных
+     */
+    void Reset(BoostTcp::socket socket, std::shared_ptr<IDatabaseService> db) {
+        socket_ = std::move(socket);
+        db_ = std::move(db);
+        requests_served_ = 0;
+        keep_alive_ = false;
+        idle_timeout_ = GetConfigSnapshot().keep_alive_timeout;
+        write_timeout_ = GetConfigSnapshot().write_timeout;
+        max_requests_ = GetConfigSnapshot().keep_alive_max_requests;
+    }
+
+    /**
+     * @brief Освобождает ресурсы соединения перед возвратом сессии в пул
+     *
+     * Закрывает сокет, отбрасывает непрочитанные данные, снимает срок
+     * и отпускает сервис базы данных.
+     */
+    void Release() {
+        boost::system::error_code ignored;
+        socket_.close(ignored);
+        ForgetDeadline();
+        Unregister();
+        read_size_ = 0;
+        request_started_ = false;
+        draining_ = false;
+        idle_ = false;
+        body_to_skip_ = 0;
+        parser_.Reset();
+        db_.reset();
+        Deactivate();
+        ReleaseAdmission();
+    }
+
    private:
     /**
-     * @brief Асинхронно читает HTTP заголовки от клиента
+     * @brief Обрабатывает данные из буфера или асинхронно читает новые
+     *
+     * Сначала пропускает остаток тела предыдущего запроса, затем продолжает
+     * разбор уже прочитанных байтов (в том числе конвейерных запросов).
+     * Если запроса целиком в буфере нет, дочитывает данные через
+     * async_read_some в свободную часть буфера; разборщик продолжает
+     * с места остановки, не сканируя прочитанное повторно.
      *
-     * Читает данные до последовательности "\r\n\r\n", которая обозначает
-     * конец HTTP заголовков. После получения заголовков выводит их в консоль
-     * и переходит к отправке ответа.
+     * Срок чтения ставится один раз на запрос, когда сессия начинает его
+     * ждать: если за KEEP_ALIVE_TIMEOUT_MS заголовки не пришли целиком,
+     * соединение закрывается. Частичные чтения срок не продлевают, поэтому
+     * клиент, присылающий заголовки по байту, не удержит соединение
+     * дольше таймаута и больше kReadBufferSize байтов памяти.
+     *
+     * После Shutdown() новый запрос не ожидается: сессия завершается.
      */
     void DoRead() {
+        SkipBody();
+        if (body_to_skip_ == 0 && read_size_ > 0) {
+            if (!request_started_) {
+                request_started_ = true;
+                request_start_ = std::chrono::steady_clock::now();
+            }
+            switch (parser_.Parse(BufferedData())) {
+                case HttpRequestParser::Status::kComplete:
+                    HandleRequest(parser_.Request(BufferedData()));
+                    return;
+                case HttpRequestParser::Status::kBadRequest:
+                    RespondError(
+                        HttpResponseBuilder::kHeadBadRequest, HttpRouter::kBadRequestBody);
+                    return;
+                case HttpRequestParser::Status::kHeadersTooLarge:
+                    RespondError(
+                        HttpResponseBuilder::kHeadHeadersTooLarge, HttpRouter::kTooLargeBody);
+                    return;
+                case HttpRequestParser::Status::kIncomplete:
+                    if (read_size_ == read_buffer_.size()) {
+                        RespondError(
+                            HttpResponseBuilder::kHeadHeadersTooLarge, HttpRouter::kTooLargeBody);
+                        return;
+                    }
+                    break;
+            }
+        }
+
         auto self = shared_from_this();  // Сохраняем сессию в памяти во время асинхронной операции
 
-        boost::asio::async_read_until(
-            socket_, buffer_, "\r\n\r\n",
-            [this, self](boost::system::error_code ec, std::size_t /*size*/) {
-                if (!ec) {
-                    std::istream request(&buffer_);
-                    std::cout << "Received request headers:\n";
-
-                    // Читаем и выводим все строки заголовков
-                    std::string header_line;
-                    while (std::getline(request, header_line) && header_line != "\r") {
-                        std::cout << header_line << '\n';
+        idle_ = !request_started_ && body_to_skip_ == 0;
+        if (idle_ && draining_) {
+            return;  // Сервер останавливается, нового запроса не ждем
+        }
+        if (!request_started_) {
+            ArmDeadline(socket_.get_executor(), idle_timeout_);
+        }
+        socket_.async_read_some(
+            boost::asio::buffer(read_buffer_.data() + read_size_, read_buffer_.size() - read_size_),
+            MakeCustomAllocHandler(
+                read_memory_, [this, self](boost::system::error_code ec, std::size_t size) {
+                    idle_ = false;
+                    if (!ec) {
+                        GetMetrics().Increment(Counter::kBytesReceived, size);
+                        read_size_ += size;
+                        DoRead();
                     }
-                    std::cout << "--- End of headers ---\n";
+                }));
+    }
+
+    /**
+     * @brief Обрабатывает полностью разобранные заголовки запроса
+     *
+     * Записывает запрос в лог, определяет, нужно ли сохранить соединение,
+     * выбирает обработчик по пути запроса и отправляет ответ.
+     *
+     * @param request Запрос, ссылающийся на буфер чтения
+     */
+    void HandleRequest(const HttpRequest& request) {
+        DisarmDeadline();
+        GetMetrics().Observe(Histogram::kRead, std::chrono::steady_clock::now() - request_start_);
+        GetMetrics().Increment(Counter::kRequests);
+        request_started_ = false;
+
+        LOG_DEBUG << "Request: " << request.method << ' ' << request.target << ' '
+                  << request.version;
+        for (std::size_t i = 0; i < request.header_count; ++i) {
+            const HttpHeader& header = request.headers[i];
+            LOG_TRACE << "Header: " << header.name << ": " << header.value;
+        }
 
-                    DoWrite();  // Переходим к отправке ответа
-                }
-            });
+        keep_alive_ = request.KeepAlive();
+        body_to_skip_ = request.ContentLength();
+
+        // Тело неизвестной длины не поддерживается, поэтому после ответа
+        // соединение закрывается, чтобы не принять тело за следующий запрос
+        ++requests_served_;
+        if (request.HasTransferEncoding() || requests_served_ >= max_requests_ || draining_) {
+            keep_alive_ = false;
+        }
+
+        router_.Route(request.Path(), request.Query(), *db_, response_);
+        response_.SetKeepAlive(keep_alive_);
+        DoWrite();
     }
 
     /**
-     * @brief Асинхронно отправляет HTTP ответ клиенту
+     * @brief Отправляет ответ об ошибке и закрывает соединение
      *
-     * Формирует HTTP ответ с информацией о количестве посещений
-     * и отправляет его клиенту. После отправки соединение закрывается.
+     * @param head Начало ответа с нужным статусом
+     * @param body Тело ответа
+     */
+    void RespondError(std::string_view head, std::string_view body) {
+        keep_alive_ = false;
+        response_.Start(head);
+        response_.AppendBody(body);
+        response_.SetKeepAlive(false);
+        DoWrite();
+    }
+
+    /**
+     * @brief Асинхронно отправляет подготовленный HTTP ответ клиенту
+     *
+     * Ответ отправляется одной scatter-gather записью за WRITE_TIMEOUT_MS.
+     * Для постоянного соединения
+     * после отправки из буфера удаляются заголовки обработанного запроса
+     * и начинается разбор следующего, иначе соединение закрывается.
      */
     void DoWrite() {
         auto self = shared_from_this();  // Сохраняем сессию в памяти во время асинхронной операции
 
-        // Получаем количество посещений из базы данных
-        const uint64_t visit_count = db_->GetCount();
-
-        // Формируем тело HTTP ответа
-        const std::string body = "Hello, world! Visits: " + std::to_string(visit_count);
-
-        // Формируем полный HTTP ответ с заголовками
-        std::string response =
-            "HTTP/1.1 200 OK\r\n"
-            "Content-Type: text/html\r\n"
-            "Content-Length: " +
-            std::to_string(body.length()) +
-            "\r\n"
-            "Connection: close\r\n\r\n" +
-            body;
+        if (response_.Overflowed()) {
+            // Finish() отдаст 500 с Connection: close
+            LOG_ERROR << "HTTP response body exceeds builder limits";
+            keep_alive_ = false;
+        }
 
         // Асинхронно отправляем ответ клиенту
+        write_start_ = std::chrono::steady_clock::now();
+        ArmDeadline(socket_.get_executor(), write_timeout_);
         boost::asio::async_write(
-            socket_, boost::asio::buffer(response),
-            [self](boost::system::error_code ec, std::size_t /*length*/) {
-                if (!ec) {
-                    std::cout << "Response sent.\n";
-                }
-                // Соединение автоматически закроется при уничтожении сессии
-            });
-    }
-
-    BoostTcp::socket socket_;               ///< TCP сокет для коммуникации с клиентом
-    boost::asio::streambuf buffer_;         ///< Буфер для чтения HTTP данных
-    std::shared_ptr<IDatabaseService> db_;  ///< Сервис базы данных
+            socket_, response_.Finish(),
+            MakeCustomAllocHandler(
+                write_memory_, [this, self](boost::system::error_code ec, std::size_t length) {
+                    DisarmDeadline();
+                    GetMetrics().Observe(
+                        Histogram::kWrite, std::chrono::steady_clock::now() - write_start_);
+                    GetMetrics().Increment(Counter::kBytesSent, length);
+                    if (ec) {
+                        return;
+                    }
+                    LOG_TRACE << "Response sent";
+                    if (keep_alive_) {
+                        ConsumeBuffered(parser_.Consumed());
+                        parser_.Reset();
+                        DoRead();  // Ждем следующий запрос на том же соединении
+                        return;
+                    }
+                    boost::system::error_code ignored;
+                    socket_.shutdown(BoostTcp::socket::shutdown_send, ignored);
+                    // Соединение автоматически закроется при уничтожении сессии
+                }));
+    }
+
+    /**
+     * @brief Закрывает сокет по истечении срока чтения или записи
+     *
+     * Вызывается из strand колеса сроков; закрытие выполняется на strand
+     * сессии и прерывает ожидающую операцию.
+     */
+    void OnDeadline() override {
+        boost::asio::post(socket_.get_executor(), [self = shared_from_this(), this] {
+            boost::system::error_code ignored;
+            socket_.close(ignored);
+        });
+    }
+
+    /**
+     * @brief Снимает сессию с учета активных, если она была запущена
+     */
+    void Deactivate() {
+        if (active_) {
+            active_ = false;
+            GetMetrics().Add(Gauge::kActiveSessions, -1);
+        }
+    }
+
+    /**
+     * @brief Прочитанные, но еще не обработанные байты
+     */
+    std::string_view BufferedData() const {
+        return {read_buffer_.data(), read_size_};
+    }
+
+    /**
+     * @brief Удаляет обработанные байты из начала буфера
+     *
+     * Оставшиеся данные (начало следующего конвейерного запроса)
+     * сдвигаются в начало буфера.
+     *
+     * @param size Количество обработанных байтов
+     */
+    void ConsumeBuffered(std::size_t size) {
+        std::memmove(read_buffer_.data(), read_buffer_.data() + size, read_size_ - size);
+        read_size_ -= size;
+    }
+
+    /**
+     * @brief Пропускает уже прочитанную часть тела предыдущего запроса
+     */
+    void SkipBody() {
+        const auto size = static_cast<std::size_t>(
+            std::min<uint64_t>(body_to_skip_, static_cast<uint64_t>(read_size_)));
+        ConsumeBuffered(size);
+        body_to_skip_ -= size;
+    }
+
+    BoostTcp::socket socket_;                              ///< TCP сокет клиента
+    std::array<char, kReadBufferSize> read_buffer_;        ///< Буфер для чтения HTTP данных
+    std::size_t read_size_ = 0;                            ///< Количество байтов в буфере
+    uint64_t body_to_skip_ = 0;                            ///< Непрочитанный остаток тела запроса
+    HttpRequestParser parser_;                             ///< Разборщик текущего запроса
+    std::shared_ptr<IDatabaseService> db_;                 ///< Сервис базы данных
+    HttpResponseBuilder response_;                         ///< Построитель отправляемого ответа
+    std::chrono::milliseconds idle_timeout_;               ///< Таймаут простоя соединения
+    std::chrono::milliseconds write_timeout_;              ///< Таймаут записи ответа
+    int max_requests_;                                     ///< Лимит запросов на соединение
+    int requests_served_ = 0;                              ///< Количество обработанных запросов
+    bool keep_alive_ = false;                              ///< Сохранять ли соединение после ответа
+    HandlerMemory read_memory_;                            ///< Память для операции чтения
+    HandlerMemory write_memory_;                           ///< Память для операции записи
+    HttpRouter router_;                                    ///< Маршрутизатор запросов
+    std::chrono::steady_clock::time_point request_start_;  ///< Начало чтения запроса
+    std::chrono::steady_clock::time_point write_start_;    ///< Начало отправки ответа
+    bool request_started_ = false;                         ///< Начато ли чтение текущего запроса
+    bool idle_ = false;                                    ///< Ждет ли сессия нового запроса
+    bool draining_ = false;                                ///< Сервер останавливается
+    bool active_ = false;                                  ///< Учтена ли сессия как активная
 };
 
 /**
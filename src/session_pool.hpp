@@ -0,0 +1,280 @@
+#pragma once
+
+#include "config.hpp"
+#include "database.hpp"
+#include "session.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Пул переиспользуемых HTTP сессий
+ *
+ * Класс SessionPool хранит:
+ * - Список свободных объектов Session вместе с их буферами чтения
+ *   и памятью для обработчиков asio
+ * - Список свободных блоков для управляющих блоков std::shared_ptr
+ *
+ * При высокой частоте подключений это убирает malloc/free объекта
+ * сессии и ее буферов из пути обработки соединения.
+ * Пул потокобезопасен: сессии возвращаются из любого потока io_context.
+ */
+class SessionPool {
+   public:
+    /**
+     * @brief Конструктор пула
+     *
+     * @param max_idle Максимальное количество свободных сессий, хранимых в пуле
+     */
+    explicit SessionPool(std::size_t max_idle) : max_idle_(max_idle) {
+        idle_.reserve(max_idle_);
+        blocks_.reserve(max_idle_);
+    }
+
+    /**
+     * @brief Деструктор - освобождает свободные сессии и блоки
+     */
+    ~SessionPool() {
+        for (void* block : blocks_) {
+            ::operator delete(block);
+        }
+    }
+
+    SessionPool(const SessionPool&) = delete;             ///< Запрет копирования
+    SessionPool& operator=(const SessionPool&) = delete;  ///< Запрет присваивания
+    SessionPool(SessionPool&&) = delete;                  ///< Запрет перемещения
+    SessionPool& operator=(SessionPool&&) = delete;       ///< Запрет перемещающего присваивания
+
+    /**
+     * @brief Забирает свободную сессию из пула
+     *
+     * @return std::unique_ptr<Session> Свободная сессия или nullptr, если пул пуст
+     */
+    std::unique_ptr<Session> TakeSession() {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        if (idle_.empty()) {
+            return nullptr;
+        }
+        auto session = std::move(idle_.back());
+        idle_.pop_back();
+        return session;
+    }
+
+    /**
+     * @brief Возвращает завершившуюся сессию в пул
+     *
+     * Если пул заполнен, сессия уничтожается.
+     *
+     * @param session Сессия, на которую больше нет ссылок
+     */
+    void RecycleSession(Session* session) {
+        std::unique_ptr<Session> owned(session);
+        owned->Release();
+
+        const std::lock_guard<std::mutex> lock(mutex_);
+        if (idle_.size() < max_idle_) {
+            idle_.push_back(std::move(owned));
+        }
+    }
+
+    /**
+     * @brief Уничтожает свободные сессии и перестает принимать новые
+     *
+     * Свободная сессия хранит weak_ptr на свой последний управляющий блок
+     * (enable_shared_from_this), а блок - ссылку на пул в удалителе и аллокаторе.
+     * Без очистки этот цикл не дает освободить пул при завершении работы.
+     * Сессии уничтожаются вне мьютекса, так как освобождение их управляющих
+     * блоков снова обращается к пулу.
+     */
+    void Clear() {
+        std::vector<std::unique_ptr<Session>> idle;
+        {
+            const std::lock_guard<std::mutex> lock(mutex_);
+            max_idle_ = 0;
+            idle.swap(idle_);
+        }
+    }
+
+    /**
+     * @brief Выделяет блок памяти (для управляющего блока shared_ptr)
+     *
+     * @param size Размер блока
+     * @return void* Переиспользованный или новый блок
+     */
+    void* AllocateBlock(std::size_t size) {
+        {
+            const std::lock_guard<std::mutex> lock(mutex_);
+            if (size == block_size_ && !blocks_.empty()) {
+                void* block = blocks_.back();
+                blocks_.pop_back();
+                return block;
+            }
+            if (block_size_ == 0) {
+                block_size_ = size;
+            }
+        }
+        return ::operator new(size);
+    }
+
+    /**
+     * @brief Возвращает блок памяти в пул
+     *
+     * @param block Блок, полученный от AllocateBlock()
+     * @param size Размер блока
+     */
+    void DeallocateBlock(void* block, std::size_t size) {
+        {
+            const std::lock_guard<std::mutex> lock(mutex_);
+            if (size == block_size_ && blocks_.size() < max_idle_) {
+                blocks_.push_back(block);
+                return;
+            }
+        }
+        ::operator delete(block);
+    }
+
+   private:
+    std::size_t max_idle_;                        ///< Лимит свободных сессий и блоков
+    std::vector<std::unique_ptr<Session>> idle_;  ///< Свободные сессии
+    std::vector<void*> blocks_;                   ///< Свободные блоки управляющих блоков
+    std::size_t block_size_ = 0;                  ///< Размер переиспользуемых блоков
+    std::mutex mutex_;                            ///< Мьютекс для потокобезопасности
+};
+
+/**
+ * @brief Аллокатор управляющих блоков shared_ptr из SessionPool
+ *
+ * Хранит владеющую ссылку на пул, чтобы пул гарантированно пережил
+ * освобождение последнего управляющего блока.
+ *
+ * @tparam T Тип выделяемых объектов
+ */
+template <typename T>
+class SessionPoolAllocator {
+   public:
+    using value_type = T;
+
+    /**
+     * @brief Конструктор аллокатора
+     *
+     * @param pool Пул, из которого выделяются блоки
+     */
+    explicit SessionPoolAllocator(std::shared_ptr<SessionPool> pool) : pool_(std::move(pool)) {
+    }
+
+    /**
+     * @brief Конструктор преобразования для rebind
+     */
+    template <typename U>
+    SessionPoolAllocator(const SessionPoolAllocator<U>& other)  // NOLINT(google-explicit-constructor)
+        : pool_(other.pool_) {
+    }
+
+    /**
+     * @brief Выделяет память для n объектов типа T
+     */
+    T* allocate(std::size_t n) const {
+        return static_cast<T*>(pool_->AllocateBlock(sizeof(T) * n));
+    }
+
+    /**
+     * @brief Освобождает память, выделенную через allocate()
+     */
+    void deallocate(T* pointer, std::size_t n) const {
+        pool_->DeallocateBlock(pointer, sizeof(T) * n);
+    }
+
+    template <typename U>
+    bool operator==(const SessionPoolAllocator<U>& other) const noexcept {
+        return pool_ == other.pool_;
+    }
+
+    template <typename U>
+    bool operator!=(const SessionPoolAllocator<U>& other) const noexcept {
+        return pool_ != other.pool_;
+    }
+
+   private:
+    template <typename>
+    friend class SessionPoolAllocator;
+
+    std::shared_ptr<SessionPool> pool_;  ///< Пул блоков
+};
+
+/**
+ * @brief Фабрика HTTP сессий, переиспользующая объекты Session
+ *
+ * Вместо std::make_shared<Session> на каждое соединение фабрика берет
+ * свободную сессию из SessionPool и переинициализирует ее новым сокетом.
+ * Когда последняя ссылка на сессию исчезает, удалитель возвращает ее в пул,
+ * а управляющий блок shared_ptr берется из списка свободных блоков.
+ * В установившемся режиме объект сессии, ее буферы и память обработчиков
+ * не выделяются заново.
+ */
+class PooledSessionFactory : public ISessionFactory {
+   public:
+    /**
+     * @brief Конструктор фабрики
+     *
+     * @param max_idle Максимальное количество свободных сессий в пуле
+     */
+    explicit PooledSessionFactory(std::size_t max_idle)
+        : pool_(std::make_shared<SessionPool>(max_idle)) {
+    }
+
+    /**
+     * @brief Конструктор с размером пула из конфигурации (SESSION_POOL_SIZE)
+     */
+    PooledSessionFactory()
+        : PooledSessionFactory(static_cast<std::size_t>(GetConfig().GetSessionPoolSize())) {
+    }
+
+    /**
+     * @brief Деструктор - освобождает свободные сессии пула
+     */
+    ~PooledSessionFactory() override {
+        pool_->Clear();
+    }
+
+    PooledSessionFactory(const PooledSessionFactory&) = delete;             ///< Запрет копирования
+    PooledSessionFactory& operator=(const PooledSessionFactory&) = delete;  ///< Запрет присваивания
+    PooledSessionFactory(PooledSessionFactory&&) = delete;                  ///< Запрет перемещения
+    PooledSessionFactory& operator=(PooledSessionFactory&&) = delete;       ///< Запрет перемещения
+
+    /**
+     * @brief Создает HTTP сессию, по возможности переиспользуя свободную
+     *
+     * @param socket TCP сокет клиентского соединения
+     * @param db_service Сервис базы данных для работы с посещениями
+     * @return std::shared_ptr<ISession> Сессия, возвращаемая в пул после завершения
+     */
+    std::shared_ptr<ISession> Create(
+        BoostTcp::socket socket, std::shared_ptr<IDatabaseService> db_service) override {
+        auto session = pool_->TakeSession();
+        if (session) {
+            session->Reset(std::move(socket), std::move(db_service));
+        } else {
+            session = std::make_unique<Session>(std::move(socket), std::move(db_service));
+        }
+        return std::shared_ptr<Session>(
+            session.release(), Recycler{pool_}, SessionPoolAllocator<Session>(pool_));
+    }
+
+   private:
+    /**
+     * @brief Удалитель shared_ptr, возвращающий сессию в пул
+     */
+    struct Recycler {
+        std::shared_ptr<SessionPool> pool;  ///< Пул для возврата сессии
+
+        void operator()(Session* session) const {
+            pool->RecycleSession(session);
+        }
+    };
+
+    std::shared_ptr<SessionPool> pool_;  ///< Пул сессий и управляющих блоков
+};
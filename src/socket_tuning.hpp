@@ -0,0 +1,103 @@
+#pragma once
+
+#include <boost/asio/detail/socket_option.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/socket_base.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <string_view>
+
+#if defined(__linux__)
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#endif
+
+/**
+ * @brief Механизм ввода-вывода, с которым собран asio
+ *
+ * Сборка с --config=io_uring (.bazelrc) определяет BOOST_ASIO_HAS_IO_URING
+ * и BOOST_ASIO_DISABLE_EPOLL: тогда сокеты обслуживает io_uring, и accept,
+ * чтение, запись и закрытие отправляются в ядро пакетами через общее
+ * кольцо вместо отдельного системного вызова на каждую операцию.
+ */
+#if defined(BOOST_ASIO_HAS_IO_URING_AS_DEFAULT)
+inline constexpr std::string_view kIoBackend = "io_uring";
+#elif defined(BOOST_ASIO_HAS_EPOLL)
+inline constexpr std::string_view kIoBackend = "epoll";
+#else
+inline constexpr std::string_view kIoBackend = "select/kqueue";
+#endif
+
+/**
+ * @brief Параметры сокетов слушателя и принятых соединений
+ *
+ * Значения по умолчанию совпадают с поведением asio без настройки, кроме
+ * no_delay: ответы сервера короткие, и алгоритм Нейгла задерживал бы
+ * их до подтверждения предыдущего сегмента.
+ */
+struct SocketTuning {
+    bool no_delay = true;     ///< TCP_NODELAY для принятых соединений
+    int defer_accept_s = 0;   ///< TCP_DEFER_ACCEPT в секундах (0 - выключен)
+    int backlog = 0;          ///< Очередь listen() (0 - SOMAXCONN)
+    bool reuse_port = false;  ///< SO_REUSEPORT для слушателя
+};
+
+#if defined(__linux__)
+/// Опция SO_REUSEPORT, которой нет среди опций asio
+using ReusePortOption = boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+/// Опция TCP_DEFER_ACCEPT, которой нет среди опций asio
+using DeferAcceptOption =
+    boost::asio::detail::socket_option::integer<IPPROTO_TCP, TCP_DEFER_ACCEPT>;
+#endif
+
+/**
+ * @brief Открывает, настраивает и переводит акцептор в режим прослушивания
+ *
+ * Порядок важен: SO_REUSEADDR и SO_REUSEPORT действуют только до bind().
+ * С SO_REUSEPORT несколько процессов могут слушать один порт, и ядро
+ * распределяет между ними входящие соединения. С TCP_DEFER_ACCEPT ядро
+ * отдает соединение в accept только после прихода первых данных, поэтому
+ * соединения без запроса не доходят до сервера.
+ *
+ * Вне Linux SO_REUSEPORT и TCP_DEFER_ACCEPT пропускаются.
+ *
+ * @param acceptor Закрытый акцептор
+ * @param endpoint Адрес прослушивания
+ * @param tuning Параметры сокетов
+ * @throws boost::system::system_error если порт не удалось открыть
+ */
+inline void ListenTuned(
+    boost::asio::ip::tcp::acceptor& acceptor, const boost::asio::ip::tcp::endpoint& endpoint,
+    const SocketTuning& tuning) {
+    acceptor.open(endpoint.protocol());
+    acceptor.set_option(boost::asio::socket_base::reuse_address(true));
+#if defined(__linux__)
+    if (tuning.reuse_port) {
+        acceptor.set_option(ReusePortOption(true));
+    }
+#endif
+    acceptor.bind(endpoint);
+#if defined(__linux__)
+    if (tuning.defer_accept_s > 0) {
+        acceptor.set_option(DeferAcceptOption(tuning.defer_accept_s));
+    }
+#endif
+    acceptor.listen(
+        tuning.backlog > 0 ? tuning.backlog : boost::asio::socket_base::max_listen_connections);
+}
+
+/**
+ * @brief Настраивает принятый сокет
+ *
+ * Ошибка настройки не мешает обслуживанию соединения и игнорируется.
+ *
+ * @param socket Принятый сокет
+ * @param tuning Параметры сокетов
+ */
+inline void TuneSocket(boost::asio::ip::tcp::socket& socket, const SocketTuning& tuning) {
+    if (tuning.no_delay) {
+        boost::system::error_code ignored;
+        socket.set_option(boost::asio::ip::tcp::no_delay(true), ignored);
+    }
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Хешированное колесо таймеров
+ *
+ * Класс TimerWheel хранит большое количество сроков с грубой точностью
+ * (один тик) за O(1) на постановку:
+ * - Срок попадает в ячейку (срок / тик) % количество ячеек
+ * - Advance() обходит только ячейки тиков, завершившихся с прошлого
+ *   вызова, и отдает ключи с истекшим сроком
+ * - Сроки дальше одного оборота колеса остаются в ячейке до нужного оборота
+ *
+ * Отмены нет: владелец проверяет актуальность ключа при срабатывании
+ * (например, по поколению записи) и при необходимости ставит его снова.
+ * Так продление срока не требует обращения к колесу.
+ *
+ * Класс не потокобезопасен, синхронизацию обеспечивает владелец.
+ *
+ * @tparam Key Тип ключа таймера
+ */
+template <typename Key>
+class TimerWheel {
+   public:
+    using Clock = std::chrono::steady_clock;  ///< Часы сроков
+    using TimePoint = Clock::time_point;      ///< Момент времени
+
+    /**
+     * @brief Конструктор колеса
+     *
+     * @param tick Длительность одного тика (точность сроков)
+     * @param slots Количество ячеек (один оборот = tick * slots)
+     * @param now Момент начала отсчета
+     */
+    TimerWheel(Clock::duration tick, std::size_t slots, TimePoint now = Clock::now())
+        : tick_(std::max(tick, Clock::duration(1)))
+        , slots_(std::max<std::size_t>(slots, 1))
+        , origin_(now) {
+    }
+
+    /**
+     * @brief Ставит таймер
+     *
+     * Срок в прошлом срабатывает по завершении ближайшего тика.
+     *
+     * @param key Ключ, который вернет Advance()
+     * @param deadline Срок срабатывания
+     */
+    void Schedule(Key key, TimePoint deadline) {
+        const uint64_t tick = std::max(TickOf(deadline), current_tick_ + 1);
+        slots_[tick % slots_.size()].push_back(Entry{std::move(key), deadline});
+        ++size_;
+    }
+
+    /**
+     * @brief Продвигает колесо до текущего момента
+     *
+     * @param now Текущий момент
+     * @param expired Вызывается с ключом каждого истекшего таймера; может
+     *        вызывать Schedule(): новый срок ставится после текущего тика
+     * @return std::size_t Количество сработавших таймеров
+     */
+    template <typename Callback>
+    std::size_t Advance(TimePoint now, Callback&& expired) {
+        // Обрабатываются только завершившиеся тики: таймер срабатывает не
+        // раньше срока и не позже чем через тик после него
+        const uint64_t target = TickOf(now);
+        if (target > current_tick_ + 1 + slots_.size()) {
+            // Пропущено больше оборота: достаточно один раз обойти все ячейки
+            current_tick_ = target - 1 - slots_.size();
+        }
+        std::size_t fired = 0;
+        while (current_tick_ + 1 < target) {
+            const uint64_t tick = ++current_tick_;
+            std::vector<Entry>& slot = slots_[tick % slots_.size()];
+            const auto keep = std::partition(
+                slot.begin(), slot.end(),
+                [this, tick](const Entry& entry) { return TickOf(entry.deadline) > tick; });
+            due_.clear();
+            std::move(keep, slot.end(), std::back_inserter(due_));
+            slot.erase(keep, slot.end());
+            size_ -= due_.size();
+            fired += due_.size();
+            for (Entry& entry : due_) {
+                expired(std::move(entry.key));
+            }
+        }
+        return fired;
+    }
+
+    /**
+     * @brief Количество поставленных таймеров
+     */
+    [[nodiscard]] std::size_t Size() const {
+        return size_;
+    }
+
+   private:
+    /**
+     * @brief Таймер в ячейке
+     */
+    struct Entry {
+        Key key;             ///< Ключ таймера
+        TimePoint deadline;  ///< Точный срок
+    };
+
+    /**
+     * @brief Номер тика, в который наступает момент
+     */
+    [[nodiscard]] uint64_t TickOf(TimePoint time) const {
+        if (time <= origin_) {
+            return 0;
+        }
+        return static_cast<uint64_t>((time - origin_) / tick_);
+    }
+
+    Clock::duration tick_;                   ///< Длительность тика
+    std::vector<std::vector<Entry>> slots_;  ///< Ячейки колеса
+    std::vector<Entry> due_;                 ///< Истекшие таймеры текущей ячейки
+    TimePoint origin_;                       ///< Момент тика 0
+    uint64_t current_tick_ = 0;              ///< Последний обработанный тик
+    std::size_t size_ = 0;                   ///< Количество таймеров
+};
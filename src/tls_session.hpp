@@ -0,0 +1,85 @@
+#pragma once
+
+#include "co_session.hpp"
+#include "metrics.hpp"
+#include "session.hpp"
+#include "tls_stream.hpp"
+
+#include <boost/asio/ssl/context.hpp>
+
+#include <memory>
+#include <utility>
+
+/**
+ * @brief Рукопожатие TLS перед первым HTTP запросом BasicCoSession
+ */
+template <>
+struct StreamHandshake<TlsStream> {
+    static constexpr bool kRequired = true;  ///< Нужно ли рукопожатие
+
+    /**
+     * @brief Запускает серверное рукопожатие TLS
+     */
+    template <typename CompletionToken>
+    static auto Async(TlsStream& stream, CompletionToken&& token) {
+        return stream.async_handshake(std::forward<CompletionToken>(token));
+    }
+
+    /**
+     * @brief Учитывает рукопожатие в метриках
+     */
+    static void Established(TlsStream& stream) {
+        GetMetrics().Increment(Counter::kTlsHandshakes);
+        if (stream.Resumed()) {
+            GetMetrics().Increment(Counter::kTlsResumed);
+        }
+        if (stream.KernelTlsSend()) {
+            GetMetrics().Increment(Counter::kTlsKernelOffload);
+        }
+    }
+
+    /**
+     * @brief Сообщает клиенту о закрытии соединения (close_notify)
+     */
+    static void Close(TlsStream& stream) {
+        stream.NotifyClose();
+    }
+};
+
+/// HTTP сессия на корутинах поверх TLS
+using TlsCoSession = BasicCoSession<TlsStream>;
+
+/**
+ * @brief Фабрика HTTPS сессий
+ *
+ * Создает TlsCoSession для каждого принятого соединения. Сессия
+ * поверх TlsStream обслуживает то же HTTP API, что и CoSession, после
+ * рукопожатия TLS, которое должно уложиться в KEEP_ALIVE_TIMEOUT_MS.
+ */
+class TlsSessionFactory : public ISessionFactory {
+   public:
+    /**
+     * @brief Конструктор
+     *
+     * @param context Контекст TLS (см. MakeTlsContext())
+     */
+    explicit TlsSessionFactory(std::shared_ptr<boost::asio::ssl::context> context)
+        : context_(std::move(context)) {
+    }
+
+    /**
+     * @brief Создает новую HTTPS сессию
+     *
+     * @param socket TCP сокет клиентского соединения
+     * @param db_service Сервис базы данных для работы с посещениями
+     * @return std::shared_ptr<ISession> Умный указатель на созданную сессию
+     */
+    std::shared_ptr<ISession> Create(
+        BoostTcp::socket socket, std::shared_ptr<IDatabaseService> db_service) override {
+        return std::make_shared<TlsCoSession>(
+            TlsStream(std::move(socket), *context_), std::move(db_service));
+    }
+
+   private:
+    std::shared_ptr<boost::asio::ssl::context> context_;  ///< Общий контекст TLS слушателя
+};
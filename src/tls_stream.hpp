@@ -0,0 +1,400 @@
+#pragma once
+
+#include "config.hpp"
+
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/compose.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/ssl/context.hpp>
+#include <boost/asio/ssl/error.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <openssl/bio.h>
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Серверный поток TLS поверх TCP сокета с шифрованием в ядре (kTLS)
+ *
+ * В отличие от boost::asio::ssl::stream, который шифрует записи через
+ * пару BIO в памяти и сам пишет зашифрованные байты в сокет, TlsStream
+ * отдает OpenSSL сам неблокирующий сокет (SSL_set_fd), а asio использует
+ * только для ожидания готовности (async_wait). Это дает две вещи:
+ * - Нет лишнего копирования каждого байта между BIO в памяти и сокетом
+ * - OpenSSL с SSL_OP_ENABLE_KTLS после рукопожатия передает ключи ядру,
+ *   и шифрование записей выполняет ядро: SSL_write становится обычным
+ *   write(), а SSL_sendfile() отправляет файлы без копирования в
+ *   пространство пользователя
+ *
+ * Если ядро или шифр не поддерживают kTLS, OpenSSL шифрует сам, и поток
+ * работает так же, только без разгрузки.
+ *
+ * Поток удовлетворяет требованиям AsyncReadStream/AsyncWriteStream asio
+ * и используется BasicCoSession как обычный сокет. Операции одного
+ * потока не должны выполняться одновременно в разных потоках: сессия
+ * работает на strand своего сокета.
+ */
+class TlsStream {
+   public:
+    using executor_type = boost::asio::ip::tcp::socket::executor_type;  ///< Executor сокета
+    using lowest_layer_type = boost::asio::ip::tcp::socket;             ///< Нижний уровень
+
+    static constexpr std::size_t kMaxGather = 16384;  ///< Байтов, собираемых в одну запись TLS
+
+    /**
+     * @brief Конструктор
+     *
+     * @param socket Принятый TCP сокет
+     * @param context Контекст TLS сервера (сертификат, параметры билетов сессий)
+     */
+    TlsStream(boost::asio::ip::tcp::socket socket, boost::asio::ssl::context& context)
+        : socket_(std::move(socket)), ssl_(SSL_new(context.native_handle())) {
+        boost::system::error_code ignored;
+        socket_.non_blocking(true, ignored);
+        if (ssl_) {
+            SSL_set_fd(ssl_.get(), static_cast<int>(socket_.native_handle()));
+            SSL_set_accept_state(ssl_.get());
+        }
+    }
+
+    /**
+     * @brief Executor, на котором выполняются обработчики потока
+     */
+    executor_type get_executor() {
+        return socket_.get_executor();
+    }
+
+    /**
+     * @brief TCP сокет потока
+     */
+    lowest_layer_type& lowest_layer() {
+        return socket_;
+    }
+
+    /**
+     * @brief Объект SSL соединения
+     */
+    SSL* native_handle() {
+        return ssl_.get();
+    }
+
+    /**
+     * @brief Выполняет рукопожатие TLS со стороны сервера
+     *
+     * @param token Обработчик void(error_code, std::size_t) или иной токен asio
+     */
+    template <typename CompletionToken>
+    auto async_handshake(CompletionToken&& token) {
+        return Async(
+            [](SSL* ssl, std::size_t& size) {
+                size = 0;
+                return SSL_do_handshake(ssl);
+            },
+            std::forward<CompletionToken>(token));
+    }
+
+    /**
+     * @brief Читает расшифрованные данные в первый непустой буфер последовательности
+     *
+     * @param buffers Буферы для данных
+     * @param token Обработчик void(error_code, std::size_t) или иной токен asio
+     */
+    template <typename MutableBufferSequence, typename CompletionToken>
+    auto async_read_some(const MutableBufferSequence& buffers, CompletionToken&& token) {
+        const auto buffer = FirstBuffer<boost::asio::mutable_buffer>(buffers);
+        return Async(
+            [buffer](SSL* ssl, std::size_t& size) {
+                return SSL_read_ex(ssl, buffer.data(), buffer.size(), &size);
+            },
+            std::forward<CompletionToken>(token));
+    }
+
+    /**
+     * @brief Записывает данные последовательности буферов
+     *
+     * Несколько буферов (например, заголовки и тело ответа) собираются
+     * в одну запись TLS размером до kMaxGather, чтобы ответ уходил одной
+     * записью и одним системным вызовом.
+     *
+     * @param buffers Буферы с данными
+     * @param token Обработчик void(error_code, std::size_t) или иной токен asio
+     */
+    template <typename ConstBufferSequence, typename CompletionToken>
+    auto async_write_some(const ConstBufferSequence& buffers, CompletionToken&& token) {
+        const boost::asio::const_buffer buffer = Gather(buffers);
+        return Async(
+            [buffer](SSL* ssl, std::size_t& size) {
+                return SSL_write_ex(ssl, buffer.data(), buffer.size(), &size);
+            },
+            std::forward<CompletionToken>(token));
+    }
+
+    /**
+     * @brief Отправляет close_notify, не дожидаясь ответа клиента
+     *
+     * Клиенты OpenSSL считают сессию, закрытую без close_notify,
+     * оборванной и не возобновляют ее.
+     */
+    void NotifyClose() {
+        if (ssl_ && SSL_is_init_finished(ssl_.get()) == 1) {
+            ERR_clear_error();
+            SSL_shutdown(ssl_.get());
+        }
+    }
+
+    /**
+     * @brief Возобновлена ли сессия по билету без полного рукопожатия
+     */
+    [[nodiscard]] bool Resumed() const {
+        return ssl_ && SSL_session_reused(ssl_.get()) == 1;
+    }
+
+    /**
+     * @brief Шифрует ли отправляемые записи ядро (kTLS)
+     */
+    [[nodiscard]] bool KernelTlsSend() const {
+#if !defined(OPENSSL_NO_KTLS)
+        return ssl_ && BIO_get_ktls_send(SSL_get_wbio(ssl_.get()));
+#else
+        return false;
+#endif
+    }
+
+   private:
+    /// Удаляет объект SSL
+    struct SslDeleter {
+        void operator()(SSL* ssl) const {
+            SSL_free(ssl);
+        }
+    };
+
+    /**
+     * @brief Асинхронная операция OpenSSL на неблокирующем сокете
+     *
+     * Вызывает операцию, пока OpenSSL не вернет результат: на
+     * SSL_ERROR_WANT_READ/WANT_WRITE ждет готовности сокета в реакторе
+     * asio и повторяет вызов с теми же аргументами, как требует OpenSSL.
+     *
+     * @tparam Operation Вызов int(SSL*, std::size_t&) с результатом 1 при успехе
+     */
+    template <typename Operation>
+    struct SslOp {
+        SslOp(TlsStream* owner, Operation call) : stream(owner), operation(std::move(call)) {
+        }
+
+        TlsStream* stream;                    ///< Поток операции
+        Operation operation;                  ///< Вызов OpenSSL
+        bool waited = false;                  ///< Ждала ли операция готовности сокета
+        bool done = false;                    ///< Получен ли результат
+        boost::system::error_code result_ec;  ///< Код результата
+        std::size_t result_size = 0;          ///< Количество обработанных байтов
+
+        template <typename Self>
+        void operator()(Self& self, boost::system::error_code ec = {}) {
+            if (done) {
+                self.complete(result_ec, result_size);
+                return;
+            }
+            if (ec) {
+                self.complete(ec, 0);
+                return;
+            }
+            SSL* ssl = stream->ssl_.get();
+            if (ssl == nullptr) {
+                Finish(self, boost::asio::error::no_memory, 0);
+                return;
+            }
+
+            std::size_t size = 0;
+            ERR_clear_error();
+            const int ret = operation(ssl, size);
+            if (ret == 1) {
+                Finish(self, {}, size);
+                return;
+            }
+            switch (SSL_get_error(ssl, ret)) {
+                case SSL_ERROR_WANT_READ:
+                    waited = true;
+                    stream->socket_.async_wait(
+                        boost::asio::ip::tcp::socket::wait_read, std::move(self));
+                    return;
+                case SSL_ERROR_WANT_WRITE:
+                    waited = true;
+                    stream->socket_.async_wait(
+                        boost::asio::ip::tcp::socket::wait_write, std::move(self));
+                    return;
+                case SSL_ERROR_ZERO_RETURN:
+                    Finish(self, boost::asio::error::eof, 0);
+                    return;
+                case SSL_ERROR_SYSCALL:
+                    if (ERR_peek_error() == 0) {
+                        Finish(self, SystemError(), 0);
+                        return;
+                    }
+                    [[fallthrough]];
+                default:
+                    Finish(
+                        self,
+                        boost::system::error_code(
+                            static_cast<int>(ERR_get_error()),
+                            boost::asio::error::get_ssl_category()),
+                        0);
+                    return;
+            }
+        }
+
+        /**
+         * @brief Завершает операцию
+         *
+         * Обработчик нельзя вызывать из инициирующей функции, поэтому
+         * результат, полученный без ожидания сокета, передается через post.
+         */
+        template <typename Self>
+        void Finish(Self& self, boost::system::error_code ec, std::size_t size) {
+            if (waited) {
+                self.complete(ec, size);
+                return;
+            }
+            done = true;
+            result_ec = ec;
+            result_size = size;
+            boost::asio::post(stream->socket_.get_executor(), std::move(self));
+        }
+
+        /**
+         * @brief Ошибка системного вызова (errno 0 - соединение закрыто)
+         */
+        static boost::system::error_code SystemError() {
+            if (errno == 0) {
+                return boost::asio::error::eof;
+            }
+            return {errno, boost::asio::error::get_system_category()};
+        }
+    };
+
+    /**
+     * @brief Запускает операцию OpenSSL с токеном asio
+     */
+    template <typename Operation, typename CompletionToken>
+    auto Async(Operation operation, CompletionToken&& token) {
+        return boost::asio::async_compose<
+            CompletionToken, void(boost::system::error_code, std::size_t)>(
+            SslOp<Operation>(this, std::move(operation)), token, socket_);
+    }
+
+    /**
+     * @brief Первый непустой буфер последовательности
+     */
+    template <typename Buffer, typename BufferSequence>
+    static Buffer FirstBuffer(const BufferSequence& buffers) {
+        const auto end = boost::asio::buffer_sequence_end(buffers);
+        for (auto it = boost::asio::buffer_sequence_begin(buffers); it != end; ++it) {
+            const Buffer buffer(*it);
+            if (buffer.size() > 0) {
+                return buffer;
+            }
+        }
+        return Buffer();
+    }
+
+    /**
+     * @brief Собирает начало последовательности в одну запись
+     *
+     * Единственный непустой буфер передается без копирования. Буфер
+     * сборки живет до следующей записи: повтор SSL_write после
+     * WANT_WRITE получает те же данные по тому же адресу.
+     */
+    template <typename ConstBufferSequence>
+    boost::asio::const_buffer Gather(const ConstBufferSequence& buffers) {
+        const boost::asio::const_buffer first = FirstBuffer<boost::asio::const_buffer>(buffers);
+        if (first.size() >= kMaxGather ||
+            boost::asio::buffer_size(buffers) == first.size()) {
+            return first;
+        }
+        write_buffer_.clear();
+        const auto end = boost::asio::buffer_sequence_end(buffers);
+        for (auto it = boost::asio::buffer_sequence_begin(buffers);
+             it != end && write_buffer_.size() < kMaxGather; ++it) {
+            const boost::asio::const_buffer buffer(*it);
+            const std::size_t size = std::min(buffer.size(), kMaxGather - write_buffer_.size());
+            const char* data = static_cast<const char*>(buffer.data());
+            write_buffer_.insert(write_buffer_.end(), data, data + size);
+        }
+        return boost::asio::buffer(write_buffer_);
+    }
+
+    boost::asio::ip::tcp::socket socket_;    ///< TCP сокет (неблокирующий)
+    std::unique_ptr<SSL, SslDeleter> ssl_;   ///< Соединение OpenSSL на сокете
+    std::vector<char> write_buffer_;         ///< Буфер сборки записи (емкость переиспользуется)
+};
+
+/**
+ * @brief Создает контекст TLS сервера по конфигурации
+ *
+ * Контекст общий для всех соединений слушателя:
+ * - TLS 1.2 и 1.3, сертификат и ключ из TLS_CERT_FILE и TLS_KEY_FILE
+ * - Возобновление сессий по билетам (RFC 5077, RFC 8446): состояние
+ *   сессии хранит клиент в зашифрованном билете, поэтому на сервере нет
+ *   общего кеша сессий с блокировкой, а повторное подключение обходится
+ *   без обмена ключами и проверки сертификата
+ * - Ключи билетов из TLS_TICKET_KEY_FILE, если он задан, иначе случайные
+ *   ключи процесса
+ * - SSL_OP_ENABLE_KTLS при TLS_KTLS: OpenSSL передает ключи записей
+ *   ядру, если ядро поддерживает выбранный шифр
+ *
+ * @param config Конфигурация
+ * @return std::shared_ptr<boost::asio::ssl::context> Контекст TLS
+ * @throws boost::system::system_error если сертификат или ключ не загружены
+ * @throws std::runtime_error если файл ключей билетов некорректен
+ */
+inline std::shared_ptr<boost::asio::ssl::context> MakeTlsContext(const ConfigManager& config) {
+    auto context =
+        std::make_shared<boost::asio::ssl::context>(boost::asio::ssl::context::tls_server);
+    SSL_CTX* ctx = context->native_handle();
+    SSL_CTX_set_min_proto_version(ctx, TLS1_2_VERSION);
+
+    uint64_t options = SSL_OP_NO_COMPRESSION | SSL_OP_CIPHER_SERVER_PREFERENCE;
+#if defined(SSL_OP_IGNORE_UNEXPECTED_EOF)
+    // Обрыв соединения без close_notify - обычный конец HTTP соединения
+    options |= SSL_OP_IGNORE_UNEXPECTED_EOF;
+#endif
+#if defined(SSL_OP_ENABLE_KTLS)
+    if (config.GetTlsKtls()) {
+        options |= SSL_OP_ENABLE_KTLS;
+    }
+#endif
+    SSL_CTX_set_options(ctx, options);
+
+    context->use_certificate_chain_file(config.GetTlsCertFile());
+    context->use_private_key_file(config.GetTlsKeyFile(), boost::asio::ssl::context::pem);
+
+    // Сессии возобновляются только по билетам, серверный кеш не нужен
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_OFF);
+    SSL_CTX_set_timeout(ctx, std::max(config.GetTlsSessionTimeoutS(), 1));
+
+    if (const std::string path = config.GetTlsTicketKeyFile(); !path.empty()) {
+        // Формат OpenSSL: 16 байт имени ключа, 32 байта ключа HMAC, 32 байта ключа AES
+        std::array<unsigned char, 80> keys{};
+        std::ifstream file(path, std::ios::binary);
+        file.read(reinterpret_cast<char*>(keys.data()), static_cast<std::streamsize>(keys.size()));
+        if (file.gcount() != static_cast<std::streamsize>(keys.size()) ||
+            SSL_CTX_set_tlsext_ticket_keys(ctx, keys.data(), keys.size()) != 1) {
+            throw std::runtime_error("TLS_TICKET_KEY_FILE must contain 80 bytes: " + path);
+        }
+    }
+    return context;
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "database_service.hpp"
+#include "logger.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Сервис базы данных с кешированным счетчиком посещений
+ *
+ * Класс CachedVisitCounter оборачивает другой IDatabaseService и держит
+ * количество посещений в атомарном счетчике внутри процесса:
+ * - Initialize() инициализирует нижележащий сервис и засевает счетчик
+ *   значением из базы данных (строка visits_counter)
+ * - MarkVisit()/MarkVisits() увеличивают счетчик и передают посещения дальше
+ * - GetCount() возвращает значение счетчика за O(1) без обращения к БД
+ * - GetVisitCounts() отвечает из гистограммы по минутам в памяти, которую
+ *   Initialize() загружает из базы данных, а MarkVisit()/MarkVisits()
+ *   дополняют, поэтому запрос /visits не блокирует поток ввода-вывода
+ *
+ * @note Счетчик и гистограмма учитывают только посещения, прошедшие через
+ * этот процесс после Initialize(). Посещения других экземпляров сервера
+ * будут видны после повторного вызова Initialize(). Гистограмма занимает
+ * 16 байт на каждую минуту, в которую были посещения.
+ */
+class CachedVisitCounter : public IDatabaseService {
+   public:
+    /**
+     * @brief Конструктор кеширующего сервиса
+     *
+     * @param backend Сервис базы данных, в который передаются посещения
+     */
+    explicit CachedVisitCounter(std::shared_ptr<IDatabaseService> backend)
+        : backend_(std::move(backend)) {
+    }
+
+    /**
+     * @brief Инициализирует нижележащий сервис и засевает счетчик и гистограмму
+     *
+     * Если нижележащий сервис не хранит аналитику посещений,
+     * GetVisitCounts() будет сообщать о недоступности.
+     */
+    void Initialize() override {
+        backend_->Initialize();
+        count_.store(backend_->GetCount(), std::memory_order_relaxed);
+
+        VisitHistogram histogram;
+        bool loaded = true;
+        try {
+            const auto end = std::chrono::system_clock::now() + std::chrono::minutes(1);
+            for (const auto& bucket : backend_->GetVisitCounts(
+                     std::chrono::system_clock::time_point{}, end, VisitGranularity::kMinute)) {
+                histogram.Add(bucket.Start(), bucket.count);
+            }
+        } catch (const DatabaseUnavailableError& e) {
+            LOG_WARNING << "Visit analytics disabled: " << e.what();
+            loaded = false;
+        }
+
+        const std::lock_guard<std::mutex> lock(mutex_);
+        histogram_ = std::move(histogram);
+        histogram_loaded_ = loaded;
+    }
+
+    /**
+     * @brief Регистрирует посещение и увеличивает счетчик
+     */
+    void MarkVisit() override {
+        count_.fetch_add(1, std::memory_order_relaxed);
+        {
+            const std::lock_guard<std::mutex> lock(mutex_);
+            histogram_.Add(std::chrono::system_clock::now());
+        }
+        backend_->MarkVisit();
+    }
+
+    /**
+     * @brief Регистрирует пакет посещений и увеличивает счетчик на его размер
+     *
+     * @param times Временные метки посещений
+     */
+    void MarkVisits(const std::vector<std::chrono::system_clock::time_point>& times) override {
+        count_.fetch_add(times.size(), std::memory_order_relaxed);
+        {
+            const std::lock_guard<std::mutex> lock(mutex_);
+            histogram_.Add(times);
+        }
+        backend_->MarkVisits(times);
+    }
+
+    /**
+     * @brief Получает количество посещений из счетчика в памяти
+     *
+     * @return uint64_t Общее число зарегистрированных посещений
+     */
+    uint64_t GetCount() override {
+        return count_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Получает количество посещений по интервалам из гистограммы в памяти
+     *
+     * @param from Начало периода (включительно)
+     * @param to Конец периода (не включительно)
+     * @param granularity Размер интервала
+     * @return std::vector<VisitBucket> Непустые интервалы в порядке возрастания
+     * @throws DatabaseUnavailableError если история посещений не загружена
+     */
+    std::vector<VisitBucket> GetVisitCounts(
+        std::chrono::system_clock::time_point from, std::chrono::system_clock::time_point to,
+        VisitGranularity granularity) override {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        if (!histogram_loaded_) {
+            throw DatabaseUnavailableError("Visit history is not loaded");
+        }
+        return histogram_.Query(from, to, granularity);
+    }
+
+    /**
+     * @brief Резервирует блок идентификаторов сообщений в нижележащем сервисе
+     *
+     * @return uint64_t Первый идентификатор блока
+     */
+    uint64_t ReserveMessageIds() override {
+        return backend_->ReserveMessageIds();
+    }
+
+    /**
+     * @brief Передает пакет сообщений нижележащему сервису
+     *
+     * @param messages Сообщения с назначенными идентификаторами
+     */
+    void AppendMessages(const std::vector<ChatMessage>& messages) override {
+        backend_->AppendMessages(messages);
+    }
+
+    /**
+     * @brief Читает страницу истории из нижележащего сервиса
+     *
+     * @param room Комната
+     * @param before_id Курсор: возвращаются сообщения с id меньше него
+     * @param limit Максимальное количество сообщений
+     * @return std::vector<ChatMessage> Сообщения от новых к старым
+     */
+    std::vector<ChatMessage> GetMessages(
+        uint16_t room, uint64_t before_id, std::size_t limit) override {
+        return backend_->GetMessages(room, before_id, limit);
+    }
+
+   private:
+    std::shared_ptr<IDatabaseService> backend_;  ///< Сервис для записи посещений
+    std::atomic<uint64_t> count_{0};             ///< Кешированное количество посещений
+    VisitHistogram histogram_;                   ///< Посещения по минутам
+    bool histogram_loaded_ = false;              ///< Загружена ли история посещений
+    std::mutex mutex_;                           ///< Мьютекс для гистограммы
+};
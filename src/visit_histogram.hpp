@@ -0,0 +1,231 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Размер интервала аналитики посещений
+ */
+enum class VisitGranularity : uint8_t {
+    kMinute,  ///< Минута
+    kHour,    ///< Час
+    kDay,     ///< Сутки (UTC)
+};
+
+/**
+ * @brief Количество минут в интервале
+ *
+ * @param granularity Размер интервала
+ * @return int64_t 1, 60 или 1440
+ */
+constexpr int64_t MinutesPerBucket(VisitGranularity granularity) {
+    switch (granularity) {
+        case VisitGranularity::kMinute:
+            return 1;
+        case VisitGranularity::kHour:
+            return 60;
+        case VisitGranularity::kDay:
+            return 1440;
+    }
+    return 1;
+}
+
+/**
+ * @brief Разбирает имя размера интервала ("minute", "hour", "day")
+ *
+ * @param name Имя
+ * @return std::optional<VisitGranularity> Размер или nullopt для неизвестного имени
+ */
+inline std::optional<VisitGranularity> ParseVisitGranularity(std::string_view name) {
+    if (name == "minute") {
+        return VisitGranularity::kMinute;
+    }
+    if (name == "hour") {
+        return VisitGranularity::kHour;
+    }
+    if (name == "day") {
+        return VisitGranularity::kDay;
+    }
+    return std::nullopt;
+}
+
+/**
+ * @brief Количество посещений за интервал времени
+ */
+struct VisitBucket {
+    int64_t minute = 0;  ///< Начало интервала в минутах от эпохи Unix (UTC)
+    uint64_t count = 0;  ///< Количество посещений
+
+    /**
+     * @brief Начало интервала как момент времени
+     */
+    [[nodiscard]] std::chrono::system_clock::time_point Start() const {
+        return std::chrono::system_clock::time_point(std::chrono::minutes(minute));
+    }
+
+    bool operator==(const VisitBucket&) const = default;
+};
+
+/**
+ * @brief Гистограмма посещений по минутам
+ *
+ * Предварительная агрегация в процессе: пакет посещений превращается в
+ * несколько строк (минута, количество) до записи в базу данных, поэтому
+ * таблица агрегатов растет на строку в минуту, а не на строку на
+ * посещение, и запросы аналитики не читают сырые посещения.
+ *
+ * Интервалы хранятся в векторе, упорядоченном по минуте. Посещения
+ * приходят почти по порядку времени, поэтому Add() обычно увеличивает
+ * последний интервал или добавляет новый в конец за O(1).
+ *
+ * @note Класс не потокобезопасен.
+ */
+class VisitHistogram {
+   public:
+    /**
+     * @brief Минута от эпохи Unix, в которую попадает момент времени
+     */
+    static int64_t MinuteOf(std::chrono::system_clock::time_point time) {
+        return std::chrono::floor<std::chrono::minutes>(time.time_since_epoch()).count();
+    }
+
+    /**
+     * @brief Округляет минуту вниз до начала интервала
+     *
+     * @param minute Минута от эпохи Unix
+     * @param width Размер интервала в минутах
+     */
+    static int64_t AlignDown(int64_t minute, int64_t width) {
+        const int64_t remainder = minute % width;
+        return remainder < 0 ? minute - remainder - width : minute - remainder;
+    }
+
+    /**
+     * @brief Учитывает посещение
+     *
+     * @param time Время посещения
+     * @param count Количество посещений
+     */
+    void Add(std::chrono::system_clock::time_point time, uint64_t count = 1) {
+        AddMinute(MinuteOf(time), count);
+    }
+
+    /**
+     * @brief Учитывает пакет посещений
+     *
+     * @param times Временные метки посещений
+     */
+    void Add(const std::vector<std::chrono::system_clock::time_point>& times) {
+        for (const auto time : times) {
+            Add(time);
+        }
+    }
+
+    /**
+     * @brief Интервалы по минутам в порядке возрастания
+     */
+    [[nodiscard]] const std::vector<VisitBucket>& Buckets() const {
+        return buckets_;
+    }
+
+    /**
+     * @brief Пуста ли гистограмма
+     */
+    [[nodiscard]] bool Empty() const {
+        return buckets_.empty();
+    }
+
+    /**
+     * @brief Удаляет все интервалы, сохраняя емкость
+     */
+    void Clear() {
+        buckets_.clear();
+    }
+
+    /**
+     * @brief Суммирует посещения по интервалам заданного размера
+     *
+     * @param from Начало периода (включительно, округляется вниз до интервала)
+     * @param to Конец периода (не включительно)
+     * @param granularity Размер интервала
+     * @return std::vector<VisitBucket> Непустые интервалы в порядке возрастания
+     */
+    [[nodiscard]] std::vector<VisitBucket> Query(
+        std::chrono::system_clock::time_point from, std::chrono::system_clock::time_point to,
+        VisitGranularity granularity) const {
+        const int64_t width = MinutesPerBucket(granularity);
+        const int64_t first = AlignDown(MinuteOf(from), width);
+        const int64_t last = MinuteOf(to - std::chrono::microseconds(1));
+
+        std::vector<VisitBucket> result;
+        auto it = std::lower_bound(
+            buckets_.begin(), buckets_.end(), first,
+            [](const VisitBucket& bucket, int64_t minute) { return bucket.minute < minute; });
+        for (; it != buckets_.end() && it->minute <= last; ++it) {
+            const int64_t start = AlignDown(it->minute, width);
+            if (!result.empty() && result.back().minute == start) {
+                result.back().count += it->count;
+            } else {
+                result.push_back(VisitBucket{start, it->count});
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief Складывает два упорядоченных списка интервалов одного размера
+     *
+     * @param lhs Интервалы в порядке возрастания
+     * @param rhs Интервалы в порядке возрастания
+     * @return std::vector<VisitBucket> Объединение с суммой совпадающих интервалов
+     */
+    static std::vector<VisitBucket> Merge(
+        const std::vector<VisitBucket>& lhs, const std::vector<VisitBucket>& rhs) {
+        std::vector<VisitBucket> result;
+        result.reserve(lhs.size() + rhs.size());
+        auto left = lhs.begin();
+        auto right = rhs.begin();
+        while (left != lhs.end() || right != rhs.end()) {
+            if (right == rhs.end() || (left != lhs.end() && left->minute < right->minute)) {
+                result.push_back(*left++);
+            } else if (left == lhs.end() || right->minute < left->minute) {
+                result.push_back(*right++);
+            } else {
+                result.push_back(VisitBucket{left->minute, left->count + right->count});
+                ++left;
+                ++right;
+            }
+        }
+        return result;
+    }
+
+   private:
+    /**
+     * @brief Учитывает посещения в минуте
+     */
+    void AddMinute(int64_t minute, uint64_t count) {
+        if (buckets_.empty() || buckets_.back().minute < minute) {
+            buckets_.push_back(VisitBucket{minute, count});
+            return;
+        }
+        if (buckets_.back().minute == minute) {
+            buckets_.back().count += count;
+            return;
+        }
+        auto it = std::lower_bound(
+            buckets_.begin(), buckets_.end(), minute,
+            [](const VisitBucket& bucket, int64_t value) { return bucket.minute < value; });
+        if (it->minute == minute) {
+            it->count += count;
+        } else {
+            buckets_.insert(it, VisitBucket{minute, count});
+        }
+    }
+
+    std::vector<VisitBucket> buckets_;  ///< Интервалы по минутам в порядке возрастания
+};
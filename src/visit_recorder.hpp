@@ -0,0 +1,287 @@
+#pragma once
+
+#include "config.hpp"
+#include "database_service.hpp"
+#include "logger.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Сервис отложенной (write-behind) записи посещений
+ *
+ * Класс BatchedVisitRecorder оборачивает другой IDatabaseService и убирает
+ * запись посещений с пути обработки соединений:
+ * - MarkVisit() только добавляет временную метку в буфер в памяти
+ * - Фоновый поток сбрасывает накопленные посещения одним пакетом
+ *   через MarkVisits() при достижении размера пакета или по таймеру
+ * - GetCount() учитывает еще не записанные посещения буфера; пакет,
+ *   записываемый в данный момент, виден после завершения записи
+ *
+ * Таким образом база данных выполняет одну транзакцию на пакет, а не на
+ * каждое соединение, а обработчик accept не блокируется на пуле соединений.
+ */
+class BatchedVisitRecorder : public IDatabaseService {
+   public:
+    /**
+     * @brief Конструктор сервиса отложенной записи
+     *
+     * @param backend Сервис базы данных, в который сбрасываются пакеты
+     * @param batch_size Количество посещений, при накоплении которого пакет сбрасывается сразу
+     * @param flush_interval Максимальное время ожидания перед сбросом пакета
+     */
+    BatchedVisitRecorder(
+        std::shared_ptr<IDatabaseService> backend, std::size_t batch_size,
+        std::chrono::milliseconds flush_interval)
+        : backend_(std::move(backend))
+        , batch_size_(batch_size > 0 ? batch_size : 1)
+        , flush_interval_(flush_interval) {
+        pending_.reserve(batch_size_);
+        worker_ = std::thread([this] { Run(); });
+    }
+
+    /**
+     * @brief Конструктор с параметрами из конфигурации
+     *
+     * @param backend Сервис базы данных, в который сбрасываются пакеты
+     */
+    explicit BatchedVisitRecorder(std::shared_ptr<IDatabaseService> backend)
+        : BatchedVisitRecorder(
+              std::move(backend), static_cast<std::size_t>(GetConfig().GetVisitBatchSize()),
+              std::chrono::milliseconds(GetConfig().GetVisitFlushIntervalMs())) {
+    }
+
+    /**
+     * @brief Деструктор - останавливает фоновый поток и сбрасывает остаток буфера
+     */
+    ~BatchedVisitRecorder() override {
+        {
+            const std::lock_guard<std::mutex> lock(mutex_);
+            stopped_ = true;
+        }
+        cv_.notify_one();
+        worker_.join();
+        Flush();
+    }
+
+    BatchedVisitRecorder(const BatchedVisitRecorder&) = delete;             ///< Запрет копирования
+    BatchedVisitRecorder& operator=(const BatchedVisitRecorder&) = delete;  ///< Запрет присваивания
+    BatchedVisitRecorder(BatchedVisitRecorder&&) = delete;                  ///< Запрет перемещения
+    BatchedVisitRecorder& operator=(
+        BatchedVisitRecorder&&) = delete;  ///< Запрет перемещающего присваивания
+
+    /**
+     * @brief Инициализирует схему базы данных нижележащего сервиса
+     */
+    void Initialize() override {
+        backend_->Initialize();
+    }
+
+    /**
+     * @brief Буферизует посещение с текущим временем
+     *
+     * Не обращается к базе данных: только добавляет метку в буфер
+     * и будит фоновый поток, если пакет заполнен.
+     */
+    void MarkVisit() override {
+        Enqueue(std::chrono::system_clock::now());
+    }
+
+    /**
+     * @brief Буферизует пакет посещений
+     *
+     * @param times Временные метки посещений
+     */
+    void MarkVisits(const std::vector<std::chrono::system_clock::time_point>& times) override {
+        bool full = false;
+        {
+            const std::lock_guard<std::mutex> lock(mutex_);
+            pending_.insert(pending_.end(), times.begin(), times.end());
+            full = pending_.size() >= batch_size_;
+        }
+        if (full) {
+            cv_.notify_one();
+        }
+    }
+
+    /**
+     * @brief Получает общее количество посещений с учетом буфера
+     *
+     * Пакет, записываемый в данный момент, не учитывается до конца записи:
+     * запись фиксируется в нижележащем сервисе раньше, чем это можно
+     * увидеть здесь, поэтому его учет дважды завысил бы результат.
+     *
+     * @return uint64_t Количество записанных посещений плюс еще не сброшенные
+     */
+    uint64_t GetCount() override {
+        std::size_t buffered = 0;
+        {
+            const std::lock_guard<std::mutex> lock(mutex_);
+            buffered = pending_.size();
+        }
+        return backend_->GetCount() + buffered;
+    }
+
+    /**
+     * @brief Получает количество посещений по интервалам с учетом буфера
+     *
+     * Еще не сброшенные посещения агрегируются по минутам и складываются
+     * с интервалами нижележащего сервиса, поэтому последние минуты видны
+     * до записи пакета. Пакет, записываемый в данный момент, не виден
+     * до конца записи.
+     *
+     * @param from Начало периода (включительно)
+     * @param to Конец периода (не включительно)
+     * @param granularity Размер интервала
+     * @return std::vector<VisitBucket> Непустые интервалы в порядке возрастания
+     */
+    std::vector<VisitBucket> GetVisitCounts(
+        std::chrono::system_clock::time_point from, std::chrono::system_clock::time_point to,
+        VisitGranularity granularity) override {
+        VisitHistogram buffered;
+        {
+            const std::lock_guard<std::mutex> lock(mutex_);
+            buffered.Add(pending_);
+        }
+        return VisitHistogram::Merge(
+            backend_->GetVisitCounts(from, to, granularity),
+            buffered.Query(from, to, granularity));
+    }
+
+    /**
+     * @brief Резервирует блок идентификаторов сообщений в нижележащем сервисе
+     *
+     * @return uint64_t Первый идентификатор блока
+     */
+    uint64_t ReserveMessageIds() override {
+        return backend_->ReserveMessageIds();
+    }
+
+    /**
+     * @brief Передает пакет сообщений нижележащему сервису
+     *
+     * @param messages Сообщения с назначенными идентификаторами
+     */
+    void AppendMessages(const std::vector<ChatMessage>& messages) override {
+        backend_->AppendMessages(messages);
+    }
+
+    /**
+     * @brief Читает страницу истории из нижележащего сервиса
+     *
+     * @param room Комната
+     * @param before_id Курсор: возвращаются сообщения с id меньше него
+     * @param limit Максимальное количество сообщений
+     * @return std::vector<ChatMessage> Сообщения от новых к старым
+     */
+    std::vector<ChatMessage> GetMessages(
+        uint16_t room, uint64_t before_id, std::size_t limit) override {
+        return backend_->GetMessages(room, before_id, limit);
+    }
+
+    /**
+     * @brief Синхронно сбрасывает все накопленные посещения в базу данных
+     *
+     * При ошибке записи пакет возвращается в буфер и будет записан
+     * при следующем сбросе.
+     */
+    void Flush() {
+        const std::lock_guard<std::mutex> flush_lock(flush_mutex_);
+
+        std::vector<std::chrono::system_clock::time_point> batch;
+        {
+            const std::lock_guard<std::mutex> lock(mutex_);
+            if (pending_.empty()) {
+                return;
+            }
+            batch.swap(pending_);
+            pending_.reserve(batch_size_);
+        }
+
+        try {
+            backend_->MarkVisits(batch);
+        } catch (const std::exception& e) {
+            LOG_ERROR << "Failed to flush " << batch.size() << " visits: " << e.what();
+            Requeue(std::move(batch));
+        }
+    }
+
+   private:
+    /// Во сколько раз буфер может превысить размер пакета, пока БД недоступна
+    static constexpr std::size_t kMaxPendingBatches = 64;
+
+    /**
+     * @brief Добавляет посещение в буфер
+     *
+     * @param time Временная метка посещения
+     */
+    void Enqueue(std::chrono::system_clock::time_point time) {
+        bool full = false;
+        {
+            const std::lock_guard<std::mutex> lock(mutex_);
+            pending_.push_back(time);
+            full = pending_.size() >= batch_size_;
+        }
+        if (full) {
+            cv_.notify_one();
+        }
+    }
+
+    /**
+     * @brief Возвращает не записанный пакет в начало буфера
+     *
+     * Если база данных долго недоступна, самые старые посещения
+     * отбрасываются, чтобы буфер не рос неограниченно.
+     *
+     * @param batch Пакет, который не удалось записать
+     */
+    void Requeue(std::vector<std::chrono::system_clock::time_point> batch) {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        batch.insert(batch.end(), pending_.begin(), pending_.end());
+        const std::size_t limit = batch_size_ * kMaxPendingBatches;
+        if (batch.size() > limit) {
+            const std::size_t dropped = batch.size() - limit;
+            batch.erase(batch.begin(), batch.begin() + static_cast<std::ptrdiff_t>(dropped));
+            LOG_WARNING << "Visit buffer overflow, dropped " << dropped << " visits";
+        }
+        pending_.swap(batch);
+    }
+
+    /**
+     * @brief Цикл фонового потока
+     *
+     * Ожидает заполнения пакета или истечения интервала сброса,
+     * после чего записывает накопленные посещения.
+     */
+    void Run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stopped_) {
+            cv_.wait_for(
+                lock, flush_interval_, [this] { return stopped_ || pending_.size() >= batch_size_; });
+            if (stopped_) {
+                break;
+            }
+            lock.unlock();
+            Flush();
+            lock.lock();
+        }
+    }
+
+    std::shared_ptr<IDatabaseService> backend_;                   ///< Сервис для записи пакетов
+    std::size_t batch_size_;                                      ///< Порог размера пакета
+    std::chrono::milliseconds flush_interval_;                    ///< Максимальный интервал сброса
+    std::vector<std::chrono::system_clock::time_point> pending_;  ///< Буфер посещений
+    bool stopped_ = false;        ///< Флаг остановки фонового потока
+    std::mutex mutex_;            ///< Мьютекс для буфера
+    std::mutex flush_mutex_;      ///< Сериализует одновременные сбросы
+    std::condition_variable cv_;  ///< Условная переменная для пробуждения фонового потока
+    std::thread worker_;          ///< Фоновый поток записи
+};
@@ -0,0 +1,144 @@
+/**
+ * @file test_admission.cpp
+ * @brief Unit-тесты контроля допуска соединений
+ *
+ * Проверяются:
+ * - Корзина токенов адреса: подключения подряд, отказ и пополнение
+ * - Независимость корзин разных адресов и совпадение IPv4 с IPv4-mapped
+ * - Вытеснение корзин в маленькой таблице
+ * - Лимит одновременных сессий и освобождение мест
+ *
+ * @date 2025
+ */
+
+#include "src/admission.hpp"
+
+#include <gtest/gtest.h>
+
+#include <boost/asio/ip/address.hpp>
+
+#include <chrono>
+#include <string>
+#include <utility>
+
+namespace {
+
+using boost::asio::ip::make_address;
+using std::chrono::milliseconds;
+
+/// Начало отсчета времени тестов
+const IpRateLimiter::Clock::time_point kStart = IpRateLimiter::Clock::now();
+
+}  // namespace
+
+/**
+ * @brief Адрес открывает burst подключений подряд, затем ждет пополнения
+ */
+TEST(IpRateLimiterTest, RefillsAfterBurst) {
+    IpRateLimiter limiter(10, 3, 64);
+    const auto address = make_address("10.0.0.1");
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_TRUE(limiter.Allow(address, kStart));
+    }
+    EXPECT_FALSE(limiter.Allow(address, kStart));
+
+    // 10 токенов в секунду: через 100 мс доступно одно подключение
+    EXPECT_TRUE(limiter.Allow(address, kStart + milliseconds(100)));
+    EXPECT_FALSE(limiter.Allow(address, kStart + milliseconds(100)));
+
+    // Корзина не наполняется выше burst
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_TRUE(limiter.Allow(address, kStart + milliseconds(10000)));
+    }
+    EXPECT_FALSE(limiter.Allow(address, kStart + milliseconds(10000)));
+}
+
+/**
+ * @brief Корзины адресов независимы, IPv4-mapped адрес делит корзину с IPv4
+ */
+TEST(IpRateLimiterTest, SeparatesAddresses) {
+    IpRateLimiter limiter(1, 1, 64);
+    EXPECT_TRUE(limiter.Allow(make_address("10.0.0.1"), kStart));
+    EXPECT_TRUE(limiter.Allow(make_address("10.0.0.2"), kStart));
+    EXPECT_TRUE(limiter.Allow(make_address("2001:db8::1"), kStart));
+    EXPECT_FALSE(limiter.Allow(make_address("::ffff:10.0.0.1"), kStart));
+    EXPECT_FALSE(limiter.Allow(make_address("2001:db8::1"), kStart));
+}
+
+/**
+ * @brief Нулевая частота отключает ограничение
+ */
+TEST(IpRateLimiterTest, ZeroRateIsUnlimited) {
+    IpRateLimiter limiter(0, 1, 8);
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(limiter.Allow(make_address("10.0.0.1"), kStart));
+    }
+}
+
+/**
+ * @brief Переполненная таблица вытесняет давно не использованные корзины
+ */
+TEST(IpRateLimiterTest, EvictsIdleBuckets) {
+    IpRateLimiter limiter(1, 1, IpRateLimiter::kProbeLimit);
+    const auto first = make_address("192.168.0.1");
+    EXPECT_TRUE(limiter.Allow(first, kStart));
+    EXPECT_FALSE(limiter.Allow(first, kStart));
+
+    // Адресов больше, чем ячеек: каждый новый вытесняет самый старый
+    for (int i = 0; i < 100; ++i) {
+        const auto address = make_address("10.0.0." + std::to_string(i + 1));
+        EXPECT_TRUE(limiter.Allow(address, kStart + milliseconds(i + 1)));
+    }
+    // Вытесненный адрес снова получает полную корзину, хотя его токен не пополнился
+    EXPECT_TRUE(limiter.Allow(first, kStart + milliseconds(200)));
+
+    // Недавний адрес остался в таблице и по-прежнему ограничен
+    EXPECT_FALSE(limiter.Allow(make_address("10.0.0.100"), kStart + milliseconds(200)));
+}
+
+/**
+ * @brief Места сессий ограничены и освобождаются вместе с AdmissionSlot
+ */
+TEST(AdmissionControllerTest, LimitsSessions) {
+    auto controller = std::make_shared<AdmissionController>(2, 0, 1, 8);
+    const auto address = make_address("10.0.0.1");
+
+    AdmissionSlot first;
+    AdmissionSlot second;
+    AdmissionSlot third;
+    EXPECT_EQ(controller->Admit(address, first), Admission::kAdmitted);
+    EXPECT_EQ(controller->Admit(address, second), Admission::kAdmitted);
+    EXPECT_EQ(controller->Admit(address, third), Admission::kSessionLimit);
+    EXPECT_EQ(controller->Active(), 2U);
+
+    // Перемещение не освобождает место, Reset - освобождает
+    AdmissionSlot moved(std::move(first));
+    EXPECT_EQ(controller->Active(), 2U);
+    moved.Reset();
+    EXPECT_EQ(controller->Active(), 1U);
+    moved.Reset();
+    EXPECT_EQ(controller->Active(), 1U);
+
+    {
+        AdmissionSlot scoped;
+        EXPECT_EQ(controller->Admit(address, scoped), Admission::kAdmitted);
+        EXPECT_EQ(controller->Active(), 2U);
+    }
+    EXPECT_EQ(controller->Active(), 1U);
+
+    // Присваивание освобождает прежнее место
+    second = AdmissionSlot();
+    EXPECT_EQ(controller->Active(), 0U);
+}
+
+/**
+ * @brief Исчерпавший лимит адрес получает kRateLimited и не занимает место
+ */
+TEST(AdmissionControllerTest, RejectsRateLimitedAddress) {
+    auto controller = std::make_shared<AdmissionController>(0, 1, 1, 8);
+    AdmissionSlot first;
+    AdmissionSlot second;
+    EXPECT_EQ(controller->Admit(make_address("10.0.0.1"), first), Admission::kAdmitted);
+    EXPECT_EQ(controller->Admit(make_address("10.0.0.1"), second), Admission::kRateLimited);
+    EXPECT_EQ(controller->Active(), 1U);
+}
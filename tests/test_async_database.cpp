@@ -0,0 +1,113 @@
+/**
+ * @file test_async_database.cpp
+ * @brief Unit-тесты асинхронного слоя PostgreSQL
+ *
+ * Проверяются:
+ * - Описания кодов ошибок AsyncDbError
+ * - Пустой результат запроса
+ * - Запрос к недоступному серверу завершается ошибкой, не блокируя io_context
+ * - Страница истории для MessageStore сообщает об ошибке DatabaseUnavailableError
+ * - Посещение не вставляется, пока не создан раздел месяца
+ *
+ * @date 2025
+ */
+
+#include "src/async_database.hpp"
+
+#include <boost/asio/io_context.hpp>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Тест с сервером, на порту которого никто не слушает
+ */
+class AsyncPostgresDatabaseTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        previous_ = GetLiveConfig().Load();
+        auto snapshot = std::make_shared<ConfigSnapshot>(*previous_);
+        snapshot->db_conn_string = "postgresql://127.0.0.1:1/none?connect_timeout=2";
+        GetLiveConfig().Publish(std::move(snapshot));
+    }
+
+    void TearDown() override {
+        GetLiveConfig().Publish(previous_);
+    }
+
+    boost::asio::io_context io_context_;                ///< Контекст теста
+    std::shared_ptr<const ConfigSnapshot> previous_;  ///< Снимок до теста
+};
+
+}  // namespace
+
+TEST(AsyncDbErrorTest, DescribesCodes) {
+    const auto ec = MakeErrorCode(AsyncDbError::kConnectionLost);
+    EXPECT_STREQ(ec.category().name(), "async_db");
+    EXPECT_EQ(ec.message(), "database connection lost");
+    EXPECT_EQ(MakeErrorCode(AsyncDbError::kQueryFailed).message(), "database query failed");
+}
+
+TEST(AsyncQueryResultTest, EmptyResultHasNoRows) {
+    const AsyncQueryResult result;
+    EXPECT_EQ(result.Rows(), 0);
+    EXPECT_EQ(result.Columns(), 0);
+    EXPECT_TRUE(result.IsNull(0, 0));
+    EXPECT_TRUE(result.Value(0, 0).empty());
+    EXPECT_TRUE(result.ErrorMessage().empty());
+}
+
+/**
+ * @brief Ошибка подключения доставляется обработчику, io_context не блокируется
+ */
+TEST_F(AsyncPostgresDatabaseTest, ReportsUnreachableServer) {
+    AsyncPostgresDatabase db(io_context_, 1);
+    bool completed = false;
+    db.AsyncExec("SELECT 1", {}, [&](boost::system::error_code ec, AsyncQueryResult result) {
+        EXPECT_EQ(ec, MakeErrorCode(AsyncDbError::kConnectionFailed));
+        EXPECT_EQ(result.Rows(), 0);
+        completed = true;
+    });
+    io_context_.run_for(std::chrono::seconds(10));
+    EXPECT_TRUE(completed);
+}
+
+/**
+ * @brief Ошибка чтения истории передается MessageStore как DatabaseUnavailableError
+ */
+TEST_F(AsyncPostgresDatabaseTest, ReadMessagesReportsUnavailableDatabase) {
+    auto db = std::make_shared<AsyncPostgresDatabase>(io_context_, 1);
+    IHistoryReader& reader = *db;
+    bool completed = false;
+    reader.ReadMessages(1, 100, 10, [&](std::exception_ptr error, std::vector<ChatMessage> page) {
+        ASSERT_TRUE(error);
+        EXPECT_THROW(std::rethrow_exception(error), DatabaseUnavailableError);
+        EXPECT_TRUE(page.empty());
+        completed = true;
+    });
+    io_context_.run_for(std::chrono::seconds(10));
+    EXPECT_TRUE(completed);
+}
+
+/**
+ * @brief Если раздел месяца не создан, посещение не вставляется, а ошибка
+ * доставляется обработчику
+ */
+TEST_F(AsyncPostgresDatabaseTest, MarkVisitWaitsForPartition) {
+    AsyncPostgresDatabase db(io_context_, 2);
+    int completed = 0;
+    for (int i = 0; i < 2; ++i) {
+        db.AsyncMarkVisit([&](boost::system::error_code ec) {
+            EXPECT_EQ(ec, MakeErrorCode(AsyncDbError::kConnectionFailed));
+            ++completed;
+        });
+    }
+    io_context_.run_for(std::chrono::seconds(10));
+    EXPECT_EQ(completed, 2);
+}
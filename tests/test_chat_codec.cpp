@@ -0,0 +1,172 @@
+/**
+ * @file test_chat_codec.cpp
+ * @brief Unit-тесты C ABI кодека протокола чата
+ *
+ * Проверяются:
+ * - Кадры построителя разбираются разборщиком, пришедшие по частям тоже
+ * - Сжатые нагрузки распаковываются при разборе
+ * - Нагрузки указывают в буферы кодека без копирования
+ * - Разбор нагрузок kMessage и kHistory в формате сервера
+ * - Ошибки разбора
+ *
+ * @date 2025
+ */
+
+#include "src/chat_codec.h"
+#include "src/chat_protocol.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace {
+
+/**
+ * @brief Строка по участку памяти кодека
+ */
+std::string_view View(ChatSlice slice) {
+    return {reinterpret_cast<const char*>(slice.data), slice.size};
+}
+
+/**
+ * @brief Дописывает кадр через место под нагрузку
+ */
+void Append(ChatWriter* writer, FrameType type, uint16_t channel, std::string_view payload) {
+    std::memcpy(chat_writer_prepare(writer, payload.size()), payload.data(), payload.size());
+    chat_writer_append(writer, static_cast<uint8_t>(type), channel, payload.size());
+}
+
+/**
+ * @brief Передает байты разборщику
+ */
+void Feed(ChatReader* reader, std::string_view data) {
+    std::memcpy(chat_reader_prepare(reader, data.size()), data.data(), data.size());
+    chat_reader_commit(reader, data.size());
+}
+
+}  // namespace
+
+/**
+ * @brief Пакет кадров, пришедший двумя частями, разбирается по порядку
+ */
+TEST(ChatCodecTest, RoundTripsFrames) {
+    ChatWriter* writer = chat_writer_create(0);
+    Append(writer, FrameType::kHello, 0, std::string_view("\x01" "alice", 6));
+    Append(writer, FrameType::kMessage, 513, "hello, world");
+    const std::string data(View(chat_writer_data(writer)));
+    chat_writer_destroy(writer);
+
+    ChatReader* reader = chat_reader_create(1024);
+    Feed(reader, std::string_view(data).substr(0, 16));
+    ChatFrame frame = chat_reader_next(reader);
+    ASSERT_EQ(frame.status, CHAT_FRAME_COMPLETE);
+    EXPECT_EQ(frame.type, static_cast<uint8_t>(FrameType::kHello));
+    EXPECT_EQ(View(frame.payload), std::string_view("\x01" "alice", 6));
+    EXPECT_EQ(chat_reader_next(reader).status, CHAT_FRAME_INCOMPLETE);
+
+    Feed(reader, std::string_view(data).substr(16));
+    frame = chat_reader_next(reader);
+    ASSERT_EQ(frame.status, CHAT_FRAME_COMPLETE);
+    EXPECT_EQ(frame.type, static_cast<uint8_t>(FrameType::kMessage));
+    EXPECT_EQ(frame.channel, 513);
+    EXPECT_EQ(View(frame.payload), "hello, world");
+    EXPECT_EQ(chat_reader_next(reader).status, CHAT_FRAME_INCOMPLETE);
+    chat_reader_destroy(reader);
+}
+
+/**
+ * @brief Нагрузка несжатого кадра указывает прямо в буфер разборщика
+ */
+TEST(ChatCodecTest, ParsesInPlace) {
+    FrameWriter writer;
+    writer.Append(FrameType::kPing, 1, "payload");
+
+    ChatReader* reader = chat_reader_create(1024);
+    uint8_t* buffer = chat_reader_prepare(reader, writer.Data().size());
+    std::memcpy(buffer, writer.Data().data(), writer.Data().size());
+    chat_reader_commit(reader, writer.Data().size());
+    const ChatFrame frame = chat_reader_next(reader);
+    ASSERT_EQ(frame.status, CHAT_FRAME_COMPLETE);
+    EXPECT_EQ(frame.payload.data, buffer + kFrameHeaderSize);
+    chat_reader_destroy(reader);
+}
+
+/**
+ * @brief Сжатая нагрузка распаковывается при разборе
+ */
+TEST(ChatCodecTest, InflatesCompressedFrames) {
+    const std::string text(4096, 'a');
+    ChatWriter* writer = chat_writer_create(64);
+    chat_writer_enable_compression(writer, 1);
+    Append(writer, FrameType::kMessage, 2, text);
+    const ChatSlice data = chat_writer_data(writer);
+    ASSERT_LT(data.size, text.size());
+
+    ChatReader* reader = chat_reader_create(8192);
+    Feed(reader, View(data));
+    const ChatFrame frame = chat_reader_next(reader);
+    ASSERT_EQ(frame.status, CHAT_FRAME_COMPLETE);
+    EXPECT_EQ(frame.flags, kFrameCompressed);
+    EXPECT_EQ(View(frame.payload), text);
+
+    chat_writer_clear(writer);
+    EXPECT_EQ(chat_writer_data(writer).size, 0U);
+    chat_writer_destroy(writer);
+    chat_reader_destroy(reader);
+}
+
+/**
+ * @brief Нагрузки сервера разбираются на имя, текст и поля истории
+ */
+TEST(ChatCodecTest, ParsesServerPayloads) {
+    const std::string message = std::string("\x03") + "bobhi there";
+    const ChatNamed named = chat_parse_named(
+        ChatSlice{reinterpret_cast<const uint8_t*>(message.data()), message.size()});
+    ASSERT_EQ(named.ok, 1);
+    EXPECT_EQ(View(named.name), "bob");
+    EXPECT_EQ(View(named.rest), "hi there");
+
+    const auto id = EncodeUint64(42);
+    const auto micros = EncodeUint64(1735689600000000ULL);
+    const std::string history = std::string(id.data(), id.size()) +
+                                std::string(micros.data(), micros.size()) + message;
+    const ChatHistoryEntry entry = chat_parse_history(
+        ChatSlice{reinterpret_cast<const uint8_t*>(history.data()), history.size()});
+    ASSERT_EQ(entry.ok, 1);
+    EXPECT_EQ(entry.id, 42U);
+    EXPECT_EQ(entry.micros, 1735689600000000ULL);
+    EXPECT_EQ(View(entry.author), "bob");
+    EXPECT_EQ(View(entry.text), "hi there");
+
+    const std::string truncated = "\x09" "bob";
+    EXPECT_EQ(
+        chat_parse_named(
+            ChatSlice{reinterpret_cast<const uint8_t*>(truncated.data()), truncated.size()})
+            .ok,
+        0);
+    EXPECT_EQ(chat_parse_history(ChatSlice{nullptr, 0}).ok, 0);
+}
+
+/**
+ * @brief Некорректные и слишком большие кадры
+ */
+TEST(ChatCodecTest, RejectsBadFrames) {
+    ChatReader* reader = chat_reader_create(4);
+    Feed(reader, std::string_view("\x00\x00\x00\x00\x63\x00\x00\x00", 8));
+    EXPECT_EQ(chat_reader_next(reader).status, CHAT_FRAME_BAD_FRAME);
+    chat_reader_destroy(reader);
+
+    reader = chat_reader_create(4);
+    Feed(reader, std::string_view("\x00\x00\x00\x10\x04\x00\x00\x00", 8));
+    EXPECT_EQ(chat_reader_next(reader).status, CHAT_FRAME_TOO_LARGE);
+    chat_reader_destroy(reader);
+
+    reader = chat_reader_create(64);
+    Feed(reader, std::string_view("\x00\x00\x00\x05\x03\x01\x00\x00garbl", 13));
+    EXPECT_EQ(chat_reader_next(reader).status, CHAT_FRAME_BAD_COMPRESSION);
+    chat_reader_destroy(reader);
+}
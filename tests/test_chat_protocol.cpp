@@ -0,0 +1,175 @@
+/**
+ * @file test_chat_protocol.cpp
+ * @brief Unit-тесты бинарного протокола чата
+ *
+ * Проверяются:
+ * - Разбор кадров, собранных FrameWriter, в том числе пакета из нескольких кадров
+ * - Неполные, слишком большие и некорректные кадры
+ * - Сжатие нагрузки и ее распаковка FrameInflater
+ *
+ * @date 2025
+ */
+
+#include "src/chat_protocol.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Несколько кадров одного пакета разбираются по порядку без копирования
+ */
+TEST(ChatProtocolTest, ParsesBatchedFrames) {
+    FrameWriter writer;
+    writer.Append(FrameType::kHello, 0, std::string_view("\x01", 1), "alice");
+    writer.Append(FrameType::kMessage, 513, "hello, ", "world");
+    writer.Append(FrameType::kPing, 7);
+    ASSERT_EQ(writer.Frames(), 3U);
+
+    std::string_view data = writer.Data();
+    Frame frame;
+    ASSERT_EQ(ParseFrame(data, 1024, frame), FrameStatus::kComplete);
+    EXPECT_EQ(frame.type, FrameType::kHello);
+    EXPECT_EQ(frame.payload, std::string_view("\x01" "alice", 6));
+    EXPECT_EQ(frame.payload.data(), data.data() + kFrameHeaderSize);
+    data.remove_prefix(frame.size);
+
+    ASSERT_EQ(ParseFrame(data, 1024, frame), FrameStatus::kComplete);
+    EXPECT_EQ(frame.type, FrameType::kMessage);
+    EXPECT_EQ(frame.channel, 513);
+    EXPECT_EQ(frame.flags, 0);
+    EXPECT_EQ(frame.payload, "hello, world");
+    data.remove_prefix(frame.size);
+
+    ASSERT_EQ(ParseFrame(data, 1024, frame), FrameStatus::kComplete);
+    EXPECT_EQ(frame.type, FrameType::kPing);
+    EXPECT_TRUE(frame.payload.empty());
+    data.remove_prefix(frame.size);
+    EXPECT_TRUE(data.empty());
+
+    writer.Clear();
+    EXPECT_TRUE(writer.Empty());
+    EXPECT_TRUE(writer.Data().empty());
+}
+
+/**
+ * @brief Кадр, пришедший не полностью, требует дочитывания
+ */
+TEST(ChatProtocolTest, ReportsIncompleteFrames) {
+    FrameWriter writer;
+    writer.Append(FrameType::kMessage, 1, "payload");
+    const std::string_view data = writer.Data();
+
+    Frame frame;
+    for (std::size_t size = 0; size < data.size(); ++size) {
+        EXPECT_EQ(ParseFrame(data.substr(0, size), 1024, frame), FrameStatus::kIncomplete)
+            << "size " << size;
+    }
+    EXPECT_EQ(ParseFrame(data, 1024, frame), FrameStatus::kComplete);
+}
+
+/**
+ * @brief Длинный кадр, неизвестный тип и зарезервированные флаги отклоняются
+ */
+TEST(ChatProtocolTest, RejectsInvalidFrames) {
+    FrameWriter writer;
+    writer.Append(FrameType::kMessage, 1, std::string(100, 'x'));
+    Frame frame;
+    // Размер проверяется по заголовку, до прихода нагрузки
+    EXPECT_EQ(ParseFrame(writer.Data().substr(0, kFrameHeaderSize), 99, frame),
+              FrameStatus::kTooLarge);
+
+    std::string bad_type(writer.Data());
+    bad_type[4] = 42;
+    EXPECT_EQ(ParseFrame(bad_type, 1024, frame), FrameStatus::kBadFrame);
+
+    std::string bad_flags(writer.Data());
+    bad_flags[5] = 0x02;
+    EXPECT_EQ(ParseFrame(bad_flags, 1024, frame), FrameStatus::kBadFrame);
+}
+
+/**
+ * @brief Большая сжимаемая нагрузка сжимается и восстанавливается без потерь
+ */
+TEST(ChatProtocolTest, CompressesLargePayloads) {
+    FrameWriter writer(64);
+    writer.EnableCompression(true);
+    std::string text;
+    for (int i = 0; i < 100; ++i) {
+        text += "chat message " + std::to_string(i % 10) + ' ';
+    }
+    writer.Append(FrameType::kMessage, 3, std::string_view("\x05", 1), "alice", text);
+    writer.Append(FrameType::kMessage, 3, "short");
+
+    std::string_view data = writer.Data();
+    Frame frame;
+    ASSERT_EQ(ParseFrame(data, 1 << 16, frame), FrameStatus::kComplete);
+    EXPECT_EQ(frame.flags, kFrameCompressed);
+    EXPECT_LT(frame.payload.size(), text.size() / 4);
+
+    FrameInflater inflater;
+    std::string_view payload;
+    ASSERT_TRUE(inflater.Inflate(frame.payload, 1 << 16, payload));
+    EXPECT_EQ(payload, "\x05" "alice" + text);
+    EXPECT_FALSE(inflater.Inflate(frame.payload, text.size(), payload));
+    data.remove_prefix(frame.size);
+
+    // Нагрузка короче порога уходит как есть
+    ASSERT_EQ(ParseFrame(data, 1 << 16, frame), FrameStatus::kComplete);
+    EXPECT_EQ(frame.flags, 0);
+    EXPECT_EQ(frame.payload, "short");
+}
+
+/**
+ * @brief Несжимаемая нагрузка и нагрузка без согласованного сжатия не сжимаются
+ */
+TEST(ChatProtocolTest, SkipsUselessCompression) {
+    std::mt19937 random(42);
+    std::string noise(4096, '\0');
+    for (char& c : noise) {
+        c = static_cast<char>(random());
+    }
+
+    FrameWriter writer(64);
+    writer.Append(FrameType::kMessage, 0, std::string(1000, 'a'));
+    writer.EnableCompression(true);
+    writer.Append(FrameType::kMessage, 0, noise);
+
+    std::string_view data = writer.Data();
+    Frame frame;
+    ASSERT_EQ(ParseFrame(data, 1 << 16, frame), FrameStatus::kComplete);
+    EXPECT_EQ(frame.flags, 0);
+    data.remove_prefix(frame.size);
+    ASSERT_EQ(ParseFrame(data, 1 << 16, frame), FrameStatus::kComplete);
+    EXPECT_EQ(frame.flags, 0);
+    EXPECT_EQ(frame.payload, noise);
+}
+
+/**
+ * @brief Поврежденная сжатая нагрузка отклоняется
+ */
+TEST(ChatProtocolTest, RejectsCorruptCompressedPayload) {
+    FrameWriter writer(16);
+    writer.EnableCompression(true);
+    writer.Append(FrameType::kMessage, 0, std::string(512, 'z'));
+    Frame frame;
+    ASSERT_EQ(ParseFrame(writer.Data(), 1024, frame), FrameStatus::kComplete);
+    ASSERT_EQ(frame.flags, kFrameCompressed);
+
+    FrameInflater inflater;
+    std::string_view payload;
+    std::string truncated(frame.payload.substr(0, frame.payload.size() - 2));
+    EXPECT_FALSE(inflater.Inflate(truncated, 1024, payload));
+    EXPECT_FALSE(inflater.Inflate("abc", 1024, payload));
+    std::string garbage(frame.payload);
+    garbage[6] = static_cast<char>(garbage[6] ^ 0x5a);
+    EXPECT_FALSE(inflater.Inflate(garbage, 1024, payload));
+
+    // После ошибки распаковщик остается пригодным
+    ASSERT_TRUE(inflater.Inflate(frame.payload, 1024, payload));
+    EXPECT_EQ(payload, std::string(512, 'z'));
+}
@@ -0,0 +1,164 @@
+/**
+ * @file test_config.cpp
+ * @brief Unit-тесты интерполяции и снимков конфигурации
+ *
+ * Проверяются:
+ * - Разрешение ссылок ${variable}, в том числе цепочек, неизвестных
+ *   ссылок и циклов
+ * - Разбор значений по умолчанию в типизированный снимок
+ * - Публикация нового снимка и его видимость из кеша потока
+ * - Чтение снимков одновременно с публикацией новых
+ *
+ * @date 2025
+ */
+
+#include "src/config.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using Values = std::unordered_map<std::string, std::string>;
+
+/// Снимок со значениями по умолчанию и заданным таймаутом keep-alive
+std::shared_ptr<const ConfigSnapshot> SnapshotWithTimeout(int timeout_ms) {
+    auto snapshot = std::make_shared<ConfigSnapshot>(*ConfigSnapshot::FromConfig(GetConfig()));
+    snapshot->keep_alive_timeout = std::chrono::milliseconds(timeout_ms);
+    return snapshot;
+}
+
+}  // namespace
+
+/**
+ * @brief Ссылки разрешаются через цепочку, значения файла важнее окружения
+ */
+TEST(ResolveNestedTest, ResolvesChains) {
+    const Values env{{"DB_HOST", "env-host"}, {"DB_PORT", "5432"}};
+    const Values file{
+        {"DB_HOST", "db"},
+        {"DB_URL", "${DB_HOST}:${DB_PORT}"},
+        {"DB_CONN_STRING", "postgresql://${DB_URL}/${DB_URL}"},
+    };
+    const Values resolved = ConfigManager::ResolveNested(env, file);
+    EXPECT_EQ(resolved.at("DB_URL"), "db:5432");
+    EXPECT_EQ(resolved.at("DB_CONN_STRING"), "postgresql://db:5432/db:5432");
+    EXPECT_EQ(resolved.size(), 4U);
+}
+
+/**
+ * @brief Неизвестные, пустые и незакрытые ссылки остаются в значении как есть
+ */
+TEST(ResolveNestedTest, KeepsUnknownReferences) {
+    const Values file{
+        {"A", "x"},
+        {"B", "${MISSING}-${A}-${}-${A"},
+        {"C", "$A ${A}}"},
+    };
+    const Values resolved = ConfigManager::ResolveNested({}, file);
+    EXPECT_EQ(resolved.at("B"), "${MISSING}-x-${}-${A");
+    EXPECT_EQ(resolved.at("C"), "$A x}");
+}
+
+/**
+ * @brief Параметры цикла сохраняют исходные значения, остальные разрешаются
+ */
+TEST(ResolveNestedTest, StopsOnCycles) {
+    const Values file{
+        {"A", "a${B}"},
+        {"B", "b${A}"},
+        {"SELF", "${SELF}"},
+        {"C", "c${D}"},
+        {"D", "d"},
+    };
+    const Values resolved = ConfigManager::ResolveNested({}, file);
+    EXPECT_EQ(resolved.at("A"), "a${B}");
+    EXPECT_EQ(resolved.at("B"), "b${A}");
+    EXPECT_EQ(resolved.at("SELF"), "${SELF}");
+    EXPECT_EQ(resolved.at("C"), "cd");
+}
+
+/**
+ * @brief Длинная цепочка ссылок разрешается без рекурсии
+ */
+TEST(ResolveNestedTest, ResolvesLongChain) {
+    constexpr int kLength = 100000;
+    Values file;
+    file["V0"] = "end";
+    for (int i = 1; i < kLength; ++i) {
+        file["V" + std::to_string(i)] = "${V" + std::to_string(i - 1) + "}";
+    }
+    const Values resolved = ConfigManager::ResolveNested({}, file);
+    EXPECT_EQ(resolved.at("V" + std::to_string(kLength - 1)), "end");
+}
+
+/**
+ * @brief Снимок содержит разобранные значения по умолчанию
+ */
+TEST(ConfigSnapshotTest, ParsesDefaults) {
+    const auto snapshot = ConfigSnapshot::FromConfig(GetConfig());
+    EXPECT_EQ(snapshot->log_level, "INFO");
+    EXPECT_EQ(snapshot->keep_alive_timeout.count(), GetConfig().GetKeepAliveTimeoutMs());
+    EXPECT_EQ(snapshot->chat_max_frame_size, 65536U);
+    EXPECT_FALSE(snapshot->chat_drop_slow);
+    EXPECT_EQ(snapshot->db_conn_string, GetConfig().GetDbConnString());
+}
+
+/**
+ * @brief Опубликованный снимок виден следующему чтению, старый остается жив
+ */
+TEST(ConfigSnapshotTest, PublishReplacesSnapshot) {
+    LiveConfig live(SnapshotWithTimeout(100));
+    const auto held = live.Load();
+    EXPECT_EQ(live.Get().keep_alive_timeout.count(), 100);
+
+    live.Publish(SnapshotWithTimeout(200));
+    EXPECT_EQ(live.Get().keep_alive_timeout.count(), 200);
+    EXPECT_EQ(held->keep_alive_timeout.count(), 100);
+
+    // Кеш потока не путает снимки разных экземпляров
+    LiveConfig other(SnapshotWithTimeout(300));
+    EXPECT_EQ(other.Get().keep_alive_timeout.count(), 300);
+    EXPECT_EQ(live.Get().keep_alive_timeout.count(), 200);
+}
+
+/**
+ * @brief Читатели видят только целые снимки, пока публикуются новые
+ */
+TEST(ConfigSnapshotTest, ConcurrentReadersSeeWholeSnapshots) {
+    LiveConfig live(SnapshotWithTimeout(0));
+    std::atomic<bool> stop{false};
+    std::atomic<bool> torn{false};
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&] {
+            int last = 0;
+            while (!stop.load()) {
+                const ConfigSnapshot& snapshot = live.Get();
+                const auto timeout = static_cast<int>(snapshot.keep_alive_timeout.count());
+                if (timeout < last || snapshot.log_level != "INFO") {
+                    torn = true;
+                }
+                last = timeout;
+            }
+        });
+    }
+    for (int i = 1; i <= 1000; ++i) {
+        live.Publish(SnapshotWithTimeout(i));
+    }
+    stop = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_FALSE(torn);
+    EXPECT_EQ(live.Get().keep_alive_timeout.count(), 1000);
+}
@@ -0,0 +1,239 @@
+/**
+ * @file test_connection_pool.cpp
+ * @brief Unit-тесты пула соединений
+ *
+ * Проверяются:
+ * - Неблокирующее получение соединения из исчерпанного пула
+ * - Истечение времени ожидания в Acquire(timeout)
+ * - Пробуждение ожидающего потока при возврате соединения
+ * - Отсутствие потерь и дублирования соединений при конкурентном доступе
+ * - Ленивое создание, проверка при возврате, закрытие простаивающих
+ *   соединений и пауза после неудачного подключения
+ *
+ * @date 2025
+ */
+
+#include "src/connection_pool.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Соединение-заглушка с флагом использования
+ */
+struct FakeConnection {
+    std::atomic<bool> in_use{false};  ///< Соединение сейчас выдано потоку
+    bool broken = false;              ///< Соединение "разорвано"
+};
+
+/**
+ * @brief Параметры эластичного пула с короткими интервалами для тестов
+ */
+ConnectionPoolOptions FastOptions(uint64_t min_size, uint64_t max_size) {
+    ConnectionPoolOptions options;
+    options.min_size = min_size;
+    options.max_size = max_size;
+    options.idle_timeout = std::chrono::milliseconds(20);
+    options.maintenance_interval = std::chrono::milliseconds(5);
+    options.initial_backoff = std::chrono::milliseconds(50);
+    options.max_backoff = std::chrono::milliseconds(200);
+    return options;
+}
+
+/**
+ * @brief Ждет выполнения условия не дольше секунды
+ */
+template <typename Predicate>
+bool WaitFor(Predicate predicate) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+}  // namespace
+
+/**
+ * @brief TryAcquire не ждет и возвращает nullopt на исчерпанном пуле
+ */
+TEST(ConnectionPoolTest, TryAcquireFailsWhenExhausted) {
+    BasicConnectionPool<FakeConnection> pool(1);
+    {
+        auto first = pool.TryAcquire();
+        ASSERT_TRUE(first.has_value());
+        EXPECT_FALSE(pool.TryAcquire().has_value());
+    }
+    EXPECT_TRUE(pool.TryAcquire().has_value());
+}
+
+/**
+ * @brief Acquire(timeout) выбрасывает ConnectionPoolTimeout и учитывает его в метриках
+ */
+TEST(ConnectionPoolTest, AcquireTimesOut) {
+    BasicConnectionPool<FakeConnection> pool(1);
+    auto held = pool.Acquire(std::chrono::milliseconds(10));
+    const uint64_t timeouts = GetMetrics().Value(Counter::kPoolTimeouts);
+
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_THROW(pool.Acquire(std::chrono::milliseconds(20)), ConnectionPoolTimeout);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+    EXPECT_EQ(GetMetrics().Value(Counter::kPoolTimeouts), timeouts + 1);
+}
+
+/**
+ * @brief Возврат соединения пробуждает поток, ожидающий в Acquire()
+ */
+TEST(ConnectionPoolTest, ReleaseWakesWaiter) {
+    BasicConnectionPool<FakeConnection> pool(1);
+    std::atomic<bool> acquired{false};
+    std::optional<std::thread> waiter;
+    {
+        auto held = pool.Acquire(std::chrono::milliseconds(10));
+        waiter.emplace([&pool, &acquired] {
+            auto connection = pool.Acquire(std::chrono::seconds(5));
+            acquired = true;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        EXPECT_FALSE(acquired.load());
+    }
+    waiter->join();
+    EXPECT_TRUE(acquired.load());
+}
+
+/**
+ * @brief Одно соединение никогда не выдается двум потокам одновременно
+ */
+TEST(ConnectionPoolTest, ConcurrentAcquireRelease) {
+    constexpr int kThreads = 8;
+    constexpr int kIterations = 20000;
+    BasicConnectionPool<FakeConnection> pool(3);
+    std::atomic<int> conflicts{0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&pool, &conflicts] {
+            for (int i = 0; i < kIterations; ++i) {
+                auto connection = pool.Acquire(std::chrono::seconds(5));
+                if (connection->in_use.exchange(true)) {
+                    ++conflicts;
+                }
+                connection->in_use = false;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(conflicts.load(), 0);
+    EXPECT_EQ(GetMetrics().Value(Gauge::kPoolConnectionsInUse), 0);
+}
+
+/**
+ * @brief Соединения открываются по требованию, а не в конструкторе
+ */
+TEST(ElasticConnectionPoolTest, OpensConnectionsLazily) {
+    std::atomic<int> opened{0};
+    BasicConnectionPool<FakeConnection> pool(FastOptions(0, 4), [&opened] {
+        ++opened;
+        return std::make_unique<FakeConnection>();
+    });
+    EXPECT_EQ(pool.Size(), 0U);
+
+    {
+        auto first = pool.Acquire(std::chrono::milliseconds(10));
+        auto second = pool.Acquire(std::chrono::milliseconds(10));
+        EXPECT_EQ(opened.load(), 2);
+    }
+    // Возвращенные соединения переиспользуются
+    auto again = pool.Acquire(std::chrono::milliseconds(10));
+    EXPECT_EQ(opened.load(), 2);
+    EXPECT_EQ(pool.Size(), 2U);
+}
+
+/**
+ * @brief Поток обслуживания открывает min_size соединений и закрывает лишние простаивающие
+ */
+TEST(ElasticConnectionPoolTest, KeepsMinimumAndReapsIdle) {
+    BasicConnectionPool<FakeConnection> pool(
+        FastOptions(2, 4), [] { return std::make_unique<FakeConnection>(); });
+    EXPECT_TRUE(WaitFor([&pool] { return pool.Size() == 2; }));
+
+    {
+        auto a = pool.Acquire(std::chrono::milliseconds(10));
+        auto b = pool.Acquire(std::chrono::milliseconds(10));
+        auto c = pool.Acquire(std::chrono::milliseconds(10));
+        auto d = pool.Acquire(std::chrono::milliseconds(10));
+        EXPECT_EQ(pool.Size(), 4U);
+    }
+    EXPECT_TRUE(WaitFor([&pool] { return pool.Size() == 2; }));
+}
+
+/**
+ * @brief Соединение, не прошедшее проверку при возврате, закрывается и заменяется новым
+ */
+TEST(ElasticConnectionPoolTest, DropsBrokenConnections) {
+    std::atomic<int> opened{0};
+    BasicConnectionPool<FakeConnection> pool(
+        FastOptions(0, 1),
+        [&opened] {
+            ++opened;
+            return std::make_unique<FakeConnection>();
+        },
+        [](FakeConnection& conn) { return !conn.broken; });
+
+    {
+        auto connection = pool.Acquire(std::chrono::milliseconds(10));
+        connection->broken = true;
+    }
+    EXPECT_EQ(pool.Size(), 0U);
+
+    auto replacement = pool.Acquire(std::chrono::milliseconds(10));
+    EXPECT_FALSE(replacement->broken);
+    EXPECT_EQ(opened.load(), 2);
+}
+
+/**
+ * @brief После неудачного подключения запросы сразу отклоняются до конца паузы,
+ *        а затем пул восстанавливается
+ */
+TEST(ElasticConnectionPoolTest, BacksOffAfterConnectFailure) {
+    std::atomic<bool> database_up{false};
+    std::atomic<int> attempts{0};
+    BasicConnectionPool<FakeConnection> pool(FastOptions(0, 2), [&] {
+        ++attempts;
+        if (!database_up) {
+            throw std::runtime_error("connection refused");
+        }
+        return std::make_unique<FakeConnection>();
+    });
+
+    EXPECT_THROW(pool.Acquire(std::chrono::milliseconds(10)), std::runtime_error);
+    EXPECT_THROW(pool.Acquire(std::chrono::milliseconds(10)), ConnectionPoolUnavailable);
+    EXPECT_EQ(attempts.load(), 1);
+
+    database_up = true;
+    EXPECT_TRUE(WaitFor([&pool] {
+        try {
+            auto connection = pool.Acquire(std::chrono::milliseconds(10));
+            return true;
+        } catch (const ConnectionPoolUnavailable&) {
+            return false;
+        }
+    }));
+    EXPECT_EQ(pool.Size(), 1U);
+}
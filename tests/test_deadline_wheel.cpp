@@ -0,0 +1,124 @@
+/**
+ * @file test_deadline_wheel.cpp
+ * @brief Unit-тесты общего колеса сроков сессий
+ *
+ * Проверяются:
+ * - Срабатывание OnDeadline() после срока и не раньше
+ * - Продление и снятие срока без обращения к колесу
+ * - Уничтоженный объект не вызывается и не держит io_context::run()
+ *
+ * @date 2025
+ */
+
+#include "src/deadline_wheel.hpp"
+
+#include <gtest/gtest.h>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+
+namespace {
+
+using std::chrono::milliseconds;
+
+/**
+ * @brief Объект со сроком, считающий срабатывания
+ */
+class CountingTarget : public DeadlineTarget,
+                       public std::enable_shared_from_this<CountingTarget> {
+   public:
+    explicit CountingTarget(boost::asio::io_context& context) : context_(context) {
+    }
+
+    /// Устанавливает срок через timeout
+    void Arm(milliseconds timeout) {
+        ArmDeadline(context_.get_executor(), timeout);
+    }
+
+    /// Снимает срок
+    void Disarm() {
+        DisarmDeadline();
+    }
+
+    std::atomic<int> fired{0};                   ///< Срабатываний OnDeadline()
+    DeadlineTarget::Clock::time_point fired_at;  ///< Момент последнего срабатывания
+
+   private:
+    void OnDeadline() override {
+        fired_at = DeadlineTarget::Clock::now();
+        ++fired;
+    }
+
+    std::weak_ptr<DeadlineTarget> DeadlineOwner() override {
+        return weak_from_this();
+    }
+
+    boost::asio::io_context& context_;  ///< Контекст колеса
+};
+
+/// Выполняет action через delay на контексте
+void After(boost::asio::io_context& context, milliseconds delay, std::function<void()> action) {
+    auto timer = std::make_shared<boost::asio::steady_timer>(context, delay);
+    timer->async_wait([timer, action = std::move(action)](boost::system::error_code) { action(); });
+}
+
+}  // namespace
+
+/**
+ * @brief Срок срабатывает один раз, не раньше заданного, и колесо останавливается
+ */
+TEST(DeadlineWheelTest, FiresOnceAfterDeadline) {
+    boost::asio::io_context context;
+    auto target = std::make_shared<CountingTarget>(context);
+    const auto start = DeadlineTarget::Clock::now();
+    target->Arm(milliseconds(120));
+    context.run();  // Возвращается, когда в колесе не осталось таймеров
+
+    EXPECT_EQ(target->fired, 1);
+    EXPECT_GE(target->fired_at - start, milliseconds(120));
+    EXPECT_LE(target->fired_at - start, milliseconds(120) + 4 * DeadlineWheel::kTick);
+    EXPECT_EQ(boost::asio::use_service<DeadlineWheel>(context).Size(), 0U);
+}
+
+/**
+ * @brief Продленный срок срабатывает по последнему значению, снятый - не срабатывает
+ */
+TEST(DeadlineWheelTest, ExtendsAndDisarms) {
+    boost::asio::io_context context;
+    auto extended = std::make_shared<CountingTarget>(context);
+    auto disarmed = std::make_shared<CountingTarget>(context);
+    const auto start = DeadlineTarget::Clock::now();
+    extended->Arm(milliseconds(100));
+    disarmed->Arm(milliseconds(100));
+    After(context, milliseconds(60), [&] {
+        extended->Arm(milliseconds(200));
+        disarmed->Disarm();
+    });
+    context.run();
+
+    EXPECT_EQ(extended->fired, 1);
+    EXPECT_GE(extended->fired_at - start, milliseconds(260));
+    EXPECT_EQ(disarmed->fired, 0);
+}
+
+/**
+ * @brief Уничтоженный объект не вызывается, а колесо отпускает io_context
+ */
+TEST(DeadlineWheelTest, ForgetsDestroyedTargets) {
+    boost::asio::io_context context;
+    auto target = std::make_shared<CountingTarget>(context);
+    std::weak_ptr<CountingTarget> weak = target;
+    target->Arm(milliseconds(60000));
+    After(context, milliseconds(20), [&] { target.reset(); });
+
+    const auto start = DeadlineTarget::Clock::now();
+    context.run();
+    EXPECT_TRUE(weak.expired());
+    EXPECT_LT(DeadlineTarget::Clock::now() - start, milliseconds(1000));
+}
@@ -0,0 +1,162 @@
+/**
+ * @file test_http_parser.cpp
+ * @brief Unit-тесты инкрементального разборщика HTTP запросов
+ *
+ * Проверяются:
+ * - Разбор строки запроса и заголовков в string_view
+ * - Продолжение разбора при данных, приходящих частями
+ * - Конвейерные запросы в одном буфере
+ * - Обработка синтаксических ошибок и лимита заголовков
+ *
+ * @date 2025
+ */
+
+#include "src/http_parser.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+
+namespace {
+
+constexpr std::string_view kSimpleRequest =
+    "GET /index.html?x=1 HTTP/1.1\r\n"
+    "Host: localhost:8000\r\n"
+    "Connection:  keep-alive \r\n"
+    "\r\n";
+
+}  // namespace
+
+/**
+ * @brief Полный запрос разбирается за один вызов
+ */
+TEST(HttpRequestParserTest, ParsesCompleteRequest) {
+    HttpRequestParser parser;
+    ASSERT_EQ(parser.Parse(kSimpleRequest), HttpRequestParser::Status::kComplete);
+    EXPECT_EQ(parser.Consumed(), kSimpleRequest.size());
+
+    const HttpRequest request = parser.Request(kSimpleRequest);
+    EXPECT_EQ(request.method, "GET");
+    EXPECT_EQ(request.target, "/index.html?x=1");
+    EXPECT_EQ(request.Path(), "/index.html");
+    EXPECT_EQ(request.Query(), "x=1");
+    EXPECT_EQ(request.version, "HTTP/1.1");
+    ASSERT_EQ(request.header_count, 2U);
+    EXPECT_EQ(request.headers[0].name, "Host");
+    EXPECT_EQ(request.headers[0].value, "localhost:8000");
+    EXPECT_EQ(request.Header("connection"), "keep-alive");
+    EXPECT_TRUE(request.KeepAlive());
+}
+
+/**
+ * @brief Параметры query-строки ищутся по имени
+ */
+TEST(HttpRequestParserTest, FindsQueryParams) {
+    constexpr std::string_view kQuery = "by=hour&from=10&flag&to=20&by=day";
+    EXPECT_EQ(HttpRequest::QueryParam(kQuery, "by"), "hour");
+    EXPECT_EQ(HttpRequest::QueryParam(kQuery, "to"), "20");
+    EXPECT_EQ(HttpRequest::QueryParam(kQuery, "flag"), "");
+    EXPECT_EQ(HttpRequest::QueryParam(kQuery, "fro"), "");
+    EXPECT_EQ(HttpRequest::QueryParam("", "by"), "");
+}
+
+/**
+ * @brief Запрос, пришедший по одному байту, разбирается так же, как целый
+ */
+TEST(HttpRequestParserTest, ResumesOnPartialData) {
+    HttpRequestParser parser;
+    for (std::size_t size = 1; size < kSimpleRequest.size(); ++size) {
+        ASSERT_EQ(parser.Parse(kSimpleRequest.substr(0, size)),
+                  HttpRequestParser::Status::kIncomplete)
+            << "size " << size;
+    }
+    ASSERT_EQ(parser.Parse(kSimpleRequest), HttpRequestParser::Status::kComplete);
+    EXPECT_EQ(parser.Request(kSimpleRequest).Header("Host"), "localhost:8000");
+}
+
+/**
+ * @brief Второй конвейерный запрос остается за пределами Consumed()
+ */
+TEST(HttpRequestParserTest, StopsAtFirstPipelinedRequest) {
+    const std::string data = std::string(kSimpleRequest) + "GET /second HTTP/1.0\n\n";
+
+    HttpRequestParser parser;
+    ASSERT_EQ(parser.Parse(data), HttpRequestParser::Status::kComplete);
+    ASSERT_EQ(parser.Consumed(), kSimpleRequest.size());
+
+    const std::string_view rest = std::string_view(data).substr(parser.Consumed());
+    parser.Reset();
+    ASSERT_EQ(parser.Parse(rest), HttpRequestParser::Status::kComplete);
+    const HttpRequest second = parser.Request(rest);
+    EXPECT_EQ(second.target, "/second");
+    EXPECT_EQ(second.header_count, 0U);
+    EXPECT_FALSE(second.KeepAlive());
+}
+
+/**
+ * @brief Заголовки тела и Connection: close учитываются
+ */
+TEST(HttpRequestParserTest, ReportsBodyAndConnectionClose) {
+    constexpr std::string_view kData =
+        "POST / HTTP/1.1\r\nContent-Length: 42\r\nConnection: Close\r\n\r\n";
+    HttpRequestParser parser;
+    ASSERT_EQ(parser.Parse(kData), HttpRequestParser::Status::kComplete);
+    const HttpRequest request = parser.Request(kData);
+    EXPECT_EQ(request.ContentLength(), 42U);
+    EXPECT_FALSE(request.HasTransferEncoding());
+    EXPECT_FALSE(request.KeepAlive());
+}
+
+/**
+ * @brief Синтаксические ошибки дают kBadRequest
+ */
+TEST(HttpRequestParserTest, RejectsMalformedRequests) {
+    for (const std::string_view data : {
+             std::string_view("GET\r\n\r\n"),
+             std::string_view(" / HTTP/1.1\r\n\r\n"),
+             std::string_view("GET / HTTP/1.1\r\nBad Header: x\r\n\r\n"),
+             std::string_view("GET / HTTP/1.1\rX"),
+         }) {
+        HttpRequestParser parser;
+        EXPECT_EQ(parser.Parse(data), HttpRequestParser::Status::kBadRequest) << data;
+    }
+}
+
+/**
+ * @brief Некорректный или противоречивый Content-Length дает kBadRequest
+ */
+TEST(HttpRequestParserTest, RejectsInvalidContentLength) {
+    for (const std::string_view data : {
+             std::string_view("POST / HTTP/1.1\r\nContent-Length: abc\r\n\r\n"),
+             std::string_view("POST / HTTP/1.1\r\nContent-Length: 12abc\r\n\r\n"),
+             std::string_view("POST / HTTP/1.1\r\nContent-Length: -1\r\n\r\n"),
+             std::string_view("POST / HTTP/1.1\r\nContent-Length: +5\r\n\r\n"),
+             std::string_view("POST / HTTP/1.1\r\nContent-Length:\r\n\r\n"),
+             std::string_view("POST / HTTP/1.1\r\nContent-Length: 99999999999999999999\r\n\r\n"),
+             std::string_view("POST / HTTP/1.1\r\nContent-Length: 5\r\ncontent-length: 6\r\n\r\n"),
+         }) {
+        HttpRequestParser parser;
+        EXPECT_EQ(parser.Parse(data), HttpRequestParser::Status::kBadRequest) << data;
+    }
+
+    constexpr std::string_view kRepeated =
+        "POST / HTTP/1.1\r\nContent-Length: 7\r\nContent-Length: 7\r\n\r\n";
+    HttpRequestParser parser;
+    ASSERT_EQ(parser.Parse(kRepeated), HttpRequestParser::Status::kComplete);
+    EXPECT_EQ(parser.Request(kRepeated).ContentLength(), 7U);
+}
+
+/**
+ * @brief Превышение лимита заголовков дает kHeadersTooLarge
+ */
+TEST(HttpRequestParserTest, LimitsHeaderCount) {
+    std::string data = "GET / HTTP/1.1\r\n";
+    for (std::size_t i = 0; i <= HttpRequest::kMaxHeaders; ++i) {
+        data += "X-Header-" + std::to_string(i) + ": value\r\n";
+    }
+    data += "\r\n";
+
+    HttpRequestParser parser;
+    EXPECT_EQ(parser.Parse(data), HttpRequestParser::Status::kHeadersTooLarge);
+}
@@ -0,0 +1,163 @@
+/**
+ * @file test_http_response.cpp
+ * @brief Unit-тесты построителя HTTP ответов
+ *
+ * Проверяются:
+ * - Сборка статусной строки, Content-Length, Connection и тела
+ * - Сброс состояния при повторном Start()
+ * - Тело на границе лимитов фрагментов и чисел
+ * - Переполнение тела: assert в отладочной сборке, ответ 500 при NDEBUG
+ *
+ * Файл собирается дважды: test_http_response (с assert) и
+ * test_http_response_ndebug (-DNDEBUG) для проверки запасного ответа.
+ *
+ * @date 2025
+ */
+
+#include "src/http_response.hpp"
+
+#include <boost/asio/buffer.hpp>
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace {
+
+/**
+ * @brief Склеивает буферы ответа в строку в порядке отправки
+ */
+std::string Join(const HttpResponseBuilder::Buffers& buffers) {
+    std::string result;
+    for (const auto& buffer : buffers) {
+        result.append(static_cast<const char*>(buffer.data()), buffer.size());
+    }
+    return result;
+}
+
+constexpr std::string_view kInternalError =
+    "HTTP/1.1 500 Internal Server Error\r\n"
+    "Content-Type: text/plain\r\n"
+    "Content-Length: 0\r\n"
+    "Connection: close\r\n"
+    "\r\n";
+
+}  // namespace
+
+TEST(HttpResponseBuilderTest, BuildsResponseWithBody) {
+    HttpResponseBuilder builder;
+    builder.Start(HttpResponseBuilder::kHeadOkHtml);
+    builder.AppendBody("Visits: ");
+    builder.AppendBody(uint64_t{42});
+    builder.SetKeepAlive(true);
+
+    EXPECT_FALSE(builder.Overflowed());
+    EXPECT_EQ(Join(builder.Finish()),
+              "HTTP/1.1 200 OK\r\n"
+              "Content-Type: text/html\r\n"
+              "Content-Length: 10\r\n"
+              "Connection: keep-alive\r\n"
+              "\r\n"
+              "Visits: 42");
+}
+
+TEST(HttpResponseBuilderTest, StartResetsPreviousResponse) {
+    HttpResponseBuilder builder;
+    builder.Start(HttpResponseBuilder::kHeadOkHtml);
+    builder.AppendBody("previous");
+    builder.SetKeepAlive(true);
+
+    builder.Start(HttpResponseBuilder::kHeadNotFound);
+    builder.AppendBody("Not Found");
+    EXPECT_EQ(Join(builder.Finish()),
+              "HTTP/1.1 404 Not Found\r\n"
+              "Content-Type: text/plain\r\n"
+              "Content-Length: 9\r\n"
+              "Connection: close\r\n"
+              "\r\n"
+              "Not Found");
+}
+
+/**
+ * @brief Тело из kMaxBodyFragments фрагментов, kMaxNumbers из которых - числа
+ */
+TEST(HttpResponseBuilderTest, AcceptsBodyAtLimits) {
+    HttpResponseBuilder builder;
+    builder.Start(HttpResponseBuilder::kHeadOkJson);
+    for (std::size_t i = 0; i < HttpResponseBuilder::kMaxNumbers; ++i) {
+        builder.AppendBody(uint64_t{i});
+    }
+    for (std::size_t i = HttpResponseBuilder::kMaxNumbers; i < HttpResponseBuilder::kMaxBodyFragments;
+         ++i) {
+        builder.AppendBody(",");
+    }
+
+    EXPECT_FALSE(builder.Overflowed());
+    const std::string response = Join(builder.Finish());
+    EXPECT_NE(response.find("Content-Length: 6\r\n"), std::string::npos);
+    EXPECT_TRUE(response.ends_with("\r\n\r\n012,,,"));
+}
+
+#ifdef NDEBUG
+
+/**
+ * @brief Лишний фрагмент не усекает тело молча, а превращает ответ в 500
+ */
+TEST(HttpResponseBuilderTest, TooManyFragmentsFallBackToInternalError) {
+    HttpResponseBuilder builder;
+    builder.Start(HttpResponseBuilder::kHeadOkHtml);
+    builder.SetKeepAlive(true);
+    for (std::size_t i = 0; i <= HttpResponseBuilder::kMaxBodyFragments; ++i) {
+        builder.AppendBody("x");
+    }
+
+    EXPECT_TRUE(builder.Overflowed());
+    EXPECT_EQ(Join(builder.Finish()), kInternalError);
+}
+
+TEST(HttpResponseBuilderTest, TooManyNumbersFallBackToInternalError) {
+    HttpResponseBuilder builder;
+    builder.Start(HttpResponseBuilder::kHeadOkHtml);
+    for (std::size_t i = 0; i <= HttpResponseBuilder::kMaxNumbers; ++i) {
+        builder.AppendBody(uint64_t{i});
+    }
+
+    EXPECT_TRUE(builder.Overflowed());
+    EXPECT_EQ(Join(builder.Finish()), kInternalError);
+}
+
+TEST(HttpResponseBuilderTest, StartClearsOverflow) {
+    HttpResponseBuilder builder;
+    builder.Start(HttpResponseBuilder::kHeadOkHtml);
+    for (std::size_t i = 0; i <= HttpResponseBuilder::kMaxBodyFragments; ++i) {
+        builder.AppendBody("x");
+    }
+
+    builder.Start(HttpResponseBuilder::kHeadBadRequest);
+    builder.AppendBody("Bad Request");
+    EXPECT_FALSE(builder.Overflowed());
+    EXPECT_NE(Join(builder.Finish()).find("400 Bad Request"), std::string::npos);
+}
+
+#else
+
+TEST(HttpResponseBuilderDeathTest, TooManyFragmentsAssert) {
+    HttpResponseBuilder builder;
+    builder.Start(HttpResponseBuilder::kHeadOkHtml);
+    for (std::size_t i = 0; i < HttpResponseBuilder::kMaxBodyFragments; ++i) {
+        builder.AppendBody("x");
+    }
+    EXPECT_DEATH(builder.AppendBody("x"), "too many body fragments");
+}
+
+TEST(HttpResponseBuilderDeathTest, TooManyNumbersAssert) {
+    HttpResponseBuilder builder;
+    builder.Start(HttpResponseBuilder::kHeadOkHtml);
+    for (std::size_t i = 0; i < HttpResponseBuilder::kMaxNumbers; ++i) {
+        builder.AppendBody(uint64_t{i});
+    }
+    EXPECT_DEATH(builder.AppendBody(uint64_t{0}), "too many numbers in body");
+}
+
+#endif  // NDEBUG
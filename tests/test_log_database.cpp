@@ -0,0 +1,204 @@
+/**
+ * @file test_log_database.cpp
+ * @brief Unit-тесты журнального хранилища в отображаемых сегментах
+ *
+ * Проверяются:
+ * - Восстановление посещений, сообщений и пиров после повторного открытия
+ * - Переход на новый сегмент при заполнении текущего
+ * - Остановка чтения на оборванной записи и дозапись после нее
+ * - Идентификаторы сообщений не повторяются после перезапуска
+ * - Отказ в записи больше сегмента
+ *
+ * @date 2025
+ */
+
+#include "src/log_database.hpp"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using std::chrono::hours;
+using std::chrono::minutes;
+using std::chrono::seconds;
+using TimePoint = std::chrono::system_clock::time_point;
+
+/// 2025-01-01 00:00:00 UTC
+const TimePoint kDayStart = TimePoint(seconds(1735689600));
+
+/**
+ * @brief Тест с пустым каталогом журнала
+ */
+class LogDatabaseTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        dir_ = std::filesystem::path(::testing::TempDir()) /
+               ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        std::filesystem::remove_all(dir_);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(dir_);
+    }
+
+    /**
+     * @brief Параметры хранилища в каталоге теста
+     */
+    [[nodiscard]] LogDatabase::Options Options(std::size_t segment_bytes = 4096) const {
+        return LogDatabase::Options{dir_.string(), segment_bytes, std::chrono::milliseconds(0)};
+    }
+
+    /**
+     * @brief Файлы сегментов каталога
+     */
+    [[nodiscard]] std::size_t SegmentCount() const {
+        std::size_t count = 0;
+        for (const auto& entry : std::filesystem::directory_iterator(dir_)) {
+            count += entry.path().extension() == ".log" ? 1 : 0;
+        }
+        return count;
+    }
+
+    std::filesystem::path dir_;  ///< Каталог журнала
+};
+
+/**
+ * @brief Сообщение комнаты с идентификатором
+ */
+ChatMessage Message(uint16_t room, uint64_t id) {
+    return ChatMessage{id, room, "alice", "message " + std::to_string(id), kDayStart};
+}
+
+}  // namespace
+
+/**
+ * @brief Посещения, сообщения и пиры восстанавливаются из журнала
+ */
+TEST_F(LogDatabaseTest, ReplaysAfterReopen) {
+    {
+        LogDatabase db(Options());
+        db.MarkVisits({kDayStart + minutes(1), kDayStart + hours(1)});
+        db.AppendMessages({Message(1, 1), Message(2, 2), Message(1, 3)});
+        PeerChanges changes;
+        changes.upserts.push_back(
+            PeerRecord{"bob", "10.0.0.2:5000", std::chrono::system_clock::now() + hours(1)});
+        changes.upserts.push_back(
+            PeerRecord{"eve", "10.0.0.3:5000", std::chrono::system_clock::now() + hours(1)});
+        db.SavePeers(changes);
+        db.SavePeers(PeerChanges{{}, {"eve"}});
+    }
+
+    LogDatabase db(Options());
+    db.Initialize();
+    EXPECT_EQ(db.GetCount(), 2U);
+    const std::vector<VisitBucket> expected{
+        {VisitHistogram::MinuteOf(kDayStart), 1},
+        {VisitHistogram::MinuteOf(kDayStart + hours(1)), 1},
+    };
+    EXPECT_EQ(
+        db.GetVisitCounts(kDayStart, kDayStart + hours(24), VisitGranularity::kHour), expected);
+
+    const auto page = db.GetMessages(1, UINT64_MAX, 10);
+    ASSERT_EQ(page.size(), 2U);
+    EXPECT_EQ(page[0].id, 3U);
+    EXPECT_EQ(page[0].text, "message 3");
+    EXPECT_EQ(page[0].time, kDayStart);
+    EXPECT_EQ(page[1].id, 1U);
+
+    const auto peers = db.LoadPeers();
+    ASSERT_EQ(peers.size(), 1U);
+    EXPECT_EQ(peers[0].id, "bob");
+    EXPECT_EQ(peers[0].endpoint, "10.0.0.2:5000");
+}
+
+/**
+ * @brief Заполненный сегмент сменяется новым, история читается из обоих
+ */
+TEST_F(LogDatabaseTest, RollsSegments) {
+    {
+        LogDatabase db(Options(256));
+        for (uint64_t id = 1; id <= 20; ++id) {
+            db.AppendMessages({Message(1, id)});
+        }
+        EXPECT_GT(SegmentCount(), 1U);
+    }
+
+    LogDatabase db(Options(256));
+    const auto page = db.GetMessages(1, 15, 100);
+    ASSERT_EQ(page.size(), 14U);
+    EXPECT_EQ(page.front().id, 14U);
+    EXPECT_EQ(page.back().id, 1U);
+}
+
+/**
+ * @brief Оборванная запись отбрасывается, новые записи идут на ее место
+ */
+TEST_F(LogDatabaseTest, StopsAtTornRecord) {
+    {
+        LogDatabase db(Options());
+        db.AppendMessages({Message(1, 1), Message(1, 2)});
+    }
+
+    // Портим последний байт данных второй записи, как при сбое во время записи
+    const auto segment = dir_ / "00000001.log";
+    std::size_t end = 0;
+    {
+        std::ifstream in(segment, std::ios::binary);
+        std::vector<char> data((std::istreambuf_iterator<char>(in)), {});
+        end = data.size();
+        while (end > 0 && data[end - 1] == 0) {
+            --end;
+        }
+    }
+    {
+        std::fstream file(segment, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(static_cast<std::streamoff>(end - 1));
+        file.put('\x7f');
+    }
+
+    {
+        LogDatabase db(Options());
+        const auto page = db.GetMessages(1, UINT64_MAX, 10);
+        ASSERT_EQ(page.size(), 1U);
+        EXPECT_EQ(page[0].id, 1U);
+        db.AppendMessages({Message(1, 5)});
+    }
+
+    LogDatabase db(Options());
+    const auto page = db.GetMessages(1, UINT64_MAX, 10);
+    ASSERT_EQ(page.size(), 2U);
+    EXPECT_EQ(page[0].id, 5U);
+    EXPECT_EQ(page[1].id, 1U);
+}
+
+/**
+ * @brief Блоки идентификаторов после перезапуска начинаются за выданными
+ */
+TEST_F(LogDatabaseTest, ReservesIdsAcrossRestarts) {
+    uint64_t first = 0;
+    {
+        LogDatabase db(Options());
+        first = db.ReserveMessageIds();
+    }
+    LogDatabase db(Options());
+    EXPECT_EQ(db.ReserveMessageIds(), first + IDatabaseService::kMessageIdBlock);
+}
+
+/**
+ * @brief Запись больше сегмента отклоняется
+ */
+TEST_F(LogDatabaseTest, RejectsOversizedRecord) {
+    LogDatabase db(Options(256));
+    ChatMessage message = Message(1, 1);
+    message.text.assign(512, 'x');
+    EXPECT_THROW(db.AppendMessages({message}), DatabaseUnavailableError);
+    EXPECT_TRUE(db.GetMessages(1, UINT64_MAX, 10).empty());
+}
@@ -0,0 +1,118 @@
+/**
+ * @file test_logger.cpp
+ * @brief Unit-тесты асинхронного логгера и lock-free очереди
+ *
+ * Проверяются:
+ * - Порядок и целостность элементов MpmcQueue при конкурентном доступе
+ * - Разбор значений LOG_LEVEL
+ * - Фильтрация по уровню и формат вывода Logger
+ *
+ * @date 2025
+ */
+
+#include "src/logger.hpp"
+#include "src/mpmc_queue.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Очередь отдает элементы в порядке добавления и сообщает о переполнении
+ */
+TEST(MpmcQueueTest, PushPopSingleThread) {
+    MpmcQueue<int> queue(3);
+    ASSERT_EQ(queue.Capacity(), 4U);
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(queue.TryPush(i));
+    }
+    EXPECT_FALSE(queue.TryPush(4));
+
+    int value = -1;
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(queue.TryPop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(queue.TryPop(value));
+}
+
+/**
+ * @brief Каждый элемент, добавленный несколькими потоками, извлекается ровно один раз
+ */
+TEST(MpmcQueueTest, ConcurrentProducersAndConsumers) {
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 10000;
+    MpmcQueue<int> queue(256);
+    std::atomic<long long> sum{0};
+    std::atomic<int> popped{0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&queue, t] {
+            for (int i = 0; i < kPerThread; ++i) {
+                int value = t * kPerThread + i;
+                while (!queue.TryPush(value)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        threads.emplace_back([&queue, &sum, &popped] {
+            int value = 0;
+            while (popped.load() < kThreads * kPerThread) {
+                if (queue.TryPop(value)) {
+                    sum += value;
+                    ++popped;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    constexpr long long kTotal = static_cast<long long>(kThreads) * kPerThread;
+    EXPECT_EQ(popped.load(), kTotal);
+    EXPECT_EQ(sum.load(), kTotal * (kTotal - 1) / 2);
+}
+
+/**
+ * @brief Значения LOG_LEVEL разбираются без учета регистра
+ */
+TEST(LoggerTest, ParsesLogLevel) {
+    EXPECT_EQ(ParseLogLevel("debug"), LogLevel::kDebug);
+    EXPECT_EQ(ParseLogLevel("TRACE"), LogLevel::kTrace);
+    EXPECT_EQ(ParseLogLevel("Warning"), LogLevel::kWarning);
+    EXPECT_EQ(ParseLogLevel("off"), LogLevel::kOff);
+    EXPECT_EQ(ParseLogLevel("unknown"), LogLevel::kInfo);
+}
+
+/**
+ * @brief Логгер выводит только сообщения включенных уровней
+ */
+TEST(LoggerTest, FiltersAndFormatsMessages) {
+    std::FILE* output = std::tmpfile();
+    ASSERT_NE(output, nullptr);
+    {
+        Logger logger(LogLevel::kInfo, output);
+        EXPECT_FALSE(logger.IsEnabled(LogLevel::kDebug));
+        EXPECT_TRUE(logger.IsEnabled(LogLevel::kError));
+
+        LogLine(LogLevel::kInfo, logger) << "visits " << 42 << ' ' << true;
+        LogLine(LogLevel::kError, logger) << std::string("failed");
+        logger.Flush();
+    }
+
+    std::rewind(output);
+    std::string text(256, '\0');
+    text.resize(std::fread(text.data(), 1, text.size(), output));
+    std::fclose(output);
+
+    EXPECT_EQ(text, "[INFO ] visits 42 true\n[ERROR] failed\n");
+}
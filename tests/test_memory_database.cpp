@@ -0,0 +1,135 @@
+/**
+ * @file test_memory_database.cpp
+ * @brief Unit-тесты хранилища в памяти процесса
+ *
+ * Проверяются:
+ * - Подсчет посещений и их агрегация по интервалам
+ * - Вытеснение старой минуты из ячейки кольца новой
+ * - Непересекающиеся блоки идентификаторов сообщений
+ * - Страницы истории комнаты по курсору
+ * - Параллельная запись сообщений без потерь
+ *
+ * @date 2025
+ */
+
+#include "src/memory_database.hpp"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using std::chrono::hours;
+using std::chrono::minutes;
+using std::chrono::seconds;
+using TimePoint = std::chrono::system_clock::time_point;
+
+/// 2025-01-01 00:00:00 UTC
+const TimePoint kDayStart = TimePoint(seconds(1735689600));
+
+/**
+ * @brief Сообщение комнаты с идентификатором
+ */
+ChatMessage Message(uint16_t room, uint64_t id) {
+    return ChatMessage{id, room, "alice", "message " + std::to_string(id), kDayStart};
+}
+
+}  // namespace
+
+/**
+ * @brief Посещения считаются и суммируются по часам
+ */
+TEST(InMemoryDatabaseTest, CountsVisits) {
+    InMemoryDatabase db;
+    db.MarkVisits({kDayStart + minutes(1), kDayStart + minutes(1), kDayStart + hours(2)});
+    db.MarkVisits({kDayStart + minutes(30)});
+
+    EXPECT_EQ(db.GetCount(), 4U);
+    const std::vector<VisitBucket> expected{
+        {VisitHistogram::MinuteOf(kDayStart), 3},
+        {VisitHistogram::MinuteOf(kDayStart + hours(2)), 1},
+    };
+    EXPECT_EQ(
+        db.GetVisitCounts(kDayStart, kDayStart + hours(24), VisitGranularity::kHour), expected);
+}
+
+/**
+ * @brief Минута, отстоящая на размер кольца, занимает ячейку старой
+ */
+TEST(InMemoryDatabaseTest, EvictsOldMinutes) {
+    InMemoryDatabase db;
+    const TimePoint later = kDayStart + minutes(InMemoryDatabase::kMinuteSlots);
+    db.MarkVisits({kDayStart});
+    db.MarkVisits({later, later});
+    // Посещения вытесненной минуты больше не принимаются
+    db.MarkVisits({kDayStart});
+
+    EXPECT_EQ(db.GetCount(), 4U);
+    EXPECT_TRUE(
+        db.GetVisitCounts(kDayStart, kDayStart + minutes(1), VisitGranularity::kMinute).empty());
+    const std::vector<VisitBucket> expected{{VisitHistogram::MinuteOf(later), 2}};
+    EXPECT_EQ(
+        db.GetVisitCounts(later, later + minutes(1), VisitGranularity::kMinute), expected);
+}
+
+/**
+ * @brief Блоки идентификаторов не пересекаются
+ */
+TEST(InMemoryDatabaseTest, ReservesDisjointBlocks) {
+    InMemoryDatabase db;
+    const uint64_t first = db.ReserveMessageIds();
+    const uint64_t second = db.ReserveMessageIds();
+    EXPECT_GE(first, 1U);
+    EXPECT_EQ(second, first + IDatabaseService::kMessageIdBlock);
+}
+
+/**
+ * @brief История читается страницами от новых к старым
+ */
+TEST(InMemoryDatabaseTest, PagesMessages) {
+    InMemoryDatabase db;
+    db.AppendMessages({Message(1, 1), Message(2, 2), Message(1, 3)});
+    db.AppendMessages({Message(1, 4)});
+
+    const auto page = db.GetMessages(1, UINT64_MAX, 2);
+    ASSERT_EQ(page.size(), 2U);
+    EXPECT_EQ(page[0].id, 4U);
+    EXPECT_EQ(page[1].id, 3U);
+    EXPECT_EQ(page[1].text, "message 3");
+
+    const auto older = db.GetMessages(1, 3, 10);
+    ASSERT_EQ(older.size(), 1U);
+    EXPECT_EQ(older[0].id, 1U);
+    EXPECT_TRUE(db.GetMessages(7, UINT64_MAX, 10).empty());
+}
+
+/**
+ * @brief Параллельные писатели одной комнаты не теряют сообщений
+ */
+TEST(InMemoryDatabaseTest, AppendsConcurrently) {
+    constexpr std::size_t kThreads = 4;
+    constexpr std::size_t kPerThread = 1000;
+    InMemoryDatabase db;
+
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&db, t] {
+            for (std::size_t i = 0; i < kPerThread; ++i) {
+                db.AppendMessages({Message(5, t * kPerThread + i + 1)});
+                db.MarkVisit();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(db.GetMessages(5, UINT64_MAX, kThreads * kPerThread * 2).size(), kThreads * kPerThread);
+    EXPECT_EQ(db.GetCount(), kThreads * kPerThread);
+}
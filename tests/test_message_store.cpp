@@ -0,0 +1,378 @@
+/**
+ * @file test_message_store.cpp
+ * @brief Unit-тесты хранилища сообщений чата
+ *
+ * Проверяются:
+ * - Назначение идентификаторов из зарезервированных блоков
+ * - Групповая запись пакета сообщений и его возврат после ошибки
+ * - Отдача последних сообщений из кеша без обращения к БД
+ * - Чтение старых страниц по курсору и вытеснение комнат из кеша
+ * - История вытесненной комнаты включает сообщения, еще не записанные в БД
+ * - Append() без зарезервированных идентификаторов не обращается к БД
+ * - Асинхронное чтение истории вне потока вызывающего и через IHistoryReader
+ *
+ * @date 2025
+ */
+
+#include "src/chat_protocol.hpp"
+#include "src/message_store.hpp"
+
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/io_context.hpp>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using std::chrono::milliseconds;
+
+/**
+ * @brief Хранилище сообщений в памяти, считающее обращения
+ */
+class FakeMessageDatabase : public IDatabaseService {
+   public:
+    void Initialize() override {
+    }
+
+    void MarkVisit() override {
+    }
+
+    uint64_t GetCount() override {
+        return 0;
+    }
+
+    uint64_t ReserveMessageIds() override {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        ++reserves;
+        if (fail_reserves) {
+            throw DatabaseUnavailableError("down");
+        }
+        const uint64_t first = next_block_;
+        next_block_ += kMessageIdBlock;
+        return first;
+    }
+
+    void AppendMessages(const std::vector<ChatMessage>& messages) override {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        ++appends;
+        if (fail) {
+            throw DatabaseUnavailableError("down");
+        }
+        stored.insert(stored.end(), messages.begin(), messages.end());
+    }
+
+    std::vector<ChatMessage> GetMessages(
+        uint16_t room, uint64_t before_id, std::size_t limit) override {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        ++reads;
+        reader = std::this_thread::get_id();
+        std::vector<ChatMessage> page;
+        for (auto it = stored.rbegin(); it != stored.rend() && page.size() < limit; ++it) {
+            if (it->room == room && it->id < before_id) {
+                page.push_back(*it);
+            }
+        }
+        return page;
+    }
+
+    /// Количество вызовов ReserveMessageIds (под mutex_ при работающем хранилище)
+    int Reserves() {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        return reserves;
+    }
+
+    /// Включает или отключает ошибку ReserveMessageIds
+    void FailReserves(bool value) {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        fail_reserves = value;
+    }
+
+    /// Записанные сообщения (под mutex_ при работающем хранилище)
+    std::vector<ChatMessage> Stored() {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        return stored;
+    }
+
+    int reserves = 0;                 ///< Вызовов ReserveMessageIds
+    int appends = 0;                  ///< Вызовов AppendMessages
+    int reads = 0;                    ///< Вызовов GetMessages
+    bool fail = false;                ///< AppendMessages завершается ошибкой
+    bool fail_reserves = false;       ///< ReserveMessageIds завершается ошибкой (под mutex_)
+    std::thread::id reader;           ///< Поток последнего GetMessages
+    std::vector<ChatMessage> stored;  ///< Записанные сообщения в порядке записи
+
+   private:
+    uint64_t next_block_ = 1;  ///< Начало следующего блока идентификаторов
+    std::mutex mutex_;
+};
+
+/// Интервал записи, заведомо больший времени теста
+constexpr milliseconds kNoTimer{60000};
+
+/// Идентификаторы сообщений страницы
+std::vector<uint64_t> Ids(const std::vector<ChatMessage>& messages) {
+    std::vector<uint64_t> ids;
+    ids.reserve(messages.size());
+    for (const ChatMessage& message : messages) {
+        ids.push_back(message.id);
+    }
+    return ids;
+}
+
+}  // namespace
+
+/**
+ * @brief Идентификаторы идут подряд, следующий блок резервируется заранее
+ */
+TEST(MessageStoreTest, AssignsIdsFromReservedBlocks) {
+    auto db = std::make_shared<FakeMessageDatabase>();
+    MessageStore store(db, 100000, kNoTimer, 0, 0);
+    EXPECT_EQ(db->Reserves(), 1);
+
+    constexpr uint64_t kHalf = IDatabaseService::kMessageIdBlock / 2;
+    uint64_t id = 1;
+    for (; id <= kHalf; ++id) {
+        EXPECT_EQ(store.Append(1, "alice", "hi").id, id);
+    }
+    // Половина блока использована: фоновый поток резервирует следующий
+    for (int i = 0; i < 200 && db->Reserves() < 2; ++i) {
+        std::this_thread::sleep_for(milliseconds(5));
+    }
+    EXPECT_EQ(db->Reserves(), 2);
+
+    for (; id <= IDatabaseService::kMessageIdBlock + 1; ++id) {
+        EXPECT_EQ(store.Append(1, "alice", "hi").id, id);
+    }
+    EXPECT_EQ(db->Reserves(), 2);
+}
+
+/**
+ * @brief Заполненный пакет записывается одним вызовом, остаток - при Flush
+ */
+TEST(MessageStoreTest, WritesFullBatchAtOnce) {
+    auto db = std::make_shared<FakeMessageDatabase>();
+    MessageStore store(db, 4, kNoTimer, 0, 0);
+    for (int i = 0; i < 4; ++i) {
+        store.Append(1, "alice", "hi");
+    }
+    for (int i = 0; i < 200 && db->Stored().size() < 4; ++i) {
+        std::this_thread::sleep_for(milliseconds(5));
+    }
+    EXPECT_EQ(db->Stored().size(), 4U);
+
+    // Неполный пакет ждет таймера или Flush
+    store.Append(1, "alice", "hi");
+    std::this_thread::sleep_for(milliseconds(20));
+    EXPECT_EQ(db->Stored().size(), 4U);
+
+    store.Flush();
+    EXPECT_EQ(db->Stored().size(), 5U);
+}
+
+/**
+ * @brief Пакет, который не удалось записать, записывается следующим сбросом
+ */
+TEST(MessageStoreTest, RequeuesFailedBatch) {
+    auto db = std::make_shared<FakeMessageDatabase>();
+    MessageStore store(db, 100, kNoTimer, 0, 0);
+    store.Append(1, "alice", "first");
+    db->fail = true;
+    store.Flush();
+    store.Append(1, "alice", "second");
+    db->fail = false;
+    store.Flush();
+
+    const std::vector<ChatMessage> stored = db->Stored();
+    ASSERT_EQ(stored.size(), 2U);
+    EXPECT_EQ(stored[0].text, "first");
+    EXPECT_EQ(stored[1].text, "second");
+}
+
+/**
+ * @brief Последние сообщения комнаты отдаются из кеша без обращения к БД
+ */
+TEST(MessageStoreTest, ServesRecentHistoryFromCache) {
+    auto db = std::make_shared<FakeMessageDatabase>();
+    MessageStore store(db, 100, kNoTimer, 8, 3);
+    for (int i = 0; i < 5; ++i) {
+        store.Append(1, "alice", "hi");
+    }
+    store.Append(2, "bob", "other room");
+
+    EXPECT_EQ(Ids(store.History(1, 0, 3)), (std::vector<uint64_t>{5, 4, 3}));
+    EXPECT_EQ(Ids(store.History(1, 5, 2)), (std::vector<uint64_t>{4, 3}));
+    EXPECT_EQ(db->reads, 0);
+
+    // Страница глубже кеша дочитывается из БД от последнего id в кеше
+    store.Flush();
+    EXPECT_EQ(Ids(store.History(1, 0, 10)), (std::vector<uint64_t>{5, 4, 3, 2, 1}));
+    EXPECT_EQ(db->reads, 1);
+    EXPECT_EQ(Ids(store.History(1, 3, 10)), (std::vector<uint64_t>{2, 1}));
+}
+
+/**
+ * @brief Вытесненная комната читается из БД и снова попадает в кеш
+ */
+TEST(MessageStoreTest, EvictsLeastRecentlyUsedRoom) {
+    auto db = std::make_shared<FakeMessageDatabase>();
+    MessageStore store(db, 100, kNoTimer, 2, 10);
+    store.Append(1, "alice", "one");
+    store.Append(2, "bob", "two");
+    store.History(1, 0, 1);  // Комната 1 становится самой свежей
+    store.Append(3, "carol", "three");
+    store.Flush();
+
+    EXPECT_EQ(store.History(1, 0, 1).size(), 1U);
+    EXPECT_EQ(db->reads, 0);
+
+    // Комната 2 вытеснена: первое чтение из БД, второе - уже из кеша
+    EXPECT_EQ(Ids(store.History(2, 0, 5)), std::vector<uint64_t>{2});
+    EXPECT_EQ(db->reads, 1);
+    EXPECT_EQ(Ids(store.History(2, 0, 5)), std::vector<uint64_t>{2});
+    EXPECT_EQ(db->reads, 1);
+}
+
+/**
+ * @brief Сообщения вытесненной комнаты, еще не записанные в БД, не теряются
+ */
+TEST(MessageStoreTest, KeepsUnwrittenMessagesOfEvictedRoom) {
+    auto db = std::make_shared<FakeMessageDatabase>();
+    MessageStore store(db, 100, kNoTimer, 1, 10);
+    store.Append(1, "alice", "one");
+    store.Append(1, "alice", "two");
+    store.Append(2, "bob", "evicts room 1");
+
+    // Комната 1 не в кеше и не в БД: страница берется из буфера записи
+    EXPECT_EQ(Ids(store.History(1, 0, 5)), (std::vector<uint64_t>{2, 1}));
+    EXPECT_EQ(db->reads, 1);
+
+    store.Flush();
+    EXPECT_EQ(Ids(store.History(1, 0, 5)), (std::vector<uint64_t>{2, 1}));
+    EXPECT_EQ(Ids(store.History(1, 0, 1)), std::vector<uint64_t>{2});
+}
+
+/**
+ * @brief Без зарезервированных идентификаторов Append() не обращается к БД
+ */
+TEST(MessageStoreTest, AppendFailsUntilIdsAreReserved) {
+    auto db = std::make_shared<FakeMessageDatabase>();
+    db->fail_reserves = true;
+    MessageStore store(db, 100, milliseconds(10), 0, 0);
+
+    EXPECT_THROW(store.Append(1, "alice", "lost"), DatabaseUnavailableError);
+
+    // Фоновый поток повторяет резервирование после интервала записи
+    db->FailReserves(false);
+    bool stored = false;
+    for (int i = 0; i < 200 && !stored; ++i) {
+        try {
+            store.Append(1, "alice", "hi");
+            stored = true;
+        } catch (const DatabaseUnavailableError&) {
+            std::this_thread::sleep_for(milliseconds(5));
+        }
+    }
+    EXPECT_TRUE(stored);
+}
+
+/**
+ * @brief AsyncHistory() читает БД вне потока вызывающего и отдает
+ * результат через executor обработчика
+ */
+TEST(MessageStoreTest, ReadsHistoryOffCallerThread) {
+    auto db = std::make_shared<FakeMessageDatabase>();
+    MessageStore store(db, 100, kNoTimer, 8, 10);
+    store.Append(1, "alice", "one");
+    store.Append(1, "alice", "two");
+    store.Flush();
+
+    boost::asio::io_context io_context;
+    std::vector<ChatMessage> page;
+    std::thread::id handler_thread;
+    const auto handler = boost::asio::bind_executor(
+        io_context, [&](std::exception_ptr error, std::vector<ChatMessage> messages) {
+            EXPECT_FALSE(error);
+            page = std::move(messages);
+            handler_thread = std::this_thread::get_id();
+        });
+
+    // Кеш комнаты не полный: страница старше id 2 дочитывается из БД
+    store.AsyncHistory(1, 2, 5, handler);
+    io_context.run();
+    EXPECT_EQ(Ids(page), std::vector<uint64_t>{1});
+    EXPECT_EQ(db->reads, 1);
+    EXPECT_NE(db->reader, std::this_thread::get_id());
+    EXPECT_EQ(handler_thread, std::this_thread::get_id());
+
+    // Последние сообщения отдаются из кеша без обращения к БД
+    store.AsyncHistory(1, 0, 2, handler);
+    io_context.restart();
+    io_context.run();
+    EXPECT_EQ(Ids(page), (std::vector<uint64_t>{2, 1}));
+    EXPECT_EQ(db->reads, 1);
+}
+
+/**
+ * @brief Недостающие сообщения читает IHistoryReader, а не backend
+ */
+TEST(MessageStoreTest, ReadsHistoryThroughReader) {
+    /// Источник, отвечающий из отдельного потока
+    class ThreadReader : public IHistoryReader {
+       public:
+        void ReadMessages(
+            uint16_t room, uint64_t before_id, std::size_t limit, Callback callback) override {
+            ++calls;
+            worker = std::thread([room, before_id, limit, callback = std::move(callback)] {
+                std::vector<ChatMessage> page;
+                for (uint64_t id = before_id - 1; id > 0 && page.size() < limit; --id) {
+                    page.push_back(ChatMessage{id, room, "db", "old", {}});
+                }
+                callback(nullptr, std::move(page));
+            });
+        }
+
+        ~ThreadReader() override {
+            worker.join();
+        }
+
+        int calls = 0;       ///< Вызовов ReadMessages
+        std::thread worker;  ///< Поток последнего чтения
+    };
+
+    auto db = std::make_shared<FakeMessageDatabase>();
+    auto reader = std::make_shared<ThreadReader>();
+    MessageStore store(db, 100, kNoTimer, 8, 10, reader);
+
+    boost::asio::io_context io_context;
+    std::vector<ChatMessage> page;
+    store.AsyncHistory(
+        1, 4, 5,
+        boost::asio::bind_executor(
+            io_context, [&](std::exception_ptr error, std::vector<ChatMessage> messages) {
+                EXPECT_FALSE(error);
+                page = std::move(messages);
+            }));
+    io_context.run();
+    EXPECT_EQ(Ids(page), (std::vector<uint64_t>{3, 2, 1}));
+    EXPECT_EQ(reader->calls, 1);
+    EXPECT_EQ(db->reads, 0);
+}
+
+/**
+ * @brief Курсор истории передается в сетевом порядке байтов
+ */
+TEST(MessageStoreTest, EncodesCursor) {
+    const auto bytes = EncodeUint64(0x0102030405060708ULL);
+    EXPECT_EQ(bytes[0], 0x01);
+    EXPECT_EQ(bytes[7], 0x08);
+    EXPECT_EQ(DecodeUint64(std::string_view(bytes.data(), bytes.size())), 0x0102030405060708ULL);
+}
@@ -0,0 +1,107 @@
+/**
+ * @file test_metrics.cpp
+ * @brief Unit-тесты метрик и гистограмм задержек
+ *
+ * Проверяются:
+ * - Границы логарифмически-линейных корзин гистограммы
+ * - Оценка квантилей и включительные границы корзин le
+ * - Суммирование шардов и формат вывода Prometheus
+ *
+ * @date 2025
+ */
+
+#include "src/metrics.hpp"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Каждое значение попадает в корзину, границы которой его содержат
+ */
+TEST(HistogramSnapshotTest, BucketBoundsContainValues) {
+    for (uint64_t value : {0ULL, 1ULL, 15ULL, 16ULL, 17ULL, 100ULL, 1000ULL, 123456ULL}) {
+        const std::size_t index = HistogramSnapshot::BucketIndex(value);
+        EXPECT_LE(value, HistogramSnapshot::BucketUpperBound(index)) << value;
+        if (index > 0) {
+            EXPECT_GT(value, HistogramSnapshot::BucketUpperBound(index - 1)) << value;
+        }
+    }
+    EXPECT_EQ(HistogramSnapshot::BucketIndex(~0ULL), HistogramSnapshot::kBuckets - 1);
+}
+
+/**
+ * @brief Квантили оцениваются с погрешностью не больше ширины корзины
+ */
+TEST(HistogramSnapshotTest, EstimatesPercentiles) {
+    HistogramSnapshot snapshot;
+    for (uint64_t value = 1; value <= 1000; ++value) {
+        snapshot.Record(value);
+    }
+    EXPECT_EQ(snapshot.count, 1000U);
+    EXPECT_NEAR(static_cast<double>(snapshot.Percentile(0.5)), 500.0, 500.0 / 16);
+    EXPECT_NEAR(static_cast<double>(snapshot.Percentile(0.99)), 990.0, 990.0 / 16);
+    EXPECT_EQ(snapshot.CountAtMost(512), 512U);
+}
+
+/**
+ * @brief Наблюдение, равное границе, учитывается в корзине le этой границы
+ */
+TEST(HistogramSnapshotTest, CountsSamplesOnBoundInclusively) {
+    Metrics metrics;
+    metrics.Observe(Histogram::kDb, std::chrono::microseconds(4));
+    metrics.Observe(Histogram::kDb, std::chrono::microseconds(1024));
+
+    const HistogramSnapshot snapshot = metrics.Snapshot(Histogram::kDb);
+    EXPECT_EQ(snapshot.CountAtMost(2), 0U);
+    EXPECT_EQ(snapshot.CountAtMost(4), 1U);
+    EXPECT_EQ(snapshot.CountAtMost(992), 1U);
+    EXPECT_EQ(snapshot.CountAtMost(1024), 2U);
+
+    std::string text;
+    metrics.Render(text);
+    EXPECT_NE(text.find("p2p_phase_latency_seconds_bucket{phase=\"db\",le=\"4e-06\"} 1\n"),
+              std::string::npos);
+    EXPECT_NE(text.find("p2p_phase_latency_seconds_bucket{phase=\"db\",le=\"0.001024\"} 2\n"),
+              std::string::npos);
+}
+
+/**
+ * @brief Значения из разных потоков суммируются и выводятся в формате Prometheus
+ */
+TEST(MetricsTest, SumsShardsAndRendersPrometheusText) {
+    Metrics metrics;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&metrics] {
+            for (int j = 0; j < 100; ++j) {
+                metrics.Increment(Counter::kRequests);
+                metrics.Observe(Histogram::kDb, std::chrono::microseconds(3));
+            }
+            metrics.Add(Gauge::kActiveSessions, 1);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    metrics.Add(Gauge::kActiveSessions, -1);
+
+    EXPECT_EQ(metrics.Value(Counter::kRequests), 400U);
+    EXPECT_EQ(metrics.Value(Gauge::kActiveSessions), 3);
+    EXPECT_EQ(metrics.Snapshot(Histogram::kDb).count, 400U);
+
+    std::string text;
+    metrics.Render(text);
+    EXPECT_NE(text.find("p2p_http_requests_total 400\n"), std::string::npos);
+    EXPECT_NE(text.find("p2p_active_sessions 3\n"), std::string::npos);
+    EXPECT_NE(text.find("p2p_phase_latency_seconds_bucket{phase=\"db\",le=\"2e-06\"} 0\n"),
+              std::string::npos);
+    EXPECT_NE(text.find("p2p_phase_latency_seconds_bucket{phase=\"db\",le=\"4e-06\"} 400\n"),
+              std::string::npos);
+    EXPECT_NE(text.find("p2p_phase_latency_seconds_count{phase=\"db\"} 400\n"),
+              std::string::npos);
+    EXPECT_NE(text.find("p2p_db_pool_wait_seconds_bucket{le=\"+Inf\"} 0\n"), std::string::npos);
+}
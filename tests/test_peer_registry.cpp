@@ -0,0 +1,159 @@
+/**
+ * @file test_peer_registry.cpp
+ * @brief Unit-тесты реестра пиров и колеса таймеров
+ *
+ * Проверяются:
+ * - Срабатывание таймеров TimerWheel не раньше срока, в том числе
+ *   сроков дальше одного оборота и после долгого простоя
+ * - Регистрация, heartbeat, поиск и истечение регистраций PeerRegistry
+ * - Накопление изменений для снимков и их возврат после ошибки записи
+ *
+ * @date 2025
+ */
+
+#include "src/peer_registry.hpp"
+#include "src/timer_wheel.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace {
+
+using std::chrono::milliseconds;
+
+}  // namespace
+
+/**
+ * @brief Таймер срабатывает в первом тике после срока
+ */
+TEST(TimerWheelTest, FiresAfterDeadline) {
+    const auto start = TimerWheel<int>::Clock::now();
+    TimerWheel<int> wheel(milliseconds(10), 8, start);
+    wheel.Schedule(1, start + milliseconds(25));
+    wheel.Schedule(2, start + milliseconds(200));  // Дальше одного оборота (80 мс)
+    EXPECT_EQ(wheel.Size(), 2U);
+
+    std::vector<int> fired;
+    const auto collect = [&fired](int key) { fired.push_back(key); };
+    EXPECT_EQ(wheel.Advance(start + milliseconds(29), collect), 0U);
+    EXPECT_EQ(wheel.Advance(start + milliseconds(30), collect), 1U);
+    EXPECT_EQ(fired, std::vector<int>{1});
+
+    // Ячейка таймера 2 пройдена несколько раз, но его оборот еще не наступил
+    EXPECT_EQ(wheel.Advance(start + milliseconds(199), collect), 0U);
+    EXPECT_EQ(wheel.Advance(start + milliseconds(210), collect), 1U);
+    EXPECT_EQ(fired, (std::vector<int>{1, 2}));
+    EXPECT_EQ(wheel.Size(), 0U);
+}
+
+/**
+ * @brief После простоя дольше оборота срабатывают все истекшие таймеры
+ */
+TEST(TimerWheelTest, CatchesUpAfterLongPause) {
+    const auto start = TimerWheel<int>::Clock::now();
+    TimerWheel<int> wheel(milliseconds(10), 4, start);
+    for (int i = 0; i < 20; ++i) {
+        wheel.Schedule(i, start + milliseconds(5 * i));
+    }
+    wheel.Schedule(100, start + milliseconds(10000));
+
+    std::vector<int> fired;
+    EXPECT_EQ(wheel.Advance(start + milliseconds(5000), [&](int key) {
+        fired.push_back(key);
+        if (key == 0) {
+            wheel.Schedule(200, start + milliseconds(5015));  // Постановка из обработчика
+        }
+    }), 20U);
+    EXPECT_EQ(wheel.Size(), 2U);
+
+    fired.clear();
+    wheel.Advance(start + milliseconds(5030), [&](int key) { fired.push_back(key); });
+    EXPECT_EQ(fired, std::vector<int>{200});
+}
+
+/**
+ * @brief Heartbeat продлевает регистрацию, истекшая регистрация удаляется
+ */
+TEST(PeerRegistryTest, ExpiresWithoutHeartbeat) {
+    const auto start = PeerRegistry::Clock::now();
+    PeerRegistry registry(milliseconds(1000), milliseconds(100));
+    EXPECT_TRUE(registry.Register("alice", "10.0.0.1:9000", start));
+    EXPECT_TRUE(registry.Register("bob", "10.0.0.2:9000", start));
+    EXPECT_EQ(registry.Lookup("alice", start), "10.0.0.1:9000");
+    EXPECT_FALSE(registry.Lookup("carol", start).has_value());
+
+    // Heartbeat и смена адреса
+    EXPECT_FALSE(registry.Register("alice", "10.0.0.1:9001", start + milliseconds(800)));
+    EXPECT_EQ(registry.Expire(start + milliseconds(1200)), 1U);
+    EXPECT_FALSE(registry.Lookup("bob", start + milliseconds(1200)).has_value());
+    EXPECT_EQ(registry.Lookup("alice", start + milliseconds(1200)), "10.0.0.1:9001");
+
+    EXPECT_EQ(registry.Expire(start + milliseconds(2000)), 1U);
+    EXPECT_EQ(registry.Size(), 0U);
+}
+
+/**
+ * @brief Таймер удаленной и заново зарегистрированной записи не удаляет ее раньше срока
+ */
+TEST(PeerRegistryTest, IgnoresStaleTimers) {
+    const auto start = PeerRegistry::Clock::now();
+    PeerRegistry registry(milliseconds(1000), milliseconds(100));
+    registry.Register("alice", "a:1", start);
+    EXPECT_TRUE(registry.Unregister("alice"));
+    EXPECT_FALSE(registry.Unregister("alice"));
+    EXPECT_TRUE(registry.Register("alice", "a:2", start + milliseconds(500)));
+
+    EXPECT_EQ(registry.Expire(start + milliseconds(1200)), 0U);
+    EXPECT_EQ(registry.Lookup("alice", start + milliseconds(1200)), "a:2");
+    EXPECT_EQ(registry.Expire(start + milliseconds(1700)), 1U);
+}
+
+/**
+ * @brief Снимок содержит каждого измененного пира один раз
+ */
+TEST(PeerRegistryTest, CoalescesChangesForSnapshot) {
+    const auto start = PeerRegistry::Clock::now();
+    PeerRegistry registry(milliseconds(1000), milliseconds(100));
+    for (int i = 0; i < 10; ++i) {
+        registry.Register("alice", "a:1", start + milliseconds(i));
+    }
+    registry.Register("bob", "b:1", start);
+    registry.Unregister("bob");
+
+    PeerChanges changes = registry.TakeChanges(start);
+    ASSERT_EQ(changes.upserts.size(), 1U);
+    EXPECT_EQ(changes.upserts[0].id, "alice");
+    EXPECT_EQ(changes.upserts[0].endpoint, "a:1");
+    EXPECT_EQ(changes.removed, std::vector<std::string>{"bob"});
+    EXPECT_TRUE(registry.TakeChanges(start).Empty());
+
+    // Не записанные изменения возвращаются, кроме устаревших
+    registry.Register("bob", "b:2", start);
+    registry.TakeChanges(start);
+    registry.Requeue(changes);
+    changes = registry.TakeChanges(start);
+    EXPECT_EQ(changes.upserts.size(), 1U);
+    EXPECT_TRUE(changes.removed.empty());
+}
+
+/**
+ * @brief Восстановленные из снимка регистрации доступны и не считаются измененными
+ */
+TEST(PeerRegistryTest, RestoresSnapshot) {
+    PeerRegistry registry(milliseconds(1000), milliseconds(100));
+    const auto now = std::chrono::system_clock::now();
+    registry.Restore({
+        PeerRecord{"alice", "a:1", now + milliseconds(500)},
+        PeerRecord{"bob", "b:1", now - milliseconds(1)},
+    });
+    EXPECT_EQ(registry.Lookup("alice"), "a:1");
+    EXPECT_FALSE(registry.Lookup("bob").has_value());
+    EXPECT_TRUE(registry.TakeChanges().Empty());
+
+    // Срок восстановленной записи сохраняется
+    EXPECT_EQ(registry.Expire(PeerRegistry::Clock::now() + milliseconds(700)), 1U);
+}
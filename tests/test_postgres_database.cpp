@@ -0,0 +1,131 @@
+/**
+ * @file test_postgres_database.cpp
+ * @brief Интеграционные тесты хранилища PostgreSQL
+ *
+ * Проверяются:
+ * - Initialize() на пустой схеме создает все таблицы до подготовки запросов
+ * - Повторный Initialize() на уже созданной схеме
+ * - Запись пакета посещений разных месяцев одной командой
+ *
+ * Тесты выполняются, только если в TEST_DB_CONN_STRING задана строка
+ * подключения к доступному серверу (bazel test --test_env=TEST_DB_CONN_STRING=...),
+ * иначе пропускаются. Каждый тест работает в собственной схеме, которая
+ * удаляется после теста.
+ *
+ * @date 2025
+ */
+
+#include "src/database.hpp"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <pqxx/pqxx>
+#include <string>
+
+namespace {
+
+/**
+ * @brief Тест с пустой схемой PostgreSQL
+ */
+class PostgresDatabaseTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        const char* conn_string = std::getenv("TEST_DB_CONN_STRING");
+        if (conn_string == nullptr || *conn_string == '\0') {
+            GTEST_SKIP() << "TEST_DB_CONN_STRING is not set";
+        }
+        conn_string_ = conn_string;
+        schema_ = "p2p_test_" + std::to_string(::getpid());
+        try {
+            Execute("DROP SCHEMA IF EXISTS " + schema_ + " CASCADE; CREATE SCHEMA " + schema_);
+        } catch (const pqxx::broken_connection& e) {
+            GTEST_SKIP() << "PostgreSQL is unreachable: " << e.what();
+        }
+
+        // Соединения пула видят только схему теста
+        ::setenv("PGOPTIONS", ("-csearch_path=" + schema_).c_str(), 1);
+        auto snapshot = std::make_shared<ConfigSnapshot>(*GetLiveConfig().Load());
+        snapshot->db_conn_string = conn_string_;
+        GetLiveConfig().Publish(std::move(snapshot));
+    }
+
+    void TearDown() override {
+        if (!schema_.empty()) {
+            Execute("DROP SCHEMA IF EXISTS " + schema_ + " CASCADE");
+        }
+    }
+
+    /**
+     * @brief Выполняет запрос в отдельном соединении вне схемы теста
+     */
+    void Execute(const std::string& query) const {
+        pqxx::connection conn(conn_string_);
+        pqxx::nontransaction transaction(conn);
+        transaction.exec(query);
+        transaction.commit();
+    }
+
+    /**
+     * @brief Читает число из первой строки результата запроса в схеме теста
+     */
+    [[nodiscard]] int64_t QueryNumber(const std::string& query) const {
+        pqxx::connection conn(conn_string_);
+        pqxx::nontransaction transaction(conn);
+        transaction.exec("SET search_path TO " + schema_);
+        const pqxx::result res = transaction.exec(query);
+        return res[0][0].as<int64_t>();
+    }
+
+    std::string conn_string_;  ///< Строка подключения из TEST_DB_CONN_STRING
+    std::string schema_;       ///< Схема теста
+};
+
+// Все запросы сервиса готовятся при первом ExecutePrepared(), поэтому
+// Initialize() должен создать таблицы сообщений и пиров до разделов visits
+TEST_F(PostgresDatabaseTest, InitializesEmptySchema) {
+    PostgresDatabase db(1);
+    ASSERT_NO_THROW(db.Initialize());
+
+    EXPECT_EQ(db.GetCount(), 0U);
+    db.MarkVisit();
+    EXPECT_EQ(db.GetCount(), 1U);
+
+    const uint64_t first = db.ReserveMessageIds();
+    EXPECT_EQ(db.ReserveMessageIds(), first + IDatabaseService::kMessageIdBlock);
+    EXPECT_TRUE(db.GetMessages(1, UINT64_MAX, 10).empty());
+    EXPECT_TRUE(db.LoadPeers().empty());
+}
+
+TEST_F(PostgresDatabaseTest, InitializesExistingSchema) {
+    {
+        PostgresDatabase db(1);
+        db.Initialize();
+        db.MarkVisit();
+    }
+    PostgresDatabase db(1);
+    ASSERT_NO_THROW(db.Initialize());
+    EXPECT_EQ(db.GetCount(), 1U);
+}
+
+// Недостающие разделы создаются той же командой, что записывает пакет
+TEST_F(PostgresDatabaseTest, MarksVisitsAcrossMonths) {
+    PostgresDatabase db(1);
+    db.Initialize();
+
+    // 2025-01-15 и 2025-03-15 00:00:00 UTC
+    const auto january = std::chrono::system_clock::time_point(std::chrono::seconds(1736899200));
+    const auto march = std::chrono::system_clock::time_point(std::chrono::seconds(1741996800));
+    db.MarkVisits({january, march, march});
+
+    EXPECT_EQ(db.GetCount(), 3U);
+    EXPECT_EQ(QueryNumber("SELECT COUNT(*) FROM visits_202501"), 1);
+    EXPECT_EQ(QueryNumber("SELECT COUNT(*) FROM visits_202503"), 2);
+    EXPECT_EQ(QueryNumber("SELECT COALESCE(SUM(count), 0) FROM visits_per_minute"), 3);
+}
+
+}  // namespace
@@ -0,0 +1,178 @@
+/**
+ * @file test_room_hub.cpp
+ * @brief Unit-тесты рассылки сообщений по комнатам
+ *
+ * Проверяются:
+ * - Лимит SendQueue и слияние пробуждений писателя
+ * - Рассылка одного буфера всем участникам комнаты без копирования
+ * - Вход и выход участников во время рассылки
+ *
+ * @date 2025
+ */
+
+#include "src/room_hub.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Участник, запоминающий полученные кадры
+ */
+class RecordingSubscriber : public IRoomSubscriber {
+   public:
+    explicit RecordingSubscriber(bool accepts_compressed = false)
+        : accepts_compressed_(accepts_compressed) {
+    }
+
+    void Deliver(const RoomMessage& message) override {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        frames_.push_back(message.For(accepts_compressed_));
+    }
+
+    std::vector<SharedFrame> Frames() {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        return frames_;
+    }
+
+   private:
+    bool accepts_compressed_;
+    std::mutex mutex_;
+    std::vector<SharedFrame> frames_;
+};
+
+SharedFrame MakeFrame(std::size_t size, char fill = 'x') {
+    return std::make_shared<const std::string>(size, fill);
+}
+
+}  // namespace
+
+/**
+ * @brief Писателя нужно будить только при выходе очереди из простоя
+ */
+TEST(SendQueueTest, CoalescesWakeups) {
+    SendQueue queue(1024);
+    EXPECT_EQ(queue.Push(MakeFrame(10)), SendQueue::PushResult::kQueuedWake);
+    EXPECT_EQ(queue.Push(MakeFrame(10)), SendQueue::PushResult::kQueued);
+    EXPECT_EQ(queue.PushUnbounded(MakeFrame(10)), SendQueue::PushResult::kQueued);
+
+    std::vector<SharedFrame> batch;
+    EXPECT_EQ(queue.PopBatch(batch, 2), 2U);
+    EXPECT_EQ(queue.Bytes(), 10U);
+    // Писатель еще работает: новые кадры не требуют пробуждения
+    EXPECT_EQ(queue.Push(MakeFrame(10)), SendQueue::PushResult::kQueued);
+    EXPECT_EQ(queue.PopBatch(batch, 64), 2U);
+    EXPECT_EQ(batch.size(), 4U);
+
+    // Пустой PopBatch усыпляет писателя
+    EXPECT_EQ(queue.PopBatch(batch, 64), 0U);
+    EXPECT_EQ(queue.Push(MakeFrame(10)), SendQueue::PushResult::kQueuedWake);
+}
+
+/**
+ * @brief Кадр, не помещающийся в лимит, отклоняется; служебные кадры - нет
+ */
+TEST(SendQueueTest, EnforcesByteLimit) {
+    SendQueue queue(100);
+    EXPECT_EQ(queue.Push(MakeFrame(60)), SendQueue::PushResult::kQueuedWake);
+    EXPECT_EQ(queue.Push(MakeFrame(60)), SendQueue::PushResult::kOverflow);
+    EXPECT_EQ(queue.Push(MakeFrame(40)), SendQueue::PushResult::kQueued);
+    EXPECT_TRUE(queue.Full());
+
+    EXPECT_EQ(queue.PushUnbounded(MakeFrame(60)), SendQueue::PushResult::kQueued);
+    EXPECT_EQ(queue.Bytes(), 160U);
+
+    std::vector<SharedFrame> batch;
+    queue.PopBatch(batch, 2);
+    EXPECT_FALSE(queue.Full());
+    EXPECT_EQ(queue.Push(MakeFrame(40)), SendQueue::PushResult::kQueued);
+}
+
+/**
+ * @brief Все участники комнаты получают один и тот же буфер
+ */
+TEST(RoomHubTest, FansOutSharedBuffer) {
+    RoomHub hub;
+    auto alice = std::make_shared<RecordingSubscriber>();
+    auto bob = std::make_shared<RecordingSubscriber>(true);
+    auto carol = std::make_shared<RecordingSubscriber>(true);
+    EXPECT_TRUE(hub.Join(1, alice));
+    EXPECT_TRUE(hub.Join(1, bob));
+    EXPECT_FALSE(hub.Join(1, bob));
+    EXPECT_TRUE(hub.Join(2, carol));
+    EXPECT_EQ(hub.Size(1), 2U);
+
+    const RoomMessage message{MakeFrame(100, 'p'), MakeFrame(20, 'c')};
+    EXPECT_EQ(hub.Publish(1, message), 2U);
+    EXPECT_EQ(hub.Publish(3, message), 0U);
+
+    ASSERT_EQ(alice->Frames().size(), 1U);
+    EXPECT_EQ(alice->Frames()[0].get(), message.plain.get());
+    ASSERT_EQ(bob->Frames().size(), 1U);
+    EXPECT_EQ(bob->Frames()[0].get(), message.compressed.get());
+    EXPECT_TRUE(carol->Frames().empty());
+
+    // Без сжатого варианта все получают обычный кадр
+    const RoomMessage plain_only{MakeFrame(10), nullptr};
+    hub.Publish(1, plain_only);
+    EXPECT_EQ(bob->Frames()[1].get(), plain_only.plain.get());
+}
+
+/**
+ * @brief Вышедший участник больше не получает сообщений, пустая комната удаляется
+ */
+TEST(RoomHubTest, LeaveRemovesMember) {
+    RoomHub hub;
+    auto alice = std::make_shared<RecordingSubscriber>();
+    auto bob = std::make_shared<RecordingSubscriber>();
+    hub.Join(5, alice);
+    hub.Join(5, bob);
+
+    EXPECT_TRUE(hub.Leave(5, alice.get()));
+    EXPECT_FALSE(hub.Leave(5, alice.get()));
+    hub.Publish(5, RoomMessage{MakeFrame(8), nullptr});
+    EXPECT_TRUE(alice->Frames().empty());
+    EXPECT_EQ(bob->Frames().size(), 1U);
+
+    EXPECT_TRUE(hub.Leave(5, bob.get()));
+    EXPECT_EQ(hub.Size(5), 0U);
+    EXPECT_EQ(hub.Publish(5, RoomMessage{MakeFrame(8), nullptr}), 0U);
+}
+
+/**
+ * @brief Вход и выход участников не мешают параллельной рассылке
+ */
+TEST(RoomHubTest, ConcurrentMembershipChanges) {
+    RoomHub hub;
+    auto stable = std::make_shared<RecordingSubscriber>();
+    hub.Join(1, stable);
+
+    constexpr int kMessages = 2000;
+    std::atomic<bool> done{false};
+    std::thread churn([&] {
+        while (!done.load()) {
+            auto member = std::make_shared<RecordingSubscriber>();
+            hub.Join(1, member);
+            hub.Leave(1, member.get());
+        }
+    });
+
+    const RoomMessage message{MakeFrame(16), nullptr};
+    for (int i = 0; i < kMessages; ++i) {
+        EXPECT_GE(hub.Publish(1, message), 1U);
+    }
+    done = true;
+    churn.join();
+
+    EXPECT_EQ(stable->Frames().size(), static_cast<std::size_t>(kMessages));
+    EXPECT_EQ(hub.Size(1), 1U);
+}
@@ -0,0 +1,92 @@
+/**
+ * @file test_socket_tuning.cpp
+ * @brief Unit-тесты настройки сокетов слушателя и соединений
+ *
+ * Проверяются:
+ * - SO_REUSEPORT: два слушателя на одном порту
+ * - TCP_DEFER_ACCEPT на слушателе
+ * - TCP_NODELAY на принятом соединении
+ *
+ * @date 2025
+ */
+
+#include "src/socket_tuning.hpp"
+
+#include <gtest/gtest.h>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/address_v4.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/system/system_error.hpp>
+
+namespace {
+
+using Tcp = boost::asio::ip::tcp;
+
+/// Адрес loopback со свободным портом, выбираемым ядром
+const Tcp::endpoint kAnyLoopback(boost::asio::ip::address_v4::loopback(), 0);
+
+}  // namespace
+
+#if defined(__linux__)
+/**
+ * @brief С SO_REUSEPORT второй слушатель занимает тот же порт, без него - нет
+ */
+TEST(SocketTuningTest, ReusePortSharesListenPort) {
+    boost::asio::io_context io_context;
+    SocketTuning tuning;
+    tuning.reuse_port = true;
+
+    Tcp::acceptor first(io_context);
+    ListenTuned(first, kAnyLoopback, tuning);
+    const Tcp::endpoint bound = first.local_endpoint();
+
+    Tcp::acceptor second(io_context);
+    EXPECT_NO_THROW(ListenTuned(second, bound, tuning));
+
+    Tcp::acceptor third(io_context);
+    EXPECT_THROW(ListenTuned(third, bound, SocketTuning{}), boost::system::system_error);
+}
+
+/**
+ * @brief TCP_DEFER_ACCEPT устанавливается на слушателе только по запросу
+ */
+TEST(SocketTuningTest, DeferAcceptIsOptional) {
+    boost::asio::io_context io_context;
+    Tcp::acceptor plain(io_context);
+    ListenTuned(plain, kAnyLoopback, SocketTuning{});
+    DeferAcceptOption option;
+    plain.get_option(option);
+    EXPECT_EQ(option.value(), 0);
+
+    SocketTuning tuning;
+    tuning.defer_accept_s = 5;
+    tuning.backlog = 16;
+    Tcp::acceptor deferred(io_context);
+    ListenTuned(deferred, kAnyLoopback, tuning);
+    deferred.get_option(option);
+    EXPECT_GT(option.value(), 0);
+}
+#endif
+
+/**
+ * @brief TuneSocket отключает алгоритм Нейгла на принятом соединении
+ */
+TEST(SocketTuningTest, TuneSocketSetsNoDelay) {
+    boost::asio::io_context io_context;
+    Tcp::acceptor acceptor(io_context);
+    ListenTuned(acceptor, kAnyLoopback, SocketTuning{});
+
+    Tcp::socket client(io_context);
+    client.connect(acceptor.local_endpoint());
+    Tcp::socket accepted(io_context);
+    acceptor.accept(accepted);
+
+    Tcp::no_delay option;
+    accepted.get_option(option);
+    EXPECT_FALSE(option.value());
+
+    TuneSocket(accepted, SocketTuning{});
+    accepted.get_option(option);
+    EXPECT_TRUE(option.value());
+}
@@ -0,0 +1,254 @@
+/**
+ * @file test_tls_stream.cpp
+ * @brief Unit-тесты серверного потока TLS на сокете
+ *
+ * Проверяются:
+ * - Рукопожатие и обмен данными с клиентом boost::asio::ssl::stream,
+ *   в том числе запись из нескольких буферов
+ * - Возобновление сессии по билету TLS 1.3 и TLS 1.2
+ * - Общие ключи билетов (TLS_TICKET_KEY_FILE): билет одного контекста
+ *   принимается другим
+ *
+ * Сертификат и ключ создаются при запуске теста.
+ *
+ * @date 2025
+ */
+
+#include "src/config.hpp"
+#include "src/tls_stream.hpp"
+
+#include <gtest/gtest.h>
+
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/connect.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/address_v4.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/ssl/stream.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/asio/write.hpp>
+
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+
+#include <array>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace {
+
+using Tcp = boost::asio::ip::tcp;
+
+/// Итог обслуживания одного соединения сервером
+struct Served {
+    std::string received;  ///< Данные, прочитанные сервером
+    bool resumed = false;  ///< Возобновлена ли сессия
+};
+
+/**
+ * @brief Создает самоподписанный сертификат и ключ ECDSA P-256 в файлах PEM
+ */
+void WriteCertificate(const std::string& cert_path, const std::string& key_path) {
+    EVP_PKEY* key = EVP_EC_gen("P-256");
+    ASSERT_NE(key, nullptr);
+    X509* cert = X509_new();
+    ASSERT_NE(cert, nullptr);
+    X509_set_version(cert, 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+    X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+    X509_gmtime_adj(X509_getm_notAfter(cert), 3600);
+    X509_set_pubkey(cert, key);
+    X509_NAME* name = X509_get_subject_name(cert);
+    X509_NAME_add_entry_by_txt(
+        name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("localhost"), -1, -1, 0);
+    X509_set_issuer_name(cert, name);
+    ASSERT_GT(X509_sign(cert, key, EVP_sha256()), 0);
+
+    FILE* cert_file = std::fopen(cert_path.c_str(), "w");
+    FILE* key_file = std::fopen(key_path.c_str(), "w");
+    ASSERT_NE(cert_file, nullptr);
+    ASSERT_NE(key_file, nullptr);
+    PEM_write_X509(cert_file, cert);
+    PEM_write_PrivateKey(key_file, key, nullptr, nullptr, 0, nullptr, nullptr);
+    std::fclose(cert_file);
+    std::fclose(key_file);
+    X509_free(cert);
+    EVP_PKEY_free(key);
+}
+
+/**
+ * @brief Принимает одно соединение, читает 4 байта и отвечает "pong" двумя буферами
+ */
+boost::asio::awaitable<void> ServeOnce(
+    Tcp::acceptor& acceptor, boost::asio::ssl::context& context, std::promise<Served>& result) {
+    Tcp::socket socket = co_await acceptor.async_accept(boost::asio::use_awaitable);
+    TlsStream stream(std::move(socket), context);
+    co_await stream.async_handshake(boost::asio::use_awaitable);
+
+    std::array<char, 4> data{};
+    co_await boost::asio::async_read(
+        stream, boost::asio::buffer(data), boost::asio::use_awaitable);
+    const std::array<boost::asio::const_buffer, 2> reply{
+        boost::asio::buffer("po", 2), boost::asio::buffer("ng", 2)};
+    co_await boost::asio::async_write(stream, reply, boost::asio::use_awaitable);
+    result.set_value(Served{std::string(data.data(), data.size()), stream.Resumed()});
+}
+
+/**
+ * @brief Сервер TLS на loopback, обслуживающий по одному соединению за вызов
+ */
+class TlsServer {
+   public:
+    explicit TlsServer(std::shared_ptr<boost::asio::ssl::context> context)
+        : context_(std::move(context)), acceptor_(io_context_, {Tcp::v4(), 0}) {
+    }
+
+    /// Порт слушателя
+    unsigned short Port() const {
+        return acceptor_.local_endpoint().port();
+    }
+
+    /// Запускает обслуживание одного соединения в отдельном потоке
+    std::future<Served> Serve() {
+        // Прошлый run() должен вернуться до restart(): иначе он может
+        // остановить io_context уже после перезапуска
+        if (worker_.joinable()) {
+            worker_.join();
+        }
+        result_ = std::promise<Served>();
+        io_context_.restart();
+        boost::asio::co_spawn(
+            io_context_, ServeOnce(acceptor_, *context_, result_),
+            [this](const std::exception_ptr& error) {
+                if (error) {
+                    result_.set_exception(error);
+                }
+            });
+        worker_ = std::thread([this] { io_context_.run(); });
+        return result_.get_future();
+    }
+
+    ~TlsServer() {
+        if (worker_.joinable()) {
+            worker_.join();
+        }
+    }
+
+    TlsServer(const TlsServer&) = delete;
+    TlsServer& operator=(const TlsServer&) = delete;
+
+   private:
+    std::shared_ptr<boost::asio::ssl::context> context_;
+    boost::asio::io_context io_context_;
+    Tcp::acceptor acceptor_;
+    std::promise<Served> result_;
+    std::thread worker_;
+};
+
+/**
+ * @brief Клиент: подключается, отправляет "ping", читает ответ
+ *
+ * @param port Порт сервера
+ * @param max_version Максимальная версия TLS клиента
+ * @param session Сессия для возобновления (nullptr - полное рукопожатие)
+ * @return SSL_SESSION* Сессия с билетом, полученным от сервера
+ */
+SSL_SESSION* Exchange(unsigned short port, int max_version, SSL_SESSION* session) {
+    boost::asio::io_context io_context;
+    boost::asio::ssl::context context(boost::asio::ssl::context::tls_client);
+    SSL_CTX_set_max_proto_version(context.native_handle(), max_version);
+    context.set_verify_mode(boost::asio::ssl::verify_none);
+    boost::asio::ssl::stream<Tcp::socket> stream(io_context, context);
+    stream.next_layer().connect({boost::asio::ip::address_v4::loopback(), port});
+    if (session != nullptr) {
+        SSL_set_session(stream.native_handle(), session);
+    }
+    stream.handshake(boost::asio::ssl::stream_base::client);
+    boost::asio::write(stream, boost::asio::buffer("ping", 4));
+    std::array<char, 4> reply{};
+    boost::asio::read(stream, boost::asio::buffer(reply));
+    EXPECT_EQ(std::string(reply.data(), reply.size()), "pong");
+    // Без close_notify OpenSSL помечает сессию клиента невозобновляемой
+    SSL_SESSION* result = SSL_get1_session(stream.native_handle());
+    boost::system::error_code ignored;
+    SSL_shutdown(stream.native_handle());
+    stream.lowest_layer().close(ignored);
+    return result;
+}
+
+/**
+ * @brief Окружение: сертификат во временном каталоге и пути к нему в конфигурации
+ */
+class TlsStreamTest : public ::testing::Test {
+   protected:
+    static void SetUpTestSuite() {
+        const std::string dir = ::testing::TempDir();
+        WriteCertificate(dir + "tls_test.crt", dir + "tls_test.key");
+        GetConfig().Put("TLS_CERT_FILE", dir + "tls_test.crt");
+        GetConfig().Put("TLS_KEY_FILE", dir + "tls_test.key");
+    }
+};
+
+}  // namespace
+
+/**
+ * @brief Первое соединение выполняет полное рукопожатие и обменивается данными
+ */
+TEST_F(TlsStreamTest, HandshakeAndExchange) {
+    TlsServer server(MakeTlsContext(GetConfig()));
+    auto served = server.Serve();
+    SSL_SESSION* session = Exchange(server.Port(), TLS1_3_VERSION, nullptr);
+    const Served result = served.get();
+    EXPECT_EQ(result.received, "ping");
+    EXPECT_FALSE(result.resumed);
+    SSL_SESSION_free(session);
+}
+
+/**
+ * @brief Повторное подключение с билетом возобновляет сессию (TLS 1.3 и 1.2)
+ */
+TEST_F(TlsStreamTest, ResumesFromTicket) {
+    for (const int version : {TLS1_3_VERSION, TLS1_2_VERSION}) {
+        TlsServer server(MakeTlsContext(GetConfig()));
+        auto first = server.Serve();
+        SSL_SESSION* session = Exchange(server.Port(), version, nullptr);
+        EXPECT_FALSE(first.get().resumed);
+
+        auto second = server.Serve();
+        SSL_SESSION_free(Exchange(server.Port(), version, session));
+        EXPECT_TRUE(second.get().resumed) << "version " << version;
+        SSL_SESSION_free(session);
+    }
+}
+
+/**
+ * @brief С общим файлом ключей билет одного контекста принимает другой
+ */
+TEST_F(TlsStreamTest, SharedTicketKeys) {
+    const std::string path = ::testing::TempDir() + "tls_test.tickets";
+    {
+        std::ofstream file(path, std::ios::binary);
+        for (int i = 0; i < 80; ++i) {
+            file.put(static_cast<char>(i * 7 + 3));
+        }
+    }
+    GetConfig().Put("TLS_TICKET_KEY_FILE", path);
+
+    TlsServer issuer(MakeTlsContext(GetConfig()));
+    auto first = issuer.Serve();
+    SSL_SESSION* session = Exchange(issuer.Port(), TLS1_3_VERSION, nullptr);
+    first.get();
+
+    TlsServer other(MakeTlsContext(GetConfig()));
+    auto second = other.Serve();
+    SSL_SESSION_free(Exchange(other.Port(), TLS1_3_VERSION, session));
+    EXPECT_TRUE(second.get().resumed);
+    SSL_SESSION_free(session);
+}
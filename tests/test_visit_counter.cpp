@@ -0,0 +1,118 @@
+/**
+ * @file test_visit_counter.cpp
+ * @brief Unit-тесты кеширующего счетчика и буфера записи посещений
+ *
+ * Проверяются:
+ * - Засев счетчика и гистограммы из нижележащего сервиса
+ * - Аналитика посещений из памяти без обращения к нижележащему сервису
+ * - Недоступность аналитики, если сервис не хранит историю
+ * - Подсчет посещений буфера записи без повторного учета сброшенных
+ *
+ * @date 2025
+ */
+
+#include "src/memory_database.hpp"
+#include "src/visit_counter.hpp"
+#include "src/visit_recorder.hpp"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace {
+
+using std::chrono::hours;
+using std::chrono::milliseconds;
+using std::chrono::minutes;
+using TimePoint = std::chrono::system_clock::time_point;
+
+/**
+ * @brief Хранилище в памяти, которое считает запросы аналитики
+ */
+class CountingDatabase : public InMemoryDatabase {
+   public:
+    std::vector<VisitBucket> GetVisitCounts(
+        TimePoint from, TimePoint to, VisitGranularity granularity) override {
+        ++queries;
+        return InMemoryDatabase::GetVisitCounts(from, to, granularity);
+    }
+
+    int queries = 0;  ///< Количество запросов аналитики
+};
+
+/**
+ * @brief Сервис без аналитики посещений
+ */
+class CountOnlyDatabase : public IDatabaseService {
+   public:
+    void Initialize() override {
+    }
+
+    void MarkVisit() override {
+    }
+
+    uint64_t GetCount() override {
+        return 7;
+    }
+};
+
+}  // namespace
+
+/**
+ * @brief История загружается при инициализации, новые посещения добавляются в память
+ */
+TEST(CachedVisitCounterTest, ServesVisitCountsFromMemory) {
+    const TimePoint hour_start =
+        std::chrono::floor<hours>(std::chrono::system_clock::now()) - hours(2);
+    auto backend = std::make_shared<CountingDatabase>();
+    backend->MarkVisits({hour_start, hour_start + minutes(5)});
+
+    CachedVisitCounter counter(backend);
+    counter.Initialize();
+    EXPECT_EQ(backend->queries, 1);
+    counter.MarkVisits({hour_start + minutes(59), hour_start + hours(1)});
+
+    EXPECT_EQ(counter.GetCount(), 4U);
+    const std::vector<VisitBucket> expected{
+        {VisitHistogram::MinuteOf(hour_start), 3},
+        {VisitHistogram::MinuteOf(hour_start + hours(1)), 1},
+    };
+    EXPECT_EQ(
+        counter.GetVisitCounts(hour_start, hour_start + hours(2), VisitGranularity::kHour),
+        expected);
+    EXPECT_EQ(backend->queries, 1);
+}
+
+/**
+ * @brief Без истории в нижележащем сервисе аналитика недоступна, счетчик работает
+ */
+TEST(CachedVisitCounterTest, ReportsMissingHistory) {
+    CachedVisitCounter counter(std::make_shared<CountOnlyDatabase>());
+    counter.Initialize();
+
+    EXPECT_EQ(counter.GetCount(), 7U);
+    const TimePoint now = std::chrono::system_clock::now();
+    EXPECT_THROW(
+        counter.GetVisitCounts(now - hours(1), now, VisitGranularity::kMinute),
+        DatabaseUnavailableError);
+}
+
+/**
+ * @brief Посещения считаются один раз: в буфере до сброса, в хранилище после
+ */
+TEST(BatchedVisitRecorderTest, CountsEachVisitOnce) {
+    auto backend = std::make_shared<InMemoryDatabase>();
+    BatchedVisitRecorder recorder(backend, 1000, milliseconds(60000));
+    for (int i = 0; i < 3; ++i) {
+        recorder.MarkVisit();
+    }
+    EXPECT_EQ(recorder.GetCount(), 3U);
+    EXPECT_EQ(backend->GetCount(), 0U);
+
+    recorder.Flush();
+    EXPECT_EQ(backend->GetCount(), 3U);
+    EXPECT_EQ(recorder.GetCount(), 3U);
+}
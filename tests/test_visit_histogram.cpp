@@ -0,0 +1,114 @@
+/**
+ * @file test_visit_histogram.cpp
+ * @brief Unit-тесты предварительной агрегации посещений по минутам
+ *
+ * Проверяются:
+ * - Агрегация посещений по минутам, в том числе не по порядку времени
+ * - Суммирование по часам и суткам в границах периода
+ * - Слияние интервалов базы данных и буфера
+ * - Разбор имени размера интервала
+ *
+ * @date 2025
+ */
+
+#include "src/visit_histogram.hpp"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <vector>
+
+namespace {
+
+using std::chrono::hours;
+using std::chrono::minutes;
+using std::chrono::seconds;
+using TimePoint = std::chrono::system_clock::time_point;
+
+/// 2025-01-01 00:00:00 UTC
+const TimePoint kDayStart = TimePoint(seconds(1735689600));
+
+/// Минута от эпохи для момента времени
+int64_t Minute(TimePoint time) {
+    return VisitHistogram::MinuteOf(time);
+}
+
+}  // namespace
+
+/**
+ * @brief Посещения одной минуты складываются, поздние и ранние встают по порядку
+ */
+TEST(VisitHistogramTest, AggregatesByMinute) {
+    VisitHistogram histogram;
+    histogram.Add(kDayStart + seconds(1));
+    histogram.Add(kDayStart + seconds(59));
+    histogram.Add(kDayStart + minutes(2));
+    histogram.Add(kDayStart + minutes(1) + seconds(30));
+    histogram.Add(kDayStart + seconds(30));
+
+    const std::vector<VisitBucket> expected{
+        {Minute(kDayStart), 3},
+        {Minute(kDayStart + minutes(1)), 1},
+        {Minute(kDayStart + minutes(2)), 1},
+    };
+    EXPECT_EQ(histogram.Buckets(), expected);
+    EXPECT_EQ(histogram.Buckets()[0].Start(), kDayStart);
+}
+
+/**
+ * @brief Запрос суммирует минуты по часам и не выходит за границы периода
+ */
+TEST(VisitHistogramTest, QueriesHours) {
+    VisitHistogram histogram;
+    histogram.Add(kDayStart + minutes(5), 2);
+    histogram.Add(kDayStart + minutes(59));
+    histogram.Add(kDayStart + hours(1), 4);
+    histogram.Add(kDayStart + hours(3));
+
+    const std::vector<VisitBucket> expected{
+        {Minute(kDayStart), 3},
+        {Minute(kDayStart + hours(1)), 4},
+    };
+    // Начало периода округляется вниз до часа, конец не включается
+    EXPECT_EQ(
+        histogram.Query(kDayStart + minutes(30), kDayStart + hours(3), VisitGranularity::kHour),
+        expected);
+
+    const std::vector<VisitBucket> day{{Minute(kDayStart), 8}};
+    EXPECT_EQ(
+        histogram.Query(kDayStart, kDayStart + hours(24), VisitGranularity::kDay), day);
+    EXPECT_TRUE(
+        histogram.Query(kDayStart + hours(4), kDayStart + hours(5), VisitGranularity::kMinute)
+            .empty());
+}
+
+/**
+ * @brief Слияние складывает совпадающие интервалы и сохраняет порядок
+ */
+TEST(VisitHistogramTest, MergesBuckets) {
+    const std::vector<VisitBucket> stored{{0, 1}, {60, 2}, {180, 3}};
+    const std::vector<VisitBucket> buffered{{60, 5}, {120, 1}, {240, 7}};
+    const std::vector<VisitBucket> expected{{0, 1}, {60, 7}, {120, 1}, {180, 3}, {240, 7}};
+    EXPECT_EQ(VisitHistogram::Merge(stored, buffered), expected);
+    EXPECT_EQ(VisitHistogram::Merge({}, buffered), buffered);
+}
+
+/**
+ * @brief Округление вниз работает и для отрицательных минут
+ */
+TEST(VisitHistogramTest, AlignsDown) {
+    EXPECT_EQ(VisitHistogram::AlignDown(125, 60), 120);
+    EXPECT_EQ(VisitHistogram::AlignDown(120, 60), 120);
+    EXPECT_EQ(VisitHistogram::AlignDown(-1, 60), -60);
+}
+
+/**
+ * @brief Имена размеров интервала
+ */
+TEST(VisitHistogramTest, ParsesGranularity) {
+    EXPECT_EQ(ParseVisitGranularity("minute"), VisitGranularity::kMinute);
+    EXPECT_EQ(ParseVisitGranularity("hour"), VisitGranularity::kHour);
+    EXPECT_EQ(ParseVisitGranularity("day"), VisitGranularity::kDay);
+    EXPECT_FALSE(ParseVisitGranularity("week").has_value());
+    EXPECT_EQ(MinutesPerBucket(VisitGranularity::kDay), 1440);
+}